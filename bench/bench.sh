@@ -0,0 +1,177 @@
+#!/bin/sh
+#
+# bench.sh: End-to-end and per-metric throughput of bin/srcmetrics.
+#
+# Usage: bench/bench.sh [corpus_dir]...
+#
+# Without arguments, benchmarks a synthetic corpus from bin/gencorpus and examples/*_preprocessed.c.
+# With arguments, benchmarks every .c file under each corpus_dir instead.
+#
+# Every corpus runs once per configuration, i.e.,
+#   parse   : all metrics excluded, so srcML parse + SAX dispatch only,
+#   all     : all metrics,
+#   <METRIC>: one metric alone,
+# and the metric time is the difference from the parse time. The report time is part of the metric time.
+#
+# Environment:
+#   BENCH_FILES, BENCH_FNS, BENCH_DEPTH, BENCH_CALLS, BENCH_SEED: the synthetic corpus, see gencorpus.c
+#   BENCH_REPEAT: runs per configuration, the fastest one counts (default: 3)
+#   BENCH_JOBS:   the '--jobs' argument (default: 1)
+#   BENCH_ARGS:   extra srcmetrics arguments, e.g., '--stream'
+#   BENCH_CSV:    also append the results to this CSV file
+#   BENCH_PERF:   if set, also count the instructions of one more run per configuration with perf stat
+#
+set -e
+
+SRCMETRICS=${SRCMETRICS:-bin/srcmetrics}
+GENCORPUS=${GENCORPUS:-bin/gencorpus}
+BENCH_DIR=${BENCH_DIR:-bench/corpus}
+
+BENCH_FILES=${BENCH_FILES:-200}
+BENCH_FNS=${BENCH_FNS:-20}
+BENCH_DEPTH=${BENCH_DEPTH:-4}
+BENCH_CALLS=${BENCH_CALLS:-8}
+BENCH_SEED=${BENCH_SEED:-20231}
+BENCH_REPEAT=${BENCH_REPEAT:-3}
+BENCH_JOBS=${BENCH_JOBS:-1}
+
+if [ ! -x "${SRCMETRICS}" ]; then
+    echo "${SRCMETRICS} is NOT built, run 'make' first" >&2
+    exit 1
+fi
+
+# Measures one run with time(1), prints "<seconds> <peak RSS in KB>"
+case "$(uname -s)" in
+    Darwin)
+        measure() {
+            /usr/bin/time -l "$@" 2> "${TMP_DIR}/time" > /dev/null
+            awk '/ real /{ s = $1 } /maximum resident set size/{ kb = $1 / 1024 } END { printf "%s %d\n", s, kb }' "${TMP_DIR}/time"
+        }
+        ;;
+    *)
+        if [ -x /usr/bin/time ]; then
+            measure() {
+                /usr/bin/time -f "%e %M" "$@" 2> "${TMP_DIR}/time" > /dev/null
+                tail -n 1 "${TMP_DIR}/time"
+            }
+        else
+            # No GNU time, so no peak RSS either
+            measure() {
+                start=$(date +%s%N)
+                "$@" > /dev/null 2>&1
+                end=$(date +%s%N)
+                awk -v a="${start}" -v b="${end}" 'BEGIN { printf "%.3f 0\n", (b - a) / 1e9 }'
+            }
+        fi
+        ;;
+esac
+
+# Counts the instructions of one run with perf stat, or prints 0 without BENCH_PERF or perf
+count_instructions() {
+    if [ -n "${BENCH_PERF}" ] && command -v perf > /dev/null 2>&1; then
+        perf stat -x, -e instructions -o "${TMP_DIR}/perf" "$@" > /dev/null 2>&1 || true
+        awk -F, '$3 ~ /^instructions/ && $1 ~ /^[0-9]+$/ { n = $1 } END { print (n == "") ? 0 : n }' "${TMP_DIR}/perf"
+    else
+        echo 0
+    fi
+}
+
+# Counts the srcML elements of the corpus, if the srcml tool is available
+count_elements() {
+    if command -v srcml > /dev/null 2>&1; then
+        srcml --files-from "$1" | tr '<' '\n' | grep -c '^[a-z]' || true
+    else
+        echo 0
+    fi
+}
+
+TMP_DIR=$(mktemp -d)
+trap 'rm -rf "${TMP_DIR}"' EXIT
+
+METRICS=$("${SRCMETRICS}" -L 2>&1 | sed -n 's/^ *\([A-Z][A-Z]*\): .*/\1/p')
+
+EXCLUDE_ALL=""
+for metric in ${METRICS}; do EXCLUDE_ALL="${EXCLUDE_ALL} -e ${metric}"; done
+
+if [ -n "${BENCH_CSV}" ] && [ ! -f "${BENCH_CSV}" ]; then
+    echo "corpus,config,files,bytes,elements,seconds,files_per_s,mb_per_s,elements_per_s,peak_rss_kb,metric_seconds,instructions" > "${BENCH_CSV}"
+fi
+
+# Benchmarks every configuration on one corpus
+bench_corpus() {
+    name=$1
+    list=$2
+
+    files=$(wc -l < "${list}" | tr -d ' ')
+    bytes=$(while IFS= read -r f; do cat "${f}"; done < "${list}" | wc -c | tr -d ' ')
+    elements=$(count_elements "${list}")
+
+    echo ""
+    echo "${name}: ${files} files, ${bytes} bytes, ${elements} elements"
+    printf "%-8s %10s %10s %10s %14s %12s %12s %16s\n" \
+        "config" "seconds" "files/s" "MB/s" "elements/s" "peak RSS MB" "metric s" "instructions"
+
+    parse_seconds=""
+    for config in parse all ${METRICS}; do
+        case "${config}" in
+            parse) metric_args="${EXCLUDE_ALL}" ;;
+            all)   metric_args="-a" ;;
+            *)     metric_args="-m ${config}" ;;
+        esac
+
+        best=""
+        rss=0
+        run=0
+        while [ "${run}" -lt "${BENCH_REPEAT}" ]; do
+            # shellcheck disable=SC2086
+            set -- $(measure "${SRCMETRICS}" -j "${BENCH_JOBS}" ${BENCH_ARGS} ${metric_args} --files-from "${list}")
+            best=$(awk -v a="${best}" -v b="$1" 'BEGIN { print (a == "" || b < a) ? b : a }')
+            [ "$2" -gt "${rss}" ] && rss=$2
+            run=$((run + 1))
+        done
+
+        [ "${config}" = "parse" ] && parse_seconds=${best}
+
+        # shellcheck disable=SC2086
+        instructions=$(count_instructions "${SRCMETRICS}" -j "${BENCH_JOBS}" ${BENCH_ARGS} ${metric_args} --files-from "${list}")
+
+        awk -v name="${name}" -v config="${config}" -v files="${files}" -v bytes="${bytes}" \
+            -v elements="${elements}" -v s="${best}" -v rss="${rss}" -v parse="${parse_seconds}" \
+            -v instructions="${instructions}" -v csv="${BENCH_CSV}" '
+            BEGIN {
+                t  = (s > 0) ? s : 0.001
+                ms = (config == "parse") ? 0 : s - parse
+                printf "%-8s %10.3f %10.1f %10.2f %14.0f %12.1f %12.3f %16.0f\n",
+                    config, s, files / t, bytes / t / 1048576, elements / t, rss / 1024, ms, instructions
+                if (csv != "")
+                    printf "%s,%s,%d,%d,%d,%.3f,%.1f,%.2f,%.0f,%d,%.3f,%.0f\n",
+                        name, config, files, bytes, elements, s, files / t, bytes / t / 1048576, elements / t, rss, ms,
+                        instructions >> csv
+            }'
+    done
+}
+
+if [ "$#" -gt 0 ]; then
+    for dir in "$@"; do
+        find "${dir}" -type f -name '*.c' | sort > "${TMP_DIR}/files"
+        bench_corpus "${dir}" "${TMP_DIR}/files"
+    done
+    exit 0
+fi
+
+if [ ! -x "${GENCORPUS}" ]; then
+    echo "${GENCORPUS} is NOT built, run 'make bin/gencorpus' first" >&2
+    exit 1
+fi
+
+SYNTHETIC_DIR="${BENCH_DIR}/f${BENCH_FILES}_n${BENCH_FNS}_d${BENCH_DEPTH}_c${BENCH_CALLS}_s${BENCH_SEED}"
+if [ ! -d "${SYNTHETIC_DIR}" ]; then
+    mkdir -p "${SYNTHETIC_DIR}"
+    "${GENCORPUS}" "${SYNTHETIC_DIR}" "${BENCH_FILES}" "${BENCH_FNS}" "${BENCH_DEPTH}" "${BENCH_CALLS}" "${BENCH_SEED}"
+fi
+
+find "${SYNTHETIC_DIR}" -type f -name '*.c' | sort > "${TMP_DIR}/synthetic"
+bench_corpus "synthetic" "${TMP_DIR}/synthetic"
+
+ls examples/*_preprocessed.c > "${TMP_DIR}/examples"
+bench_corpus "examples" "${TMP_DIR}/examples"
@@ -0,0 +1,257 @@
+/**
+ * @file gencorpus.c
+ * @brief Generates a synthetic C corpus for the srcmetrics benchmarks.
+ * @author Yavuz Koroglu
+ * @see bench.sh
+ *
+ * Usage: gencorpus <outdir> <file_count> <fns_per_file> <nesting_depth> <calls_per_fn> [seed]
+ *
+ * Every file gets a header comment, a few static globals, and fns_per_file functions with their prototypes. Every function
+ * nests if/for/while/switch statements up to nesting_depth, and calls calls_per_fn functions of the same
+ * file or of the previous files. The same arguments always generate the same corpus.
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define GENCORPUS_MAX_DEPTH     64
+
+#define GENCORPUS_DEFAULT_SEED  20231
+
+/* Every fourth function is static, i.e., private to its file */
+#define IS_STATIC_FN(fn)        ((fn) % 4 == 3)
+
+static uint64_t state = GENCORPUS_DEFAULT_SEED;
+
+/**
+ * @brief A 64-bit LCG, so the corpus does NOT depend on the rand() of the platform.
+ * @param bound The exclusive upper bound.
+ * @return A pseudo-random number in [0, bound).
+ */
+static unsigned nextRandom(unsigned const bound) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return bound == 0 ? 0 : (unsigned)((state >> 33) % bound);
+}
+
+/**
+ * @brief Parses a non-negative integer argument, or exits.
+ * @param name The name of the argument, for the error message.
+ * @param str The argument.
+ */
+static unsigned parseArgument(char const* const name, char const* const str) {
+    char* end;
+    unsigned long const value = strtoul(str, &end, 10);
+    if (*str == '\0' || *end != '\0' || value > 0xFFFFFFFF) {
+        fprintf(stderr, "\n"
+                        "%s '%s' is NOT a non-negative integer\n"
+                        "\n", name, str);
+        exit(EXIT_FAILURE);
+    }
+    return (unsigned)value;
+}
+
+/**
+ * @brief Writes the indentation of a nesting level.
+ */
+static void indent(FILE* const stream, unsigned const level) {
+    for (unsigned i = 0; i < level; i++) fputs("    ", stream);
+}
+
+/**
+ * @brief Writes a call to a random function of this file or a previous file.
+ */
+static void writeCall(FILE* const stream, unsigned const level, unsigned const file_id, unsigned const fns_per_file) {
+    unsigned const callee_file = nextRandom(file_id + 1);
+    unsigned       callee_fn   = nextRandom(fns_per_file);
+
+    /* Cannot call the static functions of another file */
+    if (callee_file != file_id && IS_STATIC_FN(callee_fn)) callee_fn--;
+
+    indent(stream, level);
+    if (nextRandom(4) == 0)
+        fprintf(stream, "x += f%u_%u(x, y);\n", callee_file, callee_fn);
+    else
+        fprintf(stream, "f%u_%u(y, x + %u);\n", callee_file, callee_fn, nextRandom(100));
+}
+
+/**
+ * @brief Writes a simple statement, i.e., an assignment, a declaration, or a comment.
+ */
+static void writeSimpleStatement(FILE* const stream, unsigned const level) {
+    indent(stream, level);
+    switch (nextRandom(6)) {
+        case 0:
+            fprintf(stream, "int t%u = x * %u + y;\n", nextRandom(1000), nextRandom(10) + 1);
+            break;
+        case 1:
+            fputs("/* keep the value in range */\n", stream);
+            indent(stream, level);
+            fprintf(stream, "x = (x %% %u) - y;\n", nextRandom(97) + 2);
+            break;
+        case 2:
+            fprintf(stream, "y <<= %u;\n", nextRandom(4) + 1);
+            break;
+        case 3:
+            fputs("x++;\n", stream);
+            break;
+        case 4:
+            fprintf(stream, "y = x > y ? x - %u : y + %u;\n", nextRandom(10), nextRandom(10));
+            break;
+        default:
+            fprintf(stream, "global_%u ^= x & y;\n", nextRandom(4));
+    }
+}
+
+/**
+ * @brief Writes a block of statements, nesting compound statements until the depth runs out.
+ */
+static void writeBlock(
+    FILE* const     stream,
+    unsigned const  level,
+    unsigned const  depth,
+    unsigned const  file_id,
+    unsigned const  fns_per_file,
+    unsigned* const calls_left
+) {
+    unsigned const stmt_count = 2 + nextRandom(3);
+    for (unsigned stmt = 0; stmt < stmt_count; stmt++) {
+        if (*calls_left > 0 && nextRandom(2) == 0) {
+            writeCall(stream, level, file_id, fns_per_file);
+            (*calls_left)--;
+        } else {
+            writeSimpleStatement(stream, level);
+        }
+    }
+
+    if (depth == 0) return;
+
+    indent(stream, level);
+    switch (nextRandom(5)) {
+        case 0:
+            fprintf(stream, "if (x > %u) {\n", nextRandom(100));
+            writeBlock(stream, level + 1, depth - 1, file_id, fns_per_file, calls_left);
+            indent(stream, level);
+            fputs("} else if (x == y) {\n", stream);
+            writeBlock(stream, level + 1, depth - 1, file_id, fns_per_file, calls_left);
+            indent(stream, level);
+            fputs("} else {\n", stream);
+            writeBlock(stream, level + 1, depth - 1, file_id, fns_per_file, calls_left);
+            break;
+        case 1:
+            fprintf(stream, "for (int i = 0; i < %u; i++) {\n", nextRandom(16) + 1);
+            writeBlock(stream, level + 1, depth - 1, file_id, fns_per_file, calls_left);
+            indent(stream, level);
+            fputs("    if (i == y) break;\n", stream);
+            break;
+        case 2:
+            fputs("while (x < y) {\n", stream);
+            writeBlock(stream, level + 1, depth - 1, file_id, fns_per_file, calls_left);
+            indent(stream, level);
+            fputs("    if (x == 0) continue;\n", stream);
+            indent(stream, level);
+            fputs("    x++;\n", stream);
+            break;
+        case 3:
+            fputs("switch (x & 3) {\n", stream);
+            for (unsigned c = 0; c < 3; c++) {
+                indent(stream, level);
+                fprintf(stream, "    case %u:\n", c);
+                writeBlock(stream, level + 2, depth - 1, file_id, fns_per_file, calls_left);
+                indent(stream, level);
+                fputs("        break;\n", stream);
+            }
+            indent(stream, level);
+            fputs("    default:\n", stream);
+            writeSimpleStatement(stream, level + 2);
+            break;
+        default:
+            fputs("do {\n", stream);
+            writeBlock(stream, level + 1, depth - 1, file_id, fns_per_file, calls_left);
+            indent(stream, level);
+            fputs("} while (--x > y);\n", stream);
+            return;
+    }
+    indent(stream, level);
+    fputs("}\n", stream);
+}
+
+/**
+ * @brief Writes one source file of the corpus.
+ */
+static void writeFile(
+    FILE* const    stream,
+    unsigned const file_id,
+    unsigned const fns_per_file,
+    unsigned const depth,
+    unsigned const calls_per_fn
+) {
+    fprintf(stream, "/* Generated by gencorpus, file %u */\n\n", file_id);
+
+    for (unsigned g = 0; g < 4; g++)
+        fprintf(stream, "static int global_%u = %u;\n", g, nextRandom(1000));
+    fputs("\n", stream);
+
+    for (unsigned fn = 0; fn < fns_per_file; fn++)
+        fprintf(stream, "%sint f%u_%u(int x, int y);\n", IS_STATIC_FN(fn) ? "static " : "", file_id, fn);
+    fputs("\n", stream);
+
+    for (unsigned fn = 0; fn < fns_per_file; fn++) {
+        unsigned calls_left = calls_per_fn;
+
+        fprintf(stream, "%sint f%u_%u(int x, int y) {\n", IS_STATIC_FN(fn) ? "static " : "", file_id, fn);
+        writeBlock(stream, 1, depth, file_id, fns_per_file, &calls_left);
+        while (calls_left > 0) {
+            writeCall(stream, 1, file_id, fns_per_file);
+            calls_left--;
+        }
+        fputs("    return x + y;\n"
+              "}\n"
+              "\n", stream);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 6 || argc > 7) {
+        fputs("\n"
+              "Usage: gencorpus <outdir> <file_count> <fns_per_file> <nesting_depth> <calls_per_fn> [seed]\n"
+              "\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    char const* const outdir       = argv[1];
+    unsigned const    file_count   = parseArgument("file_count", argv[2]);
+    unsigned const    fns_per_file = parseArgument("fns_per_file", argv[3]);
+    unsigned const    depth        = parseArgument("nesting_depth", argv[4]);
+    unsigned const    calls_per_fn = parseArgument("calls_per_fn", argv[5]);
+    if (argc == 7) state = parseArgument("seed", argv[6]);
+
+    if (depth > GENCORPUS_MAX_DEPTH) {
+        fprintf(stderr, "\n"
+                        "nesting_depth must NOT exceed %d\n"
+                        "\n", GENCORPUS_MAX_DEPTH);
+        return EXIT_FAILURE;
+    }
+
+    for (unsigned file_id = 0; file_id < file_count; file_id++) {
+        char path[4096];
+        if (snprintf(path, sizeof(path), "%s/unit_%06u.c", outdir, file_id) >= (int)sizeof(path)) {
+            fputs("\nThe output directory path is too long\n\n", stderr);
+            return EXIT_FAILURE;
+        }
+
+        FILE* const stream = fopen(path, "w");
+        if (stream == NULL) {
+            fprintf(stderr, "\n"
+                            "Could NOT create '%s' (errno = %d)\n"
+                            "\n", path, errno);
+            return EXIT_FAILURE;
+        }
+
+        writeFile(stream, file_id, fns_per_file, depth, calls_per_fn);
+
+        if (fclose(stream) == EOF) return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
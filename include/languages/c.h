@@ -1,6 +1,6 @@
 #ifndef C_H
     #define C_H
-    #include "padkit/map.h"
+    #include <stdint.h>
     #include "padkit/chunkset.h"
     #include "padkit/chunktable.h"
 
@@ -47,6 +47,33 @@
 
     #define C_IS_VALID_ELEMENT(element) (element <= C_LAST_ELEMENT)
 
+    /* Other C Tags, the metrics need them but CParse ignores them */
+    #define C_BLOCK         28
+    #define C_COMMENT       29
+    #define C_DIRECTIVE     30
+    #define C_EXPR          31
+    #define C_MACRO         32
+    #define C_OPERATOR      33
+    #define C_SPECIFIER     34
+    #define C_STRUCT        35
+    #define C_TERNARY       36
+    #define C_TYPEDEF       37
+    #define C_UNION         38
+    #define C_LAST_TAG      C_UNION
+
+    #define C_TAG_COUNT     (C_LAST_TAG + 1)
+
+    #define C_NOT_A_TAG     C_TAG_COUNT
+
+    #define C_IS_VALID_TAG(tag) (tag <= C_LAST_TAG)
+
+    /* Tag Sets, e.g., the tags a metric listens to */
+    #define C_TAG_BIT(tag)  ((uint_fast64_t)1 << (tag))
+
+    #define C_ALL_ELEMENTS  (C_TAG_BIT(C_ELEMENT_COUNT) - 1)
+
+    #define C_ALL_TAGS      (C_TAG_BIT(C_NOT_A_TAG + 1) - 1)
+
     /* Chunk Interpretations */
     #define C_CALL_NAME             0
     #define C_COND                  1
@@ -65,7 +92,40 @@
     #define C_ELEMENT_TAGS {                                                                                \
         "block_content", "break", "call", "case", "condition", "continue", "control", "decl_stmt",          \
         "default", "do", "else", "elseif", "empty_stmt", "expr_stmt", "for", "function", "goto", "if",      \
-        "if_stmt", "incr", "init", "label", "name", "parameter_list", "return", "switch", "type", "while"   \
+        "if_stmt", "incr", "init", "label", "name", "parameter_list", "return", "switch", "type", "while",  \
+        "block", "comment", "directive", "expr", "macro", "operator", "specifier", "struct", "ternary",     \
+        "typedef", "union"                                                                                  \
+    }
+
+    /*
+     * A perfect hash of C_ELEMENT_TAGS, see getTagId_cparse().
+     *
+     * hash = C_TAG_HASH_SEED, then hash = (hash ^ c) * C_TAG_HASH_PRIME for every character c of the tag,
+     * and C_TAG_HASH_TABLE[(hash >> 16) % C_TAG_HASH_SIZE] is the tag ID. The seed is the first one with
+     * no collisions. After changing the tags, run 'make bin/gentaghash && bin/gentaghash' and paste its
+     * output over C_TAG_HASH_SEED and C_TAG_HASH_TABLE, see tools/gentaghash.c.
+     */
+    #define C_TAG_HASH_SEED     1765U
+    #define C_TAG_HASH_PRIME    16777619U
+    #define C_TAG_HASH_SIZE     128
+
+    #define C_TAG_HASH_TABLE {                  \
+         23,  24,  39,  29,  34,  39,  39,  27, \
+         14,  39,  10,   5,  12,  39,   2,  39, \
+          8,  39,  39,  39,  39,  39,  39,  39, \
+         39,  39,  39,  39,  39,  39,   9,  39, \
+         39,  39,  39,  39,  21,  39,  39,  39, \
+         39,  39,  39,  39,  33,  39,  39,  13, \
+         39,   1,  39,  39,  39,  39,  39,  39, \
+         17,  39,  37,  39,  39,  39,  39,   4, \
+         16,  39,   3,  39,  39,  39,  26,  39, \
+         39,  39,  39,  36,   0,  39,  39,  20, \
+         35,  22,  39,  39,  39,  39,  39,  39, \
+         39,  39,  30,  39,  39,  39,  19,  28, \
+         39,  39,  39,  39,  39,  39,  39,  39, \
+         39,  39,  11,  39,  39,  39,  39,  15, \
+         39,  39,  38,  25,   7,  39,  32,  31, \
+         39,  39,  39,   6,  18,  39,  39,  39  \
     }
 
     #define C_INTERPRETATION_NAMES {                                                                        \
@@ -76,8 +136,10 @@
                             0, 0, NULL,                                                  \
                             { NOT_A_CHUNK, NOT_A_CHUNK },                                \
                             { NOT_A_CHUNK_TABLE, NOT_A_CHUNK_TABLE, NOT_A_CHUNK_TABLE }, \
-                            { NOT_A_MAP },                                               \
-                            { 0, 0, 0 }, { 0, 0, 0 }, { NULL, NULL, NULL }, { 0, 0, 0 }, \
+                            0, NULL, NULL, NULL,                                         \
+                            0, NULL,                                                     \
+                            { 0 }, { 0 }, { NULL }, { 0, 0, 0 },                         \
+                            { 0 }, { 0 }, { NULL }, { 0 }                                \
                          })
 
     #define CPARSE_CHUNK_PARSE              0
@@ -88,27 +150,81 @@
     #define CPARSE_TABLE_FN_FIRST_STMT      2
     #define CPARSE_TABLE_LABELS             3
     #define CPARSE_TABLE_LAST               CPARSE_TABLE_LABELS
-    #define CPARSE_MAP_EDGES                0
-    #define CPARSE_MAP_LAST                 CPARSE_MAP_EDGES
     #define CPARSE_STACK_ELEMENTS           0
     #define CPARSE_STACK_INCOMING           1
     #define CPARSE_STACK_LOOPS              2
-    #define CPARSE_STACK_LAST               CPARSE_STACK_LOOPS
+    #define CPARSE_STACK_HEADS              3
+    #define CPARSE_STACK_JUMPS              4
+    #define CPARSE_STACK_BRANCHES           5
+    #define CPARSE_STACK_IF_STMTS           6
+    #define CPARSE_STACK_CONDS              7
+    #define CPARSE_STACK_LAST               CPARSE_STACK_CONDS
     #define CPARSE_CURRENT_UNIT             0
     #define CPARSE_CURRENT_FN               1
     #define CPARSE_CURRENT_FN_FIRST_STMT    2
     #define CPARSE_TRACKED_LAST             CPARSE_CURRENT_FN_FIRST_STMT
+
+    /*
+     * The jumps wait on CPARSE_STACK_JUMPS as (kind, statement) pairs until their loop, switch, or function ends.
+     * A goto jumps to the end of its function, the labels are NOT resolved.
+     */
+    #define CPARSE_JUMP_BREAK               0
+    #define CPARSE_JUMP_CONTINUE            1
+    #define CPARSE_JUMP_EXIT                2
+    #define CPARSE_JUMP_DEFAULT             3
+
+    /*
+     * How an edge leaves its statement. The edges between two statements differ by their kinds, e.g., an if with an
+     * empty body goes to the next statement both when its condition holds and when it fails.
+     */
+    #define CPARSE_EDGE_NEXT                0
+    #define CPARSE_EDGE_FALSE               1
+    #define CPARSE_EDGE_BACK                2
+    #define CPARSE_EDGE_JUMP                3
+    #define CPARSE_EDGE_CASE                4
+
+    /*
+     * The statements, edges, and calls of a function are counted in one piece, so every function starts at an
+     * offset and ends where the next function starts. The functions of a unit are also in one piece. A count is
+     * one subtraction, and the IDs of the queries are the indexes of the functions and the units in the order
+     * they are parsed, i.e., the last function is getFnCount_cparse() - 1.
+     *
+     * The edges are three arrays, and total[CPARSE_INDEX_FN_EDGES] is their size. The edges of a function are
+     * sorted by their statements and kinds, and their duplicates dropped, at the end of the function, so every
+     * query sees the same edges. sorted_edges is the scratch space of the sort.
+     */
+    #define CPARSE_INDEX_FN_STMTS           0
+    #define CPARSE_INDEX_FN_EDGES           1
+    #define CPARSE_INDEX_FN_CALLS           2
+    #define CPARSE_INDEX_UNIT_FNS           3
+    #define CPARSE_INDEX_LAST               CPARSE_INDEX_UNIT_FNS
+    #define CPARSE_TOTAL_LAST               CPARSE_INDEX_FN_CALLS
+    /* One edge while the edges of a function are sorted */
+    typedef struct SortedEdgeBody {
+        uint32_t source;
+        uint32_t target;
+        uint32_t kind;
+    } SortedEdge;
     typedef struct CParseBody {
-        uint32_t   interpretations_cap;
-        uint32_t   interpretations_size;
-        uint8_t*   interpretations;
-        Chunk      chunks     [CPARSE_CHUNK_LAST + 1];
-        ChunkTable tables     [CPARSE_TABLE_LAST + 1];
-        Map        maps       [CPARSE_MAP_LAST + 1];
-        uint32_t   stack_cap  [CPARSE_STACK_LAST + 1];
-        uint32_t   stack_size [CPARSE_STACK_LAST + 1];
-        uint32_t*  stack      [CPARSE_STACK_LAST + 1];
-        uint32_t   tracked_id [CPARSE_TRACKED_LAST + 1];
+        uint32_t    interpretations_cap;
+        uint32_t    interpretations_size;
+        uint8_t*    interpretations;
+        Chunk       chunks     [CPARSE_CHUNK_LAST + 1];
+        ChunkTable  tables     [CPARSE_TABLE_LAST + 1];
+        uint32_t    edges_cap;
+        uint32_t*   edge_sources;
+        uint32_t*   edge_targets;
+        uint8_t*    edge_kinds;
+        uint32_t    sorted_cap;
+        SortedEdge* sorted_edges;
+        uint32_t    stack_cap  [CPARSE_STACK_LAST + 1];
+        uint32_t    stack_size [CPARSE_STACK_LAST + 1];
+        uint32_t*   stack      [CPARSE_STACK_LAST + 1];
+        uint32_t    tracked_id [CPARSE_TRACKED_LAST + 1];
+        uint32_t    index_cap  [CPARSE_INDEX_LAST + 1];
+        uint32_t    index_size [CPARSE_INDEX_LAST + 1];
+        uint32_t*   index      [CPARSE_INDEX_LAST + 1];
+        uint32_t    total      [CPARSE_TOTAL_LAST + 1];
     } CParse;
 
     #define CPARSE_LAST_CHUNK_ID cparse->chunks[CPARSE_CHUNK_PARSE].nStrings - 1
@@ -195,7 +311,7 @@
         uint32_t const initial_stack_cap
     );
 
-    void end_cparse(CParse* const cparse, char const* const c_element_tag);
+    void end_cparse(CParse* const cparse, unsigned const c_tag_id);
 
     void endUnit_cparse(CParse* const cparse);
 
@@ -229,11 +345,13 @@
 
     uint32_t getStmtCountOfUnit_cparse(CParse const* const cparse, uint32_t const unit_id);
 
+    unsigned getTagId_cparse(char const* const tag);
+
     uint32_t getUnitCount_cparse(CParse const* const cparse);
 
     bool isValid_cparse(CParse const* const cparse);
 
-    void start_cparse(CParse* const cparse, char const* const c_element_tag);
+    void start_cparse(CParse* const cparse, unsigned const c_tag_id);
 
     void startUnit_cparse(CParse* const cparse, char const* const unit_name, uint64_t const unit_len);
 #endif
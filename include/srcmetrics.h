@@ -25,6 +25,13 @@
     #define FLAG_RFU_SHOW           B8(B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_10000000)
     #define FLAG_CC_SHOW            B8(B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000001,B_00000000)
     #define FLAG_VERBOSE            B8(B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000010,B_00000000)
+    #define FLAG_STREAM             B8(B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000100,B_00000000)
+    #define FLAG_PARALLEL_METRICS   B8(B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00001000,B_00000000)
+    #define FLAG_PROFILE            B8(B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00010000,B_00000000)
+    #define FLAG_SERVER             B8(B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00100000,B_00000000)
+    #define FLAG_COLUMNAR           B8(B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_01000000,B_00000000)
+    #define FLAG_GZIP               B8(B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_10000000,B_00000000)
+    #define FLAG_STREAM_REPORT      B8(B_00000000,B_00000000,B_00000000,B_00000000,B_00000000,B_00000001,B_00000000,B_00000000)
 
     #define FLAG_GRAPH_DISABLE_DOT  ~FLAG_GRAPH_ENABLE_DOT
     #define FLAG_GRAPH_DISABLE_XML  ~FLAG_GRAPH_ENABLE_XML
@@ -33,6 +40,8 @@
     #define FLAG_RFU_TRANSITIVE     ~FLAG_RFU_SIMPLE
     #define FLAG_RFU_QUIET          ~FLAG_RFU_SHOW
     #define FLAG_CC_QUIET           ~FLAG_CC_SHOW
+    #define FLAG_BATCH              ~FLAG_STREAM
+    #define FLAG_SERIAL_METRICS     ~FLAG_PARALLEL_METRICS
 
     #define FLAGS_DEFAULT           (FLAG_GRAPH_ENABLE_DOT | FLAG_GRAPH_ENABLE_XML | FLAG_CG_NO_EXTERNAL | FLAG_RFU_SIMPLE | FLAG_RFU_SHOW | FLAG_CC_SHOW)
 
@@ -53,7 +62,7 @@
 
     /**
      * @def OPTIONS_INITIAL
-     *   Initial options are no infiles with BUFSIZ capacity, no outfile, no language, standard out, and all metrics enabled.
+     *   Initial options are no infiles with BUFSIZ capacity, no outfile, no language, standard out, all metrics enabled, one job, no profile file, no cache, and no memory budget.
      */
     #define OPTIONS_INITIAL         \
         ((struct Options){          \
@@ -68,7 +77,11 @@
             NULL,                   \
             NULL,                   \
             NULL,                   \
-            FLAGS_DEFAULT           \
+            FLAGS_DEFAULT,          \
+            1,                      \
+            NULL,                   \
+            NULL,                   \
+            0                       \
         })
 
     /**
@@ -92,9 +105,18 @@
         char const*   cfg_name;
         char const*   ipcfg_name;
         uint_fast64_t flags;
+        uint32_t      n_jobs;
+        char const*   profile_file;
+        char const*   cache_dir;
+        uint64_t      memory_budget;
     } options;
 
-    extern Chunk strings[1];
+    /**
+     * @brief Checks if the partial results of every infile are cached, see cache.h.
+     *
+     * Control flow graphs need the whole input, so they disable the cache.
+     */
+    bool isCaching(void);
 
     /**
      * @brief Checks if control flow graphs are enabled.
@@ -111,16 +133,42 @@
      */
     bool isCGNoExternal(void);
 
+    /**
+     * @brief Checks if the report is columnar binary instead of CSV, see columnar.h.
+     *
+     * The server answers with CSV, so it disables the columnar report.
+     */
+    bool isColumnar(void);
+
     /**
      * @brief Checks if DOT graphs are enabled.
      */
     bool isDotEnabled(void);
 
+    /**
+     * @brief Checks if the CSV report is compressed with gzip, see writer.h.
+     *
+     * The server answers with plain CSV, and the columnar report is NOT compressed.
+     */
+    bool isGzipping(void);
+
     /**
      * @brief Checks if inter-procedural control flow graphs are enabled.
      */
     bool isIPCFGEnabled(void);
 
+    /**
+     * @brief Checks if the parser threads also evaluate the metrics of their units.
+     *
+     * Needs more than one job, and control flow graphs need the serial evaluation.
+     */
+    bool isParallelMetrics(void);
+
+    /**
+     * @brief Checks if the phases and the metric handlers are timed, see profile.h.
+     */
+    bool isProfiling(void);
+
     /**
      * @brief Checks if RFU-quiet is toggled.
      */
@@ -131,6 +179,25 @@
      */
     bool isRFUSimple(void);
 
+    /**
+     * @brief Checks if srcmetrics answers JSON-RPC requests on stdin instead of reporting once, see server.h.
+     *
+     * Control flow graphs need the whole input, so they disable the server.
+     */
+    bool isServing(void);
+
+    /**
+     * @brief Checks if units are streamed to the metrics one by one.
+     */
+    bool isStreaming(void);
+
+    /**
+     * @brief Checks if the unit and function rows are written as soon as their unit ends, see report.h.
+     *
+     * '--stream' implies it. The columnar report is written at once, so it disables the streaming report.
+     */
+    bool isStreamingReport(void);
+
     /**
      * @brief Checks if verbose status outputs are enabled.
      */
@@ -0,0 +1,279 @@
+/**
+ * @file analysis.h
+ * @brief Defines Analysis, the state of one metric evaluation.
+ * @author Yavuz Koroglu
+ * @see analysis.c
+ */
+#ifndef ANALYSIS_H
+    #define ANALYSIS_H
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <stdio.h>
+    #include "languages/c.h"
+    #include "srcmetrics/arena.h"
+    #include "srcmetrics/event.h"
+    #include "srcmetrics/interner.h"
+    #include "srcmetrics/metrics.h"
+    #include "srcmetrics/profile.h"
+    #include "srcmetrics/result.h"
+    #include "srcmetrics/writer.h"
+    #include "padkit/chunk.h"
+    #include "padkit/map.h"
+
+    /**
+     * @struct Analysis
+     * @brief Everything a metric evaluation changes while it runs.
+     *
+     * The event handlers find the Analysis in the data field of the srcSAX context, so two Analysis objects
+     * can run at the same time, e.g., in different threads. The global options are NOT part of an Analysis.
+     * They are read-only after the command-line arguments are parsed, and every Analysis shares them.
+     *
+     * A partial Analysis evaluates one unit at a time, and merge_analysis() adds its rows and overall
+     * counters to the Analysis of the whole input, see constructEmptyPartial_analysis().
+     *
+     * Every metric keeps its rows in a ResultTable, whose entities are the unit and function name ids in the
+     * strings, so a row adds no string of its own, see result.h. If isReportingUnits, the rows are written at
+     * the end of every unit and dropped, so only the overall counters grow with the input.
+     *
+     * The interner indexes the unit and function names of the strings, so a merge or a replay finds the name
+     * an earlier unit added instead of copying it again, see interner.h.
+     *
+     * The element handlers are grouped by tag. The handlers that listen to a start tag begin at
+     * eventsAtStartElement + firstEventAtStartTag[tag_id] and end with NULL, and so do the end tags.
+     *
+     * Every metric has an Arena for the bytes it needs until its unit or its function ends, indexed by its
+     * metric id, e.g., METRIC_HSM. The framework frees them at those ends, see arena.h.
+     *
+     * With '--profile', the profile times every handler call, see profile.h. It is NULL otherwise.
+     */
+    typedef struct AnalysisBody {
+        uint_fast64_t        enabledMetrics;
+        bool                 isPartial;
+        bool                 isReportingUnits;
+        Chunk                strings[1];
+        Interner             interner[1];
+
+        unsigned             function_read_state;
+        uint32_t             currentUnit_id;
+        uint32_t             currentFn_id;
+
+        DocumentHandler      eventsAtStartDocument  [METRICS_COUNT_MAX + 1];
+        DocumentHandler      eventsAtEndDocument    [METRICS_COUNT_MAX + 1];
+        StartElementHandler  eventsAtStartRoot      [METRICS_COUNT_MAX + 1];
+        UnitHandler          eventsAtStartUnit      [METRICS_COUNT_MAX + 1];
+        EndElementHandler    eventsAtEndRoot        [METRICS_COUNT_MAX + 1];
+        UnitHandler          eventsAtEndUnit        [METRICS_COUNT_MAX + 1];
+        CharactersHandler    eventsAtCharactersRoot [METRICS_COUNT_MAX + 1];
+        CharactersHandler    eventsAtCharactersUnit [METRICS_COUNT_MAX + 1];
+        StartElementHandler  eventsAtMetaTag        [METRICS_COUNT_MAX + 1];
+        CharactersHandler    eventsAtComment        [METRICS_COUNT_MAX + 1];
+        CharactersHandler    eventsAtCDataBlock     [METRICS_COUNT_MAX + 1];
+        ProcInfoHandler      eventsAtProcInfo       [METRICS_COUNT_MAX + 1];
+
+        uint16_t             firstEventAtStartTag   [C_NOT_A_TAG + 1];
+        uint16_t             firstEventAtEndTag     [C_NOT_A_TAG + 1];
+        StartElementHandler* eventsAtStartElement;
+        EndElementHandler*   eventsAtEndElement;
+
+        ABCState             abc[1];
+        AMSState             ams[1];
+        CCState              cc[1];
+        HSMState             hsm[1];
+        MCState              mc[1];
+        MNDState             mnd[1];
+        NPMState             npm[1];
+        RFUState             rfu[1];
+        SLOCState            sloc[1];
+
+        Arena                arenas                 [METRICS_COUNT_MAX];
+
+        FILE*                output;
+        Writer               writer[1];
+        uint32_t             reportedRowCounts[METRICS_COUNT_MAX];
+
+        uint32_t*            mergedEntity_ids;
+        uint32_t             mergedEntity_cap;
+
+        Profile*             profile;
+    } Analysis;
+
+    typedef void(*Merge)(Analysis* const, Analysis const* const);
+    typedef bool(*Save)(FILE* const, Analysis const* const);
+    typedef bool(*Load)(Analysis* const, FILE* const);
+
+    #define MERGES {    \
+        ABC_MERGE,      \
+        AMS_MERGE,      \
+        CC_MERGE,       \
+        HSM_MERGE,      \
+        MC_MERGE,       \
+        MND_MERGE,      \
+        NPM_MERGE,      \
+        RFU_MERGE,      \
+        SLOC_MERGE,     \
+        NULL            \
+    }
+
+    #define SAVES {     \
+        ABC_SAVE,       \
+        AMS_SAVE,       \
+        CC_SAVE,        \
+        HSM_SAVE,       \
+        MC_SAVE,        \
+        MND_SAVE,       \
+        NPM_SAVE,       \
+        RFU_SAVE,       \
+        SLOC_SAVE,      \
+        NULL            \
+    }
+
+    #define LOADS {     \
+        ABC_LOAD,       \
+        AMS_LOAD,       \
+        CC_LOAD,        \
+        HSM_LOAD,       \
+        MC_LOAD,        \
+        MND_LOAD,       \
+        NPM_LOAD,       \
+        RFU_LOAD,       \
+        SLOC_LOAD,      \
+        NULL            \
+    }
+
+    /**
+     * @brief Constructs an empty Analysis.
+     *
+     * The metric states are constructed at the first start document event.
+     *
+     * @param analysis A pointer to the Analysis.
+     * @param enabledMetrics The bitmask of the metrics to evaluate, see METRICS.
+     */
+    void constructEmpty_analysis(Analysis* const analysis, uint_fast64_t const enabledMetrics);
+
+    /**
+     * @brief Constructs an empty partial Analysis.
+     *
+     * A partial Analysis never executes the end document events, and the metrics that need the whole
+     * input, e.g., RFU, only record what merge_analysis() has to replay.
+     *
+     * @param analysis A pointer to the partial Analysis.
+     * @param enabledMetrics The bitmask of the metrics to evaluate, see METRICS.
+     */
+    void constructEmptyPartial_analysis(Analysis* const analysis, uint_fast64_t const enabledMetrics);
+
+    /**
+     * @brief Frees an Analysis and all of its metric states, and submits its profile.
+     * @param analysis A pointer to the Analysis.
+     */
+    void free_analysis(Analysis* const analysis);
+
+    /**
+     * @brief Frees what a partial Analysis only needs while it evaluates a unit, and keeps its rows.
+     *
+     * The Arena of every metric and the CParse of CC go away, so a partial Analysis that waits for
+     * merge_analysis(), e.g., a file the server tracks, keeps only its rows and counters. The next unit
+     * allocates them again.
+     *
+     * @param analysis A pointer to the partial Analysis.
+     */
+    void trim_analysis(Analysis* const analysis);
+
+    /**
+     * @brief Checks if an Analysis is valid.
+     * @param analysis A pointer to the Analysis.
+     */
+    bool isValid_analysis(Analysis const* const analysis);
+
+    /**
+     * @brief Adds the rows and the overall counters of a partial Analysis to another Analysis.
+     *
+     * Merging the partials in input order gives the same report as evaluating the units one by one.
+     *
+     * @param analysis A pointer to the Analysis of a stream, see startStream_analysis().
+     * @param partial A pointer to the partial Analysis.
+     */
+    void merge_analysis(Analysis* const analysis, Analysis const* const partial);
+
+    /**
+     * @brief Adds every row of a partial ResultTable to the ResultTable of an Analysis.
+     *
+     * An entity name is interned in the strings of the Analysis, so it is copied once, however many rows and
+     * partials name it.
+     *
+     * @param analysis A pointer to the Analysis.
+     * @param statistics The ResultTable of a metric in the Analysis.
+     * @param partial A pointer to the partial Analysis.
+     * @param partialStatistics The ResultTable of the same metric in the partial Analysis.
+     */
+    void mergeStatistics_analysis(
+        Analysis* const          analysis,
+        ResultTable* const       statistics,
+        Analysis const* const    partial,
+        ResultTable const* const partialStatistics
+    );
+
+    /**
+     * @brief Drops every row of an Analysis, e.g., after they are written.
+     * @param analysis A pointer to the Analysis.
+     */
+    void flushRows_analysis(Analysis* const analysis);
+
+    /**
+     * @brief Evaluates the metrics on a whole srcML document, e.g., an archive.
+     * @param analysis A pointer to the Analysis.
+     * @param srcml The srcML buffer.
+     * @param srcml_size The size of the srcML buffer.
+     */
+    void run_analysis(Analysis* const analysis, char const* const srcml, size_t const srcml_size);
+
+    /**
+     * @brief Starts a stream of units, see getStreamingEventHandler().
+     * @param analysis A pointer to the Analysis.
+     */
+    void startStream_analysis(Analysis* const analysis);
+
+    /**
+     * @brief Evaluates the metrics on the srcML of one streamed unit.
+     * @param analysis A pointer to the Analysis.
+     * @param unit_srcml The srcML buffer of the unit.
+     * @param unit_srcml_size The size of the srcML buffer.
+     */
+    void streamUnit_analysis(Analysis* const analysis, char const* const unit_srcml, size_t const unit_srcml_size);
+
+    /**
+     * @brief Evaluates the metrics on the srcML of one unit with a partial Analysis.
+     *
+     * Forgets the previous unit of the partial Analysis, so merge it before calling this function again.
+     *
+     * @param analysis A pointer to the partial Analysis.
+     * @param unit_srcml The srcML buffer of the unit.
+     * @param unit_srcml_size The size of the srcML buffer.
+     */
+    void runUnit_analysis(Analysis* const analysis, char const* const unit_srcml, size_t const unit_srcml_size);
+
+    /**
+     * @brief Writes what merge_analysis() needs from a partial Analysis, see save_cache().
+     * @param analysis A pointer to the partial Analysis of one unit, see runUnit_analysis().
+     * @param stream The cache entry.
+     * @return 0 if a write fails, 1 otherwise.
+     */
+    bool saveUnit_analysis(Analysis const* const analysis, FILE* const stream);
+
+    /**
+     * @brief Reads a partial Analysis written by saveUnit_analysis(), instead of evaluating its unit.
+     *
+     * Forgets the previous unit of the partial Analysis, like runUnit_analysis(). The partial Analysis is
+     * garbage if the entry ends early, so evaluate the unit with runUnit_analysis() then.
+     *
+     * @param analysis A pointer to the partial Analysis.
+     * @param stream The cache entry.
+     * @return 0 if the entry ends early, 1 otherwise.
+     */
+    bool loadUnit_analysis(Analysis* const analysis, FILE* const stream);
+
+    /**
+     * @brief Ends a stream of units.
+     * @param analysis A pointer to the Analysis.
+     */
+    void endStream_analysis(Analysis* const analysis);
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @file arena.h
+ * @brief Defines Arena, the bytes a metric only needs until its unit or its function ends.
+ * @author Yavuz Koroglu
+ * @see arena.c
+ */
+#ifndef ARENA_H
+    #define ARENA_H
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <stdio.h>
+
+    #define ARENA_INITIAL_CAP   BUFSIZ
+
+    #define NOT_AN_ARENA ((Arena){ NULL, 0, 0, 0 })
+
+    /**
+     * @struct Arena
+     * @brief A region of bytes that is allocated from its end and freed all at once.
+     *
+     * The text a metric reads between two tags, e.g., an operator of ABC or the operands of HSM, goes to
+     * the end of the Arena, so the characters of nested tags are copied once instead of once per tag. An
+     * allocation is an offset, because the region moves when it grows. A pointer from get_arena() is valid
+     * until the next allocation.
+     *
+     * Every metric has its own Arena in the Analysis, so two metrics that read the same characters do NOT
+     * interleave them. The framework calls endFn_arena() at the end of every function and reset_arena() at the
+     * end of every unit, after the handlers, so a metric never frees what it allocates. Both take O(1) time
+     * and keep the region for the next function and unit. An empty Arena allocates nothing.
+     */
+    typedef struct ArenaBody {
+        char*    bytes;
+        uint64_t len;
+        uint64_t cap;
+        uint64_t fn_len;
+    } Arena;
+
+    /**
+     * @brief Appends bytes to the end of an Arena.
+     * @param arena A pointer to the Arena.
+     * @param bytes The bytes.
+     * @param len The number of bytes.
+     * @return The offset of the bytes.
+     */
+    uint64_t append_arena(Arena* const arena, char const* const bytes, uint64_t const len);
+
+    /**
+     * @brief Frees the allocations of a function, i.e., the ones after startFn_arena().
+     * @param arena A pointer to the Arena.
+     */
+    void endFn_arena(Arena* const arena);
+
+    /**
+     * @brief Frees the region of an Arena.
+     * @param arena A pointer to the Arena.
+     */
+    void free_arena(Arena* const arena);
+
+    /**
+     * @brief Returns the bytes of an allocation.
+     * @param arena A pointer to the Arena.
+     * @param offset The offset of the allocation.
+     */
+    char* get_arena(Arena const* const arena, uint64_t const offset);
+
+    /**
+     * @brief Checks if an Arena is valid.
+     * @param arena A pointer to the Arena.
+     */
+    bool isValid_arena(Arena const* const arena);
+
+    /**
+     * @brief Returns the offset of the next allocation, so release_arena() can free everything after it.
+     * @param arena A pointer to the Arena.
+     */
+    uint64_t mark_arena(Arena const* const arena);
+
+    /**
+     * @brief Frees every allocation after a mark.
+     * @param arena A pointer to the Arena.
+     * @param mark The mark, see mark_arena().
+     */
+    void release_arena(Arena* const arena, uint64_t const mark);
+
+    /**
+     * @brief Frees every allocation of an Arena, and keeps its region.
+     * @param arena A pointer to the Arena.
+     */
+    void reset_arena(Arena* const arena);
+
+    /**
+     * @brief Marks the start of a function, see endFn_arena().
+     * @param arena A pointer to the Arena.
+     */
+    void startFn_arena(Arena* const arena);
+#endif
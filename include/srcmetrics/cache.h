@@ -0,0 +1,108 @@
+/**
+ * @file cache.h
+ * @brief Defines the on-disk cache of partial Analysis results, see '--cache'.
+ * @author Yavuz Koroglu
+ * @see cache.c
+ */
+#ifndef CACHE_H
+    #define CACHE_H
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <stdio.h>
+    #include "srcmetrics/result.h"
+    #include "srcmetrics/source.h"
+    #include "padkit/chunk.h"
+
+    #define CACHE_MAGIC             0x33434D53U
+
+    #define CACHE_FILE_EXTENSION    ".smc"
+
+    struct AnalysisBody;
+
+    /**
+     * @brief Creates the cache directory if it does NOT exist.
+     *
+     * Terminates the program if the directory cannot be created.
+     */
+    void prepare_cache(void);
+
+    /**
+     * @brief Loads the partial Analysis of an infile from the cache.
+     *
+     * A cache entry matches if the infile path, its contents, the srcML and srcmetrics versions, the enabled
+     * metrics, and the flags that change the rows are all the same. The partial Analysis is garbage after a
+     * miss, so evaluate the infile with runUnit_analysis() then.
+     *
+     * @param partial A pointer to the partial Analysis.
+     * @param infile The source file name.
+     * @param source The contents of the source file.
+     * @return 1 on a hit, 0 on a miss.
+     */
+    bool load_cache(struct AnalysisBody* const partial, char const* const infile, Source const* const source);
+
+    /**
+     * @brief Saves the partial Analysis of an infile to the cache.
+     *
+     * Writes a temporary file and renames it, so a concurrent run never reads half an entry. Failing to save
+     * is NOT an error, the next run evaluates the infile again.
+     *
+     * @param partial A pointer to the partial Analysis of the infile, see runUnit_analysis().
+     * @param infile The source file name.
+     * @param source The contents of the source file.
+     */
+    void save_cache(struct AnalysisBody const* const partial, char const* const infile, Source const* const source);
+
+    /**
+     * @brief Reads an unsigned integer of a cache entry.
+     * @param stream The cache entry.
+     * @param value A pointer to the integer.
+     * @return 0 if the entry ends, 1 otherwise.
+     */
+    bool readUnsigned_cache(FILE* const stream, uint64_t* const value);
+
+    /**
+     * @brief Writes an unsigned integer to a cache entry.
+     * @param stream The cache entry.
+     * @param value The integer.
+     * @return 0 if the write fails, 1 otherwise.
+     */
+    bool writeUnsigned_cache(FILE* const stream, uint64_t const value);
+
+    /**
+     * @brief Reads a string of a cache entry and adds it to a Chunk.
+     * @param stream The cache entry.
+     * @param chunk A pointer to the Chunk.
+     * @return The id of the string in the Chunk, or 0xFFFFFFFF if the entry ends.
+     */
+    uint32_t readString_cache(FILE* const stream, Chunk* const chunk);
+
+    /**
+     * @brief Writes a string to a cache entry.
+     * @param stream The cache entry.
+     * @param str The string.
+     * @param len The length of the string.
+     * @return 0 if the write fails, 1 otherwise.
+     */
+    bool writeString_cache(FILE* const stream, char const* const str, uint64_t const len);
+
+    /**
+     * @brief Reads the rows of a ResultTable, interning their entities in the strings of a partial Analysis.
+     * @param stream The cache entry.
+     * @param partial A pointer to the partial Analysis.
+     * @param statistics The ResultTable of a metric in the partial Analysis.
+     * @return 0 if the entry ends, 1 otherwise.
+     */
+    bool readStatistics_cache(FILE* const stream, struct AnalysisBody* const partial, ResultTable* const statistics);
+
+    /**
+     * @brief Writes the rows of a ResultTable.
+     *
+     * The entity name of a row is only written if the previous row names another entity.
+     *
+     * @param stream The cache entry.
+     * @param partial A pointer to the partial Analysis.
+     * @param statistics The ResultTable of a metric in the partial Analysis.
+     * @return 0 if the write fails, 1 otherwise.
+     */
+    bool writeStatistics_cache(FILE* const stream, struct AnalysisBody const* const partial, ResultTable const* const statistics);
+#endif
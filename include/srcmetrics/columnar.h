@@ -0,0 +1,74 @@
+/**
+ * @file columnar.h
+ * @brief Defines the columnar binary report of '--columnar'.
+ * @author Yavuz Koroglu
+ * @see columnar.c
+ */
+#ifndef COLUMNAR_H
+    #define COLUMNAR_H
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include "srcmetrics/analysis.h"
+
+    #define COLUMNAR_MAGIC              "SRCMCOL1"
+
+    #define COLUMNAR_VERSION            1
+
+    #define COLUMNAR_BYTE_ORDER_MARK    0x01020304U
+
+    /* Every section starts at a multiple of this, so a mapped file can be read in place */
+    #define COLUMNAR_ALIGNMENT          8
+
+    /* The function name of a unit entity, and the entity of an overall row */
+    #define COLUMNAR_NONE               0xFFFFFFFFU
+
+    /**
+     * @struct ColumnarHeader
+     * @brief The first bytes of a columnar report, followed by its sections.
+     *
+     * Every *_at member is the byte offset of a section from the start of the file. The file is in the byte order
+     * of the machine that wrote it, which byte_order_mark tells. A reader maps the file and casts the sections:
+     *
+     * - names_at: The name dictionary, n_names null-terminated strings, names_len bytes in total.
+     * - name_offsets_at: uint64_t[n_names], where each name starts in the dictionary.
+     * - metric_names_at: uint32_t[n_metrics], the name of each metric, e.g., "ABC-A" or "RFU".
+     * - entity_units_at: uint32_t[n_entities], the unit name of each entity.
+     * - entity_fns_at: uint32_t[n_entities], the function name of each entity, or COLUMNAR_NONE for a unit.
+     * - row_entities_at: uint32_t[n_rows], the entity of each row, or COLUMNAR_NONE for an overall row.
+     * - row_metrics_at: uint32_t[n_rows], the metric of each row.
+     * - row_values_at: uint32_t[n_rows], the bits of the float, int, or unsigned value of each row.
+     * - row_types_at: uint8_t[n_rows], the VAL_TC_* type of each row, see result.h.
+     *
+     * The rows are in the same order as the CSV report.
+     */
+    typedef struct ColumnarHeaderBody {
+        char     magic[8];
+        uint32_t version;
+        uint32_t byte_order_mark;
+        uint32_t n_names;
+        uint32_t n_metrics;
+        uint32_t n_entities;
+        uint32_t n_rows;
+        uint64_t names_len;
+        uint64_t names_at;
+        uint64_t name_offsets_at;
+        uint64_t metric_names_at;
+        uint64_t entity_units_at;
+        uint64_t entity_fns_at;
+        uint64_t row_entities_at;
+        uint64_t row_metrics_at;
+        uint64_t row_values_at;
+        uint64_t row_types_at;
+    } ColumnarHeader;
+
+    /**
+     * @brief Writes every row of an Analysis as a columnar report.
+     *
+     * The report goes to the '--output' file, or to stdout. A row of "ABC-A" for "unit.c::fn()" is written as its
+     * metric, "ABC-A", and its entity, "unit.c" and "fn()", so every name is written once.
+     *
+     * @param analysis A pointer to the Analysis.
+     * @return 0 if the report cannot be written, 1 otherwise.
+     */
+    bool reportColumnar(Analysis const* const analysis);
+#endif
@@ -6,6 +6,8 @@
  */
 #ifndef EVENT_H
     #define EVENT_H
+    #include <stdint.h>
+    #include "libsrcsax/srcsax.h"
     #include "srcmetrics/metrics/abc.h"
     #include "srcmetrics/metrics/ams.h"
     #include "srcmetrics/metrics/cc.h"
@@ -16,14 +18,121 @@
     #include "srcmetrics/metrics/rfu.h"
     #include "srcmetrics/metrics/sloc.h"
 
-    typedef void(*Event)(struct srcsax_context*, ...);
+    struct AnalysisBody;
+
+    /**
+     * @struct UnitEvent
+     * @brief The start or the end of a unit.
+     *
+     * The end of a unit has no namespaces and no attributes.
+     */
+    typedef struct UnitEventBody {
+        char const*                    localname;
+        char const*                    prefix;
+        char const*                    uri;
+        int                            num_namespaces;
+        struct srcsax_namespace const* namespaces;
+        int                            num_attributes;
+        struct srcsax_attribute const* attributes;
+        uint32_t                       unit_id;
+    } UnitEvent;
+
+    /**
+     * @struct StartElementEvent
+     * @brief The start of an element, the root, or a meta tag.
+     *
+     * The tag_id is the ID of the localname, see getTagId_cparse(). Outside units, unit_id and fn_id are
+     * 0xFFFFFFFF, and the root and the meta tags have C_NOT_A_TAG.
+     */
+    typedef struct StartElementEventBody {
+        char const*                    localname;
+        char const*                    prefix;
+        char const*                    uri;
+        int                            num_namespaces;
+        struct srcsax_namespace const* namespaces;
+        int                            num_attributes;
+        struct srcsax_attribute const* attributes;
+        uint32_t                       unit_id;
+        uint32_t                       fn_id;
+        unsigned                       tag_id;
+    } StartElementEvent;
+
+    /**
+     * @struct EndElementEvent
+     * @brief The end of an element or the root.
+     */
+    typedef struct EndElementEventBody {
+        char const* localname;
+        char const* prefix;
+        char const* uri;
+        uint32_t    unit_id;
+        uint32_t    fn_id;
+        unsigned    tag_id;
+    } EndElementEvent;
+
+    /**
+     * @struct CharactersEvent
+     * @brief Characters, a comment, or a CDATA block.
+     */
+    typedef struct CharactersEventBody {
+        char const* ch;
+        uint64_t    len;
+        uint32_t    unit_id;
+        uint32_t    fn_id;
+    } CharactersEvent;
+
+    /**
+     * @struct ProcInfoEvent
+     * @brief A processing instruction.
+     */
+    typedef struct ProcInfoEventBody {
+        char const* target;
+        char const* data;
+    } ProcInfoEvent;
+
+    /*
+     * The metric event handlers. The document events only need the Analysis, every other event comes
+     * with a record that lives on the stack of the srcSAX callback, so a handler must NOT keep its pointer.
+     */
+    typedef void(*DocumentHandler)     (struct AnalysisBody* const analysis);
+    typedef void(*UnitHandler)         (struct AnalysisBody* const analysis, UnitEvent const* const event);
+    typedef void(*StartElementHandler) (struct AnalysisBody* const analysis, StartElementEvent const* const event);
+    typedef void(*EndElementHandler)   (struct AnalysisBody* const analysis, EndElementEvent const* const event);
+    typedef void(*CharactersHandler)   (struct AnalysisBody* const analysis, CharactersEvent const* const event);
+    typedef void(*ProcInfoHandler)     (struct AnalysisBody* const analysis, ProcInfoEvent const* const event);
 
     /**
      * @brief Gets a pointer to the static event handler for metrics.
+     *
+     * The handler is shared by every Analysis. The data field of the srcSAX context must point to the Analysis.
+     *
      * @return A pointer to the metric event handler.
      */
     struct srcsax_handler* getStaticEventHandler(void);
 
+    /**
+     * @brief Gets a pointer to the event handler for streamed units.
+     *
+     * Every streamed unit is a separate srcML document, so this handler does NOT execute the
+     * document events. Call startStream_event() before the first unit and endStream_event()
+     * after the last unit instead.
+     *
+     * @return A pointer to the streaming event handler.
+     */
+    struct srcsax_handler* getStreamingEventHandler(void);
+
+    /**
+     * @brief Executes the start document events of a stream of units.
+     * @param analysis A pointer to the Analysis of the stream.
+     */
+    void startStream_event(struct AnalysisBody* const analysis);
+
+    /**
+     * @brief Executes the end document events of a stream of units.
+     * @param analysis A pointer to the Analysis of the stream.
+     */
+    void endStream_event(struct AnalysisBody* const analysis);
+
     #define ALL_EVENTS_AT_START_DOCUMENT {  \
         ABC_EVENT_AT_START_DOCUMENT,        \
         AMS_EVENT_AT_START_DOCUMENT,        \
@@ -192,5 +301,33 @@
         SLOC_EVENT_AT_PROC_INFO,            \
         NULL                                \
     }
-#endif
 
+    /*
+     * The tags every metric listens to at the start and the end of an element, see C_TAG_BIT(). An element
+     * event only executes the handlers of the metrics that listen to its tag.
+     */
+    #define ALL_TAGS_AT_START_ELEMENT { \
+        ABC_TAGS_AT_START_ELEMENT,      \
+        AMS_TAGS_AT_START_ELEMENT,      \
+        CC_TAGS_AT_START_ELEMENT,       \
+        HSM_TAGS_AT_START_ELEMENT,      \
+        MC_TAGS_AT_START_ELEMENT,       \
+        MND_TAGS_AT_START_ELEMENT,      \
+        NPM_TAGS_AT_START_ELEMENT,      \
+        RFU_TAGS_AT_START_ELEMENT,      \
+        SLOC_TAGS_AT_START_ELEMENT,     \
+        0                               \
+    }
+    #define ALL_TAGS_AT_END_ELEMENT {   \
+        ABC_TAGS_AT_END_ELEMENT,        \
+        AMS_TAGS_AT_END_ELEMENT,        \
+        CC_TAGS_AT_END_ELEMENT,         \
+        HSM_TAGS_AT_END_ELEMENT,        \
+        MC_TAGS_AT_END_ELEMENT,         \
+        MND_TAGS_AT_END_ELEMENT,        \
+        NPM_TAGS_AT_END_ELEMENT,        \
+        RFU_TAGS_AT_END_ELEMENT,        \
+        SLOC_TAGS_AT_END_ELEMENT,       \
+        0                               \
+    }
+#endif
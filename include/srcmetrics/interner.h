@@ -0,0 +1,95 @@
+/**
+ * @file interner.h
+ * @brief Defines Interner, the hash index that keeps one copy of every entity name in the strings of an Analysis.
+ * @author Yavuz Koroglu
+ * @see interner.c
+ */
+#ifndef INTERNER_H
+    #define INTERNER_H
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include "padkit/chunk.h"
+
+    #define INTERNER_INITIAL_CAP    256
+
+    #define NOT_AN_INTERNER ((Interner){ NULL, 0, 0 })
+
+    /**
+     * @struct InternerSlot
+     * @brief A string id and its hash, so a probe compares the bytes only when the hashes match.
+     */
+    typedef struct InternerSlotBody {
+        uint32_t hash;
+        uint32_t id;
+    } InternerSlot;
+
+    /**
+     * @struct Interner
+     * @brief An open-addressing hash table over the string ids of a Chunk.
+     *
+     * The Chunk keeps the bytes and the Interner keeps the ids, so a string id stays the same 32-bit id of the
+     * Chunk, and get_chunk() still finds it. intern_interner() adds a string only if the Chunk does NOT have
+     * it yet, so the strings grow with the distinct names instead of the rows that name them.
+     *
+     * The Interner only knows the strings that went through it, see index_interner(). A string that went to
+     * the Chunk in another way is never found, so the worst case is a duplicate, as before.
+     *
+     * The table is allocated with the first string, doubles when it is 3/4 full, and a lookup takes one probe
+     * on average. flush_interner() must follow flush_chunk(), because the ids of the Chunk start over.
+     */
+    typedef struct InternerBody {
+        InternerSlot* slots;
+        uint32_t      cap;
+        uint32_t      count;
+    } Interner;
+
+    /**
+     * @brief Finds a string in an Interner.
+     * @param interner A pointer to the Interner.
+     * @param strings A pointer to the Chunk of the Interner.
+     * @param str The string.
+     * @param len The length of the string.
+     * @return The id of the string in the Chunk, or 0xFFFFFFFF if the Interner does NOT know it.
+     */
+    uint32_t find_interner(Interner const* const interner, Chunk const* const strings, char const* const str, uint64_t const len);
+
+    /**
+     * @brief Forgets every string of an Interner, and keeps its table.
+     * @param interner A pointer to the Interner.
+     */
+    void flush_interner(Interner* const interner);
+
+    /**
+     * @brief Frees the table of an Interner.
+     * @param interner A pointer to the Interner.
+     */
+    void free_interner(Interner* const interner);
+
+    /**
+     * @brief Adds a string that is already in the Chunk to an Interner, e.g., one built with append_chunk().
+     *
+     * If the Interner knows an equal string, it keeps the one it knows, and the id is still a valid copy.
+     *
+     * @param interner A pointer to the Interner.
+     * @param strings A pointer to the Chunk of the Interner.
+     * @param id The id of the string in the Chunk.
+     * @return The id the Interner gives for the string from now on.
+     */
+    uint32_t index_interner(Interner* const interner, Chunk const* const strings, uint32_t const id);
+
+    /**
+     * @brief Returns the id of a string, adding it to the Chunk only if the Interner does NOT know it.
+     * @param interner A pointer to the Interner.
+     * @param strings A pointer to the Chunk of the Interner.
+     * @param str The string.
+     * @param len The length of the string.
+     * @return The id of the string in the Chunk, or 0xFFFFFFFF if the Chunk cannot add it.
+     */
+    uint32_t intern_interner(Interner* const interner, Chunk* const strings, char const* const str, uint64_t const len);
+
+    /**
+     * @brief Checks if an Interner is valid.
+     * @param interner A pointer to the Interner.
+     */
+    bool isValid_interner(Interner const* const interner);
+#endif
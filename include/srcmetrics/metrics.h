@@ -25,6 +25,33 @@
         "SLOC",                                                                 \
         NULL                                                                    \
     }
+
+    #define METRIC_ABC                  0
+    #define METRIC_AMS                  1
+    #define METRIC_CC                   2
+    #define METRIC_HSM                  3
+    #define METRIC_MC                   4
+    #define METRIC_MND                  5
+    #define METRIC_NPM                  6
+    #define METRIC_RFU                  7
+    #define METRIC_SLOC                 8
+
+    /* The row names of every metric, in the order of METRICS, see result.h */
+    #define SUBMETRICS_COUNT_MAX        8
+    #define SUBMETRIC_ONLY              0
+    #define SUBMETRICS {                                                        \
+        { "ABC-A", "ABC-B", "ABC-C", "ABC", NULL },                             \
+        { "AMS", NULL },                                                        \
+        { "CC", NULL },                                                         \
+        { "HSM-V", "HSM-D", "HSM-E", "HSM-B", "HSM-T", NULL },                  \
+        { "MC", NULL },                                                         \
+        { "MND", NULL },                                                        \
+        { "NPM", NULL },                                                        \
+        { "RFU", NULL },                                                        \
+        { "SLOC", NULL },                                                       \
+        { NULL }                                                                \
+    }
+
     #define METRIC_DESCRIPTIONS {                                               \
         "√(A²+B²+C²);\n"                                                        \
             "            A: Assignments,\n"                                     \
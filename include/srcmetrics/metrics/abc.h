@@ -6,17 +6,60 @@
  */
 #ifndef ABC_H
     #define ABC_H
-    #include "libsrcsax/srcsax.h"
-    #include "padkit/map.h"
+    #include <stdbool.h>
+    #include <stdio.h>
+    #include "languages/c.h"
+    #include "srcmetrics/result.h"
 
-    void event_startDocument_abc  (struct srcsax_context* context, ...);
-    void event_endDocument_abc    (struct srcsax_context* context, ...);
-    void event_startUnit_abc      (struct srcsax_context* context, ...);
-    void event_endUnit_abc        (struct srcsax_context* context, ...);
-    void event_startElement_abc   (struct srcsax_context* context, ...);
-    void event_endElement_abc     (struct srcsax_context* context, ...);
-    void event_charactersUnit_abc (struct srcsax_context* context, ...);
-    Map const* report_abc         (void);
+    struct AnalysisBody;
+    struct CharactersEventBody;
+    struct EndElementEventBody;
+    struct StartElementEventBody;
+    struct UnitEventBody;
+
+    /* The sub-metrics of ABC, see SUBMETRICS */
+    #define ABC_SUB_A   0
+    #define ABC_SUB_B   1
+    #define ABC_SUB_C   2
+    #define ABC_SUB_ABC 3
+
+    /**
+     * @struct ABCState
+     * @brief The ABC statistics and counters of one Analysis.
+     *
+     * The text of the current operator starts at op_at in the Arena of ABC, see arena.h.
+     */
+    typedef struct ABCStateBody {
+        ResultTable statistics[1];
+        unsigned    ac_read_state;
+        unsigned    a_overall;
+        unsigned    b_overall;
+        unsigned    c_overall;
+        unsigned    a_unit;
+        unsigned    b_unit;
+        unsigned    c_unit;
+        unsigned    a_fn;
+        unsigned    b_fn;
+        unsigned    c_fn;
+        float       abc_overall;
+        float       abc_unit;
+        float       abc_fn;
+        uint64_t    op_at;
+    } ABCState;
+
+    void free_abc(ABCState* const abc);
+    void merge_abc(struct AnalysisBody* const analysis, struct AnalysisBody const* const partial);
+    bool save_abc(FILE* const stream, struct AnalysisBody const* const partial);
+    bool load_abc(struct AnalysisBody* const partial, FILE* const stream);
+
+    void event_startDocument_abc  (struct AnalysisBody* const analysis);
+    void event_endDocument_abc    (struct AnalysisBody* const analysis);
+    void event_startUnit_abc      (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_endUnit_abc        (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_startElement_abc   (struct AnalysisBody* const analysis, struct StartElementEventBody const* const event);
+    void event_endElement_abc     (struct AnalysisBody* const analysis, struct EndElementEventBody const* const event);
+    void event_charactersUnit_abc (struct AnalysisBody* const analysis, struct CharactersEventBody const* const event);
+    ResultTable const* report_abc (struct AnalysisBody const* const analysis);
 
     #define ABC_EVENT_AT_START_DOCUMENT  &event_startDocument_abc
     #define ABC_EVENT_AT_END_DOCUMENT    &event_endDocument_abc
@@ -32,5 +75,14 @@
     #define ABC_EVENT_AT_COMMENT         NULL
     #define ABC_EVENT_AT_CDATA_BLOCK     NULL
     #define ABC_EVENT_AT_PROC_INFO       NULL
+    #define ABC_TAGS_AT_START_ELEMENT    (                                                     \
+        C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_CALL) | C_TAG_BIT(C_GOTO) | C_TAG_BIT(C_COMMENT) | \
+        C_TAG_BIT(C_ELSE) | C_TAG_BIT(C_CASE) | C_TAG_BIT(C_DEFAULT) | C_TAG_BIT(C_TERNARY) |  \
+        C_TAG_BIT(C_OPERATOR) | C_TAG_BIT(C_DECL_STMT) | C_TAG_BIT(C_INIT)                     \
+    )
+    #define ABC_TAGS_AT_END_ELEMENT      (C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_COMMENT) | C_TAG_BIT(C_OPERATOR))
     #define ABC_REPORT                   &report_abc
+    #define ABC_MERGE                    &merge_abc
+    #define ABC_SAVE                     &save_abc
+    #define ABC_LOAD                     &load_abc
 #endif
@@ -6,16 +6,46 @@
  */
 #ifndef AMS_H
     #define AMS_H
-    #include "libsrcsax/srcsax.h"
-    #include "padkit/map.h"
+    #include <stdbool.h>
+    #include <stdio.h>
+    #include "languages/c.h"
+    #include "srcmetrics/result.h"
 
-    void event_startDocument_ams (struct srcsax_context* context, ...);
-    void event_endDocument_ams   (struct srcsax_context* context, ...);
-    void event_startUnit_ams     (struct srcsax_context* context, ...);
-    void event_endUnit_ams       (struct srcsax_context* context, ...);
-    void event_startElement_ams  (struct srcsax_context* context, ...);
-    void event_endElement_ams    (struct srcsax_context* context, ...);
-    Map const* report_ams        (void);
+    struct AnalysisBody;
+    struct EndElementEventBody;
+    struct StartElementEventBody;
+    struct UnitEventBody;
+
+    /**
+     * @struct AMSState
+     * @brief The AMS statistics and method size lists of one Analysis.
+     */
+    typedef struct AMSStateBody {
+        ResultTable statistics[1];
+        unsigned    ams_read_state;
+        unsigned    method_count_unit;
+        unsigned    method_count_overall;
+        unsigned    method_size;
+        unsigned    ms_overall_cap;
+        unsigned*   ms_overall_list;
+        unsigned    ms_unit_cap;
+        unsigned*   ms_unit_list;
+        float       ams_overall;
+        float       ams_unit;
+    } AMSState;
+
+    void free_ams(AMSState* const ams);
+    void merge_ams(struct AnalysisBody* const analysis, struct AnalysisBody const* const partial);
+    bool save_ams(FILE* const stream, struct AnalysisBody const* const partial);
+    bool load_ams(struct AnalysisBody* const partial, FILE* const stream);
+
+    void event_startDocument_ams (struct AnalysisBody* const analysis);
+    void event_endDocument_ams   (struct AnalysisBody* const analysis);
+    void event_startUnit_ams     (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_endUnit_ams       (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_startElement_ams  (struct AnalysisBody* const analysis, struct StartElementEventBody const* const event);
+    void event_endElement_ams    (struct AnalysisBody* const analysis, struct EndElementEventBody const* const event);
+    ResultTable const* report_ams (struct AnalysisBody const* const analysis);
 
     #define AMS_EVENT_AT_START_DOCUMENT  &event_startDocument_ams
     #define AMS_EVENT_AT_END_DOCUMENT    &event_endDocument_ams
@@ -31,5 +61,20 @@
     #define AMS_EVENT_AT_COMMENT         NULL
     #define AMS_EVENT_AT_CDATA_BLOCK     NULL
     #define AMS_EVENT_AT_PROC_INFO       NULL
+    #define AMS_TAGS_AT_START_ELEMENT    (                                                              \
+        C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_EXPR_STMT) | C_TAG_BIT(C_DECL_STMT) | C_TAG_BIT(C_RETURN) | \
+        C_TAG_BIT(C_BREAK) | C_TAG_BIT(C_CONTINUE) | C_TAG_BIT(C_LABEL) | C_TAG_BIT(C_GOTO) |           \
+        C_TAG_BIT(C_DEFAULT) | C_TAG_BIT(C_CASE) | C_TAG_BIT(C_DIRECTIVE) | C_TAG_BIT(C_MACRO) |        \
+        C_TAG_BIT(C_FOR) | C_TAG_BIT(C_WHILE) | C_TAG_BIT(C_SWITCH) | C_TAG_BIT(C_IF_STMT) |            \
+        C_TAG_BIT(C_TYPEDEF) | C_TAG_BIT(C_STRUCT) | C_TAG_BIT(C_UNION)                                 \
+    )
+    #define AMS_TAGS_AT_END_ELEMENT      (                                                              \
+        C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_EXPR_STMT) | C_TAG_BIT(C_DECL_STMT) | C_TAG_BIT(C_RETURN) | \
+        C_TAG_BIT(C_BREAK) | C_TAG_BIT(C_CONTINUE) | C_TAG_BIT(C_LABEL) | C_TAG_BIT(C_GOTO) |           \
+        C_TAG_BIT(C_DEFAULT) | C_TAG_BIT(C_CASE) | C_TAG_BIT(C_DIRECTIVE) | C_TAG_BIT(C_MACRO)          \
+    )
     #define AMS_REPORT                   &report_ams
+    #define AMS_MERGE                    &merge_ams
+    #define AMS_SAVE                     &save_ams
+    #define AMS_LOAD                     &load_ams
 #endif
@@ -6,17 +6,41 @@
  */
 #ifndef CC_H
     #define CC_H
-    #include "libsrcsax/srcsax.h"
-    #include "padkit/map.h"
+    #include <stdbool.h>
+    #include <stdio.h>
+    #include "languages/c.h"
+    #include "srcmetrics/result.h"
 
-    void event_startDocument_cc  (struct srcsax_context* context, ...);
-    void event_endDocument_cc    (struct srcsax_context* context, ...);
-    void event_startUnit_cc      (struct srcsax_context* context, ...);
-    void event_endUnit_cc        (struct srcsax_context* context, ...);
-    void event_startElement_cc   (struct srcsax_context* context, ...);
-    void event_endElement_cc     (struct srcsax_context* context, ...);
-    void event_charactersUnit_cc (struct srcsax_context* context, ...);
-    Map const* report_cc         (void);
+    struct AnalysisBody;
+    struct CharactersEventBody;
+    struct EndElementEventBody;
+    struct StartElementEventBody;
+    struct UnitEventBody;
+
+    /**
+     * @struct CCState
+     * @brief The CC statistics and the control-flow graph parser of one Analysis.
+     */
+    typedef struct CCStateBody {
+        ResultTable statistics[1];
+        CParse      cparse[1];
+        unsigned    cc_overall;
+    } CCState;
+
+    void free_cc(CCState* const cc);
+    void trim_cc(CCState* const cc);
+    void merge_cc(struct AnalysisBody* const analysis, struct AnalysisBody const* const partial);
+    bool save_cc(FILE* const stream, struct AnalysisBody const* const partial);
+    bool load_cc(struct AnalysisBody* const partial, FILE* const stream);
+
+    void event_startDocument_cc  (struct AnalysisBody* const analysis);
+    void event_endDocument_cc    (struct AnalysisBody* const analysis);
+    void event_startUnit_cc      (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_endUnit_cc        (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_startElement_cc   (struct AnalysisBody* const analysis, struct StartElementEventBody const* const event);
+    void event_endElement_cc     (struct AnalysisBody* const analysis, struct EndElementEventBody const* const event);
+    void event_charactersUnit_cc (struct AnalysisBody* const analysis, struct CharactersEventBody const* const event);
+    ResultTable const* report_cc (struct AnalysisBody const* const analysis);
 
     #define CC_EVENT_AT_START_DOCUMENT  &event_startDocument_cc
     #define CC_EVENT_AT_END_DOCUMENT    &event_endDocument_cc
@@ -32,5 +56,10 @@
     #define CC_EVENT_AT_COMMENT         NULL
     #define CC_EVENT_AT_CDATA_BLOCK     NULL
     #define CC_EVENT_AT_PROC_INFO       NULL
+    #define CC_TAGS_AT_START_ELEMENT    C_ALL_ELEMENTS
+    #define CC_TAGS_AT_END_ELEMENT      C_ALL_ELEMENTS
     #define CC_REPORT                   &report_cc
+    #define CC_MERGE                    &merge_cc
+    #define CC_SAVE                     &save_cc
+    #define CC_LOAD                     &load_cc
 #endif
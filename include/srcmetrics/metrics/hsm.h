@@ -6,17 +6,122 @@
  */
 #ifndef HSM_H
     #define HSM_H
-    #include "libsrcsax/srcsax.h"
-    #include "padkit/map.h"
-
-    void event_startDocument_hsm  (struct srcsax_context* context, ...);
-    void event_endDocument_hsm    (struct srcsax_context* context, ...);
-    void event_startUnit_hsm      (struct srcsax_context* context, ...);
-    void event_endUnit_hsm        (struct srcsax_context* context, ...);
-    void event_startElement_hsm   (struct srcsax_context* context, ...);
-    void event_endElement_hsm     (struct srcsax_context* context, ...);
-    void event_charactersUnit_hsm (struct srcsax_context* context, ...);
-    Map const* report_hsm         (void);
+    #include <stdbool.h>
+    #include <stdio.h>
+    #include "languages/c.h"
+    #include "srcmetrics/result.h"
+    #include "padkit/chunk.h"
+    #include "padkit/chunkset.h"
+
+    #define HSM_OPERATORS_OVERALL 0
+    #define HSM_OPERATORS_UNIT    1
+    #define HSM_OPERATORS_FN      2
+    #define HSM_OPERANDS_OVERALL  3
+    #define HSM_OPERANDS_UNIT     4
+    #define HSM_OPERANDS_FN       5
+    #define HSM_SET_LAST          HSM_OPERANDS_FN
+
+    /* The sub-metrics of HSM, see SUBMETRICS */
+    #define HSM_SUB_V   0
+    #define HSM_SUB_D   1
+    #define HSM_SUB_E   2
+    #define HSM_SUB_B   3
+    #define HSM_SUB_T   4
+
+    struct AnalysisBody;
+    struct CharactersEventBody;
+    struct EndElementEventBody;
+    struct StartElementEventBody;
+    struct UnitEventBody;
+
+    /**
+     * @struct HSMState
+     * @brief The HSM statistics, operator/operand sets, and counters of one Analysis.
+     *
+     * The characters of an operator or an expression go to the Arena of HSM once, see arena.h. The text of the
+     * current operator starts at operator_at, and the text of every open expression, i.e., an operand, starts
+     * at its offset in operand_ats. The text of an inner expression is a part of the text of the outer ones, so
+     * they share the same bytes.
+     */
+    typedef struct HSMStateBody {
+        ResultTable statistics[1];
+        unsigned    hsm_read_state;
+        ChunkSet    set[HSM_SET_LAST + 1];
+
+        /* # Distinct Operators */
+        unsigned    nu1_overall;
+        unsigned    nu1_unit;
+        unsigned    nu1_fn;
+
+        /* # Distinct Operands */
+        unsigned    nu2_overall;
+        unsigned    nu2_unit;
+        unsigned    nu2_fn;
+
+        /* # Operators */
+        unsigned    n1_overall;
+        unsigned    n1_unit;
+        unsigned    n1_fn;
+
+        /* # Operands */
+        unsigned    n2_overall;
+        unsigned    n2_unit;
+        unsigned    n2_fn;
+
+        /* Halstead Vocabulary */
+        unsigned    nu_overall;
+        unsigned    nu_unit;
+        unsigned    nu_fn;
+
+        /* Halstead Length */
+        unsigned    n_overall;
+        unsigned    n_unit;
+        unsigned    n_fn;
+
+        /* Halstead Bugs */
+        float       b_overall;
+        float       b_unit;
+        float       b_fn;
+
+        /* Halstead Time */
+        float       t_overall;
+        float       t_unit;
+        float       t_fn;
+
+        /* Halstead Volume */
+        float       v_overall;
+        float       v_unit;
+        float       v_fn;
+
+        /* Halstead Difficulty */
+        float       d_overall;
+        float       d_unit;
+        float       d_fn;
+
+        /* Halstead Effort */
+        float       e_overall;
+        float       e_unit;
+        float       e_fn;
+
+        uint64_t    operator_at;
+        uint64_t*   operand_ats;
+        unsigned    operand_count;
+        unsigned    operand_cap;
+    } HSMState;
+
+    void free_hsm(HSMState* const hsm);
+    void merge_hsm(struct AnalysisBody* const analysis, struct AnalysisBody const* const partial);
+    bool save_hsm(FILE* const stream, struct AnalysisBody const* const partial);
+    bool load_hsm(struct AnalysisBody* const partial, FILE* const stream);
+
+    void event_startDocument_hsm  (struct AnalysisBody* const analysis);
+    void event_endDocument_hsm    (struct AnalysisBody* const analysis);
+    void event_startUnit_hsm      (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_endUnit_hsm        (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_startElement_hsm   (struct AnalysisBody* const analysis, struct StartElementEventBody const* const event);
+    void event_endElement_hsm     (struct AnalysisBody* const analysis, struct EndElementEventBody const* const event);
+    void event_charactersUnit_hsm (struct AnalysisBody* const analysis, struct CharactersEventBody const* const event);
+    ResultTable const* report_hsm (struct AnalysisBody const* const analysis);
 
     #define HSM_EVENT_AT_START_DOCUMENT  &event_startDocument_hsm
     #define HSM_EVENT_AT_END_DOCUMENT    &event_endDocument_hsm
@@ -32,5 +137,10 @@
     #define HSM_EVENT_AT_COMMENT         NULL
     #define HSM_EVENT_AT_CDATA_BLOCK     NULL
     #define HSM_EVENT_AT_PROC_INFO       NULL
+    #define HSM_TAGS_AT_START_ELEMENT    (C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_EXPR) | C_TAG_BIT(C_OPERATOR))
+    #define HSM_TAGS_AT_END_ELEMENT      (C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_EXPR) | C_TAG_BIT(C_OPERATOR))
     #define HSM_REPORT                   &report_hsm
+    #define HSM_MERGE                    &merge_hsm
+    #define HSM_SAVE                     &save_hsm
+    #define HSM_LOAD                     &load_hsm
 #endif
@@ -6,15 +6,36 @@
  */
 #ifndef MC_H
     #define MC_H
-    #include "libsrcsax/srcsax.h"
-    #include "padkit/map.h"
+    #include <stdbool.h>
+    #include <stdio.h>
+    #include "languages/c.h"
+    #include "srcmetrics/result.h"
 
-    void event_startDocument_mc (struct srcsax_context* context, ...);
-    void event_endDocument_mc   (struct srcsax_context* context, ...);
-    void event_startUnit_mc     (struct srcsax_context* context, ...);
-    void event_endUnit_mc       (struct srcsax_context* context, ...);
-    void event_startElement_mc  (struct srcsax_context* context, ...);
-    Map const* report_mc        (void);
+    struct AnalysisBody;
+    struct StartElementEventBody;
+    struct UnitEventBody;
+
+    /**
+     * @struct MCState
+     * @brief The MC statistics and counters of one Analysis.
+     */
+    typedef struct MCStateBody {
+        ResultTable statistics[1];
+        unsigned    mc_overall;
+        unsigned    mc_unit;
+    } MCState;
+
+    void free_mc(MCState* const mc);
+    void merge_mc(struct AnalysisBody* const analysis, struct AnalysisBody const* const partial);
+    bool save_mc(FILE* const stream, struct AnalysisBody const* const partial);
+    bool load_mc(struct AnalysisBody* const partial, FILE* const stream);
+
+    void event_startDocument_mc (struct AnalysisBody* const analysis);
+    void event_endDocument_mc   (struct AnalysisBody* const analysis);
+    void event_startUnit_mc     (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_endUnit_mc       (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_startElement_mc  (struct AnalysisBody* const analysis, struct StartElementEventBody const* const event);
+    ResultTable const* report_mc (struct AnalysisBody const* const analysis);
 
     #define MC_EVENT_AT_START_DOCUMENT  &event_startDocument_mc
     #define MC_EVENT_AT_END_DOCUMENT    &event_endDocument_mc
@@ -30,5 +51,10 @@
     #define MC_EVENT_AT_COMMENT         NULL
     #define MC_EVENT_AT_CDATA_BLOCK     NULL
     #define MC_EVENT_AT_PROC_INFO       NULL
+    #define MC_TAGS_AT_START_ELEMENT    (C_TAG_BIT(C_FUNCTION))
+    #define MC_TAGS_AT_END_ELEMENT      0
     #define MC_REPORT                   &report_mc
+    #define MC_MERGE                    &merge_mc
+    #define MC_SAVE                     &save_mc
+    #define MC_LOAD                     &load_mc
 #endif
@@ -6,16 +6,41 @@
  */
 #ifndef MND_H
     #define MND_H
-    #include "libsrcsax/srcsax.h"
-    #include "padkit/map.h"
+    #include <stdbool.h>
+    #include <stdio.h>
+    #include "languages/c.h"
+    #include "srcmetrics/result.h"
 
-    void event_startDocument_mnd (struct srcsax_context* context, ...);
-    void event_endDocument_mnd   (struct srcsax_context* context, ...);
-    void event_startUnit_mnd     (struct srcsax_context* context, ...);
-    void event_endUnit_mnd       (struct srcsax_context* context, ...);
-    void event_startElement_mnd  (struct srcsax_context* context, ...);
-    void event_endElement_mnd    (struct srcsax_context* context, ...);
-    Map const* report_mnd        (void);
+    struct AnalysisBody;
+    struct EndElementEventBody;
+    struct StartElementEventBody;
+    struct UnitEventBody;
+
+    /**
+     * @struct MNDState
+     * @brief The MND statistics and nesting depths of one Analysis.
+     */
+    typedef struct MNDStateBody {
+        ResultTable statistics[1];
+        unsigned    mnd_read_state;
+        unsigned    mnd_overall;
+        unsigned    mnd_unit;
+        unsigned    mnd_fn;
+        unsigned    nd;
+    } MNDState;
+
+    void free_mnd(MNDState* const mnd);
+    void merge_mnd(struct AnalysisBody* const analysis, struct AnalysisBody const* const partial);
+    bool save_mnd(FILE* const stream, struct AnalysisBody const* const partial);
+    bool load_mnd(struct AnalysisBody* const partial, FILE* const stream);
+
+    void event_startDocument_mnd (struct AnalysisBody* const analysis);
+    void event_endDocument_mnd   (struct AnalysisBody* const analysis);
+    void event_startUnit_mnd     (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_endUnit_mnd       (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_startElement_mnd  (struct AnalysisBody* const analysis, struct StartElementEventBody const* const event);
+    void event_endElement_mnd    (struct AnalysisBody* const analysis, struct EndElementEventBody const* const event);
+    ResultTable const* report_mnd (struct AnalysisBody const* const analysis);
 
     #define MND_EVENT_AT_START_DOCUMENT  &event_startDocument_mnd
     #define MND_EVENT_AT_END_DOCUMENT    &event_endDocument_mnd
@@ -31,5 +56,10 @@
     #define MND_EVENT_AT_COMMENT         NULL
     #define MND_EVENT_AT_CDATA_BLOCK     NULL
     #define MND_EVENT_AT_PROC_INFO       NULL
+    #define MND_TAGS_AT_START_ELEMENT    (C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_BLOCK))
+    #define MND_TAGS_AT_END_ELEMENT      (C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_BLOCK))
     #define MND_REPORT                   &report_mnd
+    #define MND_MERGE                    &merge_mnd
+    #define MND_SAVE                     &save_mnd
+    #define MND_LOAD                     &load_mnd
 #endif
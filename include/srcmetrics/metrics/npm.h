@@ -6,17 +6,43 @@
  */
 #ifndef NPM_H
     #define NPM_H
-    #include "libsrcsax/srcsax.h"
-    #include "padkit/map.h"
+    #include <stdbool.h>
+    #include <stdio.h>
+    #include "languages/c.h"
+    #include "srcmetrics/result.h"
+    #include "padkit/chunk.h"
 
-    void event_startDocument_npm  (struct srcsax_context* context, ...);
-    void event_endDocument_npm    (struct srcsax_context* context, ...);
-    void event_startUnit_npm      (struct srcsax_context* context, ...);
-    void event_endUnit_npm        (struct srcsax_context* context, ...);
-    void event_startElement_npm   (struct srcsax_context* context, ...);
-    void event_endElement_npm     (struct srcsax_context* context, ...);
-    void event_charactersUnit_npm (struct srcsax_context* context, ...);
-    Map const* report_npm         (void);
+    struct AnalysisBody;
+    struct CharactersEventBody;
+    struct EndElementEventBody;
+    struct StartElementEventBody;
+    struct UnitEventBody;
+
+    /**
+     * @struct NPMState
+     * @brief The NPM statistics and counters of one Analysis.
+     */
+    typedef struct NPMStateBody {
+        ResultTable statistics[1];
+        unsigned    npm_read_state;
+        unsigned    npm_overall;
+        unsigned    npm_unit;
+        Chunk       specifier_chunk[1];
+    } NPMState;
+
+    void free_npm(NPMState* const npm);
+    void merge_npm(struct AnalysisBody* const analysis, struct AnalysisBody const* const partial);
+    bool save_npm(FILE* const stream, struct AnalysisBody const* const partial);
+    bool load_npm(struct AnalysisBody* const partial, FILE* const stream);
+
+    void event_startDocument_npm  (struct AnalysisBody* const analysis);
+    void event_endDocument_npm    (struct AnalysisBody* const analysis);
+    void event_startUnit_npm      (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_endUnit_npm        (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_startElement_npm   (struct AnalysisBody* const analysis, struct StartElementEventBody const* const event);
+    void event_endElement_npm     (struct AnalysisBody* const analysis, struct EndElementEventBody const* const event);
+    void event_charactersUnit_npm (struct AnalysisBody* const analysis, struct CharactersEventBody const* const event);
+    ResultTable const* report_npm (struct AnalysisBody const* const analysis);
 
     #define NPM_EVENT_AT_START_DOCUMENT  &event_startDocument_npm
     #define NPM_EVENT_AT_END_DOCUMENT    &event_endDocument_npm
@@ -32,5 +58,10 @@
     #define NPM_EVENT_AT_COMMENT         NULL
     #define NPM_EVENT_AT_CDATA_BLOCK     NULL
     #define NPM_EVENT_AT_PROC_INFO       NULL
+    #define NPM_TAGS_AT_START_ELEMENT    (C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_TYPE) | C_TAG_BIT(C_SPECIFIER))
+    #define NPM_TAGS_AT_END_ELEMENT      (C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_TYPE) | C_TAG_BIT(C_SPECIFIER))
     #define NPM_REPORT                   &report_npm
+    #define NPM_MERGE                    &merge_npm
+    #define NPM_SAVE                     &save_npm
+    #define NPM_LOAD                     &load_npm
 #endif
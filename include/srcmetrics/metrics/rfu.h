@@ -6,17 +6,92 @@
  */
 #ifndef RFU_H
     #define RFU_H
-    #include "libsrcsax/srcsax.h"
-    #include "padkit/map.h"
+    #include <stdbool.h>
+    #include <stdio.h>
+    #include "languages/c.h"
+    #include "srcmetrics/result.h"
+    #include "srcmetrics/sparsegraph.h"
+    #include "padkit/chunk.h"
+    #include "padkit/chunkset.h"
 
-    void event_startDocument_rfu  (struct srcsax_context* context, ...);
-    void event_endDocument_rfu    (struct srcsax_context* context, ...);
-    void event_startUnit_rfu      (struct srcsax_context* context, ...);
-    void event_endUnit_rfu        (struct srcsax_context* context, ...);
-    void event_startElement_rfu   (struct srcsax_context* context, ...);
-    void event_endElement_rfu     (struct srcsax_context* context, ...);
-    void event_charactersUnit_rfu (struct srcsax_context* context, ...);
-    Map const* report_rfu         (void);
+    struct AnalysisBody;
+    struct CharactersEventBody;
+    struct EndElementEventBody;
+    struct StartElementEventBody;
+    struct UnitEventBody;
+
+    /**
+     * @struct RFURow
+     * @brief A transitive RFU row, whose value needs the whole call graph.
+     */
+    typedef struct RFURowBody {
+        uint32_t entity_id;
+        uint32_t vertex_id;
+        bool     isUnit;
+    } RFURow;
+
+    /**
+     * @struct RFUState
+     * @brief The RFU statistics and the call graph of one Analysis.
+     *
+     * RFU depends on the calls of all the previous units, so a partial Analysis has no call graph. It records
+     * the units, functions, and calls it reads in a replay log, and merge_rfu() replays them in input order.
+     * Every name of the log is interned once into the replay symbols, and the log refers to it by its id, so
+     * merge_rfu() hashes a name once per partial instead of once per call, see symbol_fns.
+     *
+     * The functions are interned into dense ids, and the graphs only store ids. A simple RFU row counts the
+     * distinct ids with the visited array, where a function is visited iff its stamp is the visit epoch.
+     *
+     * The callGraph connects callers to callees, the ownerGraph connects functions to the units that define
+     * them, and the unitGraph connects units to the functions they define.
+     *
+     * With '--RFU-transitive', a unit or a function also counts every function its calls reach through the
+     * whole call graph, including the calls of the later units. So its row waits in the transitive rows until
+     * the end document event, where the reachable sets are computed once for the whole call graph.
+     */
+    typedef struct RFUStateBody {
+        ResultTable statistics[1];
+        SparseGraph callGraph[1];
+        ChunkSet    units[1];
+        ChunkSet    fns[1];
+        SparseGraph ownerGraph[1];
+        SparseGraph unitGraph[1];
+        uint32_t    unit_count;
+        uint32_t    fn_count;
+        uint32_t    unit_id;
+        uint32_t    fn_id;
+        unsigned    rfu_fn;
+        unsigned    rfu_unit;
+        unsigned    rfu_overall;
+        Chunk       name_chunk[1];
+        unsigned    rfu_read_state;
+        ChunkSet    replay_symbols[1];
+        unsigned*   replay_ops;
+        uint32_t    replay_count;
+        uint32_t    replay_cap;
+        uint32_t*   symbol_fns;
+        uint32_t    symbol_fn_cap;
+        uint32_t*   visited;
+        uint32_t    visited_cap;
+        uint32_t    visit_epoch;
+        RFURow*     transitive_rows;
+        uint32_t    transitive_count;
+        uint32_t    transitive_cap;
+    } RFUState;
+
+    void free_rfu(RFUState* const rfu);
+    void merge_rfu(struct AnalysisBody* const analysis, struct AnalysisBody const* const partial);
+    bool save_rfu(FILE* const stream, struct AnalysisBody const* const partial);
+    bool load_rfu(struct AnalysisBody* const partial, FILE* const stream);
+
+    void event_startDocument_rfu  (struct AnalysisBody* const analysis);
+    void event_endDocument_rfu    (struct AnalysisBody* const analysis);
+    void event_startUnit_rfu      (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_endUnit_rfu        (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_startElement_rfu   (struct AnalysisBody* const analysis, struct StartElementEventBody const* const event);
+    void event_endElement_rfu     (struct AnalysisBody* const analysis, struct EndElementEventBody const* const event);
+    void event_charactersUnit_rfu (struct AnalysisBody* const analysis, struct CharactersEventBody const* const event);
+    ResultTable const* report_rfu (struct AnalysisBody const* const analysis);
 
     #define RFU_EVENT_AT_START_DOCUMENT  &event_startDocument_rfu
     #define RFU_EVENT_AT_END_DOCUMENT    &event_endDocument_rfu
@@ -32,5 +107,12 @@
     #define RFU_EVENT_AT_COMMENT         NULL
     #define RFU_EVENT_AT_CDATA_BLOCK     NULL
     #define RFU_EVENT_AT_PROC_INFO       NULL
+    #define RFU_TAGS_AT_START_ELEMENT    (                                                \
+        C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_CALL) | C_TAG_BIT(C_TYPE) | C_TAG_BIT(C_NAME) \
+    )
+    #define RFU_TAGS_AT_END_ELEMENT      (C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_TYPE) | C_TAG_BIT(C_NAME))
     #define RFU_REPORT                   &report_rfu
+    #define RFU_MERGE                    &merge_rfu
+    #define RFU_SAVE                     &save_rfu
+    #define RFU_LOAD                     &load_rfu
 #endif
@@ -6,16 +6,40 @@
  */
 #ifndef SLOC_H
     #define SLOC_H
-    #include "libsrcsax/srcsax.h"
-    #include "padkit/map.h"
+    #include <stdbool.h>
+    #include <stdio.h>
+    #include "languages/c.h"
+    #include "srcmetrics/result.h"
 
-    void event_startDocument_sloc (struct srcsax_context* context, ...);
-    void event_endDocument_sloc   (struct srcsax_context* context, ...);
-    void event_startUnit_sloc     (struct srcsax_context* context, ...);
-    void event_endUnit_sloc       (struct srcsax_context* context, ...);
-    void event_startElement_sloc  (struct srcsax_context* context, ...);
-    void event_endElement_sloc    (struct srcsax_context* context, ...);
-    Map const* report_sloc        (void);
+    struct AnalysisBody;
+    struct EndElementEventBody;
+    struct StartElementEventBody;
+    struct UnitEventBody;
+
+    /**
+     * @struct SLOCState
+     * @brief The SLOC statistics and counters of one Analysis.
+     */
+    typedef struct SLOCStateBody {
+        ResultTable statistics[1];
+        unsigned    sloc_state;
+        unsigned    sloc_overall;
+        unsigned    sloc_unit;
+        unsigned    sloc_fn;
+    } SLOCState;
+
+    void free_sloc(SLOCState* const sloc);
+    void merge_sloc(struct AnalysisBody* const analysis, struct AnalysisBody const* const partial);
+    bool save_sloc(FILE* const stream, struct AnalysisBody const* const partial);
+    bool load_sloc(struct AnalysisBody* const partial, FILE* const stream);
+
+    void event_startDocument_sloc (struct AnalysisBody* const analysis);
+    void event_endDocument_sloc   (struct AnalysisBody* const analysis);
+    void event_startUnit_sloc     (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_endUnit_sloc       (struct AnalysisBody* const analysis, struct UnitEventBody const* const event);
+    void event_startElement_sloc  (struct AnalysisBody* const analysis, struct StartElementEventBody const* const event);
+    void event_endElement_sloc    (struct AnalysisBody* const analysis, struct EndElementEventBody const* const event);
+    ResultTable const* report_sloc (struct AnalysisBody const* const analysis);
 
     #define SLOC_EVENT_AT_START_DOCUMENT  &event_startDocument_sloc
     #define SLOC_EVENT_AT_END_DOCUMENT    &event_endDocument_sloc
@@ -31,5 +55,20 @@
     #define SLOC_EVENT_AT_COMMENT         NULL
     #define SLOC_EVENT_AT_CDATA_BLOCK     NULL
     #define SLOC_EVENT_AT_PROC_INFO       NULL
+    #define SLOC_TAGS_AT_START_ELEMENT    (                                                             \
+        C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_EXPR_STMT) | C_TAG_BIT(C_DECL_STMT) | C_TAG_BIT(C_RETURN) | \
+        C_TAG_BIT(C_BREAK) | C_TAG_BIT(C_CONTINUE) | C_TAG_BIT(C_LABEL) | C_TAG_BIT(C_GOTO) |           \
+        C_TAG_BIT(C_DEFAULT) | C_TAG_BIT(C_CASE) | C_TAG_BIT(C_DIRECTIVE) | C_TAG_BIT(C_MACRO) |        \
+        C_TAG_BIT(C_FOR) | C_TAG_BIT(C_WHILE) | C_TAG_BIT(C_SWITCH) | C_TAG_BIT(C_IF_STMT) |            \
+        C_TAG_BIT(C_TYPEDEF) | C_TAG_BIT(C_STRUCT) | C_TAG_BIT(C_UNION)                                 \
+    )
+    #define SLOC_TAGS_AT_END_ELEMENT      (                                                             \
+        C_TAG_BIT(C_FUNCTION) | C_TAG_BIT(C_EXPR_STMT) | C_TAG_BIT(C_DECL_STMT) | C_TAG_BIT(C_RETURN) | \
+        C_TAG_BIT(C_BREAK) | C_TAG_BIT(C_CONTINUE) | C_TAG_BIT(C_LABEL) | C_TAG_BIT(C_GOTO) |           \
+        C_TAG_BIT(C_DEFAULT) | C_TAG_BIT(C_CASE) | C_TAG_BIT(C_DIRECTIVE) | C_TAG_BIT(C_MACRO)          \
+    )
     #define SLOC_REPORT                   &report_sloc
+    #define SLOC_MERGE                    &merge_sloc
+    #define SLOC_SAVE                     &save_sloc
+    #define SLOC_LOAD                     &load_sloc
 #endif
@@ -0,0 +1,177 @@
+/**
+ * @file parse.h
+ * @brief Defines ParsePool, the srcML parsing stage.
+ * @author Yavuz Koroglu
+ * @see parse.c
+ */
+#ifndef PARSE_H
+    #define PARSE_H
+    #include <pthread.h>
+    #include <stdbool.h>
+    #include <stddef.h>
+    #include <stdint.h>
+    #include "libsrcml/srcml.h"
+    #include "srcmetrics/analysis.h"
+    #include "srcmetrics/profile.h"
+    #include "srcmetrics/source.h"
+
+    #define PPOOL_MAX_JOBS                      1024
+
+    #define PPOOL_RECOMMENDED_QUEUE_CAP_PER_JOB 4
+
+    /**
+     * @struct ParseSlot
+     * @brief One place in the bounded queue of a ParsePool.
+     */
+    typedef struct ParseSlotBody {
+        struct srcml_unit* unit;
+        bool               isReady;
+        bool               hasFailed;
+    } ParseSlot;
+
+    /**
+     * @struct ParseWorker
+     * @brief A parser thread and the srcML archive clone it creates units with.
+     */
+    typedef struct ParseWorkerBody {
+        pthread_t              thread;
+        struct srcml_archive*  archive;
+        struct ParsePoolBody*  pool;
+    } ParseWorker;
+
+    /**
+     * @struct ParsePool
+     * @brief Parses source files into srcML units, possibly with several worker threads.
+     *
+     * Every worker owns a clone of the srcML archive and its own Source, see source.h. Parsed units go to a bounded
+     * queue, and nextUnit_ppool() takes them out in input order, no matter which worker finishes first.
+     * With one job, there are no workers and nextUnit_ppool() parses the next file itself.
+     *
+     * If the pool evaluates metrics, every slot also owns a partial Analysis. A worker evaluates the unit it
+     * parsed in the Analysis of its slot and frees the unit, so nextAnalysis_ppool() takes out Analysis
+     * objects instead of units. With '--cache', a worker loads the Analysis of an unchanged file instead of
+     * parsing it, see cache.h. With one job, the pool owns one partial Analysis and nextAnalysis_ppool()
+     * evaluates the next file in it.
+     *
+     * With '--profile', every worker times its reads and parses in its own Profile, and so does a pool with
+     * one job, see profile.h.
+     *
+     * A worker never terminates the program. If an infile cannot be opened, its slot fails, and the consumer
+     * finds out when it takes that slot, i.e., after every infile before it, as in the serial loop. Then
+     * failedInfile is the infile, nextUnit_ppool() and nextAnalysis_ppool() return NULL, and free_ppool()
+     * stops the workers.
+     */
+    typedef struct ParsePoolBody {
+        size_t                 n_infiles;
+        char const* const*     infiles;
+        uint32_t               n_jobs;
+        uint32_t               queue_cap;
+        size_t                 nextToParse;
+        size_t                 nextToTake;
+        ParseSlot*             queue;
+        ParseWorker*           workers;
+        Analysis*              analyses;
+        bool                   isHoldingAnalysis;
+        struct srcml_archive*  archive;
+        Source                 source[1];
+        Profile*               profile;
+        char const*            failedInfile;
+        pthread_mutex_t        mutex;
+        pthread_cond_t         unitParsed;
+        pthread_cond_t         slotFreed;
+    } ParsePool;
+
+    /**
+     * @brief Constructs an empty ParsePool and starts its workers.
+     *
+     * Units come out in the order of the serial loop, i.e., from the last infile to the first.
+     *
+     * @param pool A pointer to the ParsePool.
+     * @param archive The srcML archive whose settings the units inherit.
+     * @param infiles The source file names.
+     * @param n_infiles The number of source files.
+     * @param n_jobs The number of parser threads.
+     * @param evaluatedMetrics The metrics the workers evaluate, or 0 if they only parse.
+     */
+    void constructEmpty_ppool(
+        ParsePool* const            pool,
+        struct srcml_archive* const archive,
+        char const* const* const    infiles,
+        size_t const                n_infiles,
+        uint32_t const              n_jobs,
+        uint_fast64_t const         evaluatedMetrics
+    );
+
+    /**
+     * @brief Joins the workers, frees the archive clones, and submits the profiles of a ParsePool.
+     *
+     * All units taken from the pool must be freed before calling this function. The units nobody took are freed
+     * here, so the consumer may stop early.
+     *
+     * @param pool A pointer to the ParsePool.
+     */
+    void free_ppool(ParsePool* const pool);
+
+    /**
+     * @brief Checks if a ParsePool is valid.
+     * @param pool A pointer to the ParsePool.
+     */
+    bool isValid_ppool(ParsePool const* const pool);
+
+    /**
+     * @brief Takes the next parsed unit, waiting for it if necessary.
+     *
+     * The caller owns the unit and must free it with srcml_unit_free().
+     *
+     * @param pool A pointer to the ParsePool.
+     * @return The next unit, or NULL if all the infiles are taken or the next one failed, see failedInfile.
+     */
+    struct srcml_unit* nextUnit_ppool(ParsePool* const pool);
+
+    /**
+     * @brief Takes the partial Analysis of the next unit, waiting for it if necessary.
+     *
+     * The Analysis belongs to the pool. It is valid until the next call, so merge it before taking another one.
+     *
+     * @param pool A pointer to a ParsePool that evaluates metrics.
+     * @return The next partial Analysis, or NULL if all the infiles are taken or the next one failed, see failedInfile.
+     */
+    Analysis const* nextAnalysis_ppool(ParsePool* const pool);
+
+    /**
+     * @brief Reads a source file and parses it into a new srcML unit.
+     *
+     * @param archive The srcML archive the unit belongs to.
+     * @param infile The source file name.
+     * @param source A released Source to read the source file into, see release_source().
+     * @param profile A pointer to the Profile of the calling thread, or NULL.
+     * @return The parsed unit, which the caller must free, or NULL if the file cannot be opened.
+     */
+    struct srcml_unit* parseUnit_ppool(
+        struct srcml_archive* const archive,
+        char const* const           infile,
+        Source* const               source,
+        Profile* const              profile
+    );
+
+    /**
+     * @brief Reads a source file and evaluates it in a partial Analysis, or loads it from the cache.
+     *
+     * A cache hit skips the srcML parse, and a miss saves the evaluated unit for the next run, see cache.h.
+     * If the file cannot be opened, the partial Analysis is left as it was.
+     *
+     * @param archive The srcML archive the unit belongs to.
+     * @param infile The source file name.
+     * @param source A released Source to read the source file into, see release_source().
+     * @param profile A pointer to the Profile of the calling thread, or NULL.
+     * @param partial A pointer to the partial Analysis, see runUnit_analysis().
+     * @return 0 if the file cannot be opened, 1 otherwise.
+     */
+    bool evaluateUnit_ppool(
+        struct srcml_archive* const archive,
+        char const* const           infile,
+        Source* const               source,
+        Profile* const              profile,
+        Analysis* const             partial
+    );
+#endif
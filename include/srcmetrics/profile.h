@@ -0,0 +1,103 @@
+/**
+ * @file profile.h
+ * @brief Defines Profile, the per-phase and per-metric timers of '--profile'.
+ * @author Yavuz Koroglu
+ * @see profile.c
+ */
+#ifndef PROFILE_H
+    #define PROFILE_H
+    #include <stddef.h>
+    #include <stdint.h>
+    #include "srcmetrics/metrics.h"
+
+    #define PROFILE_FILE_READ       0
+    #define PROFILE_SRCML_PARSE     1
+    #define PROFILE_ARCHIVE_WRITE   2
+    #define PROFILE_SRCSAX_PARSE    3
+    #define PROFILE_REPORT_CSV      4
+    #define PROFILE_GRAPHS          5
+    #define PROFILE_CACHE_LOAD      6
+    #define PROFILE_CACHE_SAVE      7
+    #define PROFILE_PHASE_COUNT     8
+
+    #define PROFILE_PHASES {            \
+        "file_read",                    \
+        "srcml_unit_parse_memory",      \
+        "srcml_archive_write_unit",     \
+        "srcsax_parse",                 \
+        "report_csv",                   \
+        "graph_generation",             \
+        "cache_load",                   \
+        "cache_save"                    \
+    }
+
+    /**
+     * @struct Profile
+     * @brief The total time and the call count of every phase and of every metric's handlers.
+     *
+     * Every thread adds to its own Profile, so the timers never lock. submit_profile() adds a Profile to the
+     * process total, which is written at exit, see enable_profile(). A NULL Profile means '--profile' is off, and
+     * every function below does nothing with it.
+     *
+     * The srcsax_parse phase includes the metric handlers, and the handlers of a metric include the graph
+     * generation of that metric.
+     */
+    typedef struct ProfileBody {
+        uint64_t phaseNanoseconds   [PROFILE_PHASE_COUNT];
+        uint64_t phaseCalls         [PROFILE_PHASE_COUNT];
+        uint64_t metricNanoseconds  [METRICS_COUNT_MAX];
+        uint64_t metricCalls        [METRICS_COUNT_MAX];
+    } Profile;
+
+    /**
+     * @brief Allocates an empty Profile if '--profile' is on.
+     * @return A pointer to the new Profile, or NULL if '--profile' is off.
+     */
+    Profile* new_profile(void);
+
+    /**
+     * @brief Submits a Profile and frees it.
+     * @param profile A pointer to the Profile, or NULL.
+     */
+    void free_profile(Profile* const profile);
+
+    /**
+     * @brief Reads the monotonic clock.
+     * @param profile A pointer to the Profile, or NULL.
+     * @return The current time in nanoseconds, or 0 if the Profile is NULL.
+     */
+    uint64_t start_profile(Profile const* const profile);
+
+    /**
+     * @brief Adds the time since start to a phase.
+     * @param profile A pointer to the Profile, or NULL.
+     * @param phase The phase, e.g., PROFILE_FILE_READ.
+     * @param start The return value of start_profile().
+     */
+    void stop_profile(Profile* const profile, unsigned const phase, uint64_t const start);
+
+    /**
+     * @brief Adds the time since start to the handlers of a metric.
+     * @param profile A pointer to the Profile, or NULL.
+     * @param metricId The index of the metric, see METRICS.
+     * @param start The return value of start_profile().
+     */
+    void stopMetric_profile(Profile* const profile, size_t const metricId, uint64_t const start);
+
+    /**
+     * @brief Adds a Profile to the process total and empties it.
+     *
+     * Thread-safe.
+     *
+     * @param profile A pointer to the Profile, or NULL.
+     */
+    void submit_profile(Profile* const profile);
+
+    /**
+     * @brief Starts the wall clock and writes the process total at exit.
+     *
+     * Writes JSON to options.profile_file, or CSV if its name ends with '.csv', or JSON to stderr if there is no
+     * options.profile_file.
+     */
+    void enable_profile(void);
+#endif
@@ -1,11 +1,12 @@
 /**
  * @file report.h
- * @brief Defines the reportCsv() function.
+ * @brief Defines the reportCsv() and reportNewRowsCsv() functions.
  * @author Yavuz Koroglu
  * @see report.c
  */
 #ifndef REPORT_H
     #define REPORT_H
+    #include "srcmetrics/analysis.h"
     #include "srcmetrics/metrics/abc.h"
     #include "srcmetrics/metrics/ams.h"
     #include "srcmetrics/metrics/cc.h"
@@ -15,18 +16,41 @@
     #include "srcmetrics/metrics/npm.h"
     #include "srcmetrics/metrics/rfu.h"
     #include "srcmetrics/metrics/sloc.h"
+    #include "srcmetrics/result.h"
 
-    typedef Map const*(*Report)(void);
+    typedef ResultTable const*(*Report)(Analysis const* const);
 
     /**
-     * @brief Calls all enabled metric Report functions.
+     * @brief Calls all enabled metric Report functions of an Analysis and closes the output.
+     *
+     * Rows already written by reportNewRowsCsv() are NOT written again. The rows go through the Writer of the
+     * Analysis, gzipped with '--gzip', see writer.h. With '--columnar', writes every row as a columnar report
+     * instead, see columnar.h.
+     *
+     * @param analysis A pointer to the Analysis.
      */
     #ifndef NDEBUG
     bool
     #else
     void
     #endif
-    reportCsv(void);
+    reportCsv(Analysis* const analysis);
+
+    /**
+     * @brief Writes the rows added since the last report and keeps the output open.
+     *
+     * Used in streaming mode to emit unit and function metrics as soon as their unit is processed, e.g., at the
+     * end of every unit if isReportingUnits. The Writer is flushed, so the output has every row so far, and the
+     * written rows are dropped, see flushRows_analysis(). Does nothing with '--columnar'.
+     *
+     * @param analysis A pointer to the Analysis.
+     */
+    #ifndef NDEBUG
+    bool
+    #else
+    void
+    #endif
+    reportNewRowsCsv(Analysis* const analysis);
 
     #define REPORTS {   \
         ABC_REPORT,     \
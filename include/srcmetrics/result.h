@@ -0,0 +1,102 @@
+/**
+ * @file result.h
+ * @brief Defines ResultTable, the rows of one metric in an Analysis.
+ * @author Yavuz Koroglu
+ * @see result.c
+ */
+#ifndef RESULT_H
+    #define RESULT_H
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include "padkit/chunk.h"
+    #include "padkit/map.h"
+
+    /* The entity of an overall row, e.g., "ABC-A" */
+    #define RESULT_OVERALL      0xFFFFFFFF
+
+    #define NOT_A_RESULT_TABLE ((ResultTable){ 0, 0, NULL })
+
+    /**
+     * @struct Result
+     * @brief One row of a report, e.g., "ABC-A_unit.c::fn()" with its value.
+     *
+     * The entity is the id of a unit or a function name in the strings of the Analysis, i.e., the ids of the
+     * events, or RESULT_OVERALL. The sub-metric indexes the SUBMETRICS of its metric, see metrics.h. The row
+     * name is only formatted when it is written, see nameOf_result().
+     */
+    typedef struct ResultBody {
+        uint32_t entity_id;
+        uint16_t metric_id;
+        uint16_t sub_id;
+        Value    value;
+    } Result;
+
+    /**
+     * @struct ResultTable
+     * @brief The rows of a metric in the order they are inserted.
+     */
+    typedef struct ResultTableBody {
+        uint32_t cap;
+        uint32_t size;
+        Result*  results;
+    } ResultTable;
+
+    /**
+     * @brief Constructs an empty ResultTable.
+     * @param table A pointer to the ResultTable.
+     * @param initial_cap The initial capacity.
+     * @return 0 if the allocation fails, 1 otherwise.
+     */
+    bool constructEmpty_rtable(ResultTable* const table, uint32_t const initial_cap);
+
+    /**
+     * @brief Removes every row of a ResultTable and keeps its memory.
+     * @param table A pointer to the ResultTable.
+     * @return 0 if the ResultTable is invalid, 1 otherwise.
+     */
+    bool flush_rtable(ResultTable* const table);
+
+    /**
+     * @brief Frees a ResultTable.
+     * @param table A pointer to the ResultTable.
+     * @return 0 if the ResultTable is invalid, 1 otherwise.
+     */
+    bool free_rtable(ResultTable* const table);
+
+    /**
+     * @brief Appends a row to a ResultTable.
+     * @param table A pointer to the ResultTable.
+     * @param entity_id The string id of the unit or the function, or RESULT_OVERALL.
+     * @param metric_id The index of the metric, see metrics.h.
+     * @param sub_id The index of the sub-metric, see SUBMETRICS.
+     * @param value The value.
+     * @return 0 if the allocation fails, 1 otherwise.
+     */
+    bool insert_rtable(
+        ResultTable* const  table,
+        uint32_t const      entity_id,
+        uint16_t const      metric_id,
+        uint16_t const      sub_id,
+        Value const         value
+    );
+
+    /**
+     * @brief Checks if a ResultTable is valid.
+     * @param table A pointer to the ResultTable.
+     */
+    bool isValid_rtable(ResultTable const* const table);
+
+    /**
+     * @brief Returns the sub-metric name of a row, e.g., "ABC-A".
+     * @param result A pointer to the Result.
+     */
+    char const* nameOf_result(Result const* const result);
+
+    /**
+     * @brief Returns the entity name of a row, e.g., "unit.c::fn()".
+     * @param result A pointer to the Result.
+     * @param strings The strings of the Analysis that has the row.
+     * @return NULL for an overall row, the entity name otherwise.
+     */
+    char const* entityOf_result(Result const* const result, Chunk const* const strings);
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file server.h
+ * @brief Defines Server, the long-lived JSON-RPC mode of '--server'.
+ * @author Yavuz Koroglu
+ * @see server.c
+ */
+#ifndef SERVER_H
+    #define SERVER_H
+    #include <stdbool.h>
+    #include <stddef.h>
+    #include <stdint.h>
+    #include <stdio.h>
+    #include "libsrcml/srcml.h"
+    #include "srcmetrics/analysis.h"
+    #include "srcmetrics/profile.h"
+    #include "srcmetrics/source.h"
+    #include "padkit/chunkset.h"
+
+    #define SERVER_RECOMMENDED_INITIAL_CAP  UNIT_COUNT_GUESS
+
+    #define SERVER_ERROR_PARSE              -32700
+    #define SERVER_ERROR_INVALID_REQUEST    -32600
+    #define SERVER_ERROR_METHOD_NOT_FOUND   -32601
+    #define SERVER_ERROR_INVALID_PARAMS     -32602
+    #define SERVER_ERROR_INTERNAL           -32603
+    #define SERVER_ERROR_FILE_NOT_FOUND     -32001
+
+    /**
+     * @struct ServerUnit
+     * @brief A source file the Server tracks, and the partial Analysis and the bytes of its last version.
+     */
+    typedef struct ServerUnitBody {
+        uint32_t  infile_id;
+        uint64_t  len;
+        Analysis* partial;
+    } ServerUnit;
+
+    /**
+     * @struct Server
+     * @brief Keeps the partial Analysis of every tracked source file in memory between requests.
+     *
+     * A change re-evaluates the partial Analysis of one file, and nothing else. The tables of the partial are
+     * sized for that file, and once it is evaluated, only its rows and counters stay, see trim_analysis().
+     * A report merges the partials into a fresh Analysis, so the cross-unit metrics, e.g., RFU and the
+     * overall ABC and HSM, reflect every change without parsing the unchanged files again, see
+     * merge_analysis(). A merge cannot take one file back out, because the overall HSM counts the distinct
+     * operators of every file and RFU closes the call graph of every file, so the report is kept instead. It
+     * is merged again only if a file changed since the last report, and the fresh Analysis is sized for the
+     * bytes of the tracked files.
+     *
+     * The units merge from the last tracked file to the first, i.e., in the order of the serial loop. A new
+     * file goes after the tracked ones.
+     */
+    typedef struct ServerBody {
+        ChunkSet              infiles[1];
+        size_t                n_units;
+        size_t                cap_units;
+        ServerUnit*           units;
+        struct srcml_archive* archive;
+        Source                source[1];
+        Profile*              profile;
+        Chunk                 report[1];
+        bool                  isReportStale;
+        bool                  isShutdown;
+    } Server;
+
+    /**
+     * @brief Constructs an empty Server, see update_server().
+     * @param server A pointer to the Server.
+     */
+    void constructEmpty_server(Server* const server);
+
+    /**
+     * @brief Frees a Server and the partial Analysis of every tracked file.
+     * @param server A pointer to the Server.
+     */
+    void free_server(Server* const server);
+
+    /**
+     * @brief Checks if a Server is valid.
+     * @param server A pointer to the Server.
+     */
+    bool isValid_server(Server const* const server);
+
+    /**
+     * @brief Evaluates the current version of a source file, and tracks it if it is new.
+     * @param server A pointer to the Server.
+     * @param infile The source file name.
+     * @return 0 if the file cannot be opened, 1 otherwise.
+     */
+    bool update_server(Server* const server, char const* const infile);
+
+    /**
+     * @brief Stops tracking a source file.
+     * @param server A pointer to the Server.
+     * @param infile The source file name.
+     * @return 0 if the file is NOT tracked, 1 otherwise.
+     */
+    bool remove_server(Server* const server, char const* const infile);
+
+    /**
+     * @brief Merges every tracked file and writes the CSV report, see serve_server() for the cached one.
+     * @param server A pointer to the Server.
+     * @param output The stream to write the report to.
+     * @return 0 if a write fails, 1 otherwise.
+     */
+    bool report_server(Server* const server, FILE* const output);
+
+    /**
+     * @brief Answers newline-delimited JSON-RPC 2.0 requests until a shutdown request or the end of the input.
+     *
+     * The methods are:
+     *   didChange {"file": FILE}  re-evaluates FILE, tracking it if it is new,
+     *   didDelete {"file": FILE}  stops tracking FILE,
+     *   report                    returns the CSV report of the tracked files as a string, the same one
+     *                             until a file changes,
+     *   shutdown                  stops the Server.
+     *
+     * A request without an id is a notification, and gets no response.
+     *
+     * @param server A pointer to the Server.
+     * @param input The stream of requests, e.g., stdin.
+     * @param output The stream of responses, e.g., stdout.
+     */
+    void serve_server(Server* const server, FILE* const input, FILE* const output);
+#endif
@@ -0,0 +1,77 @@
+/**
+ * @file sizing.h
+ * @brief Defines Sizing, the initial capacities of the metric tables for the input at hand.
+ * @author Yavuz Koroglu
+ * @see sizing.c
+ */
+#ifndef SIZING_H
+    #define SIZING_H
+    #include <stdbool.h>
+    #include <stddef.h>
+    #include <stdint.h>
+
+    /* A function and a statement take about this many bytes of source code */
+    #define SIZING_BYTES_PER_FN     512
+    #define SIZING_BYTES_PER_STMT   32
+
+    /* No table starts smaller, every table grows geometrically anyway */
+    #define SIZING_COUNT_MIN        16
+
+    /**
+     * @struct Sizing
+     * @brief The initial capacities of the tables of an Analysis.
+     *
+     * The capacities are guessed from the input bytes, never above the compile-time guesses, e.g.,
+     * FN_COUNT_GUESS, so a small input does NOT reserve, or page in, the memory of a large one.
+     */
+    typedef struct SizingBody {
+        uint32_t unit_count;
+        uint32_t fn_count;
+        uint32_t entry_count;
+        uint32_t stmt_count;
+        uint32_t text_len;
+    } Sizing;
+
+    /**
+     * @brief Accounts for a table that grows, shrinks, or goes away, and enforces '--memory-budget'.
+     *
+     * The arenas, the result tables, and the edges of CParse report their allocations here, so their total
+     * is known across the threads. If a growth takes the total past the budget, prints an error and exits
+     * with failure, instead of swapping or being killed. Without a budget, does nothing.
+     *
+     * @param old_bytes The bytes of the table before.
+     * @param new_bytes The bytes of the table after, 0 if it is freed.
+     */
+    void charge_sizing(uint64_t const old_bytes, uint64_t const new_bytes);
+
+    /**
+     * @brief Returns the Sizing of an Analysis.
+     *
+     * Without prepare_sizing(), the Sizing is the compile-time guesses. The server sizes every unit from its
+     * own file instead, see prepareUnit_sizing().
+     *
+     * @param isPartial 1 for a partial Analysis, which evaluates one unit at a time, 0 otherwise.
+     */
+    Sizing const* get_sizing(bool const isPartial);
+
+    /**
+     * @brief Guesses the Sizing of one unit from the bytes of its source file, e.g., in the server.
+     *
+     * Only for a partial Analysis that is NOT evaluated yet, or trimmed, see trim_analysis(). It changes the
+     * Sizing of every partial Analysis, so it must NOT be called while another thread evaluates a unit.
+     *
+     * @param unit_bytes The bytes of the source file.
+     */
+    void prepareUnit_sizing(uint64_t const unit_bytes);
+
+    /**
+     * @brief Guesses the Sizing of the whole input and of one unit.
+     *
+     * With '--memory-budget', the guess assumes at most that many input bytes, so the initial tables fit in
+     * the budget.
+     *
+     * @param input_bytes The total bytes of the infiles, see getInputBytes_walk().
+     * @param n_infiles The number of infiles.
+     */
+    void prepare_sizing(uint64_t const input_bytes, size_t const n_infiles);
+#endif
@@ -0,0 +1,76 @@
+/**
+ * @file source.h
+ * @brief Defines Source, the contents of one source file as the srcML parser reads them.
+ * @author Yavuz Koroglu
+ * @see source.c
+ */
+#ifndef SOURCE_H
+    #define SOURCE_H
+    #include <stdbool.h>
+    #include <stddef.h>
+    #include <stdint.h>
+    #include "padkit/chunk.h"
+
+    /* Smaller files are read into the buffer, a mapping costs more than copying them */
+    #define SOURCE_MMAP_THRESHOLD   65536
+
+    /**
+     * @struct Source
+     * @brief A read-only view of a source file, either memory-mapped or read into a reusable buffer.
+     *
+     * A large file is mapped, so srcml_unit_parse_memory() reads it straight from the page cache without a
+     * copy. A small file, an empty file, or a file that cannot be mapped is read into the buffer, which keeps
+     * its memory between files. Either way, start and len are the contents, which are NOT null-terminated.
+     *
+     * A member of a tar archive is the byte range of its contents in the archive, so it is mapped or read
+     * the same way, see walk.h.
+     *
+     * A mapped file must NOT shrink until release_source(), or reading past its new end raises SIGBUS. So
+     * nothing is mapped while serving, see isServing(), because an editor truncates the files it saves.
+     */
+    typedef struct SourceBody {
+        char const* start;
+        uint64_t    len;
+        void*       map;
+        size_t      map_len;
+        Chunk       buffer[1];
+    } Source;
+
+    /**
+     * @brief Constructs an empty Source.
+     * @param source A pointer to the Source.
+     */
+    void constructEmpty_source(Source* const source);
+
+    /**
+     * @brief Checks if read_source() can open a source file or a tar member.
+     * @param infile The source file name.
+     */
+    bool exists_source(char const* const infile);
+
+    /**
+     * @brief Releases the contents and frees the buffer of a Source.
+     * @param source A pointer to the Source.
+     */
+    void free_source(Source* const source);
+
+    /**
+     * @brief Checks if a Source is valid.
+     * @param source A pointer to the Source.
+     */
+    bool isValid_source(Source const* const source);
+
+    /**
+     * @brief Maps or reads a source file or a tar member into a released Source.
+     * @param source A pointer to the Source.
+     * @param infile The source file name.
+     * @return 0 if the file cannot be opened or the member cannot be read, 1 otherwise.
+     */
+    bool read_source(Source* const source, char const* const infile);
+
+    /**
+     * @brief Unmaps the file of a Source, or flushes its buffer, so it can read the next file.
+     * @param source A pointer to the Source.
+     */
+    void release_source(Source* const source);
+#endif
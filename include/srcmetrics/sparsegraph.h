@@ -0,0 +1,116 @@
+/**
+ * @file sparsegraph.h
+ * @brief Defines SparseGraph, a directed graph of adjacency lists.
+ * @author Yavuz Koroglu
+ * @see sparsegraph.c
+ */
+#ifndef SPARSEGRAPH_H
+    #define SPARSEGRAPH_H
+    #include <stdbool.h>
+    #include <stdint.h>
+
+    #define SPARSE_GRAPH_RECOMMENDED_INITIAL_DEGREE_CAP 4
+
+    #define NOT_A_SPARSE_GRAPH ((SparseGraph){ 0, 0, NULL })
+
+    /**
+     * @struct SparseVertex
+     * @brief The sinks of one vertex, sorted and unique.
+     */
+    typedef struct SparseVertexBody {
+        uint32_t* sinks;
+        uint32_t  degree;
+        uint32_t  cap;
+    } SparseVertex;
+
+    /**
+     * @struct SparseGraph
+     * @brief A directed graph that only stores its edges.
+     *
+     * Unlike a GraphMatrix, the memory grows with the edges instead of the square of the vertices, and
+     * iterating the sinks of a vertex costs its out-degree instead of a whole row. The graph can be queried
+     * while it grows, e.g., the call graph of RFU. A vertex gets its sink list with its first edge.
+     */
+    typedef struct SparseGraphBody {
+        uint32_t      vertex_count;
+        uint32_t      vertex_cap;
+        SparseVertex* vertices;
+    } SparseGraph;
+
+    /**
+     * @brief Connects a source to a sink, if they are NOT connected yet.
+     * @param graph A pointer to the SparseGraph.
+     * @param source The source vertex.
+     * @param sink The sink vertex.
+     * @return 0 if the allocation fails, 1 otherwise.
+     */
+    bool connect_sgraph(SparseGraph* const graph, uint32_t const source, uint32_t const sink);
+
+    /**
+     * @brief Finds the strongly connected components of a SparseGraph with Tarjan's algorithm.
+     *
+     * Uses an explicit stack instead of recursion, so deep call chains cannot overflow the thread stack.
+     * The components are numbered in reverse topological order, i.e., every edge goes from a component to
+     * itself or to a component with a smaller number.
+     *
+     * @param graph A pointer to the SparseGraph.
+     * @param vertex_count The number of vertices, every sink must be less than this.
+     * @param component The component of every vertex, an array of vertex_count elements.
+     * @return The number of components.
+     */
+    uint32_t condense_sgraph(SparseGraph const* const graph, uint32_t const vertex_count, uint32_t* const component);
+
+    /**
+     * @brief Constructs an empty SparseGraph.
+     * @param graph A pointer to the SparseGraph.
+     * @param vertex_cap The number of vertices to allocate for, the graph grows if necessary.
+     * @return 0 if the allocation fails, 1 otherwise.
+     */
+    bool constructEmpty_sgraph(SparseGraph* const graph, uint32_t const vertex_cap);
+
+    /**
+     * @brief Removes every edge of a SparseGraph, but keeps its memory.
+     * @param graph A pointer to the SparseGraph.
+     * @return 0 if the graph is invalid, 1 otherwise.
+     */
+    bool disconnectAll_sgraph(SparseGraph* const graph);
+
+    /**
+     * @brief Frees a SparseGraph.
+     * @param graph A pointer to the SparseGraph.
+     * @return 0 if the graph is invalid, 1 otherwise.
+     */
+    bool free_sgraph(SparseGraph* const graph);
+
+    /**
+     * @brief Checks if a source is connected to a sink, in O(log out-degree).
+     * @param graph A pointer to the SparseGraph.
+     * @param source The source vertex.
+     * @param sink The sink vertex.
+     */
+    bool isConnected_sgraph(SparseGraph const* const graph, uint32_t const source, uint32_t const sink);
+
+    /**
+     * @brief Checks if a SparseGraph is valid.
+     * @param graph A pointer to the SparseGraph.
+     */
+    bool isValid_sgraph(SparseGraph const* const graph);
+
+    /**
+     * @brief Counts the sinks of a vertex.
+     * @param graph A pointer to the SparseGraph.
+     * @param source The source vertex.
+     */
+    uint32_t outDegree_sgraph(SparseGraph const* const graph, uint32_t const source);
+
+    /**
+     * @brief Gets the sinks of a vertex in ascending order, see outDegree_sgraph().
+     *
+     * The array is valid until the next connect_sgraph() on the same graph.
+     *
+     * @param graph A pointer to the SparseGraph.
+     * @param source The source vertex.
+     * @return The sinks, or NULL if there are none.
+     */
+    uint32_t const* sinks_sgraph(SparseGraph const* const graph, uint32_t const source);
+#endif
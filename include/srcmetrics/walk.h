@@ -0,0 +1,84 @@
+/**
+ * @file walk.h
+ * @brief Defines the discovery of source files in directories and tar archives.
+ * @author Yavuz Koroglu
+ * @see walk.c
+ */
+#ifndef WALK_H
+    #define WALK_H
+    #include <stdbool.h>
+    #include <stddef.h>
+    #include <stdint.h>
+
+    #define WALK_DEFAULT_INCLUDES   { "*.c", "*.h" }
+
+    #define WALK_TAR_EXTENSION      ".tar"
+
+    #define WALK_TAR_BLOCK_SIZE     512
+
+    /* A file in a directory is NOT stat'ed, so it counts as this many bytes, see getInputBytes_walk() */
+    #define WALK_FILE_LEN_GUESS     16384
+
+    /**
+     * @struct TarMember
+     * @brief Where the contents of a regular file are in a tar archive.
+     *
+     * A tar archive stores every file as is, so a member is a byte range of the archive, see read_source().
+     */
+    typedef struct TarMemberBody {
+        uint32_t archive_id;
+        uint64_t offset;
+        uint64_t len;
+    } TarMember;
+
+    /**
+     * @brief Adds a glob pattern that selects the files of the directories and the tar archives.
+     *
+     * A pattern with a '/' matches the whole path, any other pattern matches the last component of the path,
+     * see fnmatch(3). An excluded directory is NOT walked at all. Without an include pattern, the default ones
+     * are '*.c' and '*.h'. The infiles on the command line are always evaluated.
+     *
+     * @param pattern The glob pattern, which must outlive the walk.
+     * @param isExcluded 1 for '--exclude-files', 0 for '--include-files'.
+     */
+    void addPattern_walk(char const* const pattern, bool const isExcluded);
+
+    /**
+     * @brief Replaces every directory and tar archive in a list of infiles with the source files in it.
+     *
+     * The infiles are classified with one stat(2) each, on up to n_jobs threads. A directory is walked
+     * recursively in the order of strcmp(3), without following the symbolic links to directories, and the
+     * directory entry types save the stat(2) of every file. A member of a tar archive is named as
+     * ARCHIVE/MEMBER. The list does NOT change if no infile is a directory or a tar archive.
+     *
+     * Terminates the program if a directory cannot be opened or a tar archive is corrupt.
+     *
+     * @param infiles A pointer to the malloc'ed infiles array.
+     * @param n_infiles A pointer to the number of infiles.
+     * @param cap_infiles A pointer to the capacity of the infiles array.
+     * @param n_jobs The number of threads to classify the infiles with.
+     */
+    void expand_walk(char const*** const infiles, size_t* const n_infiles, size_t* const cap_infiles, uint32_t const n_jobs);
+
+    /**
+     * @brief Finds an infile among the tar members of expand_walk().
+     * @param infile The infile name.
+     * @param archive A pointer to the tar archive name.
+     * @param member A pointer to the TarMember.
+     * @return 1 if the infile is a tar member, 0 otherwise.
+     */
+    bool findMember_walk(char const* const infile, char const** const archive, TarMember* const member);
+
+    /**
+     * @brief Frees the names and the patterns of the walk.
+     */
+    void free_walk(void);
+
+    /**
+     * @brief Returns the total bytes of the infiles of expand_walk(), a guess for the files in directories.
+     *
+     * An infile and a tar member have their exact size, but a file in a directory is NOT stat'ed, so it counts
+     * as WALK_FILE_LEN_GUESS bytes. A missing infile counts as 0 bytes.
+     */
+    uint64_t getInputBytes_walk(void);
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @file writer.h
+ * @brief Defines Writer, the buffered output of the CSV report.
+ * @author Yavuz Koroglu
+ * @see writer.c
+ */
+#ifndef WRITER_H
+    #define WRITER_H
+    #include <stdbool.h>
+    #include <stddef.h>
+    #include <stdio.h>
+    #include "srcmetrics/result.h"
+
+    /* Most reports fit in one buffer, so they are written with one system call */
+    #define WRITER_BUFFER_SIZE      65536
+
+    /* The most bytes a value takes, e.g., "-2147483648" or a float with VAL_F_FLOAT */
+    #define WRITER_VALUE_LEN_MAX    64
+
+    struct z_stream_s;
+
+    /**
+     * @struct Writer
+     * @brief Formats a report into a buffer and writes the buffer straight to the file descriptor of a stream.
+     *
+     * Values are formatted by hand instead of fprintf(), and the bytes are the same as VAL_F_FLOAT, VAL_F_INT,
+     * and VAL_F_UNSIGNED give. A format the Writer does NOT know is left to snprintf(). The stream is flushed
+     * once when the Writer opens, so it can still be used before and after the Writer, e.g., by the server.
+     *
+     * With '--gzip', the buffer goes through zlib and the stream gets a gzip file instead.
+     *
+     * An error sticks until the Writer closes, like ferror(), so the writes do NOT check it one by one.
+     */
+    typedef struct WriterBody {
+        FILE*               stream;
+        char*               buffer;
+        size_t              len;
+        struct z_stream_s*  gzip;
+        char*               compressed;
+        int                 float_digits;
+        bool                isPlainInt;
+        bool                isPlainUnsigned;
+        bool                hasFailed;
+    } Writer;
+
+    /**
+     * @brief Writes the rest of a Writer, frees its buffers, and leaves its stream open.
+     * @param writer A pointer to the Writer.
+     * @return 0 if any write failed, 1 otherwise.
+     */
+    bool close_writer(Writer* const writer);
+
+    /**
+     * @brief Writes the buffer of a Writer, so the stream has every byte so far.
+     * @param writer A pointer to the Writer.
+     * @return 0 if any write failed, 1 otherwise.
+     */
+    bool flush_writer(Writer* const writer);
+
+    /**
+     * @brief Checks if a Writer is open.
+     * @param writer A pointer to the Writer.
+     */
+    bool isOpen_writer(Writer const* const writer);
+
+    /**
+     * @brief Opens a Writer on a stream.
+     * @param writer A pointer to the Writer.
+     * @param stream The stream.
+     * @param isCompressing Writes a gzip file if 1.
+     * @return 0 if the buffers cannot be allocated, 1 otherwise.
+     */
+    bool open_writer(Writer* const writer, FILE* const stream, bool const isCompressing);
+
+    /**
+     * @brief Writes bytes to a Writer.
+     * @param writer A pointer to the Writer.
+     * @param bytes The bytes.
+     * @param len The number of bytes.
+     */
+    void write_writer(Writer* const writer, char const* const bytes, size_t const len);
+
+    /**
+     * @brief Writes a null-terminated string to a Writer.
+     * @param writer A pointer to the Writer.
+     * @param str The string.
+     */
+    void writeString_writer(Writer* const writer, char const* const str);
+
+    /**
+     * @brief Writes a Value to a Writer, or "NOT_A_VALUE" for an unknown type.
+     * @param writer A pointer to the Writer.
+     * @param value The Value.
+     */
+    void writeValue_writer(Writer* const writer, Value const value);
+#endif
@@ -1,15 +1,29 @@
 #include <stdarg.h>
 #include <stdlib.h>
+#include <string.h>
 #include "languages/c.h"
 #include "srcmetrics.h"
+#include "srcmetrics/sizing.h"
 #include "padkit/debug.h"
 #include "padkit/reallocate.h"
 #include "padkit/repeat.h"
-#include "padkit/streq.h"
 #include "padkit/timestamp.h"
 
+/* An edge is its source, its target, and its kind */
+#define EDGE_BYTES  (2 * sizeof(uint32_t) + sizeof(uint8_t))
+
 static char const* element_tags[] = C_ELEMENT_TAGS;
 
+static int compareEdges(void const* const a, void const* const b) {
+    SortedEdge const* const x = a;
+    SortedEdge const* const y = b;
+
+    if (x->source != y->source) return x->source < y->source ? -1 : 1;
+    if (x->target != y->target) return x->target < y->target ? -1 : 1;
+    if (x->kind != y->kind)     return x->kind < y->kind ? -1 : 1;
+    return 0;
+}
+
 static uint32_t interpret_cparse(CParse* const cparse, uint8_t const interpretation) {
     static char const* const c_interpretation_names[] = C_INTERPRETATION_NAMES;
 
@@ -76,21 +90,237 @@ static void pushStack_cparse(
     cparse->stack[stack_id][cparse->stack_size[stack_id]++] = element;
 }
 
-static void start_stmt_cparse(CParse* const cparse) {
+static void index_cparse(
+    CParse* const cparse, unsigned const index_id, uint32_t const offset
+) {
     DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(index_id > CPARSE_INDEX_LAST)
 
-    if (peekStack_cparse(cparse, CPARSE_STACK_ELEMENTS) == C_BLOCK_CONTENT)
-        return;
+    REALLOC_IF_NECESSARY(
+        uint32_t, cparse->index[index_id],
+        uint32_t, cparse->index_cap[index_id], cparse->index_size[index_id],
+        {REALLOC_ERROR;}
+    )
 
-    parse_cparse(cparse, "", 0, C_STMT);
+    cparse->index[index_id][cparse->index_size[index_id]++] = offset;
 }
-static void start_block_content_cparse(CParse* const cparse) {
+
+/* The offset where a function starts, or the total after the last function */
+static uint32_t offsetOfFn_cparse(
+    CParse const* const cparse, unsigned const index_id, uint32_t const fn_id
+) {
+    DEBUG_ERROR_IF(index_id > CPARSE_TOTAL_LAST)
+    DEBUG_ERROR_IF(fn_id > getFnCount_cparse(cparse))
+
+    if (fn_id == getFnCount_cparse(cparse)) return cparse->total[index_id];
+    return cparse->index[index_id][fn_id];
+}
+
+/* The function after the last function of a unit */
+static uint32_t endFnOfUnit_cparse(CParse const* const cparse, uint32_t const unit_id) {
+    DEBUG_ERROR_IF(unit_id >= getUnitCount_cparse(cparse))
+
+    if (unit_id + 1 == getUnitCount_cparse(cparse)) return getFnCount_cparse(cparse);
+    return cparse->index[CPARSE_INDEX_UNIT_FNS][unit_id + 1];
+}
+
+/* Sorts the edges of the last function, drops the duplicates, and moves the total */
+static void sortEdges_cparse(CParse* const cparse) {
+    DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(getFnCount_cparse(cparse) == 0)
+
+    uint32_t const first_edge = cparse->index[CPARSE_INDEX_FN_EDGES][getFnCount_cparse(cparse) - 1];
+    uint32_t const n_edges    = cparse->total[CPARSE_INDEX_FN_EDGES] - first_edge;
+    if (n_edges == 0) return;
+
+    /* The scratch edges are kept for the next function, and grow with the largest one */
+    if (n_edges > cparse->sorted_cap) {
+        uint32_t new_cap = cparse->sorted_cap > 0 ? cparse->sorted_cap : n_edges;
+        while (new_cap < n_edges) new_cap <<= 1;
+
+        SortedEdge* const sorted_edges = realloc(cparse->sorted_edges, (size_t)new_cap * sizeof(SortedEdge));
+        if (sorted_edges == NULL) {REALLOC_ERROR;}
+
+        cparse->sorted_edges = sorted_edges;
+        cparse->sorted_cap   = new_cap;
+    }
+
+    SortedEdge* const edges = cparse->sorted_edges;
+    for (uint32_t i = 0; i < n_edges; i++) {
+        edges[i].source = cparse->edge_sources[first_edge + i];
+        edges[i].target = cparse->edge_targets[first_edge + i];
+        edges[i].kind   = cparse->edge_kinds[first_edge + i];
+    }
+
+    qsort(edges, n_edges, sizeof(SortedEdge), compareEdges);
+
+    uint32_t kept = first_edge;
+    for (uint32_t i = 0; i < n_edges; i++) {
+        if (i > 0 && compareEdges(edges + i - 1, edges + i) == 0) continue;
+
+        cparse->edge_sources[kept] = edges[i].source;
+        cparse->edge_targets[kept] = edges[i].target;
+        cparse->edge_kinds[kept]   = (uint8_t)edges[i].kind;
+        kept++;
+    }
+    cparse->total[CPARSE_INDEX_FN_EDGES] = kept;
+}
+
+static bool isInFnBody_cparse(CParse const* const cparse) {
+    return cparse->tracked_id[CPARSE_CURRENT_FN_FIRST_STMT] != 0xFFFFFFFF;
+}
+
+static void edge_cparse(
+    CParse* const cparse, uint32_t const from, uint32_t const to, uint32_t const edge_kind
+) {
     DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(from == 0xFFFFFFFF)
+    DEBUG_ERROR_IF(to == 0xFFFFFFFF)
+    DEBUG_ERROR_IF(edge_kind > CPARSE_EDGE_CASE)
+
+    uint32_t const edge_id = cparse->total[CPARSE_INDEX_FN_EDGES];
+    if (edge_id >= cparse->edges_cap) {
+        DEBUG_ERROR_IF(cparse->edges_cap > 0x7FFFFFFF)
+        uint32_t const new_cap = cparse->edges_cap << 1;
+        charge_sizing((uint64_t)cparse->edges_cap * EDGE_BYTES, (uint64_t)new_cap * EDGE_BYTES);
 
-    parse_cparse(cparse, "", 0, C_SPURIOUS);
+        uint32_t* const sources = realloc(cparse->edge_sources, (size_t)new_cap * sizeof(uint32_t));
+        if (sources == NULL) {REALLOC_ERROR;}
+        cparse->edge_sources = sources;
 
-    uint32_t const currentStmt_id = CPARSE_LAST_CHUNK_ID;
-    DEBUG_ERROR_IF(currentStmt_id == 0xFFFFFFFF)
+        uint32_t* const targets = realloc(cparse->edge_targets, (size_t)new_cap * sizeof(uint32_t));
+        if (targets == NULL) {REALLOC_ERROR;}
+        cparse->edge_targets = targets;
+
+        uint8_t* const kinds = realloc(cparse->edge_kinds, (size_t)new_cap);
+        if (kinds == NULL) {REALLOC_ERROR;}
+        cparse->edge_kinds = kinds;
+
+        cparse->edges_cap = new_cap;
+    }
+
+    cparse->edge_sources[edge_id] = from;
+    cparse->edge_targets[edge_id] = to;
+    cparse->edge_kinds[edge_id]   = (uint8_t)edge_kind;
+
+    cparse->total[CPARSE_INDEX_FN_EDGES]++;
+}
+
+/* The incoming stack has (kind, statement) pairs, the kind is how the statement goes to the next one */
+static void pushIncoming_cparse(CParse* const cparse, uint32_t const stmt_id, uint32_t const edge_kind) {
+    DEBUG_ASSERT(isValid_cparse(cparse))
+
+    pushStack_cparse(cparse, CPARSE_STACK_INCOMING, edge_kind);
+    pushStack_cparse(cparse, CPARSE_STACK_INCOMING, stmt_id);
+}
+
+/* Connects every incoming statement to a statement, and empties the incoming stack */
+static void connectIncoming_cparse(CParse* const cparse, uint32_t const stmt_id) {
+    DEBUG_ASSERT(isValid_cparse(cparse))
+
+    while (cparse->stack_size[CPARSE_STACK_INCOMING] > 1) {
+        uint32_t const from      = popStack_cparse(cparse, CPARSE_STACK_INCOMING);
+        uint32_t const edge_kind = popStack_cparse(cparse, CPARSE_STACK_INCOMING);
+        edge_cparse(cparse, from, stmt_id, edge_kind);
+    }
+}
+
+/* Moves the top of a stack, starting at an index, onto another stack */
+static void moveStack_cparse(
+    CParse* const cparse, unsigned const from_id, uint32_t const start, unsigned const to_id
+) {
+    DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(from_id == to_id)
+    DEBUG_ERROR_IF(start > cparse->stack_size[from_id])
+
+    for (uint32_t i = start; i < cparse->stack_size[from_id]; i++)
+        pushStack_cparse(cparse, to_id, cparse->stack[from_id][i]);
+
+    cparse->stack_size[from_id] = start;
+}
+
+/* Adds a statement, every statement that may run right before it has an edge to it */
+static uint32_t node_cparse(CParse* const cparse, uint8_t const interpretation) {
+    DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(!isInFnBody_cparse(cparse))
+
+    parse_cparse(cparse, "", 0, interpretation);
+
+    uint32_t const stmt_id = CPARSE_LAST_CHUNK_ID;
+    DEBUG_ERROR_IF(stmt_id == 0xFFFFFFFF)
+
+    connectIncoming_cparse(cparse, stmt_id);
+    pushIncoming_cparse(cparse, stmt_id, CPARSE_EDGE_NEXT);
+    cparse->total[CPARSE_INDEX_FN_STMTS]++;
+
+    return stmt_id;
+}
+
+/* Adds a statement that never falls through, e.g., break */
+static void jump_cparse(CParse* const cparse, uint32_t const jump_kind) {
+    DEBUG_ASSERT(isValid_cparse(cparse))
+
+    if (!isInFnBody_cparse(cparse)) return;
+    if (peekStack_cparse(cparse, CPARSE_STACK_ELEMENTS) != C_BLOCK_CONTENT) return;
+
+    uint32_t const stmt_id = node_cparse(cparse, C_STMT);
+    cparse->stack_size[CPARSE_STACK_INCOMING] = 0;
+
+    pushStack_cparse(cparse, CPARSE_STACK_JUMPS, jump_kind);
+    pushStack_cparse(cparse, CPARSE_STACK_JUMPS, stmt_id);
+}
+
+/*
+ * Resolves the jumps of a loop or a switch. The breaks fall through to the next statement, the continues go to the
+ * head of the loop, and the other jumps wait for an outer loop or the end of the function.
+ *
+ * Returns 1 if the switch has a default case.
+ */
+static bool resolveJumps_cparse(CParse* const cparse, uint32_t const start, uint32_t const loop_head) {
+    DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(start > cparse->stack_size[CPARSE_STACK_JUMPS])
+
+    bool hasDefault = 0;
+    uint32_t kept   = start;
+    for (uint32_t i = start; i + 1 < cparse->stack_size[CPARSE_STACK_JUMPS]; i += 2) {
+        uint32_t const jump_kind = cparse->stack[CPARSE_STACK_JUMPS][i];
+        uint32_t const stmt_id   = cparse->stack[CPARSE_STACK_JUMPS][i + 1];
+        switch (jump_kind) {
+            case CPARSE_JUMP_BREAK:
+                pushIncoming_cparse(cparse, stmt_id, CPARSE_EDGE_JUMP);
+                continue;
+            case CPARSE_JUMP_DEFAULT:
+                hasDefault = 1;
+                continue;
+            case CPARSE_JUMP_CONTINUE:
+                if (loop_head == 0xFFFFFFFF) break;
+                edge_cparse(cparse, stmt_id, loop_head, CPARSE_EDGE_BACK);
+                continue;
+        }
+        cparse->stack[CPARSE_STACK_JUMPS][kept++] = jump_kind;
+        cparse->stack[CPARSE_STACK_JUMPS][kept++] = stmt_id;
+    }
+    cparse->stack_size[CPARSE_STACK_JUMPS] = kept;
+
+    return hasDefault;
+}
+
+static void start_stmt_cparse(CParse* const cparse) {
+    DEBUG_ASSERT(isValid_cparse(cparse))
+
+    if (!isInFnBody_cparse(cparse)) return;
+    if (peekStack_cparse(cparse, CPARSE_STACK_ELEMENTS) != C_BLOCK_CONTENT) return;
+
+    node_cparse(cparse, C_STMT);
+}
+static void start_loop_cparse(CParse* const cparse, uint32_t const loop_head) {
+    DEBUG_ASSERT(isValid_cparse(cparse))
+
+    pushStack_cparse(cparse, CPARSE_STACK_LOOPS, cparse->stack_size[CPARSE_STACK_JUMPS]);
+    pushStack_cparse(cparse, CPARSE_STACK_HEADS, loop_head);
+}
+static void start_block_content_cparse(CParse* const cparse) {
+    DEBUG_ASSERT(isValid_cparse(cparse))
 
     switch (peekStack_cparse(cparse, CPARSE_STACK_ELEMENTS)) {
         case C_FUNCTION:
@@ -98,59 +328,84 @@ static void start_block_content_cparse(CParse* const cparse) {
                 VERBOSE_MSG_LITERAL("CPARSE_DANGLING_CONTROL_FLOW_FROM_PREVIOUS_FN");
                 TERMINATE_ERROR;
             }
-            if (cparse->tracked_id[CPARSE_CURRENT_FN_FIRST_STMT] != 0xFFFFFFFF) {
+            if (isInFnBody_cparse(cparse)) {
                 VERBOSE_MSG_LITERAL("CPARSE_NESTED_FUNCTION");
                 TERMINATE_ERROR;
             }
-            cparse->tracked_id[CPARSE_CURRENT_FN_FIRST_STMT] = currentStmt_id;
+            /* The first statement is the next chunk */
+            cparse->tracked_id[CPARSE_CURRENT_FN_FIRST_STMT] = cparse->chunks[CPARSE_CHUNK_PARSE].nStrings;
     }
 
-    uint32_t const incomingStmt_id = popStack_cparse(cparse, CPARSE_STACK_INCOMING);
-    if (incomingStmt_id != 0xFFFFFFFF) {
-        Map* const edges = cparse->maps + CPARSE_MAP_EDGES;
-        DEBUG_ASSERT_NDEBUG_EXECUTE(
-            insert_map(edges, incomingStmt_id, VAL_UNSIGNED(currentStmt_id))
-        )
-    }
-
-    pushStack_cparse(cparse, CPARSE_STACK_INCOMING, currentStmt_id);
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_BLOCK_CONTENT);
 }
 static void start_break_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
-    if (peekStack_cparse(cparse, CPARSE_STACK_ELEMENTS) != C_BLOCK_CONTENT)
-        return;
-
-    parse_cparse(cparse, "", 0, C_SPURIOUS);
+    jump_cparse(cparse, CPARSE_JUMP_BREAK);
 
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_BREAK);
 }
 static void start_call_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
-    if (cparse->interpretations[cparse->interpretations_size - 1] != C_STMT)
-        return;
-
-    Chunk* const call_stack = cparse->chunks + CPARSE_CHUNK_CALLS;
-    uint32_t const call_id  = add_chunk(call_stack, "", 0);
-    DEBUG_ERROR_IF(call_id == 0xFFFFFFFF)
-
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_CALL);
+
+    if (!isInFnBody_cparse(cparse)) return;
+    switch (cparse->interpretations[cparse->interpretations_size - 1]) {
+        case C_COND:
+        case C_STMT:
+            DEBUG_ERROR_IF(add_chunk(cparse->chunks + CPARSE_CHUNK_CALLS, "", 0) == 0xFFFFFFFF)
+            NDEBUG_EXECUTE(add_chunk(cparse->chunks + CPARSE_CHUNK_CALLS, "", 0))
+            cparse->total[CPARSE_INDEX_FN_CALLS]++;
+    }
 }
 static void start_case_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    uint32_t const switch_head = peekStack_cparse(cparse, CPARSE_STACK_HEADS);
+    if (
+        isInFnBody_cparse(cparse) && switch_head != 0xFFFFFFFF &&
+        peekStack_cparse(cparse, CPARSE_STACK_ELEMENTS) == C_BLOCK_CONTENT
+    ) {
+        /* A case falls through from the previous case, and the switch jumps to it */
+        edge_cparse(cparse, switch_head, node_cparse(cparse, C_SPURIOUS), CPARSE_EDGE_CASE);
+    }
+
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_CASE);
 }
 static void start_condition_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    unsigned const c_element_id = peekStack_cparse(cparse, CPARSE_STACK_ELEMENTS);
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_CONDITION);
+
+    if (!isInFnBody_cparse(cparse)) return;
+    switch (c_element_id) {
+        case C_IF:
+        case C_ELSEIF:
+            cparse->stack[CPARSE_STACK_CONDS][cparse->stack_size[CPARSE_STACK_CONDS] - 1]
+                = node_cparse(cparse, C_COND);
+            break;
+        case C_CONTROL:
+        case C_WHILE:
+            cparse->stack[CPARSE_STACK_HEADS][cparse->stack_size[CPARSE_STACK_HEADS] - 1]
+                = node_cparse(cparse, C_COND);
+            break;
+        case C_SWITCH:
+            /* The switch flows into its cases only */
+            cparse->stack[CPARSE_STACK_HEADS][cparse->stack_size[CPARSE_STACK_HEADS] - 1]
+                = node_cparse(cparse, C_COND);
+            cparse->stack_size[CPARSE_STACK_INCOMING] = 0;
+            break;
+        case C_DO:
+            node_cparse(cparse, C_COND);
+    }
 }
 static void start_continue_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    jump_cparse(cparse, CPARSE_JUMP_CONTINUE);
+
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_CONTINUE);
 }
 static void start_for_ctrl_cparse(CParse* const cparse) {
@@ -168,11 +423,29 @@ static void start_decl_stmt_cparse(CParse* const cparse) {
 static void start_default_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    uint32_t const switch_head = peekStack_cparse(cparse, CPARSE_STACK_HEADS);
+    if (
+        isInFnBody_cparse(cparse) && switch_head != 0xFFFFFFFF &&
+        peekStack_cparse(cparse, CPARSE_STACK_ELEMENTS) == C_BLOCK_CONTENT
+    ) {
+        uint32_t const stmt_id = node_cparse(cparse, C_SPURIOUS);
+        edge_cparse(cparse, switch_head, stmt_id, CPARSE_EDGE_CASE);
+
+        /* The switch does NOT fall through to the next statement */
+        pushStack_cparse(cparse, CPARSE_STACK_JUMPS, CPARSE_JUMP_DEFAULT);
+        pushStack_cparse(cparse, CPARSE_STACK_JUMPS, stmt_id);
+    }
+
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_DEFAULT);
 }
 static void start_do_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    /* The body of a do loop starts at the next chunk, or the condition does if the body is empty */
+    start_loop_cparse(
+        cparse, isInFnBody_cparse(cparse) ? cparse->chunks[CPARSE_CHUNK_PARSE].nStrings : 0xFFFFFFFF
+    );
+
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_DO);
 }
 static void start_else_cparse(CParse* const cparse) {
@@ -183,6 +456,8 @@ static void start_else_cparse(CParse* const cparse) {
 static void start_elseif_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    pushStack_cparse(cparse, CPARSE_STACK_CONDS, 0xFFFFFFFF);
+
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_ELSEIF);
 }
 static void start_empty_stmt_cparse(CParse* const cparse) {
@@ -202,6 +477,8 @@ static void start_expr_stmt_cparse(CParse* const cparse) {
 static void start_for_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    start_loop_cparse(cparse, 0xFFFFFFFF);
+
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_FOR);
 }
 static void start_fn_cparse(CParse* const cparse) {
@@ -216,21 +493,31 @@ static void start_fn_cparse(CParse* const cparse) {
         TERMINATE_ERROR;
     }
 
+    index_cparse(cparse, CPARSE_INDEX_FN_STMTS, cparse->total[CPARSE_INDEX_FN_STMTS]);
+    index_cparse(cparse, CPARSE_INDEX_FN_EDGES, cparse->total[CPARSE_INDEX_FN_EDGES]);
+    index_cparse(cparse, CPARSE_INDEX_FN_CALLS, cparse->total[CPARSE_INDEX_FN_CALLS]);
+
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_FUNCTION);
 }
 static void start_goto_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    jump_cparse(cparse, CPARSE_JUMP_EXIT);
+
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_GOTO);
 }
 static void start_if_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    pushStack_cparse(cparse, CPARSE_STACK_CONDS, 0xFFFFFFFF);
+
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_IF);
 }
 static void start_if_stmt_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    pushStack_cparse(cparse, CPARSE_STACK_IF_STMTS, cparse->stack_size[CPARSE_STACK_BRANCHES]);
+
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_IF_STMT);
 }
 static void start_incr_cparse(CParse* const cparse) {
@@ -275,13 +562,15 @@ static void start_params_cparse(CParse* const cparse) {
 static void start_return_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
-    start_stmt_cparse(cparse);
+    jump_cparse(cparse, CPARSE_JUMP_EXIT);
 
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_RETURN);
 }
 static void start_switch_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    start_loop_cparse(cparse, 0xFFFFFFFF);
+
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_SWITCH);
 }
 static void start_type_cparse(CParse* const cparse) {
@@ -296,12 +585,38 @@ static void start_type_cparse(CParse* const cparse) {
 static void start_while_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    start_loop_cparse(cparse, 0xFFFFFFFF);
+
     pushStack_cparse(cparse, CPARSE_STACK_ELEMENTS, C_WHILE);
 }
 
 static void end_stmt_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 }
+static void end_branch_cparse(CParse* const cparse) {
+    DEBUG_ASSERT(isValid_cparse(cparse))
+
+    uint32_t const cond_id = popStack_cparse(cparse, CPARSE_STACK_CONDS);
+
+    /* The branch waits for the end of the if statement, the next branch starts at the condition */
+    moveStack_cparse(cparse, CPARSE_STACK_INCOMING, 0, CPARSE_STACK_BRANCHES);
+    if (cond_id != 0xFFFFFFFF)
+        pushIncoming_cparse(cparse, cond_id, CPARSE_EDGE_FALSE);
+}
+static void end_loop_cparse(CParse* const cparse) {
+    DEBUG_ASSERT(isValid_cparse(cparse))
+
+    uint32_t const loop_head = popStack_cparse(cparse, CPARSE_STACK_HEADS);
+    uint32_t const start     = popStack_cparse(cparse, CPARSE_STACK_LOOPS);
+    DEBUG_ERROR_IF(start == 0xFFFFFFFF)
+    if (loop_head == 0xFFFFFFFF) return;
+
+    connectIncoming_cparse(cparse, loop_head);
+    resolveJumps_cparse(cparse, start, loop_head);
+
+    /* The loop ends when its condition fails */
+    pushIncoming_cparse(cparse, loop_head, CPARSE_EDGE_FALSE);
+}
 static void end_block_content_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
@@ -361,6 +676,19 @@ static void end_default_cparse(CParse* const cparse) {
 static void end_do_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    uint32_t const loop_head = popStack_cparse(cparse, CPARSE_STACK_HEADS);
+    uint32_t const start     = popStack_cparse(cparse, CPARSE_STACK_LOOPS);
+    DEBUG_ERROR_IF(start == 0xFFFFFFFF)
+
+    /* The condition is the last statement, it goes back to the body */
+    uint32_t const cond_id = peekStack_cparse(cparse, CPARSE_STACK_INCOMING);
+    if (loop_head != 0xFFFFFFFF && cond_id != 0xFFFFFFFF) {
+        cparse->stack_size[CPARSE_STACK_INCOMING] = 0;
+        edge_cparse(cparse, cond_id, loop_head, CPARSE_EDGE_BACK);
+        resolveJumps_cparse(cparse, start, cond_id);
+        pushIncoming_cparse(cparse, cond_id, CPARSE_EDGE_FALSE);
+    }
+
     DEBUG_ERROR_IF(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS) != C_DO)
     NDEBUG_EXECUTE(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS))
 }
@@ -373,6 +701,8 @@ static void end_else_cparse(CParse* const cparse) {
 static void end_elseif_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    end_branch_cparse(cparse);
+
     DEBUG_ERROR_IF(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS) != C_ELSEIF)
     NDEBUG_EXECUTE(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS))
 }
@@ -395,6 +725,8 @@ static void end_expr_stmt_cparse(CParse* const cparse) {
 static void end_for_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    end_loop_cparse(cparse);
+
     DEBUG_ERROR_IF(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS) != C_FOR)
     NDEBUG_EXECUTE(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS))
 }
@@ -402,10 +734,23 @@ static void end_fn_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
     unsigned c_element_id = peekStack_cparse(cparse, CPARSE_STACK_ELEMENTS);
-    if (c_element_id != 0xFFFFFFFF) {
-        VERBOSE_MSG_VARIADIC("CPARSE_FN_END_BEFORE </%s>", element_tags[c_element_id]);
+    if (c_element_id != C_FUNCTION) {
+        VERBOSE_MSG_VARIADIC("CPARSE_FN_END_BEFORE </%s>", C_IS_VALID_ELEMENT(c_element_id) ? element_tags[c_element_id] : "?");
         TERMINATE_ERROR;
     }
+
+    if (isInFnBody_cparse(cparse)) {
+        /* Every function has one exit, the returns and the last statements go there */
+        uint32_t const exit_id = node_cparse(cparse, C_SPURIOUS);
+        for (uint32_t i = 1; i < cparse->stack_size[CPARSE_STACK_JUMPS]; i += 2)
+            edge_cparse(cparse, cparse->stack[CPARSE_STACK_JUMPS][i], exit_id, CPARSE_EDGE_JUMP);
+    }
+    for (int stack_id = CPARSE_STACK_LAST; stack_id > CPARSE_STACK_ELEMENTS; stack_id--)
+        cparse->stack_size[stack_id] = 0;
+
+    /* The edges are final, so the CC of the function already sees the same graph as its unit */
+    sortEdges_cparse(cparse);
+
     cparse->tracked_id[CPARSE_CURRENT_FN]            = 0xFFFFFFFF;
     cparse->tracked_id[CPARSE_CURRENT_FN_FIRST_STMT] = 0xFFFFFFFF;
 
@@ -421,12 +766,25 @@ static void end_goto_cparse(CParse* const cparse) {
 static void end_if_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
-    DEBUG_ERROR_IF(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS) != C_IF)
-    NDEBUG_EXECUTE(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS))
+    end_branch_cparse(cparse);
+
+    /* An <if type="elseif"> starts as C_ELSEIF, see event_startElement_cc() */
+    #ifndef NDEBUG
+        unsigned const c_element_id = popStack_cparse(cparse, CPARSE_STACK_ELEMENTS);
+        DEBUG_ERROR_IF(c_element_id != C_IF && c_element_id != C_ELSEIF)
+    #else
+        popStack_cparse(cparse, CPARSE_STACK_ELEMENTS);
+    #endif
 }
 static void end_if_stmt_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    uint32_t const start = popStack_cparse(cparse, CPARSE_STACK_IF_STMTS);
+    DEBUG_ERROR_IF(start == 0xFFFFFFFF)
+
+    /* The last branch, or the condition if there is NO else, falls through with the other branches */
+    moveStack_cparse(cparse, CPARSE_STACK_BRANCHES, start, CPARSE_STACK_INCOMING);
+
     DEBUG_ERROR_IF(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS) != C_IF_STMT)
     NDEBUG_EXECUTE(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS))
 }
@@ -526,6 +884,14 @@ static void end_return_cparse(CParse* const cparse) {
 static void end_switch_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    uint32_t const switch_head = popStack_cparse(cparse, CPARSE_STACK_HEADS);
+    uint32_t const start       = popStack_cparse(cparse, CPARSE_STACK_LOOPS);
+    DEBUG_ERROR_IF(start == 0xFFFFFFFF)
+
+    /* Without a default case, the switch may skip every case */
+    if (switch_head != 0xFFFFFFFF && !resolveJumps_cparse(cparse, start, 0xFFFFFFFF))
+        pushIncoming_cparse(cparse, switch_head, CPARSE_EDGE_FALSE);
+
     DEBUG_ERROR_IF(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS) != C_SWITCH)
     NDEBUG_EXECUTE(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS))
 }
@@ -538,6 +904,8 @@ static void end_type_cparse(CParse* const cparse) {
 static void end_while_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
+    end_loop_cparse(cparse);
+
     DEBUG_ERROR_IF(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS) != C_WHILE)
     NDEBUG_EXECUTE(popStack_cparse(cparse, CPARSE_STACK_ELEMENTS))
 }
@@ -666,34 +1034,50 @@ void constructEmpty_cparse(
     ChunkTable* const labels = cparse->tables + CPARSE_TABLE_LABELS;
     DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_ctbl(labels, initial_stack_cap, load_percent))
 
-    Map* const edges = cparse->maps + CPARSE_MAP_EDGES;
-    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_map(edges, chunk_size_guess))
+    /* A function has about one edge per statement */
+    charge_sizing(0, (uint64_t)chunk_item_count_guess * EDGE_BYTES);
+    cparse->edges_cap    = chunk_item_count_guess;
+    cparse->edge_sources = malloc((size_t)chunk_item_count_guess * sizeof(uint32_t));
+    cparse->edge_targets = malloc((size_t)chunk_item_count_guess * sizeof(uint32_t));
+    cparse->edge_kinds   = malloc((size_t)chunk_item_count_guess);
+    DEBUG_ERROR_IF(cparse->edge_sources == NULL)
+    DEBUG_ERROR_IF(cparse->edge_targets == NULL)
+    DEBUG_ERROR_IF(cparse->edge_kinds == NULL)
+
+    cparse->sorted_cap   = 0;
+    cparse->sorted_edges = NULL;
+
+    for (unsigned index_id = 0; index_id <= CPARSE_INDEX_LAST; index_id++) {
+        cparse->index_cap[index_id]  = index_id == CPARSE_INDEX_UNIT_FNS ? unit_count_guess : total_fn_count_guess;
+        cparse->index_size[index_id] = 0;
+        cparse->index[index_id]      = malloc(cparse->index_cap[index_id] * sizeof(uint32_t));
+        DEBUG_ERROR_IF(cparse->index[index_id] == NULL)
+    }
+
+    for (unsigned i = 0; i <= CPARSE_TOTAL_LAST; i++)
+        cparse->total[i] = 0;
 
     for (unsigned i = 0; i <= CPARSE_TRACKED_LAST; i++)
         cparse->tracked_id[i] = 0xFFFFFFFF;
 }
 
-void end_cparse(CParse* const cparse, char const* const c_element_tag) {
+void end_cparse(CParse* const cparse, unsigned const c_tag_id) {
     static CParser element_parsers[C_ELEMENT_COUNT] = C_ELEMENT_ENDERS;
 
     DEBUG_ASSERT(isValid_cparse(cparse))
 
-    char const** bsearch_result = bsearch(
-        c_element_tag, element_tags, C_ELEMENT_COUNT,
-        sizeof(char const*), strcmp_as_comparator
-    );
-    if (bsearch_result == NULL) {
-        VERBOSE_MSG_VARIADIC("CPARSE_IGNORE => <%s>", c_element_tag);
+    if (!C_IS_VALID_ELEMENT(c_tag_id)) {
+        VERBOSE_MSG_VARIADIC("CPARSE_IGNORE => </%s>", C_IS_VALID_TAG(c_tag_id) ? element_tags[c_tag_id] : "?");
         return;
     }
 
-    uint32_t const id = (uint32_t)(bsearch_result - element_tags);
-    VERBOSE_MSG_VARIADIC("CPARSE_POP_ELEMENT => </%s>", element_tags[id]);
-    element_parsers[id](cparse);
+    VERBOSE_MSG_VARIADIC("CPARSE_POP_ELEMENT => </%s>", element_tags[c_tag_id]);
+    element_parsers[c_tag_id](cparse);
 }
 
 void endUnit_cparse(CParse* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(getUnitCount_cparse(cparse) == 0)
 
     cparse->tracked_id[CPARSE_CURRENT_UNIT] = 0xFFFFFFFF;
 }
@@ -708,12 +1092,15 @@ void flush_cparse(CParse* const cparse) {
     for (int tbl_id = CPARSE_TABLE_LAST; tbl_id >= 0; tbl_id--)
         DEBUG_ASSERT_NDEBUG_EXECUTE(flush_ctbl(cparse->tables + tbl_id))
 
-    for (int map_id = CPARSE_MAP_LAST; map_id >= 0; map_id--)
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_map(cparse->maps + map_id))
-
     for (int stack_id = CPARSE_STACK_LAST; stack_id >= 0; stack_id--)
         cparse->stack_size[stack_id] = 0;
 
+    for (int index_id = CPARSE_INDEX_LAST; index_id >= 0; index_id--)
+        cparse->index_size[index_id] = 0;
+
+    for (int i = CPARSE_TOTAL_LAST; i >= 0; i--)
+        cparse->total[i] = 0;
+
     for (int i = CPARSE_TRACKED_LAST; i >= 0; i--)
         cparse->tracked_id[i] = 0xFFFFFFFF;
 }
@@ -729,11 +1116,17 @@ void free_cparse(CParse* const cparse) {
     for (int tbl_id = CPARSE_TABLE_LAST; tbl_id >= 0; tbl_id--)
         DEBUG_ASSERT_NDEBUG_EXECUTE(free_ctbl(cparse->tables + tbl_id))
 
-    for (int map_id = CPARSE_MAP_LAST; map_id >= 0; map_id--)
-        DEBUG_ASSERT_NDEBUG_EXECUTE(free_map(cparse->maps + map_id))
+    free(cparse->edge_sources);
+    free(cparse->edge_targets);
+    free(cparse->edge_kinds);
+    charge_sizing((uint64_t)cparse->edges_cap * EDGE_BYTES, 0);
+    free(cparse->sorted_edges);
 
     for (int stack_id = CPARSE_STACK_LAST; stack_id >= 0; stack_id--)
         free(cparse->stack[stack_id]);
+
+    for (int index_id = CPARSE_INDEX_LAST; index_id >= 0; index_id--)
+        free(cparse->index[index_id]);
 }
 
 void generateDot_cparse(
@@ -751,77 +1144,113 @@ void generateXml_cparse(
 uint32_t getCallCount_cparse(CParse const* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
-    return 0;
+    return cparse->total[CPARSE_INDEX_FN_CALLS];
 }
 
 uint32_t getCallCountOfFn_cparse(CParse const* const cparse, uint32_t const fn_id) {
     DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(fn_id >= getFnCount_cparse(cparse))
 
-    return 0;
+    return offsetOfFn_cparse(cparse, CPARSE_INDEX_FN_CALLS, fn_id + 1)
+         - offsetOfFn_cparse(cparse, CPARSE_INDEX_FN_CALLS, fn_id);
 }
 
 uint32_t getCallCountOfUnit_cparse(CParse const* const cparse, uint32_t const unit_id) {
     DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(unit_id >= getUnitCount_cparse(cparse))
 
-    return 0;
+    return offsetOfFn_cparse(cparse, CPARSE_INDEX_FN_CALLS, endFnOfUnit_cparse(cparse, unit_id))
+         - offsetOfFn_cparse(cparse, CPARSE_INDEX_FN_CALLS, cparse->index[CPARSE_INDEX_UNIT_FNS][unit_id]);
 }
 
+/* An interprocedural graph also has an edge to the callee and an edge back for every call */
 uint32_t getEdgeCount_cparse(CParse const* const cparse, bool const interprocedural) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
-    return 0;
+    uint32_t count = cparse->total[CPARSE_INDEX_FN_EDGES];
+    if (interprocedural) count += 2 * getCallCount_cparse(cparse);
+    return count;
 }
 
 uint32_t getEdgeCountOfFn_cparse(
     CParse const* const cparse, uint32_t const fn_id, bool const interprocedural
 ) {
     DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(fn_id >= getFnCount_cparse(cparse))
 
-    return 0;
+    uint32_t count = offsetOfFn_cparse(cparse, CPARSE_INDEX_FN_EDGES, fn_id + 1)
+                   - offsetOfFn_cparse(cparse, CPARSE_INDEX_FN_EDGES, fn_id);
+    if (interprocedural) count += 2 * getCallCountOfFn_cparse(cparse, fn_id);
+    return count;
 }
 
 uint32_t getEdgeCountOfUnit_cparse(
     CParse const* const cparse, uint32_t const unit_id, bool const interprocedural
 ) {
     DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(unit_id >= getUnitCount_cparse(cparse))
 
-    return 0;
+    uint32_t count = offsetOfFn_cparse(cparse, CPARSE_INDEX_FN_EDGES, endFnOfUnit_cparse(cparse, unit_id))
+                   - offsetOfFn_cparse(cparse, CPARSE_INDEX_FN_EDGES, cparse->index[CPARSE_INDEX_UNIT_FNS][unit_id]);
+    if (interprocedural) count += 2 * getCallCountOfUnit_cparse(cparse, unit_id);
+    return count;
 }
 
 uint32_t getFnCount_cparse(CParse const* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
-    return 0;
+    return cparse->index_size[CPARSE_INDEX_FN_STMTS];
 }
 
 uint32_t getFnCountOfUnit_cparse(CParse const* const cparse, uint32_t const unit_id) {
     DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(unit_id >= getUnitCount_cparse(cparse))
 
-    return 0;
+    return endFnOfUnit_cparse(cparse, unit_id) - cparse->index[CPARSE_INDEX_UNIT_FNS][unit_id];
 }
 
 uint32_t getStmtCount_cparse(CParse const* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
-    return 0;
+    return cparse->total[CPARSE_INDEX_FN_STMTS];
 }
 
 uint32_t getStmtCountOfFn_cparse(CParse const* const cparse, uint32_t const fn_id) {
     DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(fn_id >= getFnCount_cparse(cparse))
 
-    return 0;
+    return offsetOfFn_cparse(cparse, CPARSE_INDEX_FN_STMTS, fn_id + 1)
+         - offsetOfFn_cparse(cparse, CPARSE_INDEX_FN_STMTS, fn_id);
 }
 
 uint32_t getStmtCountOfUnit_cparse(CParse const* const cparse, uint32_t const unit_id) {
     DEBUG_ASSERT(isValid_cparse(cparse))
+    DEBUG_ERROR_IF(unit_id >= getUnitCount_cparse(cparse))
 
-    return 0;
+    return offsetOfFn_cparse(cparse, CPARSE_INDEX_FN_STMTS, endFnOfUnit_cparse(cparse, unit_id))
+         - offsetOfFn_cparse(cparse, CPARSE_INDEX_FN_STMTS, cparse->index[CPARSE_INDEX_UNIT_FNS][unit_id]);
+}
+
+unsigned getTagId_cparse(char const* const tag) {
+    static unsigned char const hash_table[C_TAG_HASH_SIZE] = C_TAG_HASH_TABLE;
+
+    DEBUG_ERROR_IF(tag == NULL)
+
+    uint32_t hash = C_TAG_HASH_SEED;
+    for (unsigned char const* c = (unsigned char const*)tag; *c; c++)
+        hash = (hash ^ *c) * C_TAG_HASH_PRIME;
+
+    /* One string compare rejects the tags that are NOT in C_ELEMENT_TAGS */
+    unsigned const id = hash_table[(hash >> 16) % C_TAG_HASH_SIZE];
+    if (id == C_NOT_A_TAG || strcmp(tag, element_tags[id]) != 0) return C_NOT_A_TAG;
+
+    return id;
 }
 
 uint32_t getUnitCount_cparse(CParse const* const cparse) {
     DEBUG_ASSERT(isValid_cparse(cparse))
 
-    return 0;
+    return cparse->index_size[CPARSE_INDEX_UNIT_FNS];
 }
 
 bool isValid_cparse(CParse const* const cparse) {
@@ -837,8 +1266,11 @@ bool isValid_cparse(CParse const* const cparse) {
     for (int tbl_id = CPARSE_TABLE_LAST; tbl_id >= 0; tbl_id--)
         if (!isValid_ctbl(cparse->tables + tbl_id)) return 0;
 
-    for (int map_id = CPARSE_MAP_LAST; map_id >= 0; map_id--)
-        if (!isValid_map(cparse->maps + map_id)) return 0;
+    if (cparse->edge_sources == NULL)                               return 0;
+    if (cparse->edge_targets == NULL)                               return 0;
+    if (cparse->edge_kinds == NULL)                                 return 0;
+    if (cparse->edges_cap == 0)                                     return 0;
+    if (cparse->total[CPARSE_INDEX_FN_EDGES] > cparse->edges_cap)   return 0;
 
     for (int stack_id = CPARSE_STACK_LAST; stack_id >= 0; stack_id--) {
         if (cparse->stack[stack_id] == NULL)                            return 0;
@@ -847,27 +1279,28 @@ bool isValid_cparse(CParse const* const cparse) {
         if (cparse->stack_size[stack_id] > cparse->stack_cap[stack_id]) return 0;
     }
 
+    for (int index_id = CPARSE_INDEX_LAST; index_id >= 0; index_id--) {
+        if (cparse->index[index_id] == NULL)                            return 0;
+        if (cparse->index_cap[index_id] == 0)                           return 0;
+        if (cparse->index_cap[index_id] == 0xFFFFFFFF)                  return 0;
+        if (cparse->index_size[index_id] > cparse->index_cap[index_id]) return 0;
+    }
+
     return 1;
 }
 
-void start_cparse(CParse* const cparse, char const* const c_element_tag) {
+void start_cparse(CParse* const cparse, unsigned const c_tag_id) {
     DEBUG_ASSERT(isValid_cparse(cparse))
-    DEBUG_ERROR_IF(c_element_tag == NULL)
 
     static CParser element_parsers[C_ELEMENT_COUNT] = C_ELEMENT_STARTERS;
 
-    char const** bsearch_result = bsearch(
-        c_element_tag, element_tags, C_ELEMENT_COUNT,
-        sizeof(char const*), strcmp_as_comparator
-    );
-    if (bsearch_result == NULL) {
-        VERBOSE_MSG_VARIADIC("CPARSE_IGNORE => <%s>", c_element_tag);
+    if (!C_IS_VALID_ELEMENT(c_tag_id)) {
+        VERBOSE_MSG_VARIADIC("CPARSE_IGNORE => <%s>", C_IS_VALID_TAG(c_tag_id) ? element_tags[c_tag_id] : "?");
         return;
     }
 
-    uint32_t const id = (uint32_t)(bsearch_result - element_tags);
-    VERBOSE_MSG_VARIADIC("CPARSE_PUSH_ELEMENT => <%s>", element_tags[id]);
-    element_parsers[id](cparse);
+    VERBOSE_MSG_VARIADIC("CPARSE_PUSH_ELEMENT => <%s>", element_tags[c_tag_id]);
+    element_parsers[c_tag_id](cparse);
 }
 
 void startUnit_cparse(
@@ -886,6 +1319,7 @@ void startUnit_cparse(
     VERBOSE_MSG_VARIADIC("CPARSE_START_UNIT %.*s", (int)unit_len, unit_name);
 
     parse_cparse(cparse, unit_name, unit_len, C_UNIT);
+    index_cparse(cparse, CPARSE_INDEX_UNIT_FNS, getFnCount_cparse(cparse));
 
     cparse->tracked_id[CPARSE_CURRENT_UNIT] = CPARSE_LAST_CHUNK_ID;
     DEBUG_ERROR_IF(cparse->tracked_id[CPARSE_CURRENT_UNIT] == 0xFFFFFFFF)
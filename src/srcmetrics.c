@@ -33,14 +33,20 @@
 #include "padkit/reallocate.h"
 #include "padkit/streq.h"
 #include "srcmetrics.h"
-#include "srcmetrics/event.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/cache.h"
 #include "srcmetrics/metrics.h"
+#include "srcmetrics/parse.h"
+#include "srcmetrics/profile.h"
 #include "srcmetrics/report.h"
+#include "srcmetrics/server.h"
+#include "srcmetrics/sizing.h"
+#include "srcmetrics/walk.h"
 
 char const* csv_delimeter = CSV_INITIAL_DELIMETER;
 char const* csv_row_end   = CSV_INITIAL_ROW_END;
 struct Options options    = OPTIONS_INITIAL;
-Chunk strings[1]          = { NOT_A_CHUNK };
+static Chunk strings[1]   = { NOT_A_CHUNK };
 
 /**
  * @defgroup atexit_Functions Functions Called @ Exit
@@ -48,7 +54,7 @@ Chunk strings[1]          = { NOT_A_CHUNK };
  */
 
 /**
- * @brief Frees the global strings Chunk.
+ * @brief Frees the strings Chunk of the command-line arguments.
  */
 static void free_strings(void) {
     DEBUG_ABORT_IF(!free_chunk(strings))
@@ -107,6 +113,28 @@ static void showFileNOTFoundError(char const* const filepath) {
                     "\n", filepath);
 }
 
+/**
+ * @brief Prints an 'invalid-job-count' error.
+ */
+static void showInvalidJobCountError(char const* const job_count_str) {
+    fprintf(stderr, "\n"
+                    "Job count '%s' is NOT a positive integer\n"
+                    "\n"
+                    "Execute `srcmetrics --help` for more information.\n"
+                    "\n", job_count_str);
+}
+
+/**
+ * @brief Prints an 'invalid-memory-budget' error.
+ */
+static void showInvalidMemoryBudgetError(char const* const memory_budget_str) {
+    fprintf(stderr, "\n"
+                    "Memory budget '%s' is NOT a positive number of bytes, e.g., 512M\n"
+                    "\n"
+                    "Execute `srcmetrics --help` for more information.\n"
+                    "\n", memory_budget_str);
+}
+
 /**
  * @brief Prints a short option 'must-be-alone' error.
  */
@@ -138,7 +166,7 @@ static void showLongHelpMessage(void) {
           "\n"
           "Calculates static metrics from C source code files.\n"
           "\n"
-          "Source-code input can be from standard input, a file, a directory, or an archive file, i.e., tar, cpio, zip, etc.\n"
+          "Source-code input can be a file, a directory, or an uncompressed tar archive.\n"
           "\n"
           "GENERAL OPTIONS:\n"
           "  -h,--help                      Output this help message and exit\n"
@@ -148,7 +176,19 @@ static void showLongHelpMessage(void) {
           "  -o,--output FILE               Write output to FILE\n"
           "  -l,--language LANG             Set the source-code language to C\n"
           "  -d,--delimeter DELIM           Change the CSV delimeter, default: ','\n"
+          "  --columnar                     Write a columnar binary report instead of CSV\n"
+          "  --gzip                         Compress the CSV report with gzip\n"
           "  --files-from FILE              Input source-code filenames from FILE\n"
+          "  --include-files GLOB           Evaluate the files in directories and tar archives that match GLOB, default: *.c *.h\n"
+          "  --exclude-files GLOB           Skip the files and directories that match GLOB in directories and tar archives\n"
+          "  -j,--jobs N                    Parse N source files in parallel, default: 1\n"
+          "  --memory-budget BYTES          Fail if the metric tables need more than BYTES (K, M, or G), default: no limit\n"
+          "  --stream                       Process units one by one instead of building one srcML archive in memory\n"
+          "  --stream-report                Write the unit and function metrics of every unit as soon as it ends\n"
+          "  --parallel-metrics             Also evaluate the metrics of each unit on the '--jobs' threads\n"
+          "  --profile[=FILE]               Time every phase and metric, write JSON (CSV if FILE is .csv) at exit\n"
+          "  --cache DIR                    Reuse the results of unchanged source files from DIR, and save the rest\n"
+          "  --server                       Keep the results in memory and answer JSON-RPC requests on stdin\n"
           "\n"
           "SRCMETRICS OPTIONS:\n"
           "  -a,--all-metrics               (Default) Report all metrics (implies '--RFU-show --CC-show')\n"
@@ -307,6 +347,41 @@ static void getInfilesFromFile(char const* const filename) {
     options.last_infile_id = strings->nStrings - 1;
 }
 
+/**
+ * @brief Sets the number of parser threads using the '--jobs' argument.
+ * @param job_count_str The '--jobs' argument.
+ * @return 0 if the argument is NOT a positive integer, 1 otherwise.
+ */
+static bool getJobCount(char const* const job_count_str) {
+    char* end;
+    unsigned long const n_jobs = strtoul(job_count_str, &end, 10);
+    if (*job_count_str == '\0' || *end != '\0' || n_jobs == 0 || n_jobs > PPOOL_MAX_JOBS) return 0;
+    options.n_jobs = (uint32_t)n_jobs;
+    return 1;
+}
+
+/**
+ * @brief Sets the memory budget using the '--memory-budget' argument.
+ * @param memory_budget_str The '--memory-budget' argument, e.g., 65536, 64K, 512M, or 2G.
+ * @return 0 if the argument is NOT a positive number of bytes, 1 otherwise.
+ */
+static bool getMemoryBudget(char const* const memory_budget_str) {
+    char* end;
+    unsigned long long const n = strtoull(memory_budget_str, &end, 10);
+    if (*memory_budget_str < '0' || *memory_budget_str > '9' || n == 0) return 0;
+
+    unsigned shift = 0;
+    if (*end == 'K' || *end == 'k')         shift = 10;
+    else if (*end == 'M' || *end == 'm')    shift = 20;
+    else if (*end == 'G' || *end == 'g')    shift = 30;
+    if (shift > 0) end++;
+
+    if (*end != '\0' || n > (UINT64_MAX >> shift)) return 0;
+
+    options.memory_budget = (uint64_t)n << shift;
+    return 1;
+}
+
 /**
  * @brief Gets enabled or excluded metrics using the file given with '--metrics-from' argument.
  *
@@ -335,15 +410,23 @@ static void getEnabledOrExcludedMetricsFromFile(char const* const filename, bool
     }
 }
 
-bool isCFGEnabled(void)   { return options.flags & FLAG_CFG_ENABLE; }
-bool isCGEnabled(void)    { return options.flags & FLAG_CG_ENABLE; }
-bool isCGNoExternal(void) { return options.flags & FLAG_CG_NO_EXTERNAL; }
-bool isDotEnabled(void)   { return options.flags & FLAG_GRAPH_ENABLE_DOT; }
-bool isIPCFGEnabled(void) { return options.flags & FLAG_IPCFG_ENABLE; }
-bool isRFUQuiet(void)     { return !(options.flags & FLAG_RFU_SHOW); }
-bool isRFUSimple(void)    { return options.flags & FLAG_RFU_SIMPLE; }
-bool isVerbose(void)      { return options.flags & FLAG_VERBOSE; }
-bool isXmlEnabled(void)   { return options.flags & FLAG_GRAPH_ENABLE_XML; }
+bool isCaching(void)         { return options.cache_dir != NULL && !isCFGEnabled(); }
+bool isCFGEnabled(void)      { return options.flags & FLAG_CFG_ENABLE; }
+bool isCGEnabled(void)       { return options.flags & FLAG_CG_ENABLE; }
+bool isCGNoExternal(void)    { return options.flags & FLAG_CG_NO_EXTERNAL; }
+bool isColumnar(void)        { return (options.flags & FLAG_COLUMNAR) && !isServing(); }
+bool isDotEnabled(void)      { return options.flags & FLAG_GRAPH_ENABLE_DOT; }
+bool isGzipping(void)        { return (options.flags & FLAG_GZIP) && !isServing() && !isColumnar(); }
+bool isIPCFGEnabled(void)    { return options.flags & FLAG_IPCFG_ENABLE; }
+bool isParallelMetrics(void) { return (options.flags & FLAG_PARALLEL_METRICS) && options.n_jobs > 1 && !isCFGEnabled(); }
+bool isProfiling(void)       { return options.flags & FLAG_PROFILE; }
+bool isRFUQuiet(void)        { return !(options.flags & FLAG_RFU_SHOW); }
+bool isRFUSimple(void)       { return options.flags & FLAG_RFU_SIMPLE; }
+bool isServing(void)         { return (options.flags & FLAG_SERVER) && !isCFGEnabled(); }
+bool isStreaming(void)       { return options.flags & FLAG_STREAM; }
+bool isStreamingReport(void) { return (options.flags & (FLAG_STREAM | FLAG_STREAM_REPORT)) && !isColumnar() && !isServing(); }
+bool isVerbose(void)         { return options.flags & FLAG_VERBOSE; }
+bool isXmlEnabled(void)      { return options.flags & FLAG_GRAPH_ENABLE_XML; }
 
 /**
  * @brief Parses the command-line arguments and starts the metrics collection.
@@ -383,6 +466,17 @@ SRCMETRICS_NEXT_OPTION_CHAR:
                         if (STR_EQ_CONST(argv[arg_id], "--all-metrics")) {
                             options.enabledMetrics |= ALL_METRICS_ENABLED;
                             break;
+                        } else if (STR_EQ_CONST(argv[arg_id], "--cache")) {
+                            if (arg_id < finalArg_id) {
+                                options.cache_dir = argv[++arg_id];
+                                break;
+                            } else {
+                                showLongOptionNeedsParametersError(argv[arg_id]);
+                                return EXIT_FAILURE;
+                            }
+                        } else if (STR_CONTAINS_CONST(argv[arg_id], "--cache=")) {
+                            options.cache_dir = argv[arg_id] + 8;
+                            break;
                         } else if (STR_EQ_CONST(argv[arg_id], "--cfg")) {
                             if (arg_id < finalArg_id) {
                                 options.flags |= FLAG_CFG_ENABLE;
@@ -425,6 +519,9 @@ SRCMETRICS_NEXT_OPTION_CHAR:
                         } else if (STR_EQ_CONST(argv[arg_id], "--cg-show-external")) {
                             options.flags &= (~FLAG_CG_NO_EXTERNAL);
                             break;
+                        } else if (STR_EQ_CONST(argv[arg_id], "--columnar")) {
+                            options.flags |= FLAG_COLUMNAR;
+                            break;
                         } else if (STR_EQ_CONST(argv[arg_id], "--copyright")) {
                             if (arg_id == 1 && arg_id == finalArg_id) {
                                 showCopyright();
@@ -481,6 +578,17 @@ SRCMETRICS_NEXT_OPTION_CHAR:
                         } else if (STR_CONTAINS_CONST(argv[arg_id], "--excluded-from=")) {
                             getEnabledOrExcludedMetricsFromFile(argv[arg_id] + 16, 0);
                             break;
+                        } else if (STR_EQ_CONST(argv[arg_id], "--exclude-files")) {
+                            if (arg_id < finalArg_id) {
+                                addPattern_walk(argv[++arg_id], 1);
+                                break;
+                            } else {
+                                showLongOptionNeedsParametersError(argv[arg_id]);
+                                return EXIT_FAILURE;
+                            }
+                        } else if (STR_CONTAINS_CONST(argv[arg_id], "--exclude-files=")) {
+                            addPattern_walk(argv[arg_id] + 16, 1);
+                            break;
                         } else if (STR_EQ_CONST(argv[arg_id], "--files-from")) {
                             if (arg_id < finalArg_id) {
                                 getInfilesFromFile(argv[++arg_id]);
@@ -504,6 +612,9 @@ SRCMETRICS_NEXT_OPTION_CHAR:
                         } else if (STR_EQ_CONST(argv[arg_id], "--graph-disable-xml")) {
                             options.flags &= FLAG_GRAPH_DISABLE_XML;
                             break;
+                        } else if (STR_EQ_CONST(argv[arg_id], "--gzip")) {
+                            options.flags |= FLAG_GZIP;
+                            break;
                         } else if (STR_EQ_CONST(argv[arg_id], "--help")) {
                             if (arg_id == 1 && arg_id == finalArg_id) {
                                 showLongHelpMessage();
@@ -512,6 +623,17 @@ SRCMETRICS_NEXT_OPTION_CHAR:
                                 showLongOptionMustBeAloneError(argv[arg_id]);
                                 return EXIT_FAILURE;
                             }
+                        } else if (STR_EQ_CONST(argv[arg_id], "--include-files")) {
+                            if (arg_id < finalArg_id) {
+                                addPattern_walk(argv[++arg_id], 0);
+                                break;
+                            } else {
+                                showLongOptionNeedsParametersError(argv[arg_id]);
+                                return EXIT_FAILURE;
+                            }
+                        } else if (STR_CONTAINS_CONST(argv[arg_id], "--include-files=")) {
+                            addPattern_walk(argv[arg_id] + 16, 0);
+                            break;
                         } else if (STR_EQ_CONST(argv[arg_id], "--ipcfg")) {
                             if (arg_id < finalArg_id) {
                                 options.flags |= FLAG_IPCFG_ENABLE;
@@ -530,6 +652,25 @@ SRCMETRICS_NEXT_OPTION_CHAR:
                             options.flags &= FLAG_CC_QUIET;
                             options.ipcfg_name = argv[arg_id] + 6;
                             break;
+                        } else if (STR_EQ_CONST(argv[arg_id], "--jobs")) {
+                            if (arg_id < finalArg_id) {
+                                if (getJobCount(argv[++arg_id])) {
+                                    break;
+                                } else {
+                                    showInvalidJobCountError(argv[arg_id]);
+                                    return EXIT_FAILURE;
+                                }
+                            } else {
+                                showLongOptionNeedsParametersError(argv[arg_id]);
+                                return EXIT_FAILURE;
+                            }
+                        } else if (STR_CONTAINS_CONST(argv[arg_id], "--jobs=")) {
+                            if (getJobCount(argv[arg_id] + 7)) {
+                                break;
+                            } else {
+                                showInvalidJobCountError(argv[arg_id] + 7);
+                                return EXIT_FAILURE;
+                            }
                         } else if (STR_EQ_CONST(argv[arg_id], "--language")) {
                             if (arg_id < finalArg_id) {
                                 options.language = "C";
@@ -550,6 +691,25 @@ SRCMETRICS_NEXT_OPTION_CHAR:
                                 showLongOptionMustBeAloneError(argv[arg_id]);
                                 return EXIT_FAILURE;
                             }
+                        } else if (STR_EQ_CONST(argv[arg_id], "--memory-budget")) {
+                            if (arg_id < finalArg_id) {
+                                if (getMemoryBudget(argv[++arg_id])) {
+                                    break;
+                                } else {
+                                    showInvalidMemoryBudgetError(argv[arg_id]);
+                                    return EXIT_FAILURE;
+                                }
+                            } else {
+                                showLongOptionNeedsParametersError(argv[arg_id]);
+                                return EXIT_FAILURE;
+                            }
+                        } else if (STR_CONTAINS_CONST(argv[arg_id], "--memory-budget=")) {
+                            if (getMemoryBudget(argv[arg_id] + 16)) {
+                                break;
+                            } else {
+                                showInvalidMemoryBudgetError(argv[arg_id] + 16);
+                                return EXIT_FAILURE;
+                            }
                         } else if (STR_EQ_CONST(argv[arg_id], "--metric")) {
                             if (arg_id < finalArg_id) {
                                 arg_id++;
@@ -598,6 +758,16 @@ SRCMETRICS_NEXT_OPTION_CHAR:
                         } else if (STR_CONTAINS_CONST(argv[arg_id], "--output=")) {
                             options.outfile = argv[arg_id] + 9;
                             break;
+                        } else if (STR_EQ_CONST(argv[arg_id], "--parallel-metrics")) {
+                            options.flags |= FLAG_PARALLEL_METRICS;
+                            break;
+                        } else if (STR_EQ_CONST(argv[arg_id], "--profile")) {
+                            options.flags |= FLAG_PROFILE;
+                            break;
+                        } else if (STR_CONTAINS_CONST(argv[arg_id], "--profile=")) {
+                            options.flags |= FLAG_PROFILE;
+                            options.profile_file = argv[arg_id] + 10;
+                            break;
                         } else if (STR_EQ_CONST(argv[arg_id], "--RFU-quiet")) {
                             options.flags &= FLAG_RFU_QUIET;
                             break;
@@ -610,6 +780,9 @@ SRCMETRICS_NEXT_OPTION_CHAR:
                         } else if (STR_EQ_CONST(argv[arg_id], "--RFU-transitive")) {
                             options.flags &= FLAG_RFU_TRANSITIVE;
                             break;
+                        } else if (STR_EQ_CONST(argv[arg_id], "--server")) {
+                            options.flags |= FLAG_SERVER;
+                            break;
                         } else if (STR_EQ_CONST(argv[arg_id], "--show")) {
                             if (arg_id != 1) {
                                 showLongOptionMustBeAloneError(argv[arg_id]);
@@ -634,6 +807,12 @@ SRCMETRICS_NEXT_OPTION_CHAR:
                                 showLongOptionMustBeAloneError(argv[arg_id]);
                                 return EXIT_FAILURE;
                             }
+                        } else if (STR_EQ_CONST(argv[arg_id], "--stream")) {
+                            options.flags |= FLAG_STREAM;
+                            break;
+                        } else if (STR_EQ_CONST(argv[arg_id], "--stream-report")) {
+                            options.flags |= FLAG_STREAM_REPORT;
+                            break;
                         } else if (STR_EQ_CONST(argv[arg_id], "--verbose")) {
                             options.flags |= FLAG_VERBOSE;
                             break;
@@ -714,6 +893,25 @@ SRCMETRICS_NEXT_OPTION_CHAR:
                             showShortOptionMustBeAloneError(argv[arg_id][i]);
                             return EXIT_FAILURE;
                         }
+                    case 'j':
+                        if (argv[arg_id][i + 1] == '=') {
+                            if (getJobCount(argv[arg_id] + i + 2)) {
+                                break;
+                            } else {
+                                showInvalidJobCountError(argv[arg_id] + i + 2);
+                                return EXIT_FAILURE;
+                            }
+                        } else if (argv[arg_id][i + 1] == '\0' && arg_id < finalArg_id) {
+                            if (getJobCount(argv[++arg_id])) {
+                                break;
+                            } else {
+                                showInvalidJobCountError(argv[arg_id]);
+                                return EXIT_FAILURE;
+                            }
+                        } else {
+                            showShortOptionNeedsParametersError(argv[arg_id][i]);
+                            return EXIT_FAILURE;
+                        }
                     case 'l':
                         if (argv[arg_id][i + 1] == '=') {
                             options.language = "C";
@@ -860,72 +1058,192 @@ SRCMETRICS_NEXT_OPTION_CHAR:
         }
     }
 
-    if (options.n_cmd_infiles == 0) return EXIT_SUCCESS;
+    /* Replace the directories and the tar archives with the source files in them */
+    DEBUG_ERROR_IF(atexit(free_walk) != 0)
+    NDEBUG_EXECUTE(atexit(free_walk))
+    expand_walk(&options.cmd_infiles, &options.n_cmd_infiles, &options.cap_cmd_infiles, options.n_jobs);
 
-    Chunk chunk[1];
-    size_t archiveBufferSize            = 0;
-    char* archiveBuffer                 = NULL;
-    struct srcml_archive* const archive = srcml_archive_create();
-    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_chunk(chunk, CHUNK_RECOMMENDED_INITIAL_CAP, 1))
+    /* The tables start as large as the input needs, and grow geometrically from there */
+    prepare_sizing(getInputBytes_walk(), options.n_cmd_infiles);
 
-    DEBUG_ERROR_IF(srcml_archive_write_open_memory(archive, &archiveBuffer, &archiveBufferSize) != SRCML_STATUS_OK)
-    NDEBUG_EXECUTE(srcml_archive_write_open_memory(archive, &archiveBuffer, &archiveBufferSize))
-    VERBOSE_MSG_LITERAL("CREATED_EMPTY_SRCML_ARCHIVE");
+    /* A server may start with no infiles, and track them as they change */
+    if (options.n_cmd_infiles == 0 && !isServing()) return EXIT_SUCCESS;
+
+    /* Every Analysis and ParsePool submits its timers before the exit, where the profile is written */
+    if (isProfiling()) enable_profile();
+
+    if (isCaching()) prepare_cache();
 
-    for (size_t infile_id = options.n_cmd_infiles - 1; infile_id != SIZE_MAX; infile_id--) {
-        char const* const infile = options.cmd_infiles[infile_id];
+    if (isServing()) {
+        Server server[1];
+        constructEmpty_server(server);
 
-        VERBOSE_MSG_VARIADIC("SRCML_UNIT = %s", infile);
+        for (size_t infile_id = 0; infile_id < options.n_cmd_infiles; infile_id++) {
+            if (!update_server(server, options.cmd_infiles[infile_id])) {
+                showFileNOTFoundError(options.cmd_infiles[infile_id]);
+                free_server(server);
+                return EXIT_FAILURE;
+            }
+        }
+
+        /* The responses own stdout, so the reports go into them */
+        serve_server(server, stdin, stdout);
 
-        /* NOTE: I assume every file contains exactly one unit.
-         * This is true for C but maybe not for Java */
-        struct srcml_unit* const unit = srcml_unit_create(archive);
+        free_server(server);
+
+        return EXIT_SUCCESS;
+    }
 
-        VERBOSE_MSG_LITERAL("SRCML_LANGUAGE = C");
+    Analysis analysis[1];
+    ParsePool pool[1];
+    struct srcml_unit* unit;
 
-        /* Set language to C */
-        DEBUG_ERROR_IF(srcml_unit_set_language(unit, SRCML_LANGUAGE_C) != SRCML_STATUS_OK)
-        NDEBUG_EXECUTE(srcml_unit_set_language(unit, SRCML_LANGUAGE_C))
+    constructEmpty_analysis(analysis, options.enabledMetrics);
 
-        VERBOSE_MSG_VARIADIC("SRCML_SET_FILENAME = %s", infile);
+    /* The partials are written after each merge instead, see below */
+    analysis->isReportingUnits = isStreamingReport();
 
-        /* Set filename */
-        DEBUG_ERROR_IF(srcml_unit_set_filename(unit, infile) != SRCML_STATUS_OK)
-        NDEBUG_EXECUTE(srcml_unit_set_filename(unit, infile))
+    if (isParallelMetrics() || isCaching()) {
+        Analysis const* partial;
+
+        /* The archive is never written, it only provides the unit defaults */
+        struct srcml_archive* const archive = srcml_archive_create();
+        VERBOSE_MSG_LITERAL("CREATED_PARALLEL_SRCML_ARCHIVE");
+
+        /* The parsers also evaluate their units, or load them from the cache, each in a partial Analysis */
+        constructEmpty_ppool(pool, archive, options.cmd_infiles, options.n_cmd_infiles, options.n_jobs, options.enabledMetrics);
+
+        startStream_analysis(analysis);
+
+        /* Merging in input order gives the same rows as the serial evaluation */
+        while ((partial = nextAnalysis_ppool(pool)) != NULL) {
+            merge_analysis(analysis, partial);
+
+            if (isStreamingReport()) {
+                DEBUG_ASSERT_NDEBUG_EXECUTE(reportNewRowsCsv(analysis))
+            }
+        }
+
+        /* The infiles before the missing one are merged, as in the serial run, so stop the parsers first */
+        if (pool->failedInfile != NULL) {
+            char const* const failedInfile = pool->failedInfile;
+            free_ppool(pool);
+            srcml_archive_free(archive);
+            showFileNOTFoundError(failedInfile);
+            free_analysis(analysis);
+            return EXIT_FAILURE;
+        }
 
-        /* Read the unit file */
-        FILE* const stream = fopen(infile, "r");
-        if (stream == NULL) { showFileNOTFoundError(infile); return EXIT_FAILURE; }
+        endStream_analysis(analysis);
 
-        DEBUG_ERROR_IF(fromStreamAsWhole_chunk(chunk, stream) == 0xFFFFFFFF)
-        NDEBUG_EXECUTE(fromStreamAsWhole_chunk(chunk, stream))
+        VERBOSE_MSG_LITERAL("PARALLEL_METRICS_COMPLETED");
 
-        DEBUG_ERROR_IF(fclose(stream) == EOF)
-        NDEBUG_EXECUTE(fclose(stream))
+        /* Stop the parsers */
+        free_ppool(pool);
 
-        VERBOSE_MSG_VARIADIC("SRCML_UNIT_PARSE => %llu bytes", chunk->len);
+        /* Free the archive */
+        srcml_archive_free(archive);
 
-        /* Create the unit */
-        DEBUG_ERROR_IF(srcml_unit_parse_memory(unit, chunk->start, chunk->len) != SRCML_STATUS_OK)
-        NDEBUG_EXECUTE(srcml_unit_parse_memory(unit, chunk->start, chunk->len))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(reportCsv(analysis))
 
-        VERBOSE_MSG_VARIADIC("SRCML_ARCHIVE_WRITE => %s", infile);
+        VERBOSE_MSG_LITERAL("REPORT_CSV_COMPLETED");
+
+        free_analysis(analysis);
+
+        return EXIT_SUCCESS;
+    }
+
+    if (isStreaming()) {
+        /* The archive is never written, it only provides the unit defaults */
+        struct srcml_archive* const archive = srcml_archive_create();
+        VERBOSE_MSG_LITERAL("CREATED_STREAMING_SRCML_ARCHIVE");
+
+        constructEmpty_ppool(pool, archive, options.cmd_infiles, options.n_cmd_infiles, options.n_jobs, 0);
+
+        startStream_analysis(analysis);
+
+        while ((unit = nextUnit_ppool(pool)) != NULL) {
+            /* The srcML of the unit is valid until the unit is freed */
+            char const* const unit_srcml = srcml_unit_get_srcml(unit);
+            DEBUG_ERROR_IF(unit_srcml == NULL)
+
+            VERBOSE_MSG_VARIADIC("SRCSAX_PARSE => %s", srcml_unit_get_filename(unit));
+
+            streamUnit_analysis(analysis, unit_srcml, strlen(unit_srcml));
+
+            VERBOSE_MSG_VARIADIC("SRCML_FREE => %s", srcml_unit_get_filename(unit));
+
+            /* The metrics are done with the unit, and its rows are written at its end, free it before taking the next one */
+            srcml_unit_free(unit);
+        }
+
+        if (pool->failedInfile != NULL) {
+            char const* const failedInfile = pool->failedInfile;
+            free_ppool(pool);
+            srcml_archive_free(archive);
+            showFileNOTFoundError(failedInfile);
+            free_analysis(analysis);
+            return EXIT_FAILURE;
+        }
+
+        endStream_analysis(analysis);
+
+        VERBOSE_MSG_LITERAL("SRCSAX_STREAM_COMPLETED");
+
+        /* Stop the parsers */
+        free_ppool(pool);
+
+        /* Free the archive */
+        srcml_archive_free(archive);
+
+        DEBUG_ASSERT_NDEBUG_EXECUTE(reportCsv(analysis))
+
+        VERBOSE_MSG_LITERAL("REPORT_CSV_COMPLETED");
+
+        free_analysis(analysis);
+
+        return EXIT_SUCCESS;
+    }
+
+    size_t archiveBufferSize            = 0;
+    char* archiveBuffer                 = NULL;
+    struct srcml_archive* const archive = srcml_archive_create();
+
+    /* The parsers clone the archive, so start them before opening it */
+    constructEmpty_ppool(pool, archive, options.cmd_infiles, options.n_cmd_infiles, options.n_jobs, 0);
+
+    DEBUG_ERROR_IF(srcml_archive_write_open_memory(archive, &archiveBuffer, &archiveBufferSize) != SRCML_STATUS_OK)
+    NDEBUG_EXECUTE(srcml_archive_write_open_memory(archive, &archiveBuffer, &archiveBufferSize))
+    VERBOSE_MSG_LITERAL("CREATED_EMPTY_SRCML_ARCHIVE");
+
+    /* The units arrive in input order, whichever parser finishes first */
+    while ((unit = nextUnit_ppool(pool)) != NULL) {
+        VERBOSE_MSG_VARIADIC("SRCML_ARCHIVE_WRITE => %s", srcml_unit_get_filename(unit));
 
         /* Append to the archive */
+        uint64_t const start = start_profile(analysis->profile);
         DEBUG_ERROR_IF(srcml_archive_write_unit(archive, unit) != SRCML_STATUS_OK)
         NDEBUG_EXECUTE(srcml_archive_write_unit(archive, unit))
+        stop_profile(analysis->profile, PROFILE_ARCHIVE_WRITE, start);
 
-        VERBOSE_MSG_VARIADIC("SRCML_FREE => %s", infile);
+        VERBOSE_MSG_VARIADIC("SRCML_FREE => %s", srcml_unit_get_filename(unit));
 
         /* Copied the unit to the archive, now free the dangling unit */
         srcml_unit_free(unit);
+    }
 
-        /* Flush the chunk */
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(chunk))
+    if (pool->failedInfile != NULL) {
+        char const* const failedInfile = pool->failedInfile;
+        free_ppool(pool);
+        srcml_archive_close(archive);
+        srcml_archive_free(archive);
+        showFileNOTFoundError(failedInfile);
+        free_analysis(analysis);
+        return EXIT_FAILURE;
     }
 
-    /* Free the chunk */
-    DEBUG_ASSERT_NDEBUG_EXECUTE(free_chunk(chunk))
+    /* Stop the parsers */
+    free_ppool(pool);
 
     /* Close the archive */
     srcml_archive_close(archive);
@@ -934,24 +1252,13 @@ SRCMETRICS_NEXT_OPTION_CHAR:
     srcml_archive_free(archive);
 
     /* Second Task: Do srcsax stuff on the archive */
-    struct srcsax_context* context = srcsax_create_context_memory(archiveBuffer, archiveBufferSize, NULL);
-    DEBUG_ERROR_IF(context == NULL)
-
-    /* VERY IMPORTANT, DO NOT FORGET */
-    context->handler = getStaticEventHandler();
-
-    VERBOSE_MSG_LITERAL("SRCSAX_CONTEXT_CREATED");
-
-    DEBUG_ERROR_IF(srcsax_parse(context) == -1)
-    NDEBUG_EXECUTE(srcsax_parse(context))
-
-    VERBOSE_MSG_LITERAL("SRCSAX_PARSE_COMPLETED");
+    run_analysis(analysis, archiveBuffer, archiveBufferSize);
 
-    DEBUG_ASSERT_NDEBUG_EXECUTE(reportCsv())
+    DEBUG_ASSERT_NDEBUG_EXECUTE(reportCsv(analysis))
 
     VERBOSE_MSG_LITERAL("REPORT_CSV_COMPLETED");
 
-    srcsax_free_context(context);
+    free_analysis(analysis);
 
     return EXIT_SUCCESS;
 }
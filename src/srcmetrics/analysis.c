@@ -0,0 +1,286 @@
+/**
+ * @file analysis.c
+ * @brief Implements functions defined in analysis.h.
+ * @author Yavuz Koroglu
+ * @see analysis.h
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/event.h"
+#include "srcmetrics/interner.h"
+#include "srcmetrics/metrics.h"
+#include "srcmetrics/profile.h"
+#include "srcmetrics/result.h"
+#include "padkit/chunk.h"
+#include "padkit/debug.h"
+
+void constructEmpty_analysis(Analysis* const analysis, uint_fast64_t const enabledMetrics) {
+    DEBUG_ERROR_IF(analysis == NULL)
+
+    /* Every metric state starts invalid, i.e., zeroed, until its start document event */
+    memset(analysis, 0, sizeof(Analysis));
+
+    analysis->enabledMetrics = enabledMetrics;
+    analysis->currentUnit_id = 0xFFFFFFFF;
+    analysis->currentFn_id   = 0xFFFFFFFF;
+    analysis->profile        = new_profile();
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_chunk(analysis->strings, CHUNK_RECOMMENDED_PARAMETERS))
+}
+
+void constructEmptyPartial_analysis(Analysis* const analysis, uint_fast64_t const enabledMetrics) {
+    constructEmpty_analysis(analysis, enabledMetrics);
+    analysis->isPartial = 1;
+}
+
+void free_analysis(Analysis* const analysis) {
+    DEBUG_ASSERT(isValid_analysis(analysis))
+
+    free_abc(analysis->abc);
+    free_ams(analysis->ams);
+    free_cc(analysis->cc);
+    free_hsm(analysis->hsm);
+    free_mc(analysis->mc);
+    free_mnd(analysis->mnd);
+    free_npm(analysis->npm);
+    free_rfu(analysis->rfu);
+    free_sloc(analysis->sloc);
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_chunk(analysis->strings))
+    free_interner(analysis->interner);
+
+    for (Arena* arena = analysis->arenas; arena < analysis->arenas + METRICS_COUNT_MAX; arena++)
+        free_arena(arena);
+
+    free(analysis->eventsAtStartElement);
+    free(analysis->eventsAtEndElement);
+    free(analysis->mergedEntity_ids);
+
+    /* The output of the server outlives the Analysis, see report_server() */
+    if (isOpen_writer(analysis->writer)) close_writer(analysis->writer);
+
+    free_profile(analysis->profile);
+
+    memset(analysis, 0, sizeof(Analysis));
+}
+
+void trim_analysis(Analysis* const analysis) {
+    DEBUG_ASSERT(isValid_analysis(analysis))
+    DEBUG_ERROR_IF(!analysis->isPartial)
+
+    trim_cc(analysis->cc);
+
+    for (Arena* arena = analysis->arenas; arena < analysis->arenas + METRICS_COUNT_MAX; arena++)
+        free_arena(arena);
+}
+
+bool isValid_analysis(Analysis const* const analysis) {
+    return analysis != NULL && isValid_chunk(analysis->strings) && isValid_interner(analysis->interner);
+}
+
+void merge_analysis(Analysis* const analysis, Analysis const* const partial) {
+    static char const* metrics[] = METRICS;
+    static Merge merges[]        = MERGES;
+
+    DEBUG_ASSERT(isValid_analysis(analysis))
+    DEBUG_ASSERT(isValid_analysis(partial))
+    DEBUG_ERROR_IF(analysis->isPartial)
+    DEBUG_ERROR_IF(!partial->isPartial)
+
+    /* No entity of the partial is copied yet, see mergeStatistics_analysis() */
+    uint32_t const entity_count = partial->strings->nStrings;
+    if (entity_count > analysis->mergedEntity_cap) {
+        uint32_t new_cap = analysis->mergedEntity_cap > 0 ? analysis->mergedEntity_cap : UNIT_COUNT_GUESS;
+        while (new_cap < entity_count) new_cap <<= 1;
+
+        uint32_t* const new_ids = realloc(analysis->mergedEntity_ids, (size_t)new_cap * sizeof(uint32_t));
+        DEBUG_ERROR_IF(new_ids == NULL)
+
+        analysis->mergedEntity_ids = new_ids;
+        analysis->mergedEntity_cap = new_cap;
+    }
+    memset(analysis->mergedEntity_ids, 0xFF, (size_t)entity_count * sizeof(uint32_t));
+
+    char const** metric = metrics;
+    size_t metricId     = 0;
+    for (uint_fast64_t enabledMetrics = analysis->enabledMetrics & partial->enabledMetrics;
+        *metric && metricId < METRICS_COUNT_MAX;
+        (metric++, metricId++, enabledMetrics >>= 1)
+    ) {
+        if (!(enabledMetrics & 1) || merges[metricId] == NULL) continue;
+        merges[metricId](analysis, partial);
+    }
+}
+
+void mergeStatistics_analysis(
+    Analysis* const          analysis,
+    ResultTable* const       statistics,
+    Analysis const* const    partial,
+    ResultTable const* const partialStatistics
+) {
+    DEBUG_ASSERT(isValid_rtable(statistics))
+
+    /* A metric that never started has nothing to merge */
+    if (!isValid_rtable(partialStatistics)) return;
+
+    for (
+        Result const* result = partialStatistics->results;
+        result < partialStatistics->results + partialStatistics->size;
+        result++
+    ) {
+        uint32_t entity_id = result->entity_id;
+        if (entity_id != RESULT_OVERALL) {
+            DEBUG_ERROR_IF(entity_id >= analysis->mergedEntity_cap)
+
+            /* Every metric of the partial names the same entities, so each one is copied once */
+            if (analysis->mergedEntity_ids[entity_id] == 0xFFFFFFFF) {
+                char const* const entity = get_chunk(partial->strings, entity_id);
+                DEBUG_ERROR_IF(entity == NULL)
+
+                uint64_t const entity_len = strlen_chunk(partial->strings, entity_id);
+                DEBUG_ERROR_IF(entity_len == 0xFFFFFFFFFFFFFFFF)
+
+                analysis->mergedEntity_ids[entity_id] = intern_interner(
+                    analysis->interner, analysis->strings, entity, entity_len
+                );
+                DEBUG_ERROR_IF(analysis->mergedEntity_ids[entity_id] == 0xFFFFFFFF)
+            }
+            entity_id = analysis->mergedEntity_ids[entity_id];
+        }
+
+        DEBUG_ASSERT_NDEBUG_EXECUTE(
+            insert_rtable(statistics, entity_id, result->metric_id, result->sub_id, result->value)
+        )
+    }
+}
+
+void flushRows_analysis(Analysis* const analysis) {
+    DEBUG_ASSERT(isValid_analysis(analysis))
+
+    /* A disabled metric has no ResultTable, so flushing it fails harmlessly */
+    flush_rtable(analysis->abc->statistics);
+    flush_rtable(analysis->ams->statistics);
+    flush_rtable(analysis->cc->statistics);
+    flush_rtable(analysis->hsm->statistics);
+    flush_rtable(analysis->mc->statistics);
+    flush_rtable(analysis->mnd->statistics);
+    flush_rtable(analysis->npm->statistics);
+    flush_rtable(analysis->rfu->statistics);
+    flush_rtable(analysis->sloc->statistics);
+
+    memset(analysis->reportedRowCounts, 0, sizeof(analysis->reportedRowCounts));
+}
+
+void run_analysis(Analysis* const analysis, char const* const srcml, size_t const srcml_size) {
+    DEBUG_ASSERT(isValid_analysis(analysis))
+    DEBUG_ERROR_IF(srcml == NULL)
+
+    struct srcsax_context* const context = srcsax_create_context_memory(srcml, srcml_size, NULL);
+    DEBUG_ERROR_IF(context == NULL)
+
+    /* VERY IMPORTANT, DO NOT FORGET */
+    context->handler = getStaticEventHandler();
+    context->data    = analysis;
+
+    VERBOSE_MSG_LITERAL("SRCSAX_CONTEXT_CREATED");
+
+    uint64_t const start = start_profile(analysis->profile);
+    DEBUG_ERROR_IF(srcsax_parse(context) == -1)
+    NDEBUG_EXECUTE(srcsax_parse(context))
+    stop_profile(analysis->profile, PROFILE_SRCSAX_PARSE, start);
+
+    VERBOSE_MSG_LITERAL("SRCSAX_PARSE_COMPLETED");
+
+    srcsax_free_context(context);
+}
+
+void startStream_analysis(Analysis* const analysis) {
+    DEBUG_ASSERT(isValid_analysis(analysis))
+    startStream_event(analysis);
+}
+
+void streamUnit_analysis(Analysis* const analysis, char const* const unit_srcml, size_t const unit_srcml_size) {
+    DEBUG_ASSERT(isValid_analysis(analysis))
+    DEBUG_ERROR_IF(unit_srcml == NULL)
+
+    struct srcsax_context* const context = srcsax_create_context_memory(unit_srcml, unit_srcml_size, NULL);
+    DEBUG_ERROR_IF(context == NULL)
+
+    /* VERY IMPORTANT, DO NOT FORGET */
+    context->handler = getStreamingEventHandler();
+    context->data    = analysis;
+
+    uint64_t const start = start_profile(analysis->profile);
+    DEBUG_ERROR_IF(srcsax_parse(context) == -1)
+    NDEBUG_EXECUTE(srcsax_parse(context))
+    stop_profile(analysis->profile, PROFILE_SRCSAX_PARSE, start);
+
+    srcsax_free_context(context);
+}
+
+void runUnit_analysis(Analysis* const analysis, char const* const unit_srcml, size_t const unit_srcml_size) {
+    DEBUG_ASSERT(isValid_analysis(analysis))
+    DEBUG_ERROR_IF(!analysis->isPartial)
+
+    /* The previous unit is merged, so its strings are garbage now */
+    DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(analysis->strings))
+    flush_interner(analysis->interner);
+
+    startStream_event(analysis);
+    streamUnit_analysis(analysis, unit_srcml, unit_srcml_size);
+}
+
+bool saveUnit_analysis(Analysis const* const analysis, FILE* const stream) {
+    static char const* metrics[] = METRICS;
+    static Save saves[]          = SAVES;
+
+    DEBUG_ASSERT(isValid_analysis(analysis))
+    DEBUG_ERROR_IF(!analysis->isPartial)
+    DEBUG_ERROR_IF(stream == NULL)
+
+    char const** metric = metrics;
+    size_t metricId     = 0;
+    for (uint_fast64_t enabledMetrics = analysis->enabledMetrics;
+        *metric && metricId < METRICS_COUNT_MAX;
+        (metric++, metricId++, enabledMetrics >>= 1)
+    ) {
+        if (!(enabledMetrics & 1) || saves[metricId] == NULL) continue;
+        if (!saves[metricId](stream, analysis)) return 0;
+    }
+
+    return 1;
+}
+
+bool loadUnit_analysis(Analysis* const analysis, FILE* const stream) {
+    static char const* metrics[] = METRICS;
+    static Load loads[]          = LOADS;
+
+    DEBUG_ASSERT(isValid_analysis(analysis))
+    DEBUG_ERROR_IF(!analysis->isPartial)
+    DEBUG_ERROR_IF(stream == NULL)
+
+    /* Start the metric states as if the unit was evaluated, see runUnit_analysis() */
+    DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(analysis->strings))
+    flush_interner(analysis->interner);
+    startStream_event(analysis);
+
+    char const** metric = metrics;
+    size_t metricId     = 0;
+    for (uint_fast64_t enabledMetrics = analysis->enabledMetrics;
+        *metric && metricId < METRICS_COUNT_MAX;
+        (metric++, metricId++, enabledMetrics >>= 1)
+    ) {
+        if (!(enabledMetrics & 1) || loads[metricId] == NULL) continue;
+        if (!loads[metricId](analysis, stream)) return 0;
+    }
+
+    return 1;
+}
+
+void endStream_analysis(Analysis* const analysis) {
+    DEBUG_ASSERT(isValid_analysis(analysis))
+    endStream_event(analysis);
+}
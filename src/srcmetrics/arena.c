@@ -0,0 +1,90 @@
+/**
+ * @file arena.c
+ * @brief Implements functions defined in arena.h.
+ * @author Yavuz Koroglu
+ * @see arena.h
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "srcmetrics/arena.h"
+#include "srcmetrics/sizing.h"
+#include "padkit/debug.h"
+
+uint64_t append_arena(Arena* const arena, char const* const bytes, uint64_t const len) {
+    DEBUG_ASSERT(isValid_arena(arena))
+    DEBUG_ERROR_IF(bytes == NULL && len > 0)
+
+    /* The region is allocated with the first bytes, and doubles from there */
+    if (arena->len + len > arena->cap) {
+        uint64_t new_cap = arena->cap > 0 ? arena->cap : ARENA_INITIAL_CAP;
+        while (new_cap < arena->len + len) new_cap <<= 1;
+        charge_sizing(arena->cap, new_cap);
+
+        char* const new_bytes = realloc(arena->bytes, (size_t)new_cap);
+        DEBUG_ERROR_IF(new_bytes == NULL)
+
+        arena->bytes = new_bytes;
+        arena->cap   = new_cap;
+    }
+
+    uint64_t const offset = arena->len;
+    if (len > 0) memcpy(arena->bytes + offset, bytes, (size_t)len);
+    arena->len += len;
+
+    return offset;
+}
+
+void endFn_arena(Arena* const arena) {
+    DEBUG_ASSERT(isValid_arena(arena))
+    DEBUG_ERROR_IF(arena->fn_len > arena->len)
+
+    arena->len    = arena->fn_len;
+    arena->fn_len = 0;
+}
+
+void free_arena(Arena* const arena) {
+    DEBUG_ASSERT(isValid_arena(arena))
+
+    free(arena->bytes);
+    charge_sizing(arena->cap, 0);
+
+    *arena = NOT_AN_ARENA;
+}
+
+char* get_arena(Arena const* const arena, uint64_t const offset) {
+    DEBUG_ASSERT(isValid_arena(arena))
+    DEBUG_ERROR_IF(offset > arena->len)
+
+    return arena->bytes + offset;
+}
+
+bool isValid_arena(Arena const* const arena) {
+    return arena != NULL && (arena->cap == 0 || arena->bytes != NULL) && arena->len <= arena->cap && arena->fn_len <= arena->cap;
+}
+
+uint64_t mark_arena(Arena const* const arena) {
+    DEBUG_ASSERT(isValid_arena(arena))
+
+    return arena->len;
+}
+
+void release_arena(Arena* const arena, uint64_t const mark) {
+    DEBUG_ASSERT(isValid_arena(arena))
+    DEBUG_ERROR_IF(mark > arena->len)
+
+    arena->len = mark;
+}
+
+void reset_arena(Arena* const arena) {
+    DEBUG_ASSERT(isValid_arena(arena))
+
+    arena->len    = 0;
+    arena->fn_len = 0;
+}
+
+void startFn_arena(Arena* const arena) {
+    DEBUG_ASSERT(isValid_arena(arena))
+
+    arena->fn_len = arena->len;
+}
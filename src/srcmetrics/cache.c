@@ -0,0 +1,350 @@
+/**
+ * @file cache.c
+ * @brief Implements functions defined in cache.h.
+ * @author Yavuz Koroglu
+ * @see cache.h
+ */
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/cache.h"
+#include "srcmetrics/interner.h"
+#include "srcmetrics/profile.h"
+#include "srcmetrics/result.h"
+#include "srcmetrics/source.h"
+#include "padkit/chunk.h"
+#include "padkit/debug.h"
+
+/* The flags that change the rows of a partial Analysis */
+#define CACHE_FLAGS             (FLAG_CG_NO_EXTERNAL | FLAG_RFU_SIMPLE | FLAG_RFU_SHOW | FLAG_CC_SHOW)
+
+#define FNV_OFFSET_BASIS        0xCBF29CE484222325ULL
+#define FNV_PRIME               0x00000100000001B3ULL
+
+/* A different basis for the content check, so a name collision is NOT a hit */
+#define CONTENT_OFFSET_BASIS    0x84222325CBF29CE4ULL
+
+/* How a cached row names its entity */
+#define ENTITY_OVERALL          0
+#define ENTITY_PREVIOUS         1
+#define ENTITY_NEW              2
+
+static pthread_mutex_t tmpMutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned        tmpCount = 0;
+
+static uint64_t fnv1a(uint64_t hash, char const* const bytes, uint64_t const len) {
+    for (char const* byte = bytes; byte < bytes + len; byte++) {
+        hash ^= (unsigned char)*byte;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Builds the key of an infile, i.e., everything a cache entry depends on except the contents.
+ * @return A malloc'ed string the caller must free.
+ */
+static char* newKey(char const* const infile) {
+    char const* const srcml_version = srcml_version_string();
+    int const         len           = snprintf(
+        NULL, 0, "%s\n%s\n%016llx\n%016llx\n%s", VERSION_SRCMETRICS, srcml_version,
+        (unsigned long long)options.enabledMetrics, (unsigned long long)(options.flags & CACHE_FLAGS), infile
+    );
+    DEBUG_ERROR_IF(len < 0)
+
+    char* const key = malloc((size_t)len + 1);
+    DEBUG_ERROR_IF(key == NULL)
+
+    snprintf(
+        key, (size_t)len + 1, "%s\n%s\n%016llx\n%016llx\n%s", VERSION_SRCMETRICS, srcml_version,
+        (unsigned long long)options.enabledMetrics, (unsigned long long)(options.flags & CACHE_FLAGS), infile
+    );
+    return key;
+}
+
+/**
+ * @brief Builds the path of the cache entry of a key and its contents.
+ * @return A malloc'ed string the caller must free.
+ */
+static char* newPath(char const* const key, Source const* const source) {
+    uint64_t const hash = fnv1a(fnv1a(FNV_OFFSET_BASIS, key, strlen(key)), source->start, source->len);
+
+    size_t const len  = strlen(options.cache_dir) + 1 + 16 + sizeof(CACHE_FILE_EXTENSION);
+    char* const  path = malloc(len);
+    DEBUG_ERROR_IF(path == NULL)
+
+    snprintf(path, len, "%s/%016llx" CACHE_FILE_EXTENSION, options.cache_dir, (unsigned long long)hash);
+    return path;
+}
+
+void prepare_cache(void) {
+    #ifdef _WIN32
+        if (mkdir(options.cache_dir) == 0 || errno == EEXIST) return;
+    #else
+        if (mkdir(options.cache_dir, 0777) == 0 || errno == EEXIST) return;
+    #endif
+
+    fprintf(stderr, "\n"
+                    "Cache directory '%s' could NOT be created\n"
+                    "\n", options.cache_dir);
+    exit(EXIT_FAILURE);
+}
+
+bool load_cache(Analysis* const partial, char const* const infile, Source const* const source) {
+    DEBUG_ASSERT(isValid_analysis(partial))
+    DEBUG_ERROR_IF(infile == NULL)
+    DEBUG_ASSERT(isValid_source(source))
+
+    uint64_t const start = start_profile(partial->profile);
+    char* const    key   = newKey(infile);
+    char* const    path  = newPath(key, source);
+
+    FILE* const stream = fopen(path, "rb");
+    free(path);
+    if (stream == NULL) {
+        free(key);
+        VERBOSE_MSG_VARIADIC("CACHE_MISS => %s", infile);
+        return 0;
+    }
+
+    /* Compare the header, then load the rows */
+    uint64_t magic, source_len, source_hash, trailer;
+    bool isHit = readUnsigned_cache(stream, &magic) && magic == CACHE_MAGIC;
+
+    if (isHit) {
+        uint32_t const key_id = readString_cache(stream, partial->strings);
+        isHit = key_id != 0xFFFFFFFF && strcmp(get_chunk(partial->strings, key_id), key) == 0;
+    }
+
+    isHit = isHit
+        && readUnsigned_cache(stream, &source_len) && source_len == source->len
+        && readUnsigned_cache(stream, &source_hash)
+        && source_hash == fnv1a(CONTENT_OFFSET_BASIS, source->start, source->len)
+        && loadUnit_analysis(partial, stream)
+        && readUnsigned_cache(stream, &trailer) && trailer == CACHE_MAGIC;
+
+    fclose(stream);
+    free(key);
+
+    if (isHit) {
+        stop_profile(partial->profile, PROFILE_CACHE_LOAD, start);
+        VERBOSE_MSG_VARIADIC("CACHE_HIT => %s", infile);
+    } else {
+        VERBOSE_MSG_VARIADIC("CACHE_MISS => %s", infile);
+    }
+    return isHit;
+}
+
+void save_cache(Analysis const* const partial, char const* const infile, Source const* const source) {
+    DEBUG_ASSERT(isValid_analysis(partial))
+    DEBUG_ERROR_IF(infile == NULL)
+    DEBUG_ASSERT(isValid_source(source))
+
+    uint64_t const start = start_profile(partial->profile);
+    char* const    key   = newKey(infile);
+    char* const    path  = newPath(key, source);
+
+    pthread_mutex_lock(&tmpMutex);
+    unsigned const tmp_id = tmpCount++;
+    pthread_mutex_unlock(&tmpMutex);
+
+    size_t const tmp_len = strlen(path) + 32;
+    char* const  tmp     = malloc(tmp_len);
+    DEBUG_ERROR_IF(tmp == NULL)
+    snprintf(tmp, tmp_len, "%s.%ld.%u", path, (long)getpid(), tmp_id);
+
+    FILE* const stream = fopen(tmp, "wb");
+    if (stream != NULL) {
+        bool const isSaved = writeUnsigned_cache(stream, CACHE_MAGIC)
+            && writeString_cache(stream, key, strlen(key))
+            && writeUnsigned_cache(stream, source->len)
+            && writeUnsigned_cache(stream, fnv1a(CONTENT_OFFSET_BASIS, source->start, source->len))
+            && saveUnit_analysis(partial, stream)
+            && writeUnsigned_cache(stream, CACHE_MAGIC);
+
+        if (fclose(stream) == 0 && isSaved && rename(tmp, path) == 0) {
+            stop_profile(partial->profile, PROFILE_CACHE_SAVE, start);
+            VERBOSE_MSG_VARIADIC("CACHE_SAVED => %s", infile);
+        } else {
+            remove(tmp);
+        }
+    }
+
+    free(tmp);
+    free(path);
+    free(key);
+}
+
+bool readUnsigned_cache(FILE* const stream, uint64_t* const value) {
+    return fread(value, sizeof(uint64_t), 1, stream) == 1;
+}
+
+bool writeUnsigned_cache(FILE* const stream, uint64_t const value) {
+    return fwrite(&value, sizeof(uint64_t), 1, stream) == 1;
+}
+
+uint32_t readString_cache(FILE* const stream, Chunk* const chunk) {
+    char     buffer[BUFSIZ];
+    uint64_t len;
+    uint64_t piece_len;
+
+    if (!readUnsigned_cache(stream, &len)) return 0xFFFFFFFF;
+
+    /* Read the first piece as a new string, and append the rest */
+    piece_len = len < BUFSIZ ? len : BUFSIZ;
+    if (fread(buffer, 1, piece_len, stream) != piece_len) return 0xFFFFFFFF;
+
+    uint32_t const str_id = add_chunk(chunk, buffer, piece_len);
+    if (str_id == 0xFFFFFFFF) return 0xFFFFFFFF;
+
+    for (len -= piece_len; len > 0; len -= piece_len) {
+        piece_len = len < BUFSIZ ? len : BUFSIZ;
+        if (fread(buffer, 1, piece_len, stream) != piece_len) return 0xFFFFFFFF;
+        if (append_chunk(chunk, buffer, piece_len) == NULL)   return 0xFFFFFFFF;
+    }
+
+    return str_id;
+}
+
+bool writeString_cache(FILE* const stream, char const* const str, uint64_t const len) {
+    return writeUnsigned_cache(stream, len) && fwrite(str, 1, len, stream) == len;
+}
+
+/**
+ * @brief Reads the rows of readStatistics_cache(), reading every new entity into a scratch Chunk first.
+ * @return 0 if the entry ends, 1 otherwise.
+ */
+static bool readRows(FILE* const stream, Analysis* const partial, ResultTable* const statistics, Chunk* const names) {
+    uint64_t row_count;
+    if (!readUnsigned_cache(stream, &row_count)) return 0;
+
+    uint32_t previous_id = RESULT_OVERALL;
+    while (row_count--) {
+        uint64_t entity_tag, metric_id, sub_id, type_code, raw;
+
+        if (!readUnsigned_cache(stream, &entity_tag)) return 0;
+
+        uint32_t entity_id;
+        switch (entity_tag) {
+            case ENTITY_OVERALL:
+                entity_id = RESULT_OVERALL;
+                break;
+            case ENTITY_PREVIOUS:
+                if (previous_id == RESULT_OVERALL) return 0;
+                entity_id = previous_id;
+                break;
+            case ENTITY_NEW: {
+                uint32_t const name_id = readString_cache(stream, names);
+                if (name_id == 0xFFFFFFFF) return 0;
+
+                /* Every metric of the entry names the same entities, so the partial keeps one copy of each */
+                entity_id = previous_id = intern_interner(
+                    partial->interner, partial->strings, get_chunk(names, name_id), strlen_chunk(names, name_id)
+                );
+                DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(names))
+                if (entity_id == 0xFFFFFFFF) return 0;
+                break;
+            }
+            default:
+                return 0;
+        }
+
+        if (!readUnsigned_cache(stream, &metric_id))    return 0;
+        if (!readUnsigned_cache(stream, &sub_id))       return 0;
+        if (!readUnsigned_cache(stream, &type_code))    return 0;
+        if (!readUnsigned_cache(stream, &raw))          return 0;
+        if (metric_id >= METRICS_COUNT_MAX)             return 0;
+        if (sub_id >= SUBMETRICS_COUNT_MAX)             return 0;
+
+        Value value;
+        switch (type_code) {
+            case VAL_TC_FLOAT: {
+                uint32_t const bits = (uint32_t)raw;
+                float          as_float;
+                memcpy(&as_float, &bits, sizeof(float));
+                value = VAL_FLOAT(as_float);
+                break;
+            }
+            case VAL_TC_INT:
+                value = VAL_INT((int)(int64_t)raw);
+                break;
+            case VAL_TC_UNSIGNED:
+                value = VAL_UNSIGNED((unsigned)raw);
+                break;
+            default:
+                return 0;
+        }
+
+        DEBUG_ASSERT_NDEBUG_EXECUTE(
+            insert_rtable(statistics, entity_id, (uint16_t)metric_id, (uint16_t)sub_id, value)
+        )
+    }
+
+    return 1;
+}
+
+bool readStatistics_cache(FILE* const stream, Analysis* const partial, ResultTable* const statistics) {
+    DEBUG_ASSERT(isValid_rtable(statistics))
+
+    Chunk names[1] = { NOT_A_CHUNK };
+    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_chunk(names, BUFSIZ, 1))
+
+    bool const isRead = readRows(stream, partial, statistics, names);
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_chunk(names))
+    return isRead;
+}
+
+bool writeStatistics_cache(FILE* const stream, Analysis const* const partial, ResultTable const* const statistics) {
+    /* A metric that never started has no rows */
+    if (!isValid_rtable(statistics)) return writeUnsigned_cache(stream, 0);
+
+    if (!writeUnsigned_cache(stream, statistics->size)) return 0;
+
+    uint32_t previous_id = RESULT_OVERALL;
+    for (Result const* result = statistics->results; result < statistics->results + statistics->size; result++) {
+        uint64_t raw;
+        switch (result->value.type_code) {
+            case VAL_TC_FLOAT: {
+                uint32_t bits;
+                memcpy(&bits, &result->value.raw.as_float, sizeof(float));
+                raw = bits;
+                break;
+            }
+            case VAL_TC_INT:
+                raw = (uint64_t)(int64_t)result->value.raw.as_int;
+                break;
+            case VAL_TC_UNSIGNED:
+                raw = result->value.raw.as_unsigned;
+                break;
+            default:
+                return 0;
+        }
+
+        if (result->entity_id == RESULT_OVERALL) {
+            if (!writeUnsigned_cache(stream, ENTITY_OVERALL)) return 0;
+        } else if (result->entity_id == previous_id) {
+            if (!writeUnsigned_cache(stream, ENTITY_PREVIOUS)) return 0;
+        } else {
+            char const* const entity = get_chunk(partial->strings, result->entity_id);
+            DEBUG_ERROR_IF(entity == NULL)
+
+            if (!writeUnsigned_cache(stream, ENTITY_NEW))                                              return 0;
+            if (!writeString_cache(stream, entity, strlen_chunk(partial->strings, result->entity_id))) return 0;
+            previous_id = result->entity_id;
+        }
+
+        if (!writeUnsigned_cache(stream, result->metric_id))                    return 0;
+        if (!writeUnsigned_cache(stream, result->sub_id))                       return 0;
+        if (!writeUnsigned_cache(stream, (uint64_t)result->value.type_code))    return 0;
+        if (!writeUnsigned_cache(stream, raw))                                  return 0;
+    }
+
+    return 1;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file columnar.c
+ * @brief Implements functions defined in columnar.h.
+ * @author Yavuz Koroglu
+ * @see columnar.h
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "srcmetrics.h"
+#include "srcmetrics/columnar.h"
+#include "srcmetrics/report.h"
+#include "srcmetrics/result.h"
+#include "padkit/chunkset.h"
+#include "padkit/debug.h"
+
+#define ALIGN(offset)   (((offset) + COLUMNAR_ALIGNMENT - 1) & ~(uint64_t)(COLUMNAR_ALIGNMENT - 1))
+
+/**
+ * @brief Pads a stream with zeros up to the offset of a section, and writes the section in one piece.
+ * @return 0 if the section cannot be written, 1 otherwise.
+ */
+static bool writeSection(FILE* const output, uint64_t* const pos, uint64_t const at, void const* const section, size_t const len) {
+    static char const zeros[COLUMNAR_ALIGNMENT] = { 0 };
+
+    DEBUG_ERROR_IF(at < *pos || at - *pos >= COLUMNAR_ALIGNMENT)
+    if (at > *pos && fwrite(zeros, 1, (size_t)(at - *pos), output) != (size_t)(at - *pos)) return 0;
+    if (len > 0 && fwrite(section, 1, len, output) != len)                                  return 0;
+
+    *pos = at + len;
+    return 1;
+}
+
+bool reportColumnar(Analysis const* const analysis) {
+    DEBUG_ERROR_IF(analysis == NULL)
+
+    static Report      reports[] = REPORTS;
+    ResultTable const* statistics[METRICS_COUNT_MAX] = { NULL };
+
+    /* Every row is one metric of one entity, so the rows bound the metrics and the entities */
+    uint64_t      n_rows         = 0;
+    uint_fast64_t enabledMetrics = analysis->enabledMetrics;
+    for (uint32_t report_id = 0; enabledMetrics; report_id++, enabledMetrics >>= 1) {
+        if (reports[report_id] == NULL || !(enabledMetrics & 1)) continue;
+        statistics[report_id] = reports[report_id](analysis);
+        if (statistics[report_id] == NULL || !isValid_rtable(statistics[report_id])) {
+            statistics[report_id] = NULL;
+            continue;
+        }
+        n_rows += statistics[report_id]->size;
+    }
+    DEBUG_ERROR_IF(n_rows >= COLUMNAR_NONE)
+
+    size_t const cap = n_rows > 0 ? (size_t)n_rows : 1;
+
+    uint32_t* const metric_names = malloc(cap * sizeof(uint32_t));
+    uint32_t* const entity_units = malloc(cap * sizeof(uint32_t));
+    uint32_t* const entity_fns   = malloc(cap * sizeof(uint32_t));
+    uint32_t* const row_entities = malloc(cap * sizeof(uint32_t));
+    uint32_t* const row_metrics  = malloc(cap * sizeof(uint32_t));
+    uint32_t* const row_values   = malloc(cap * sizeof(uint32_t));
+    uint8_t*  const row_types    = malloc(cap * sizeof(uint8_t));
+    DEBUG_ERROR_IF(metric_names == NULL || entity_units == NULL || entity_fns == NULL)
+    DEBUG_ERROR_IF(row_entities == NULL || row_metrics == NULL || row_values == NULL || row_types == NULL)
+
+    ChunkSet names[1];
+    ChunkSet metrics[1];
+    ChunkSet entities[1];
+    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_cset(names, CHUNK_SET_RECOMMENDED_PARAMETERS))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_cset(metrics, CHUNK_SET_RECOMMENDED_PARAMETERS))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_cset(entities, CHUNK_SET_RECOMMENDED_PARAMETERS))
+
+    /* Name every row by its metric and its entity, in the order of the CSV report */
+    uint32_t row_id = 0;
+    for (uint32_t report_id = 0; report_id < METRICS_COUNT_MAX; report_id++) {
+        if (statistics[report_id] == NULL) continue;
+
+        ResultTable const* const table = statistics[report_id];
+        for (Result const* result = table->results; result < table->results + table->size; result++, row_id++) {
+            char const* const metric     = nameOf_result(result);
+            uint64_t const    metric_len = strlen(metric);
+            uint32_t const    n_metrics  = getKeyCount_cset(metrics);
+            uint32_t const    metric_id  = addKey_cset(metrics, metric, metric_len);
+            DEBUG_ERROR_IF(metric_id == 0xFFFFFFFF)
+            if (metric_id == n_metrics) metric_names[metric_id] = addKey_cset(names, metric, metric_len);
+
+            row_metrics[row_id] = metric_id;
+            row_values[row_id]  = result->value.raw.as_unsigned;
+            row_types[row_id]   = (uint8_t)result->value.type_code;
+
+            if (result->entity_id == RESULT_OVERALL) {
+                row_entities[row_id] = COLUMNAR_NONE;
+                continue;
+            }
+
+            char const* const entity     = entityOf_result(result, analysis->strings);
+            uint64_t const    entity_len = strlen_chunk(analysis->strings, result->entity_id);
+            uint32_t const    n_entities = getKeyCount_cset(entities);
+            uint32_t const    entity_id  = addKey_cset(entities, entity, entity_len);
+            DEBUG_ERROR_IF(entity_id == 0xFFFFFFFF)
+
+            row_entities[row_id] = entity_id;
+            if (entity_id < n_entities) continue;
+
+            /*
+             * A function entity ends with "()", or with "::" if the function has no name, so a unit entity is
+             * never split. A unit name may have "::" in its path, the function name never does.
+             */
+            uint64_t   unit_len = entity_len;
+            bool const isFn     = entity_len >= 2 && (
+                (entity[entity_len - 2] == '(' && entity[entity_len - 1] == ')') ||
+                (entity[entity_len - 2] == ':' && entity[entity_len - 1] == ':')
+            );
+            for (uint64_t i = entity_len; isFn && i >= 2; i--) {
+                if (entity[i - 2] == ':' && entity[i - 1] == ':') {
+                    unit_len = i - 2;
+                    break;
+                }
+            }
+
+            entity_units[entity_id] = addKey_cset(names, entity, unit_len);
+            entity_fns[entity_id]   = unit_len == entity_len
+                ? COLUMNAR_NONE
+                : addKey_cset(names, entity + unit_len + 2, entity_len - unit_len - 2);
+        }
+    }
+
+    /* The dictionary is one blob, so it is written at once */
+    uint32_t const  n_names      = getKeyCount_cset(names);
+    uint64_t* const name_offsets = malloc((n_names > 0 ? (size_t)n_names : 1) * sizeof(uint64_t));
+    DEBUG_ERROR_IF(name_offsets == NULL)
+
+    uint64_t names_len = 0;
+    for (uint32_t name_id = 0; name_id < n_names; name_id++) {
+        name_offsets[name_id] = names_len;
+        names_len += strlen_cset(names, name_id) + 1;
+    }
+
+    char* const blob = malloc(names_len > 0 ? (size_t)names_len : 1);
+    DEBUG_ERROR_IF(blob == NULL)
+    for (uint32_t name_id = 0; name_id < n_names; name_id++) {
+        uint64_t const name_len = strlen_cset(names, name_id);
+        memcpy(blob + name_offsets[name_id], getKey_cset(names, name_id), (size_t)name_len);
+        blob[name_offsets[name_id] + name_len] = '\0';
+    }
+
+    ColumnarHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COLUMNAR_MAGIC, sizeof(header.magic));
+    header.version          = COLUMNAR_VERSION;
+    header.byte_order_mark  = COLUMNAR_BYTE_ORDER_MARK;
+    header.n_names          = n_names;
+    header.n_metrics        = getKeyCount_cset(metrics);
+    header.n_entities       = getKeyCount_cset(entities);
+    header.n_rows           = row_id;
+    header.names_len        = names_len;
+    header.names_at         = ALIGN(sizeof(header));
+    header.name_offsets_at  = ALIGN(header.names_at + names_len);
+    header.metric_names_at  = ALIGN(header.name_offsets_at + (uint64_t)n_names * sizeof(uint64_t));
+    header.entity_units_at  = ALIGN(header.metric_names_at + (uint64_t)header.n_metrics * sizeof(uint32_t));
+    header.entity_fns_at    = ALIGN(header.entity_units_at + (uint64_t)header.n_entities * sizeof(uint32_t));
+    header.row_entities_at  = ALIGN(header.entity_fns_at + (uint64_t)header.n_entities * sizeof(uint32_t));
+    header.row_metrics_at   = ALIGN(header.row_entities_at + (uint64_t)row_id * sizeof(uint32_t));
+    header.row_values_at    = ALIGN(header.row_metrics_at + (uint64_t)row_id * sizeof(uint32_t));
+    header.row_types_at     = ALIGN(header.row_values_at + (uint64_t)row_id * sizeof(uint32_t));
+
+    FILE* const output    = options.outfile ? fopen(options.outfile, "wb") : stdout;
+    uint64_t    pos       = 0;
+    bool const  isWritten = output != NULL
+        && writeSection(output, &pos, 0, &header, sizeof(header))
+        && writeSection(output, &pos, header.names_at, blob, (size_t)names_len)
+        && writeSection(output, &pos, header.name_offsets_at, name_offsets, (size_t)n_names * sizeof(uint64_t))
+        && writeSection(output, &pos, header.metric_names_at, metric_names, (size_t)header.n_metrics * sizeof(uint32_t))
+        && writeSection(output, &pos, header.entity_units_at, entity_units, (size_t)header.n_entities * sizeof(uint32_t))
+        && writeSection(output, &pos, header.entity_fns_at, entity_fns, (size_t)header.n_entities * sizeof(uint32_t))
+        && writeSection(output, &pos, header.row_entities_at, row_entities, (size_t)row_id * sizeof(uint32_t))
+        && writeSection(output, &pos, header.row_metrics_at, row_metrics, (size_t)row_id * sizeof(uint32_t))
+        && writeSection(output, &pos, header.row_values_at, row_values, (size_t)row_id * sizeof(uint32_t))
+        && writeSection(output, &pos, header.row_types_at, row_types, (size_t)row_id * sizeof(uint8_t));
+
+    bool const isClosed = output == NULL || (options.outfile ? fclose(output) : fflush(output)) != EOF;
+
+    VERBOSE_MSG_VARIADIC("COLUMNAR_REPORT => %u rows, %u entities, %u names", row_id, header.n_entities, n_names);
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_cset(entities))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_cset(metrics))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_cset(names))
+    free(blob);
+    free(name_offsets);
+    free(row_types);
+    free(row_values);
+    free(row_metrics);
+    free(row_entities);
+    free(entity_fns);
+    free(entity_units);
+    free(metric_names);
+
+    return isWritten && isClosed;
+}
@@ -4,69 +4,113 @@
  * @author Yavuz Koroglu
  * @see event.h
  */
+#include <stdlib.h>
+#include <string.h>
+
+#include "languages/c.h"
 #include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/arena.h"
 #include "srcmetrics/event.h"
+#include "srcmetrics/interner.h"
 #include "srcmetrics/metrics.h"
+#include "srcmetrics/profile.h"
+#include "srcmetrics/report.h"
 #include "padkit/chunk.h"
 #include "padkit/debug.h"
 #include "padkit/map.h"
 #include "padkit/streq.h"
 
-static unsigned function_read_state = 0U;
-
-static uint32_t currentUnit_id = 0xFFFFFFFF;
-static uint32_t currentFn_id   = 0xFFFFFFFF;
-
-static Event eventsAtStartDocument  [METRICS_COUNT_MAX + 1];
-static Event eventsAtEndDocument    [METRICS_COUNT_MAX + 1];
-static Event eventsAtStartRoot      [METRICS_COUNT_MAX + 1];
-static Event eventsAtStartUnit      [METRICS_COUNT_MAX + 1];
-static Event eventsAtStartElement   [METRICS_COUNT_MAX + 1];
-static Event eventsAtEndRoot        [METRICS_COUNT_MAX + 1];
-static Event eventsAtEndUnit        [METRICS_COUNT_MAX + 1];
-static Event eventsAtEndElement     [METRICS_COUNT_MAX + 1];
-static Event eventsAtCharactersRoot [METRICS_COUNT_MAX + 1];
-static Event eventsAtCharactersUnit [METRICS_COUNT_MAX + 1];
-static Event eventsAtMetaTag        [METRICS_COUNT_MAX + 1];
-static Event eventsAtComment        [METRICS_COUNT_MAX + 1];
-static Event eventsAtCDataBlock     [METRICS_COUNT_MAX + 1];
-static Event eventsAtProcInfo       [METRICS_COUNT_MAX + 1];
+static char const*         metrics[]                   = METRICS;
+static DocumentHandler     allEventsAtStartDocument[]  = ALL_EVENTS_AT_START_DOCUMENT;
+static DocumentHandler     allEventsAtEndDocument[]    = ALL_EVENTS_AT_END_DOCUMENT;
+static StartElementHandler allEventsAtStartRoot[]      = ALL_EVENTS_AT_START_ROOT;
+static UnitHandler         allEventsAtStartUnit[]      = ALL_EVENTS_AT_START_UNIT;
+static StartElementHandler allEventsAtStartElement[]   = ALL_EVENTS_AT_START_ELEMENT;
+static EndElementHandler   allEventsAtEndRoot[]        = ALL_EVENTS_AT_END_ROOT;
+static UnitHandler         allEventsAtEndUnit[]        = ALL_EVENTS_AT_END_UNIT;
+static EndElementHandler   allEventsAtEndElement[]     = ALL_EVENTS_AT_END_ELEMENT;
+static CharactersHandler   allEventsAtCharactersRoot[] = ALL_EVENTS_AT_CHARACTERS_ROOT;
+static CharactersHandler   allEventsAtCharactersUnit[] = ALL_EVENTS_AT_CHARACTERS_UNIT;
+static StartElementHandler allEventsAtMetaTag[]        = ALL_EVENTS_AT_META_TAG;
+static CharactersHandler   allEventsAtComment[]        = ALL_EVENTS_AT_COMMENT;
+static CharactersHandler   allEventsAtCDataBlock[]     = ALL_EVENTS_AT_CDATA_BLOCK;
+static ProcInfoHandler     allEventsAtProcInfo[]       = ALL_EVENTS_AT_PROC_INFO;
+static uint_fast64_t       allTagsAtStartElement[]     = ALL_TAGS_AT_START_ELEMENT;
+static uint_fast64_t       allTagsAtEndElement[]       = ALL_TAGS_AT_END_ELEMENT;
 
-static void event_startDocument(struct srcsax_context* context) {
-    static char const* metrics[]             = METRICS;
-    static Event allEventsAtStartDocument[]  = ALL_EVENTS_AT_START_DOCUMENT;
-    static Event allEventsAtEndDocument[]    = ALL_EVENTS_AT_END_DOCUMENT;
-    static Event allEventsAtStartRoot[]      = ALL_EVENTS_AT_START_ROOT;
-    static Event allEventsAtStartUnit[]      = ALL_EVENTS_AT_START_UNIT;
-    static Event allEventsAtStartElement[]   = ALL_EVENTS_AT_START_ELEMENT;
-    static Event allEventsAtEndRoot[]        = ALL_EVENTS_AT_END_ROOT;
-    static Event allEventsAtEndUnit[]        = ALL_EVENTS_AT_END_UNIT;
-    static Event allEventsAtEndElement[]     = ALL_EVENTS_AT_END_ELEMENT;
-    static Event allEventsAtCharactersRoot[] = ALL_EVENTS_AT_CHARACTERS_ROOT;
-    static Event allEventsAtCharactersUnit[] = ALL_EVENTS_AT_CHARACTERS_UNIT;
-    static Event allEventsAtMetaTag[]        = ALL_EVENTS_AT_META_TAG;
-    static Event allEventsAtComment[]        = ALL_EVENTS_AT_COMMENT;
-    static Event allEventsAtCDataBlock[]     = ALL_EVENTS_AT_CDATA_BLOCK;
-    static Event allEventsAtProcInfo[]       = ALL_EVENTS_AT_PROC_INFO;
-
-    Event* lastEventOfStartDocument          = eventsAtStartDocument;
-    Event* lastEventOfEndDocument            = eventsAtEndDocument;
-    Event* lastEventOfStartRoot              = eventsAtStartRoot;
-    Event* lastEventOfStartUnit              = eventsAtStartUnit;
-    Event* lastEventOfStartElement           = eventsAtStartElement;
-    Event* lastEventOfEndRoot                = eventsAtEndRoot;
-    Event* lastEventOfEndUnit                = eventsAtEndUnit;
-    Event* lastEventOfEndElement             = eventsAtEndElement;
-    Event* lastEventOfCharactersRoot         = eventsAtCharactersRoot;
-    Event* lastEventOfCharactersUnit         = eventsAtCharactersUnit;
-    Event* lastEventOfMetaTag                = eventsAtMetaTag;
-    Event* lastEventOfComment                = eventsAtComment;
-    Event* lastEventOfCDataBlock             = eventsAtCDataBlock;
-    Event* lastEventOfProcInfo               = eventsAtProcInfo;
+/**
+ * @brief Executes the handlers of the enabled metrics one by one, timing each one, see profile.h.
+ *
+ * Walks the metrics instead of the handler lists, so the Profile knows whose handler it is timing.
+ */
+#define EXECUTE_PROFILED(analysis, allEvents, isListening, ...)                                     \
+    for (size_t metricId = 0; metrics[metricId] && metricId < METRICS_COUNT_MAX; metricId++) {     \
+        if (!((analysis)->enabledMetrics & ((uint_fast64_t)1 << metricId))) continue;              \
+        if (allEvents[metricId] == NULL || !(isListening)) continue;                               \
+        uint64_t const start = start_profile((analysis)->profile);                                 \
+        allEvents[metricId](__VA_ARGS__);                                                          \
+        stopMetric_profile((analysis)->profile, metricId, start);                                  \
+    }
+
+/**
+ * @brief Calls an Arena function, e.g., reset_arena(), on the Arena of every enabled metric, see arena.h.
+ */
+static void forEachArena(Analysis* const analysis, void (*const scope)(Arena* const)) {
+    for (size_t metricId = 0; metrics[metricId] && metricId < METRICS_COUNT_MAX; metricId++)
+        if (analysis->enabledMetrics & ((uint_fast64_t)1 << metricId)) scope(analysis->arenas + metricId);
+}
+
+static void groupElementEventsByTag(Analysis* const analysis) {
+    /* Every tag gets at most one handler per metric, plus the NULL at the end */
+    size_t metricCount = 0;
+    for (char const** metric = metrics; *metric && metricCount < METRICS_COUNT_MAX; metric++) metricCount++;
+    size_t const cap = (C_NOT_A_TAG + 1) * (metricCount + 1);
+    DEBUG_ERROR_IF(cap > 0xFFFF)
+
+    analysis->eventsAtStartElement = malloc(cap * sizeof(StartElementHandler));
+    DEBUG_ERROR_IF(analysis->eventsAtStartElement == NULL)
+    analysis->eventsAtEndElement = malloc(cap * sizeof(EndElementHandler));
+    DEBUG_ERROR_IF(analysis->eventsAtEndElement == NULL)
+
+    StartElementHandler* lastEventOfStartElement = analysis->eventsAtStartElement;
+    EndElementHandler*   lastEventOfEndElement   = analysis->eventsAtEndElement;
+    for (unsigned tag_id = 0; tag_id <= C_NOT_A_TAG; tag_id++) {
+        uint_fast64_t const tag = C_TAG_BIT(tag_id);
+
+        analysis->firstEventAtStartTag[tag_id] = (uint16_t)(lastEventOfStartElement - analysis->eventsAtStartElement);
+        analysis->firstEventAtEndTag[tag_id]   = (uint16_t)(lastEventOfEndElement - analysis->eventsAtEndElement);
+
+        uint_fast64_t enabledMetrics = analysis->enabledMetrics;
+        for (size_t metricId = 0; metricId < metricCount; (metricId++, enabledMetrics >>= 1)) {
+            if (!(enabledMetrics & 1)) continue;
+
+            if (allEventsAtStartElement[metricId] && (allTagsAtStartElement[metricId] & tag))
+                *(lastEventOfStartElement++) = allEventsAtStartElement[metricId];
+            if (allEventsAtEndElement[metricId] && (allTagsAtEndElement[metricId] & tag))
+                *(lastEventOfEndElement++) = allEventsAtEndElement[metricId];
+        }
+        *(lastEventOfStartElement++) = NULL;
+        *(lastEventOfEndElement++)   = NULL;
+    }
+}
+static void startDocument(Analysis* const analysis) {
+    DocumentHandler*     lastEventOfStartDocument      = analysis->eventsAtStartDocument;
+    DocumentHandler*     lastEventOfEndDocument        = analysis->eventsAtEndDocument;
+    StartElementHandler* lastEventOfStartRoot          = analysis->eventsAtStartRoot;
+    UnitHandler*         lastEventOfStartUnit          = analysis->eventsAtStartUnit;
+    EndElementHandler*   lastEventOfEndRoot            = analysis->eventsAtEndRoot;
+    UnitHandler*         lastEventOfEndUnit            = analysis->eventsAtEndUnit;
+    CharactersHandler*   lastEventOfCharactersRoot     = analysis->eventsAtCharactersRoot;
+    CharactersHandler*   lastEventOfCharactersUnit     = analysis->eventsAtCharactersUnit;
+    StartElementHandler* lastEventOfMetaTag            = analysis->eventsAtMetaTag;
+    CharactersHandler*   lastEventOfComment            = analysis->eventsAtComment;
+    CharactersHandler*   lastEventOfCDataBlock         = analysis->eventsAtCDataBlock;
+    ProcInfoHandler*     lastEventOfProcInfo           = analysis->eventsAtProcInfo;
 
     char const** metric = metrics;
     size_t metricId     = 0;
-    for (uint_fast64_t enabledMetrics = options.enabledMetrics;
+    for (uint_fast64_t enabledMetrics = analysis->enabledMetrics;
         *metric && metricId < METRICS_COUNT_MAX;
         (metric++, metricId++, enabledMetrics >>= 1)
     ) {
@@ -76,10 +120,8 @@ static void event_startDocument(struct srcsax_context* context) {
         if (allEventsAtEndDocument[metricId])    *(lastEventOfEndDocument++)    = allEventsAtEndDocument[metricId];
         if (allEventsAtStartRoot[metricId])      *(lastEventOfStartRoot++)      = allEventsAtStartRoot[metricId];
         if (allEventsAtStartUnit[metricId])      *(lastEventOfStartUnit++)      = allEventsAtStartUnit[metricId];
-        if (allEventsAtStartElement[metricId])   *(lastEventOfStartElement++)   = allEventsAtStartElement[metricId];
         if (allEventsAtEndRoot[metricId])        *(lastEventOfEndRoot++)        = allEventsAtEndRoot[metricId];
         if (allEventsAtEndUnit[metricId])        *(lastEventOfEndUnit++)        = allEventsAtEndUnit[metricId];
-        if (allEventsAtEndElement[metricId])     *(lastEventOfEndElement++)     = allEventsAtEndElement[metricId];
         if (allEventsAtCharactersRoot[metricId]) *(lastEventOfCharactersRoot++) = allEventsAtCharactersRoot[metricId];
         if (allEventsAtCharactersUnit[metricId]) *(lastEventOfCharactersUnit++) = allEventsAtCharactersUnit[metricId];
         if (allEventsAtMetaTag[metricId])        *(lastEventOfMetaTag++)        = allEventsAtMetaTag[metricId];
@@ -91,10 +133,8 @@ static void event_startDocument(struct srcsax_context* context) {
     *lastEventOfEndDocument    = NULL;
     *lastEventOfStartRoot      = NULL;
     *lastEventOfStartUnit      = NULL;
-    *lastEventOfStartElement   = NULL;
     *lastEventOfEndRoot        = NULL;
     *lastEventOfEndUnit        = NULL;
-    *lastEventOfEndElement     = NULL;
     *lastEventOfCharactersRoot = NULL;
     *lastEventOfCharactersUnit = NULL;
     *lastEventOfMetaTag        = NULL;
@@ -102,23 +142,48 @@ static void event_startDocument(struct srcsax_context* context) {
     *lastEventOfCDataBlock     = NULL;
     *lastEventOfProcInfo       = NULL;
 
-    DEBUG_ASSERT(isValid_chunk(strings))
+    /* The enabled metrics never change, so the element handlers are grouped once */
+    if (analysis->eventsAtStartElement == NULL) groupElementEventsByTag(analysis);
+
+    DEBUG_ASSERT(isValid_chunk(analysis->strings))
 
     VERBOSE_MSG_LITERAL("SRCSAX_START => document");
 
-    currentFn_id   = 0xFFFFFFFF;
-    currentUnit_id = 0xFFFFFFFF;
+    analysis->currentFn_id   = 0xFFFFFFFF;
+    analysis->currentUnit_id = 0xFFFFFFFF;
+
+    forEachArena(analysis, reset_arena);
 
     /* Execute all related events */
-    for (Event* event = eventsAtStartDocument; *event; event++)
-        (*event)(context);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtStartDocument, 1, analysis)
+    } else {
+        for (DocumentHandler* handler = analysis->eventsAtStartDocument; *handler; handler++)
+            (*handler)(analysis);
+    }
 }
-static void event_endDocument(struct srcsax_context* context) {
+static void endDocument(Analysis* const analysis) {
     VERBOSE_MSG_LITERAL("SRCSAX_END => document");
 
     /* Execute all related events */
-    for (Event* event = eventsAtEndDocument; *event; event++)
-        (*event)(context);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtEndDocument, 1, analysis)
+    } else {
+        for (DocumentHandler* handler = analysis->eventsAtEndDocument; *handler; handler++)
+            (*handler)(analysis);
+    }
+}
+static void event_startDocument(struct srcsax_context* context) {
+    startDocument(context->data);
+}
+static void event_endDocument(struct srcsax_context* context) {
+    endDocument(context->data);
+}
+static void event_startDocumentOfStream(struct srcsax_context* context) {
+    VERBOSE_MSG_LITERAL("SRCSAX_START => streamed unit document");
+}
+static void event_endDocumentOfStream(struct srcsax_context* context) {
+    VERBOSE_MSG_LITERAL("SRCSAX_END => streamed unit document");
 }
 static void event_startRoot(
     struct srcsax_context*         context,
@@ -130,11 +195,22 @@ static void event_startRoot(
     int                            num_attributes,
     struct srcsax_attribute const* attributes
 ) {
+    Analysis* const analysis = context->data;
+
     VERBOSE_MSG_LITERAL("SRCSAX_START => root");
 
+    StartElementEvent const event[1] = {{
+        localname, prefix, uri, num_namespaces, namespaces, num_attributes, attributes,
+        0xFFFFFFFF, 0xFFFFFFFF, C_NOT_A_TAG
+    }};
+
     /* Execute all related events */
-    for (Event* event = eventsAtStartRoot; *event; event++)
-        (*event)(context, localname, prefix, uri, num_namespaces, namespaces, num_attributes, attributes);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtStartRoot, 1, analysis, event)
+    } else {
+        for (StartElementHandler* handler = analysis->eventsAtStartRoot; *handler; handler++)
+            (*handler)(analysis, event);
+    }
 }
 static void event_startUnit(
     struct srcsax_context*         context,
@@ -146,20 +222,31 @@ static void event_startUnit(
     int                            num_attributes,
     struct srcsax_attribute const* attributes
 ) {
-    DEBUG_ASSERT(function_read_state == 0U)
+    Analysis* const analysis = context->data;
+
+    DEBUG_ASSERT(analysis->function_read_state == 0U)
 
     for (struct srcsax_attribute const* attribute = attributes + num_attributes - 1; attribute >= attributes; attribute--) {
         if (!STR_EQ_CONST(attribute->localname, "filename")) continue;
         size_t const unit_len = strlen(attribute->value);
-        currentUnit_id = add_chunk(strings, attribute->value, unit_len);
+        analysis->currentUnit_id = intern_interner(analysis->interner, analysis->strings, attribute->value, unit_len);
         VERBOSE_MSG_VARIADIC("SRCSAX_START => unit (%.*s)", (int)unit_len, attribute->value);
         break;
     }
-    DEBUG_ERROR_IF(currentUnit_id == 0xFFFFFFFF)
+    DEBUG_ERROR_IF(analysis->currentUnit_id == 0xFFFFFFFF)
+
+    UnitEvent const event[1] = {{
+        localname, prefix, uri, num_namespaces, namespaces, num_attributes, attributes,
+        analysis->currentUnit_id
+    }};
 
     /* Execute all related events */
-    for (Event* event = eventsAtStartUnit; *event; event++)
-        (*event)(context, localname, prefix, uri, num_namespaces, namespaces, num_attributes, attributes, currentUnit_id);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtStartUnit, 1, analysis, event)
+    } else {
+        for (UnitHandler* handler = analysis->eventsAtStartUnit; *handler; handler++)
+            (*handler)(analysis, event);
+    }
 }
 static void event_startElement(
     struct srcsax_context*         context,
@@ -171,24 +258,41 @@ static void event_startElement(
     int                            num_attributes,
     struct srcsax_attribute const* attributes
 ) {
-    if (STR_EQ_CONST(localname, "function")) {
+    Analysis* const analysis = context->data;
+    unsigned const  tag_id   = getTagId_cparse(localname);
+
+    if (tag_id == C_FUNCTION) {
         VERBOSE_MSG_LITERAL("SRCSAX_START => function");
-        function_read_state = 1U;
-        currentFn_id = addIndex_chunk(strings, currentUnit_id);
-        DEBUG_ERROR_IF(currentFn_id == 0xFFFFFFFF)
-        DEBUG_ERROR_IF(append_chunk(strings, "::", 2) == NULL)
-        NDEBUG_EXECUTE(append_chunk(strings, "::", 2))
-    } else if (function_read_state == 1 && STR_EQ_CONST(localname, "type")) {
+        analysis->function_read_state = 1U;
+        analysis->currentFn_id = addIndex_chunk(analysis->strings, analysis->currentUnit_id);
+        DEBUG_ERROR_IF(analysis->currentFn_id == 0xFFFFFFFF)
+        DEBUG_ERROR_IF(append_chunk(analysis->strings, "::", 2) == NULL)
+        NDEBUG_EXECUTE(append_chunk(analysis->strings, "::", 2))
+
+        forEachArena(analysis, startFn_arena);
+    } else if (analysis->function_read_state == 1 && tag_id == C_TYPE) {
         VERBOSE_MSG_LITERAL("SRCSAX_START => function_type");
-        function_read_state = 2U;
-    } else if (function_read_state == 3 && STR_EQ_CONST(localname, "name")) {
+        analysis->function_read_state = 2U;
+    } else if (analysis->function_read_state == 3 && tag_id == C_NAME) {
         VERBOSE_MSG_LITERAL("SRCSAX_START => function_name");
-        function_read_state = 4U;
+        analysis->function_read_state = 4U;
     }
 
+    StartElementEvent const event[1] = {{
+        localname, prefix, uri, num_namespaces, namespaces, num_attributes, attributes,
+        analysis->currentUnit_id, analysis->currentFn_id, tag_id
+    }};
+
     /* Execute all related events */
-    for (Event* event = eventsAtStartElement; *event; event++)
-        (*event)(context, localname, prefix, uri, num_namespaces, namespaces, num_attributes, attributes, currentUnit_id, currentFn_id);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtStartElement, allTagsAtStartElement[metricId] & C_TAG_BIT(tag_id), analysis, event)
+    } else {
+        for (
+            StartElementHandler* handler = analysis->eventsAtStartElement + analysis->firstEventAtStartTag[tag_id];
+            *handler;
+            handler++
+        ) (*handler)(analysis, event);
+    }
 }
 static void event_endRoot(
     struct srcsax_context* context,
@@ -196,11 +300,19 @@ static void event_endRoot(
     char const*            prefix,
     char const*            uri
 ) {
+    Analysis* const analysis = context->data;
+
     VERBOSE_MSG_LITERAL("SRCSAX_END => root");
 
+    EndElementEvent const event[1] = {{ localname, prefix, uri, 0xFFFFFFFF, 0xFFFFFFFF, C_NOT_A_TAG }};
+
     /* Execute all related events */
-    for (Event* event = eventsAtEndRoot; *event; event++)
-        (*event)(context, localname, prefix, uri);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtEndRoot, 1, analysis, event)
+    } else {
+        for (EndElementHandler* handler = analysis->eventsAtEndRoot; *handler; handler++)
+            (*handler)(analysis, event);
+    }
 }
 static void event_endUnit(
     struct srcsax_context* context,
@@ -208,13 +320,27 @@ static void event_endUnit(
     char const*            prefix,
     char const*            uri
 ) {
-    VERBOSE_MSG_VARIADIC("SRCSAX_END => unit (%s)", get_chunk(strings, currentUnit_id));
+    Analysis* const analysis = context->data;
+
+    VERBOSE_MSG_VARIADIC("SRCSAX_END => unit (%s)", get_chunk(analysis->strings, analysis->currentUnit_id));
+
+    UnitEvent const event[1] = {{ localname, prefix, uri, 0, NULL, 0, NULL, analysis->currentUnit_id }};
 
     /* Execute all related events */
-    for (Event* event = eventsAtEndUnit; *event; event++)
-        (*event)(context, localname, prefix, uri, currentUnit_id);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtEndUnit, 1, analysis, event)
+    } else {
+        for (UnitHandler* handler = analysis->eventsAtEndUnit; *handler; handler++)
+            (*handler)(analysis, event);
+    }
+
+    /* Every metric is done with the unit, so its rows are final and its Arena is free */
+    if (analysis->isReportingUnits) {
+        DEBUG_ASSERT_NDEBUG_EXECUTE(reportNewRowsCsv(analysis))
+    }
+    forEachArena(analysis, reset_arena);
 
-    currentUnit_id = 0xFFFFFFFF;
+    analysis->currentUnit_id = 0xFFFFFFFF;
 }
 static void event_endElement(
     struct srcsax_context* context,
@@ -222,43 +348,79 @@ static void event_endElement(
     char const*            prefix,
     char const*            uri
 ) {
+    Analysis* const analysis = context->data;
+    unsigned const  tag_id   = getTagId_cparse(localname);
+
     bool closeFn = 0;
-    if (STR_EQ_CONST(localname, "function")) {
-        VERBOSE_MSG_VARIADIC("SRCSAX_END => function (%s)", get_chunk(strings, currentFn_id));
-        function_read_state = 0U;
+    if (tag_id == C_FUNCTION) {
+        VERBOSE_MSG_VARIADIC("SRCSAX_END => function (%s)", get_chunk(analysis->strings, analysis->currentFn_id));
+        analysis->function_read_state = 0U;
         closeFn             = 1;
-    } else if (function_read_state == 2U && STR_EQ_CONST(localname, "type")) {
+    } else if (analysis->function_read_state == 2U && tag_id == C_TYPE) {
         VERBOSE_MSG_LITERAL("SRCSAX_END => function_type");
-        function_read_state = 3U;
-    } else if (function_read_state == 4U && STR_EQ_CONST(localname, "name")) {
-        DEBUG_ERROR_IF(append_chunk(strings, "()", 2) == NULL)
-        NDEBUG_EXECUTE(append_chunk(strings, "()", 2))
-        VERBOSE_MSG_VARIADIC("SRCSAX_END => function_nane (%s)", get_chunk(strings, currentFn_id));
-        function_read_state = 5U;
+        analysis->function_read_state = 3U;
+    } else if (analysis->function_read_state == 4U && tag_id == C_NAME) {
+        DEBUG_ERROR_IF(append_chunk(analysis->strings, "()", 2) == NULL)
+        NDEBUG_EXECUTE(append_chunk(analysis->strings, "()", 2))
+        VERBOSE_MSG_VARIADIC("SRCSAX_END => function_nane (%s)", get_chunk(analysis->strings, analysis->currentFn_id));
+
+        /* The metrics already have the id, so a name another function took stays a copy, but RFU finds one */
+        index_interner(analysis->interner, analysis->strings, analysis->currentFn_id);
+        analysis->function_read_state = 5U;
     }
-    DEBUG_ERROR_IF(function_read_state == 5U && currentFn_id == 0xFFFFFFFF)
+    DEBUG_ERROR_IF(analysis->function_read_state == 5U && analysis->currentFn_id == 0xFFFFFFFF)
+
+    EndElementEvent const event[1] = {{
+        localname, prefix, uri, analysis->currentUnit_id, analysis->currentFn_id, tag_id
+    }};
 
     /* Execute all related events */
-    for (Event* event = eventsAtEndElement; *event; event++)
-        (*event)(context, localname, prefix, uri, currentUnit_id, currentFn_id);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtEndElement, allTagsAtEndElement[metricId] & C_TAG_BIT(tag_id), analysis, event)
+    } else {
+        for (
+            EndElementHandler* handler = analysis->eventsAtEndElement + analysis->firstEventAtEndTag[tag_id];
+            *handler;
+            handler++
+        ) (*handler)(analysis, event);
+    }
 
-    if (closeFn) currentFn_id = 0xFFFFFFFF;
+    if (closeFn) {
+        forEachArena(analysis, endFn_arena);
+        analysis->currentFn_id = 0xFFFFFFFF;
+    }
     return;
 }
 static void event_charactersRoot(struct srcsax_context* context, char const* ch, int len) {
+    Analysis* const analysis = context->data;
+
+    CharactersEvent const event[1] = {{ ch, (uint64_t)len, 0xFFFFFFFF, 0xFFFFFFFF }};
+
     /* Execute all related events */
-    for (Event* event = eventsAtCharactersRoot; *event; event++)
-        (*event)(context, ch, (uint64_t)len);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtCharactersRoot, 1, analysis, event)
+    } else {
+        for (CharactersHandler* handler = analysis->eventsAtCharactersRoot; *handler; handler++)
+            (*handler)(analysis, event);
+    }
 }
 static void event_charactersUnit(struct srcsax_context* context, char const* ch, int len) {
-    if (function_read_state == 4U) {
-        DEBUG_ERROR_IF(append_chunk(strings, ch, (uint64_t)len) == NULL)
-        NDEBUG_EXECUTE(append_chunk(strings, ch, (uint64_t)len))
+    Analysis* const analysis = context->data;
+
+    if (analysis->function_read_state == 4U) {
+        DEBUG_ERROR_IF(append_chunk(analysis->strings, ch, (uint64_t)len) == NULL)
+        NDEBUG_EXECUTE(append_chunk(analysis->strings, ch, (uint64_t)len))
     }
 
+    CharactersEvent const event[1] = {{ ch, (uint64_t)len, analysis->currentUnit_id, analysis->currentFn_id }};
+
     /* Execute all related events */
-    for (Event* event = eventsAtCharactersUnit; *event; event++)
-        (*event)(context, ch, (uint64_t)len, currentUnit_id, currentFn_id);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtCharactersUnit, 1, analysis, event)
+    } else {
+        for (CharactersHandler* handler = analysis->eventsAtCharactersUnit; *handler; handler++)
+            (*handler)(analysis, event);
+    }
 }
 static void event_metaTag(
     struct srcsax_context*         context,
@@ -270,24 +432,64 @@ static void event_metaTag(
     int                            num_attributes,
     struct srcsax_attribute const* attributes
 ) {
+    Analysis* const analysis = context->data;
+
+    StartElementEvent const event[1] = {{
+        localname, prefix, uri, num_namespaces, namespaces, num_attributes, attributes,
+        0xFFFFFFFF, 0xFFFFFFFF, C_NOT_A_TAG
+    }};
+
     /* Execute all related events */
-    for (Event* event = eventsAtMetaTag; *event; event++)
-        (*event)(context, localname, prefix, uri, num_namespaces, namespaces, num_attributes, attributes);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtMetaTag, 1, analysis, event)
+    } else {
+        for (StartElementHandler* handler = analysis->eventsAtMetaTag; *handler; handler++)
+            (*handler)(analysis, event);
+    }
 }
 static void event_comment(struct srcsax_context* context, char const* value) {
+    Analysis* const analysis = context->data;
+
+    /* Do NOT measure the comment if nobody listens */
+    if (*analysis->eventsAtComment == NULL) return;
+
+    CharactersEvent const event[1] = {{
+        value, (uint64_t)strlen(value), analysis->currentUnit_id, analysis->currentFn_id
+    }};
+
     /* Execute all related events */
-    for (Event* event = eventsAtComment; *event; event++)
-        (*event)(context, value);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtComment, 1, analysis, event)
+    } else {
+        for (CharactersHandler* handler = analysis->eventsAtComment; *handler; handler++)
+            (*handler)(analysis, event);
+    }
 }
 static void event_cdataBlock(struct srcsax_context * context, char const* value, int len) {
+    Analysis* const analysis = context->data;
+
+    CharactersEvent const event[1] = {{ value, (uint64_t)len, analysis->currentUnit_id, analysis->currentFn_id }};
+
     /* Execute all related events */
-    for (Event* event = eventsAtCDataBlock; *event; event++)
-        (*event)(context, value, (uint64_t)len);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtCDataBlock, 1, analysis, event)
+    } else {
+        for (CharactersHandler* handler = analysis->eventsAtCDataBlock; *handler; handler++)
+            (*handler)(analysis, event);
+    }
 }
 static void event_procInfo(struct srcsax_context* context, char const* target, char const* data) {
+    Analysis* const analysis = context->data;
+
+    ProcInfoEvent const event[1] = {{ target, data }};
+
     /* Execute all related events */
-    for (Event* event = eventsAtProcInfo; *event; event++)
-        (*event)(context, target, data);
+    if (analysis->profile) {
+        EXECUTE_PROFILED(analysis, allEventsAtProcInfo, 1, analysis, event)
+    } else {
+        for (ProcInfoHandler* handler = analysis->eventsAtProcInfo; *handler; handler++)
+            (*handler)(analysis, event);
+    }
 }
 
 static struct srcsax_handler events[1] = {{
@@ -298,3 +500,20 @@ static struct srcsax_handler events[1] = {{
     &event_metaTag, &event_comment, &event_cdataBlock, &event_procInfo
 }};
 struct srcsax_handler* getStaticEventHandler(void) { return events; }
+
+static struct srcsax_handler streamingEvents[1] = {{
+    &event_startDocumentOfStream, &event_endDocumentOfStream,
+    &event_startRoot, &event_startUnit, &event_startElement,
+    &event_endRoot, &event_endUnit, &event_endElement,
+    &event_charactersRoot, &event_charactersUnit,
+    &event_metaTag, &event_comment, &event_cdataBlock, &event_procInfo
+}};
+struct srcsax_handler* getStreamingEventHandler(void) { return streamingEvents; }
+
+void startStream_event(struct AnalysisBody* const analysis) {
+    startDocument(analysis);
+}
+
+void endStream_event(struct AnalysisBody* const analysis) {
+    endDocument(analysis);
+}
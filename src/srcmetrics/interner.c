@@ -0,0 +1,143 @@
+/**
+ * @file interner.c
+ * @brief Implements functions defined in interner.h.
+ * @author Yavuz Koroglu
+ * @see interner.h
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "srcmetrics/interner.h"
+#include "padkit/debug.h"
+
+#define FNV32_OFFSET_BASIS  0x811C9DC5U
+#define FNV32_PRIME         0x01000193U
+
+#define NOT_AN_ID           0xFFFFFFFF
+
+static uint32_t fnv1a32(char const* const bytes, uint64_t const len) {
+    uint32_t hash = FNV32_OFFSET_BASIS;
+    for (char const* byte = bytes; byte < bytes + len; byte++) {
+        hash ^= (unsigned char)*byte;
+        hash *= FNV32_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Finds the slot of a string, or the empty slot where it goes.
+ */
+static InternerSlot* probe(
+    Interner const* const interner,
+    Chunk const* const    strings,
+    char const* const     str,
+    uint64_t const        len,
+    uint32_t const        hash
+) {
+    uint32_t const mask = interner->cap - 1;
+    for (uint32_t pos = hash & mask; ; pos = (pos + 1) & mask) {
+        InternerSlot* const slot = interner->slots + pos;
+        if (slot->id == NOT_AN_ID) return slot;
+        if (slot->hash != hash) continue;
+        if (strlen_chunk(strings, slot->id) != len) continue;
+        if (memcmp(get_chunk(strings, slot->id), str, (size_t)len) == 0) return slot;
+    }
+}
+
+/**
+ * @brief Makes room for one more string, keeping the table at most 3/4 full.
+ */
+static void reserve(Interner* const interner) {
+    if ((uint64_t)(interner->count + 1) * 4 <= (uint64_t)interner->cap * 3) return;
+
+    uint32_t const new_cap = interner->cap > 0 ? interner->cap << 1 : INTERNER_INITIAL_CAP;
+    DEBUG_ERROR_IF(new_cap <= interner->cap)
+
+    InternerSlot* const new_slots = malloc((size_t)new_cap * sizeof(InternerSlot));
+    DEBUG_ERROR_IF(new_slots == NULL)
+    memset(new_slots, 0xFF, (size_t)new_cap * sizeof(InternerSlot));
+
+    /* The hashes are kept, so the strings are NOT read again */
+    uint32_t const new_mask = new_cap - 1;
+    for (InternerSlot const* slot = interner->slots; slot < interner->slots + interner->cap; slot++) {
+        if (slot->id == NOT_AN_ID) continue;
+
+        uint32_t pos = slot->hash & new_mask;
+        while (new_slots[pos].id != NOT_AN_ID) pos = (pos + 1) & new_mask;
+        new_slots[pos] = *slot;
+    }
+
+    free(interner->slots);
+    interner->slots = new_slots;
+    interner->cap   = new_cap;
+}
+
+uint32_t find_interner(Interner const* const interner, Chunk const* const strings, char const* const str, uint64_t const len) {
+    DEBUG_ASSERT(isValid_interner(interner))
+    DEBUG_ERROR_IF(str == NULL)
+
+    if (interner->count == 0) return NOT_AN_ID;
+
+    return probe(interner, strings, str, len, fnv1a32(str, len))->id;
+}
+
+void flush_interner(Interner* const interner) {
+    DEBUG_ASSERT(isValid_interner(interner))
+
+    if (interner->count == 0) return;
+
+    memset(interner->slots, 0xFF, (size_t)interner->cap * sizeof(InternerSlot));
+    interner->count = 0;
+}
+
+void free_interner(Interner* const interner) {
+    DEBUG_ASSERT(isValid_interner(interner))
+
+    free(interner->slots);
+
+    *interner = NOT_AN_INTERNER;
+}
+
+uint32_t index_interner(Interner* const interner, Chunk const* const strings, uint32_t const id) {
+    DEBUG_ASSERT(isValid_interner(interner))
+
+    char const* const str = get_chunk(strings, id);
+    DEBUG_ERROR_IF(str == NULL)
+
+    uint64_t const len = strlen_chunk(strings, id);
+    DEBUG_ERROR_IF(len == 0xFFFFFFFFFFFFFFFF)
+
+    reserve(interner);
+
+    uint32_t const      hash = fnv1a32(str, len);
+    InternerSlot* const slot = probe(interner, strings, str, len, hash);
+    if (slot->id != NOT_AN_ID) return slot->id;
+
+    *slot = (InternerSlot){ hash, id };
+    interner->count++;
+
+    return id;
+}
+
+uint32_t intern_interner(Interner* const interner, Chunk* const strings, char const* const str, uint64_t const len) {
+    DEBUG_ASSERT(isValid_interner(interner))
+    DEBUG_ERROR_IF(str == NULL)
+
+    reserve(interner);
+
+    uint32_t const      hash = fnv1a32(str, len);
+    InternerSlot* const slot = probe(interner, strings, str, len, hash);
+    if (slot->id != NOT_AN_ID) return slot->id;
+
+    uint32_t const id = add_chunk(strings, str, len);
+    if (id == NOT_AN_ID) return NOT_AN_ID;
+
+    *slot = (InternerSlot){ hash, id };
+    interner->count++;
+
+    return id;
+}
+
+bool isValid_interner(Interner const* const interner) {
+    return interner != NULL && (interner->cap == 0 || interner->slots != NULL) && interner->count <= interner->cap;
+}
@@ -4,269 +4,213 @@
  * @author Yavuz Koroglu
  */
 #include <math.h>
-#include <stdarg.h>
+#include "languages/c.h"
 #include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/cache.h"
 #include "srcmetrics/metrics/abc.h"
+#include "srcmetrics/sizing.h"
 #include "padkit/chunk.h"
 #include "padkit/debug.h"
-#include "padkit/repeat.h"
 #include "padkit/streq.h"
 
-#define ENTRY_COUNT_GUESS (UNIT_COUNT_GUESS + FN_COUNT_GUESS)
-
-static Map abc_statistics[1] = { NOT_A_MAP };
-
 #define AC_READ_STATE_WAITING_FOR_OPERATOR 0U
 #define AC_READ_STATE_COMMENT              1U
 #define AC_READ_STATE_READING_OPERATOR     2U
 #define AC_READ_STATE_DECLARATION          3U
-static unsigned ac_read_state = AC_READ_STATE_WAITING_FOR_OPERATOR;
-
-static unsigned a_overall   = 0U;
-static unsigned b_overall   = 0U;
-static unsigned c_overall   = 0U;
-static unsigned a_unit      = 0U;
-static unsigned b_unit      = 0U;
-static unsigned c_unit      = 0U;
-static unsigned a_fn        = 0U;
-static unsigned b_fn        = 0U;
-static unsigned c_fn        = 0U;
-static float    abc_overall = 0.0f;
-static float    abc_unit    = 0.0f;
-static float    abc_fn      = 0.0f;
-
-static Chunk    op_chunk[1] = { NOT_A_CHUNK };
-
-static void free_abc_stuff(void) {
-    VERBOSE_MSG_LITERAL("ABC_FREE");
 
-    DEBUG_ABORT_IF(!free_map(abc_statistics))
-    NDEBUG_EXECUTE(free_map(abc_statistics))
+void free_abc(ABCState* const abc) {
+    if (!isValid_rtable(abc->statistics)) return;
 
-    DEBUG_ABORT_IF(!free_chunk(op_chunk))
-    NDEBUG_EXECUTE(free_chunk(op_chunk))
-}
+    VERBOSE_MSG_LITERAL("ABC_FREE");
 
-void event_startDocument_abc(struct srcsax_context* context, ...) {
-    static bool first_time_execution = 1;
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_rtable(abc->statistics))
+}
 
-    VERBOSE_MSG_LITERAL("ABC_START => document");
+void merge_abc(Analysis* const analysis, Analysis const* const partial) {
+    ABCState* const       abc         = analysis->abc;
+    ABCState const* const partial_abc = partial->abc;
 
-    if (first_time_execution) {
-        first_time_execution = 0;
+    VERBOSE_MSG_LITERAL("ABC_MERGE");
 
-        DEBUG_ASSERT_NDEBUG_EXECUTE(
-            constructEmpty_map(abc_statistics, ENTRY_COUNT_GUESS)
-        )
+    mergeStatistics_analysis(analysis, abc->statistics, partial, partial_abc->statistics);
 
-        DEBUG_ASSERT_NDEBUG_EXECUTE(
-            constructEmpty_chunk(op_chunk, BUFSIZ, 1)
-        )
+    abc->a_overall += partial_abc->a_overall;
+    abc->b_overall += partial_abc->b_overall;
+    abc->c_overall += partial_abc->c_overall;
+}
 
-        DEBUG_ERROR_IF(atexit(free_abc_stuff) != 0)
-        NDEBUG_EXECUTE(atexit(free_abc_stuff))
-    } else {
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_map(abc_statistics))
+bool save_abc(FILE* const stream, Analysis const* const partial) {
+    ABCState const* const abc = partial->abc;
 
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(op_chunk))
-    }
+    VERBOSE_MSG_LITERAL("ABC_SAVE");
 
-    ac_read_state   = AC_READ_STATE_WAITING_FOR_OPERATOR;
-    a_overall       = 0U;
-    b_overall       = 0U;
-    c_overall       = 0U;
-    abc_overall     = 0.0f;
+    return writeStatistics_cache(stream, partial, abc->statistics)
+        && writeUnsigned_cache(stream, abc->a_overall)
+        && writeUnsigned_cache(stream, abc->b_overall)
+        && writeUnsigned_cache(stream, abc->c_overall);
 }
 
-void event_endDocument_abc(struct srcsax_context* context, ...) {
-    VERBOSE_MSG_LITERAL("ABC_END => document");
+bool load_abc(Analysis* const partial, FILE* const stream) {
+    ABCState* const abc = partial->abc;
+    uint64_t        a_overall, b_overall, c_overall;
 
-    abc_overall
-        = sqrtf((float)((a_overall * a_overall) + (b_overall * b_overall) + (c_overall * c_overall)));
+    VERBOSE_MSG_LITERAL("ABC_LOAD");
 
-    uint32_t key_id = add_chunk(strings, "ABC-A", 5);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(abc_statistics, key_id, VAL_UNSIGNED(a_overall)))
+    if (!readStatistics_cache(stream, partial, abc->statistics)) return 0;
+    if (!readUnsigned_cache(stream, &a_overall))                 return 0;
+    if (!readUnsigned_cache(stream, &b_overall))                 return 0;
+    if (!readUnsigned_cache(stream, &c_overall))                 return 0;
 
-    key_id = add_chunk(strings, "ABC-B", 5);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(abc_statistics, key_id, VAL_UNSIGNED(b_overall)))
+    abc->a_overall = (unsigned)a_overall;
+    abc->b_overall = (unsigned)b_overall;
+    abc->c_overall = (unsigned)c_overall;
+    return 1;
+}
 
-    key_id = add_chunk(strings, "ABC-C", 5);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(abc_statistics, key_id, VAL_UNSIGNED(c_overall)))
+void event_startDocument_abc(Analysis* const analysis) {
+    ABCState* const abc = analysis->abc;
 
-    key_id = add_chunk(strings, "ABC", 3);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(abc_statistics, key_id, VAL_FLOAT(abc_overall)))
-}
+    VERBOSE_MSG_LITERAL("ABC_START => document");
 
-void event_startUnit_abc(struct srcsax_context* context, ...) {
-    VERBOSE_MSG_LITERAL("ABC_START => unit");
+    if (!isValid_rtable(abc->statistics)) {
+        DEBUG_ASSERT_NDEBUG_EXECUTE(
+            constructEmpty_rtable(abc->statistics, get_sizing(analysis->isPartial)->entry_count)
+        )
+    } else {
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_rtable(abc->statistics))
+    }
 
-    ac_read_state = AC_READ_STATE_WAITING_FOR_OPERATOR;
-    a_unit        = 0U;
-    b_unit        = 0U;
-    c_unit        = 0U;
-    abc_unit      = 0.0f;
+    abc->ac_read_state   = AC_READ_STATE_WAITING_FOR_OPERATOR;
+    abc->a_overall       = 0U;
+    abc->b_overall       = 0U;
+    abc->c_overall       = 0U;
+    abc->abc_overall     = 0.0f;
 }
 
-void event_endUnit_abc(struct srcsax_context* context, ...) {
-    va_list args;
+void event_endDocument_abc(Analysis* const analysis) {
+    ABCState* const abc = analysis->abc;
 
-    va_start(args, context);
+    VERBOSE_MSG_LITERAL("ABC_END => document");
 
-    /* localname, prefix, uri */
-    REPEAT(3) va_arg(args, char const*);
+    abc->abc_overall
+        = sqrtf((float)((abc->a_overall * abc->a_overall) + (abc->b_overall * abc->b_overall) + (abc->c_overall * abc->c_overall)));
 
-    uint32_t const unit_id = va_arg(args, uint32_t);
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(abc->statistics, RESULT_OVERALL, METRIC_ABC, ABC_SUB_A, VAL_UNSIGNED(abc->a_overall)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(abc->statistics, RESULT_OVERALL, METRIC_ABC, ABC_SUB_B, VAL_UNSIGNED(abc->b_overall)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(abc->statistics, RESULT_OVERALL, METRIC_ABC, ABC_SUB_C, VAL_UNSIGNED(abc->c_overall)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(abc->statistics, RESULT_OVERALL, METRIC_ABC, ABC_SUB_ABC, VAL_FLOAT(abc->abc_overall)))
+}
 
-    va_end(args);
+void event_startUnit_abc(Analysis* const analysis, UnitEvent const* const event) {
+    ABCState* const abc = analysis->abc;
 
-    VERBOSE_MSG_VARIADIC("ABC_END => unit (%s)", get_chunk(strings, unit_id));
+    VERBOSE_MSG_LITERAL("ABC_START => unit");
 
-    abc_unit
-        = sqrtf((float)((a_unit * a_unit) + (b_unit * b_unit) + (c_unit * c_unit)));
-
-    uint32_t key_id = add_chunk(strings, "ABC-A_", 6);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(abc_statistics, key_id, VAL_UNSIGNED(a_unit)))
-
-    key_id = add_chunk(strings, "ABC-B_", 6);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(abc_statistics, key_id, VAL_UNSIGNED(b_unit)))
-
-    key_id = add_chunk(strings, "ABC-C_", 6);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(abc_statistics, key_id, VAL_UNSIGNED(c_unit)))
-
-    key_id = add_chunk(strings, "ABC_", 4);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(abc_statistics, key_id, VAL_FLOAT(abc_unit)))
+    abc->ac_read_state = AC_READ_STATE_WAITING_FOR_OPERATOR;
+    abc->a_unit        = 0U;
+    abc->b_unit        = 0U;
+    abc->c_unit        = 0U;
+    abc->abc_unit      = 0.0f;
 }
 
-void event_startElement_abc(struct srcsax_context* context, ...) {
-    va_list args;
-
-    va_start(args, context);
-
-    char const* const localname = va_arg(args, char const*);
-
-    /* prefix, uri */
-    REPEAT(2) va_arg(args, char const*);
-
-    /* num_namespaces */
-    va_arg(args, int);
-
-    /* namespaces */
-    va_arg(args, void const*);
-
-    /* num_attributes */
-    va_arg(args, int);
-
-    /* attributes */
-    va_arg(args, void const*);
-
-    uint32_t const unit_id = va_arg(args, uint32_t);
-    uint32_t const fn_id   = va_arg(args, uint32_t);
-
-    va_end(args);
-
-    if (STR_EQ_CONST(localname, "function")) {
-        VERBOSE_MSG_VARIADIC("ABC_START => %s", localname);
-        a_fn   = 0U;
-        b_fn   = 0U;
-        c_fn   = 0U;
-        abc_fn = 0.0f;
-    } else if (STR_EQ_CONST(localname, "call") || STR_EQ_CONST(localname, "goto")) {
-        VERBOSE_MSG_VARIADIC("ABC_BRANCHES++ => %s", localname);
-        b_overall++;
-        b_unit += (unit_id != 0xFFFFFFFF);
-        b_fn   += (fn_id   != 0xFFFFFFFF);
-    } else if (STR_EQ_CONST(localname, "comment")) {
-        VERBOSE_MSG_VARIADIC("ABC_START => %s", localname);
-        ac_read_state = AC_READ_STATE_COMMENT;
-    } else if (
-        STR_EQ_CONST(localname, "else")     ||
-        STR_EQ_CONST(localname, "case")     ||
-        STR_EQ_CONST(localname, "default")  ||
-        STR_EQ_CONST(localname, "ternary")
-    ) {
-        VERBOSE_MSG_VARIADIC("ABC_CONDITIONALS++ => %s", localname);
-        c_overall++;
-        c_unit += (unit_id != 0xFFFFFFFF);
-        c_fn   += (fn_id   != 0xFFFFFFFF);
-    } else if (STR_EQ_CONST(localname, "operator")) {
-        VERBOSE_MSG_VARIADIC("ABC_START => %s", localname);
-        ac_read_state = AC_READ_STATE_READING_OPERATOR;
-    } else if (STR_EQ_CONST(localname, "decl_stmt")) {
-        ac_read_state = AC_READ_STATE_DECLARATION;
-    } else if (ac_read_state == AC_READ_STATE_DECLARATION && STR_EQ_CONST(localname, "init")) {
-        VERBOSE_MSG_LITERAL("ABC_ASSIGNMENTS++ => (=)");
-        a_overall++;
-        a_unit += (unit_id != 0xFFFFFFFF);
-        a_fn   += (fn_id != 0xFFFFFFFF);
-        ac_read_state = AC_READ_STATE_WAITING_FOR_OPERATOR;
-    }
-}
+void event_endUnit_abc(Analysis* const analysis, UnitEvent const* const event) {
+    ABCState* const abc     = analysis->abc;
+    Chunk* const    strings = analysis->strings;
 
-void event_endElement_abc(struct srcsax_context* context, ...) {
-    va_list args;
+    uint32_t const unit_id = event->unit_id;
+
+    VERBOSE_MSG_VARIADIC("ABC_END => unit (%s)", get_chunk(strings, unit_id));
 
-    va_start(args, context);
+    abc->abc_unit
+        = sqrtf((float)((abc->a_unit * abc->a_unit) + (abc->b_unit * abc->b_unit) + (abc->c_unit * abc->c_unit)));
 
-    char const* const localname = va_arg(args, char const*);
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(abc->statistics, unit_id, METRIC_ABC, ABC_SUB_A, VAL_UNSIGNED(abc->a_unit)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(abc->statistics, unit_id, METRIC_ABC, ABC_SUB_B, VAL_UNSIGNED(abc->b_unit)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(abc->statistics, unit_id, METRIC_ABC, ABC_SUB_C, VAL_UNSIGNED(abc->c_unit)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(abc->statistics, unit_id, METRIC_ABC, ABC_SUB_ABC, VAL_FLOAT(abc->abc_unit)))
+}
 
-    /* prefix and uri */
-    REPEAT(2) va_arg(args, char const*);
+void event_startElement_abc(Analysis* const analysis, StartElementEvent const* const event) {
+    ABCState* const abc = analysis->abc;
+
+    char const* const localname = event->localname;
+    uint32_t const    unit_id   = event->unit_id;
+    uint32_t const    fn_id     = event->fn_id;
+    unsigned const    tag_id    = event->tag_id;
+
+    switch (tag_id) {
+        case C_FUNCTION:
+            VERBOSE_MSG_VARIADIC("ABC_START => %s", localname);
+            abc->a_fn   = 0U;
+            abc->b_fn   = 0U;
+            abc->c_fn   = 0U;
+            abc->abc_fn = 0.0f;
+            break;
+        case C_CALL:
+        case C_GOTO:
+            VERBOSE_MSG_VARIADIC("ABC_BRANCHES++ => %s", localname);
+            abc->b_overall++;
+            abc->b_unit += (unit_id != 0xFFFFFFFF);
+            abc->b_fn   += (fn_id   != 0xFFFFFFFF);
+            break;
+        case C_COMMENT:
+            VERBOSE_MSG_VARIADIC("ABC_START => %s", localname);
+            abc->ac_read_state = AC_READ_STATE_COMMENT;
+            break;
+        case C_ELSE:
+        case C_CASE:
+        case C_DEFAULT:
+        case C_TERNARY:
+            VERBOSE_MSG_VARIADIC("ABC_CONDITIONALS++ => %s", localname);
+            abc->c_overall++;
+            abc->c_unit += (unit_id != 0xFFFFFFFF);
+            abc->c_fn   += (fn_id   != 0xFFFFFFFF);
+            break;
+        case C_OPERATOR:
+            VERBOSE_MSG_VARIADIC("ABC_START => %s", localname);
+            abc->ac_read_state = AC_READ_STATE_READING_OPERATOR;
+            abc->op_at         = mark_arena(analysis->arenas + METRIC_ABC);
+            break;
+        case C_DECL_STMT:
+            abc->ac_read_state = AC_READ_STATE_DECLARATION;
+            break;
+        case C_INIT:
+            if (abc->ac_read_state != AC_READ_STATE_DECLARATION) break;
+            VERBOSE_MSG_LITERAL("ABC_ASSIGNMENTS++ => (=)");
+            abc->a_overall++;
+            abc->a_unit += (unit_id != 0xFFFFFFFF);
+            abc->a_fn   += (fn_id != 0xFFFFFFFF);
+            abc->ac_read_state = AC_READ_STATE_WAITING_FOR_OPERATOR;
+    }
+}
 
-    uint32_t const unit_id = va_arg(args, uint32_t);
-    uint32_t const fn_id   = va_arg(args, uint32_t);
+void event_endElement_abc(Analysis* const analysis, EndElementEvent const* const event) {
+    ABCState* const abc     = analysis->abc;
+    Chunk* const    strings = analysis->strings;
 
-    va_end(args);
+    char const* const localname = event->localname;
+    uint32_t const    unit_id   = event->unit_id;
+    uint32_t const    fn_id     = event->fn_id;
+    unsigned const    tag_id    = event->tag_id;
 
-    if (STR_EQ_CONST(localname, "function")) {
+    if (tag_id == C_FUNCTION) {
         VERBOSE_MSG_VARIADIC("ABC_END => function (%s)", get_chunk(strings, fn_id));
-        abc_fn
-            = sqrtf((float)((a_fn * a_fn) + (b_fn * b_fn) + (c_fn * c_fn)));
-
-        uint32_t key_id = add_chunk(strings, "ABC-A_", 6);
-        DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-        DEBUG_ERROR_IF(appendIndex_chunk(strings, fn_id) == NULL)
-        NDEBUG_EXECUTE(appendIndex_chunk(strings, fn_id))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(abc_statistics, key_id, VAL_UNSIGNED(a_fn)))
-
-        key_id = add_chunk(strings, "ABC-B_", 6);
-        DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-        DEBUG_ERROR_IF(appendIndex_chunk(strings, fn_id) == NULL)
-        NDEBUG_EXECUTE(appendIndex_chunk(strings, fn_id))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(abc_statistics, key_id, VAL_UNSIGNED(b_fn)))
-
-        key_id = add_chunk(strings, "ABC-C_", 6);
-        DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-        DEBUG_ERROR_IF(appendIndex_chunk(strings, fn_id) == NULL)
-        NDEBUG_EXECUTE(appendIndex_chunk(strings, fn_id))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(abc_statistics, key_id, VAL_UNSIGNED(c_fn)))
-
-        key_id = add_chunk(strings, "ABC_", 4);
-        DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-        DEBUG_ERROR_IF(appendIndex_chunk(strings, fn_id) == NULL)
-        NDEBUG_EXECUTE(appendIndex_chunk(strings, fn_id))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(abc_statistics, key_id, VAL_FLOAT(abc_fn)))
-    } else if (STR_EQ_CONST(localname, "comment")) {
+        abc->abc_fn
+            = sqrtf((float)((abc->a_fn * abc->a_fn) + (abc->b_fn * abc->b_fn) + (abc->c_fn * abc->c_fn)));
+
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(abc->statistics, fn_id, METRIC_ABC, ABC_SUB_A, VAL_UNSIGNED(abc->a_fn)))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(abc->statistics, fn_id, METRIC_ABC, ABC_SUB_B, VAL_UNSIGNED(abc->b_fn)))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(abc->statistics, fn_id, METRIC_ABC, ABC_SUB_C, VAL_UNSIGNED(abc->c_fn)))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(abc->statistics, fn_id, METRIC_ABC, ABC_SUB_ABC, VAL_FLOAT(abc->abc_fn)))
+    } else if (tag_id == C_COMMENT) {
         VERBOSE_MSG_VARIADIC("ABC_END => %s", localname);
-        ac_read_state = AC_READ_STATE_WAITING_FOR_OPERATOR;
-    } else if (STR_EQ_CONST(localname, "operator")) {
-        char const* const op = getLast_chunk(op_chunk);
-        DEBUG_ERROR_IF(op == NULL)
+        abc->ac_read_state = AC_READ_STATE_WAITING_FOR_OPERATOR;
+    } else if (tag_id == C_OPERATOR) {
+        Arena* const arena = analysis->arenas + METRIC_ABC;
+
+        append_arena(arena, "", 1);
+        char const* const op = get_arena(arena, abc->op_at);
 
         VERBOSE_MSG_VARIADIC("ABC_END => %s (%s)", localname, op);
 
@@ -279,9 +223,9 @@ void event_endElement_abc(struct srcsax_context* context, ...) {
             STR_EQ_CONST(op, "<")
         ) {
             VERBOSE_MSG_VARIADIC("ABC_CONDITIONALS++ (%s)", op);
-            c_overall++;
-            c_unit += (unit_id != 0xFFFFFFFF);
-            c_fn   += (fn_id != 0xFFFFFFFF);
+            abc->c_overall++;
+            abc->c_unit += (unit_id != 0xFFFFFFFF);
+            abc->c_fn   += (fn_id != 0xFFFFFFFF);
         } else if (
             STR_EQ_CONST(op, "++")  ||
             STR_EQ_CONST(op, "--")  ||
@@ -298,31 +242,28 @@ void event_endElement_abc(struct srcsax_context* context, ...) {
             STR_EQ_CONST(op, "=")
         ) {
             VERBOSE_MSG_VARIADIC("ABC_ASSIGNMENTS++ (%s)", op);
-            a_overall++;
-            a_unit += (unit_id != 0xFFFFFFFF);
-            a_fn   += (fn_id != 0xFFFFFFFF);
+            abc->a_overall++;
+            abc->a_unit += (unit_id != 0xFFFFFFFF);
+            abc->a_fn   += (fn_id != 0xFFFFFFFF);
         }
 
-        ac_read_state = AC_READ_STATE_WAITING_FOR_OPERATOR;
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(op_chunk))
+        abc->ac_read_state = AC_READ_STATE_WAITING_FOR_OPERATOR;
+        release_arena(arena, abc->op_at);
     }
 }
 
-void event_charactersUnit_abc(struct srcsax_context* context, ...) {
-    va_list args;
+void event_charactersUnit_abc(Analysis* const analysis, CharactersEvent const* const event) {
+    ABCState* const abc = analysis->abc;
 
-    if (ac_read_state != AC_READ_STATE_READING_OPERATOR) return;
+    if (abc->ac_read_state != AC_READ_STATE_READING_OPERATOR) return;
 
-    va_start(args, context);
-    char const* const ch = va_arg(args, char*);
-    uint64_t const len   = va_arg(args, uint64_t);
-    va_end(args);
+    char const* const ch  = event->ch;
+    uint64_t const    len = event->len;
 
-    DEBUG_ERROR_IF(append_chunk(op_chunk, ch, len) == NULL)
-    NDEBUG_EXECUTE(append_chunk(op_chunk, ch, len))
+    append_arena(analysis->arenas + METRIC_ABC, ch, len);
 }
 
-Map const* report_abc(void) {
+ResultTable const* report_abc(Analysis const* const analysis) {
     VERBOSE_MSG_LITERAL("ABC_REPORT");
-    return isValid_map(abc_statistics) ? abc_statistics : NULL;
+    return isValid_rtable(analysis->abc->statistics) ? analysis->abc->statistics : NULL;
 }
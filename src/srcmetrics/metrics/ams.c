@@ -3,219 +3,258 @@
  * @brief Average Method Size
  * @author Yavuz Koroglu
  */
-#include <stdarg.h>
+#include "languages/c.h"
 #include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/cache.h"
 #include "srcmetrics/metrics/ams.h"
+#include "srcmetrics/sizing.h"
 #include "padkit/chunk.h"
 #include "padkit/debug.h"
 #include "padkit/reallocate.h"
-#include "padkit/repeat.h"
-#include "padkit/streq.h"
-
-#define ENTRY_COUNT_GUESS UNIT_COUNT_GUESS
-
-static Map ams_statistics[1] = { NOT_A_MAP };
 
 #define AMS_READ_STATE_WAITING_METHOD    0U
 #define AMS_READ_STATE_READING_METHOD    1U
 #define AMS_READ_STATE_READING_STATEMENT 2U
-static unsigned  ams_read_state       = AMS_READ_STATE_WAITING_METHOD;
-
-static unsigned  method_count_unit    = 0U;
-static unsigned  method_count_overall = 0U;
-static unsigned  method_size          = 0U;
-static unsigned  ms_overall_cap       = FN_COUNT_GUESS;
-static unsigned* ms_overall_list      = NULL;
-static unsigned  ms_unit_cap          = FN_COUNT_GUESS / UNIT_COUNT_GUESS;
-static unsigned* ms_unit_list         = NULL;
-static float     ams_overall          = 0.0f;
-static float     ams_unit             = 0.0f;
-
-static void free_ams_stuff(void) {
+
+void free_ams(AMSState* const ams) {
+    if (!isValid_rtable(ams->statistics)) return;
+
     VERBOSE_MSG_LITERAL("AMS_FREE");
-    DEBUG_ABORT_IF(!free_map(ams_statistics))
-    NDEBUG_EXECUTE(free_map(ams_statistics))
-    free(ms_overall_list);
-    free(ms_unit_list);
-    ms_overall_list = NULL;
-    ms_unit_list    = NULL;
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_rtable(ams->statistics))
+    free(ams->ms_overall_list);
+    free(ams->ms_unit_list);
+    ams->ms_overall_list = NULL;
+    ams->ms_unit_list    = NULL;
+}
+
+void merge_ams(Analysis* const analysis, Analysis const* const partial) {
+    AMSState* const       ams         = analysis->ams;
+    AMSState const* const partial_ams = partial->ams;
+
+    VERBOSE_MSG_LITERAL("AMS_MERGE");
+
+    mergeStatistics_analysis(analysis, ams->statistics, partial, partial_ams->statistics);
+
+    /* The overall average needs every method size, NOT the unit averages */
+    for (
+        unsigned const* ms = partial_ams->ms_overall_list;
+        ms < partial_ams->ms_overall_list + partial_ams->method_count_overall;
+        ms++
+    ) {
+        ams->method_count_overall++;
+        REALLOC_IF_NECESSARY(
+            unsigned, ams->ms_overall_list,
+            unsigned, ams->ms_overall_cap, ams->method_count_overall,
+            {REALLOC_ERROR;}
+        )
+        ams->ms_overall_list[ams->method_count_overall - 1] = *ms;
+    }
+}
+
+bool save_ams(FILE* const stream, Analysis const* const partial) {
+    AMSState const* const ams = partial->ams;
+
+    VERBOSE_MSG_LITERAL("AMS_SAVE");
+
+    if (!writeStatistics_cache(stream, partial, ams->statistics)) return 0;
+    if (!writeUnsigned_cache(stream, ams->method_count_overall))  return 0;
+    for (
+        unsigned const* ms = ams->ms_overall_list;
+        ms < ams->ms_overall_list + ams->method_count_overall;
+        ms++
+    ) if (!writeUnsigned_cache(stream, *ms)) return 0;
+
+    return 1;
 }
 
-void event_startDocument_ams(struct srcsax_context* context, ...) {
-    static bool first_time_execution = 1;
+bool load_ams(Analysis* const partial, FILE* const stream) {
+    AMSState* const ams = partial->ams;
+    uint64_t        method_count, ms;
+
+    VERBOSE_MSG_LITERAL("AMS_LOAD");
+
+    if (!readStatistics_cache(stream, partial, ams->statistics)) return 0;
+    if (!readUnsigned_cache(stream, &method_count))              return 0;
+
+    /* The overall average needs every method size, see merge_ams() */
+    while (method_count--) {
+        if (!readUnsigned_cache(stream, &ms)) return 0;
+        ams->method_count_overall++;
+        REALLOC_IF_NECESSARY(
+            unsigned, ams->ms_overall_list,
+            unsigned, ams->ms_overall_cap, ams->method_count_overall,
+            {REALLOC_ERROR;}
+        )
+        ams->ms_overall_list[ams->method_count_overall - 1] = (unsigned)ms;
+    }
+
+    return 1;
+}
+
+void event_startDocument_ams(Analysis* const analysis) {
+    AMSState* const ams = analysis->ams;
 
     VERBOSE_MSG_LITERAL("AMS_START => document");
 
-    if (first_time_execution) {
+    if (!isValid_rtable(ams->statistics)) {
+        Sizing const* const sizing = get_sizing(analysis->isPartial);
+
         DEBUG_ASSERT_NDEBUG_EXECUTE(
-            constructEmpty_map(ams_statistics, ENTRY_COUNT_GUESS)
+            constructEmpty_rtable(ams->statistics, sizing->unit_count)
         )
 
-        ms_overall_list = malloc(ms_overall_cap * sizeof(unsigned));
-        DEBUG_ERROR_IF(ms_overall_list == NULL)
+        ams->ms_overall_cap  = sizing->fn_count;
+        ams->ms_overall_list = malloc(ams->ms_overall_cap * sizeof(unsigned));
+        DEBUG_ERROR_IF(ams->ms_overall_list == NULL)
 
-        ms_unit_list = malloc(ms_unit_cap * sizeof(unsigned));
-        DEBUG_ERROR_IF(ms_unit_list == NULL)
-
-        DEBUG_ERROR_IF(atexit(free_ams_stuff) != 0)
-        NDEBUG_EXECUTE(atexit(free_ams_stuff))
+        ams->ms_unit_cap  = sizing->fn_count > sizing->unit_count ? sizing->fn_count / sizing->unit_count : 1;
+        ams->ms_unit_list = malloc(ams->ms_unit_cap * sizeof(unsigned));
+        DEBUG_ERROR_IF(ams->ms_unit_list == NULL)
     } else {
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_map(ams_statistics))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_rtable(ams->statistics))
     }
 
-    ams_read_state       = AMS_READ_STATE_WAITING_METHOD;
-    ams_overall          = 0.0f;
-    method_count_overall = 0U;
+    ams->ams_read_state       = AMS_READ_STATE_WAITING_METHOD;
+    ams->ams_overall          = 0.0f;
+    ams->method_count_overall = 0U;
 }
 
-void event_endDocument_ams(struct srcsax_context* context, ...) {
+void event_endDocument_ams(Analysis* const analysis) {
+    AMSState* const ams = analysis->ams;
+
     VERBOSE_MSG_LITERAL("AMS_END => document");
 
     unsigned sum_ms = 0U;
     for (
-        unsigned const* ms = ms_overall_list + method_count_overall - 1;
-        ms >= ms_overall_list;
+        unsigned const* ms = ams->ms_overall_list + ams->method_count_overall - 1;
+        ms >= ams->ms_overall_list;
         ms--
     ) sum_ms += *ms;
 
-    ams_overall = (float)sum_ms / (float)method_count_overall;
-    uint32_t const key_id = add_chunk(strings, "AMS", 3);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(ams_statistics, key_id, VAL_FLOAT(ams_overall)))
+    ams->ams_overall = (float)sum_ms / (float)ams->method_count_overall;
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(ams->statistics, RESULT_OVERALL, METRIC_AMS, SUBMETRIC_ONLY, VAL_FLOAT(ams->ams_overall)))
 }
 
-void event_startUnit_ams(struct srcsax_context* context, ...) {
+void event_startUnit_ams(Analysis* const analysis, UnitEvent const* const event) {
+    AMSState* const ams = analysis->ams;
+
     VERBOSE_MSG_LITERAL("AMS_START => unit");
 
-    ams_read_state    = AMS_READ_STATE_WAITING_METHOD;
-    method_count_unit = 0U;
-    ams_unit          = 0.0f;
+    ams->ams_read_state    = AMS_READ_STATE_WAITING_METHOD;
+    ams->method_count_unit = 0U;
+    ams->ams_unit          = 0.0f;
 }
 
-void event_endUnit_ams(struct srcsax_context* context, ...) {
-    va_list args;
-
-    va_start(args, context);
-
-    /* localname, prefix, uri. */
-    REPEAT(3) va_arg(args, char const*);
-
-    uint32_t const unit_id = va_arg(args, uint32_t);
+void event_endUnit_ams(Analysis* const analysis, UnitEvent const* const event) {
+    AMSState* const ams     = analysis->ams;
+    Chunk* const    strings = analysis->strings;
+    uint32_t const  unit_id = event->unit_id;
 
     VERBOSE_MSG_VARIADIC("AMS_START => unit (%s)", get_chunk(strings, unit_id));
 
-    va_end(args);
-
     unsigned sum_ms = 0U;
     for (
-        unsigned const* ms = ms_unit_list + method_count_unit - 1;
-        ms >= ms_unit_list;
+        unsigned const* ms = ams->ms_unit_list + ams->method_count_unit - 1;
+        ms >= ams->ms_unit_list;
         ms--
     ) sum_ms += *ms;
 
-    ams_unit = (float)sum_ms / (float)method_count_unit;
+    ams->ams_unit = (float)sum_ms / (float)ams->method_count_unit;
 
-    uint32_t const key_id = add_chunk(strings, "AMS_", 4);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(ams_statistics, key_id, VAL_FLOAT(ams_unit)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(ams->statistics, unit_id, METRIC_AMS, SUBMETRIC_ONLY, VAL_FLOAT(ams->ams_unit)))
 }
 
-void event_startElement_ams(struct srcsax_context* context, ...) {
-    va_list args;
+void event_startElement_ams(Analysis* const analysis, StartElementEvent const* const event) {
+    AMSState* const ams = analysis->ams;
 
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
-    va_end(args);
+    char const* const localname = event->localname;
+    unsigned const    tag_id    = event->tag_id;
 
-    switch (ams_read_state) {
+    switch (ams->ams_read_state) {
         case AMS_READ_STATE_WAITING_METHOD:
-            if (!STR_EQ_CONST(localname, "function")) break;
+            if (tag_id != C_FUNCTION) break;
             VERBOSE_MSG_VARIADIC("AMS_METHOD_COUNT++ (%s)", localname);
-            ams_read_state = AMS_READ_STATE_READING_METHOD;
-            method_size    = 0U;
-            method_count_unit++;
-            method_count_overall++;
+            ams->ams_read_state = AMS_READ_STATE_READING_METHOD;
+            ams->method_size    = 0U;
+            ams->method_count_unit++;
+            ams->method_count_overall++;
             break;
         case AMS_READ_STATE_READING_METHOD:
-            if (
-                STR_EQ_CONST(localname, "expr_stmt") ||
-                STR_EQ_CONST(localname, "decl_stmt") ||
-                STR_EQ_CONST(localname, "return")    ||
-                STR_EQ_CONST(localname, "break")     ||
-                STR_EQ_CONST(localname, "continue")  ||
-                STR_EQ_CONST(localname, "label")     ||
-                STR_EQ_CONST(localname, "goto")      ||
-                STR_EQ_CONST(localname, "default")   ||
-                STR_EQ_CONST(localname, "case")      ||
-                STR_EQ_CONST(localname, "directive") ||
-                STR_EQ_CONST(localname, "macro")
-            ) {
-                VERBOSE_MSG_VARIADIC("AMS_METHOD_SIZE++ (%s)", localname);
-                ams_read_state = AMS_READ_STATE_READING_STATEMENT;
-                method_size++;
-            } else if (
-                STR_EQ_CONST(localname, "for")       ||
-                STR_EQ_CONST(localname, "while")     ||
-                STR_EQ_CONST(localname, "switch")    ||
-                STR_EQ_CONST(localname, "if_stmt")   ||
-                STR_EQ_CONST(localname, "typedef")   ||
-                STR_EQ_CONST(localname, "struct")    ||
-                STR_EQ_CONST(localname, "union")
-            ) {
-                VERBOSE_MSG_VARIADIC("AMS_METHOD_SIZE++ (%s)", localname);
-                method_size++;
+            switch (tag_id) {
+                case C_EXPR_STMT:
+                case C_DECL_STMT:
+                case C_RETURN:
+                case C_BREAK:
+                case C_CONTINUE:
+                case C_LABEL:
+                case C_GOTO:
+                case C_DEFAULT:
+                case C_CASE:
+                case C_DIRECTIVE:
+                case C_MACRO:
+                    VERBOSE_MSG_VARIADIC("AMS_METHOD_SIZE++ (%s)", localname);
+                    ams->ams_read_state = AMS_READ_STATE_READING_STATEMENT;
+                    ams->method_size++;
+                    break;
+                case C_FOR:
+                case C_WHILE:
+                case C_SWITCH:
+                case C_IF_STMT:
+                case C_TYPEDEF:
+                case C_STRUCT:
+                case C_UNION:
+                    VERBOSE_MSG_VARIADIC("AMS_METHOD_SIZE++ (%s)", localname);
+                    ams->method_size++;
             }
     }
 }
 
-void event_endElement_ams(struct srcsax_context* context, ...) {
-    va_list args;
+void event_endElement_ams(Analysis* const analysis, EndElementEvent const* const event) {
+    AMSState* const ams = analysis->ams;
 
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
-    va_end(args);
+    unsigned const tag_id = event->tag_id;
 
-    switch (ams_read_state) {
+    switch (ams->ams_read_state) {
         case AMS_READ_STATE_READING_METHOD:
-            if (!STR_EQ_CONST(localname, "function")) break;
+            if (tag_id != C_FUNCTION) break;
             VERBOSE_MSG_LITERAL("AMS_END => function");
-            ams_read_state = AMS_READ_STATE_WAITING_METHOD;
+            ams->ams_read_state = AMS_READ_STATE_WAITING_METHOD;
 
             REALLOC_IF_NECESSARY(
-                unsigned, ms_overall_list,
-                unsigned, ms_overall_cap, method_count_overall,
+                unsigned, ams->ms_overall_list,
+                unsigned, ams->ms_overall_cap, ams->method_count_overall,
                 {REALLOC_ERROR;}
             )
-            ms_overall_list[method_count_overall - 1] = method_size;
+            ams->ms_overall_list[ams->method_count_overall - 1] = ams->method_size;
 
             REALLOC_IF_NECESSARY(
-                unsigned, ms_unit_list,
-                unsigned, ms_unit_cap, method_count_unit,
+                unsigned, ams->ms_unit_list,
+                unsigned, ams->ms_unit_cap, ams->method_count_unit,
                 {REALLOC_ERROR;}
             )
-            ms_unit_list[method_count_unit - 1] = method_size;
+            ams->ms_unit_list[ams->method_count_unit - 1] = ams->method_size;
 
             break;
         case AMS_READ_STATE_READING_STATEMENT:
-            if (
-                STR_EQ_CONST(localname, "expr_stmt") ||
-                STR_EQ_CONST(localname, "decl_stmt") ||
-                STR_EQ_CONST(localname, "return")    ||
-                STR_EQ_CONST(localname, "break")     ||
-                STR_EQ_CONST(localname, "continue")  ||
-                STR_EQ_CONST(localname, "label")     ||
-                STR_EQ_CONST(localname, "goto")      ||
-                STR_EQ_CONST(localname, "default")   ||
-                STR_EQ_CONST(localname, "case")      ||
-                STR_EQ_CONST(localname, "directive") ||
-                STR_EQ_CONST(localname, "macro")
-            ) ams_read_state = AMS_READ_STATE_READING_METHOD;
+            switch (tag_id) {
+                case C_EXPR_STMT:
+                case C_DECL_STMT:
+                case C_RETURN:
+                case C_BREAK:
+                case C_CONTINUE:
+                case C_LABEL:
+                case C_GOTO:
+                case C_DEFAULT:
+                case C_CASE:
+                case C_DIRECTIVE:
+                case C_MACRO:
+                    ams->ams_read_state = AMS_READ_STATE_READING_METHOD;
+            }
     }
 }
 
-Map const* report_ams(void) {
+ResultTable const* report_ams(Analysis const* const analysis) {
     VERBOSE_MSG_LITERAL("AMS_REPORT");
-    return isValid_map(ams_statistics) ? ams_statistics : NULL;
+    return isValid_rtable(analysis->ams->statistics) ? analysis->ams->statistics : NULL;
 }
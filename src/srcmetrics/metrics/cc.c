@@ -5,57 +5,104 @@
  */
 #include "languages/c.h"
 #include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/cache.h"
 #include "srcmetrics/metrics/cc.h"
+#include "srcmetrics/profile.h"
+#include "srcmetrics/sizing.h"
 #include "padkit/debug.h"
-#include "padkit/repeat.h"
 #include "padkit/streq.h"
 
-#define ENTRY_COUNT_GUESS (UNIT_COUNT_GUESS + FN_COUNT_GUESS)
+void free_cc(CCState* const cc) {
+    if (!isValid_rtable(cc->statistics)) return;
 
-static Map cc_statistics[1] = { NOT_A_MAP };
-static CParse cparse[1]     = { NOT_A_CPARSE };
-
-static void free_cc_stuff(void) {
     VERBOSE_MSG_LITERAL("CC_FREE");
 
-    DEBUG_ABORT_IF(!free_map(cc_statistics))
-    NDEBUG_EXECUTE(free_map(cc_statistics))
-    free_cparse(cparse);
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_rtable(cc->statistics))
+    trim_cc(cc);
+}
+
+void trim_cc(CCState* const cc) {
+    if (!isValid_cparse(cc->cparse)) return;
+
+    VERBOSE_MSG_LITERAL("CC_TRIM");
+
+    /* The rows are enough for merge_cc(), the next unit constructs a CParse again */
+    free_cparse(cc->cparse);
+    *cc->cparse = NOT_A_CPARSE;
 }
 
-void event_startDocument_cc(struct srcsax_context* context, ...) {
-    static bool first_time_execution = 1;
+void merge_cc(Analysis* const analysis, Analysis const* const partial) {
+    VERBOSE_MSG_LITERAL("CC_MERGE");
+
+    /* Control flow graphs need the serial evaluation, see isParallelMetrics() */
+    mergeStatistics_analysis(analysis, analysis->cc->statistics, partial, partial->cc->statistics);
+
+    analysis->cc->cc_overall += partial->cc->cc_overall;
+}
+
+bool save_cc(FILE* const stream, Analysis const* const partial) {
+    VERBOSE_MSG_LITERAL("CC_SAVE");
+
+    return writeStatistics_cache(stream, partial, partial->cc->statistics)
+        && writeUnsigned_cache(stream, partial->cc->cc_overall);
+}
+
+bool load_cc(Analysis* const partial, FILE* const stream) {
+    uint64_t cc_overall;
+
+    VERBOSE_MSG_LITERAL("CC_LOAD");
+
+    if (!readStatistics_cache(stream, partial, partial->cc->statistics)) return 0;
+    if (!readUnsigned_cache(stream, &cc_overall))                        return 0;
+
+    partial->cc->cc_overall = (unsigned)cc_overall;
+    return 1;
+}
+
+void event_startDocument_cc(Analysis* const analysis) {
+    CCState* const cc = analysis->cc;
 
     VERBOSE_MSG_LITERAL("CC_START => document");
 
-    if (first_time_execution) {
-        first_time_execution = 0;
+    Sizing const* const sizing = get_sizing(analysis->isPartial);
 
+    if (!isValid_rtable(cc->statistics)) {
         DEBUG_ASSERT_NDEBUG_EXECUTE(
-            constructEmpty_map(cc_statistics, ENTRY_COUNT_GUESS)
+            constructEmpty_rtable(cc->statistics, sizing->entry_count)
         )
+    } else {
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_rtable(cc->statistics))
+    }
 
+    /* A trimmed Analysis has no CParse, see trim_cc() */
+    if (!isValid_cparse(cc->cparse)) {
         constructEmpty_cparse(
-            cparse,
-            CPARSE_RECOMMENDED_CHUNK_SIZE,
-            CPARSE_RECOMMENDED_CHUNK_ITEM_COUNT,
-            UNIT_COUNT_GUESS,
-            FN_COUNT_GUESS,
+            cc->cparse,
+            sizing->text_len,
+            sizing->stmt_count,
+            sizing->unit_count,
+            sizing->fn_count,
             CPARSE_RECOMMENDED_LOAD_PERCENT,
             CPARSE_RECOMMENDED_INITIAL_STACK_CAP
         );
-
-        DEBUG_ERROR_IF(atexit(free_cc_stuff) != 0)
-        NDEBUG_EXECUTE(atexit(free_cc_stuff))
     } else {
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_map(cc_statistics))
-        flush_cparse(cparse);
+        flush_cparse(cc->cparse);
     }
+
+    cc->cc_overall = 0U;
 }
 
-void event_endDocument_cc(struct srcsax_context* context, ...) {
+void event_endDocument_cc(Analysis* const analysis) {
+    CCState* const cc      = analysis->cc;
+    Chunk* const   strings = analysis->strings;
+
     VERBOSE_MSG_LITERAL("CC_END => document");
 
+    DEBUG_ASSERT_NDEBUG_EXECUTE(
+        insert_rtable(cc->statistics, RESULT_OVERALL, METRIC_CC, SUBMETRIC_ONLY, VAL_UNSIGNED(cc->cc_overall))
+    )
+
     if (isCFGEnabled()) {
         if (isDotEnabled()) {
             uint64_t const cfg_name_len = strlen(options.cfg_name);
@@ -65,34 +112,18 @@ void event_endDocument_cc(struct srcsax_context* context, ...) {
             char const* filename = append_chunk(strings, ".dot", 4);
             DEBUG_ERROR_IF(filename == NULL)
 
-            generateDot_cparse(cparse, filename, 0);
+            uint64_t const start = start_profile(analysis->profile);
+            generateDot_cparse(cc->cparse, filename, 0);
+            stop_profile(analysis->profile, PROFILE_GRAPHS, start);
         }
     }
 }
 
-void event_startUnit_cc(struct srcsax_context* context, ...) {
-    va_list args;
-
-    va_start(args, context);
-
-    /* localname, prefix, uri */
-    REPEAT(3) va_arg(args, char const*);
-
-    /* num_namespaces */
-    va_arg(args, int);
-
-    /* namespaces */
-    va_arg(args, void const*);
-
-    /* num_attributes */
-    va_arg(args, int);
-
-    /* attributes */
-    va_arg(args, void const*);
+void event_startUnit_cc(Analysis* const analysis, UnitEvent const* const event) {
+    CCState* const cc      = analysis->cc;
+    Chunk* const   strings = analysis->strings;
 
-    uint32_t const unit_id = va_arg(args, uint32_t);
-
-    va_end(args);
+    uint32_t const unit_id = event->unit_id;
 
     char const* const unit_name = get_chunk(strings, unit_id);
     DEBUG_ERROR_IF(unit_name == NULL)
@@ -101,40 +132,34 @@ void event_startUnit_cc(struct srcsax_context* context, ...) {
     DEBUG_ERROR_IF(unit_len == 0xFFFFFFFFFFFFFFFF)
 
     VERBOSE_MSG_VARIADIC("CC_START_UNIT (%s)", unit_name);
-    startUnit_cparse(cparse, unit_name, unit_len);
-}
-
-void event_endUnit_cc(struct srcsax_context* context, ...) {
-    VERBOSE_MSG_LITERAL("CC_END_UNIT");
-
-    endUnit_cparse(cparse);
+    startUnit_cparse(cc->cparse, unit_name, unit_len);
 }
 
-void event_startElement_cc(struct srcsax_context* context, ...) {
-    va_list args;
+void event_endUnit_cc(Analysis* const analysis, UnitEvent const* const event) {
+    CCState* const cc = analysis->cc;
 
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
+    uint32_t const unit_id = event->unit_id;
 
-    /* prefix, uri. */
-    REPEAT(2) va_arg(args, char const*);
+    VERBOSE_MSG_LITERAL("CC_END_UNIT");
 
-    /* num_namespaces */
-    va_arg(args, int);
+    endUnit_cparse(cc->cparse);
 
-    /* namespaces */
-    va_arg(args, void const*);
+    uint32_t const complexity = complexityUnit_cparse(cc->cparse, getUnitCount_cparse(cc->cparse) - 1, 0);
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(cc->statistics, unit_id, METRIC_CC, SUBMETRIC_ONLY, VAL_UNSIGNED(complexity)))
 
-    int const num_attributes = va_arg(args, int);
+    /* The overall complexity is the sum of the units, so the cached units count too */
+    cc->cc_overall += complexity;
+}
 
-    struct srcsax_attribute const* const attributes
-        = va_arg(args, struct srcsax_attribute const*);
+void event_startElement_cc(Analysis* const analysis, StartElementEvent const* const event) {
+    CCState* const cc = analysis->cc;
 
-    va_end(args);
+    char const* const localname = event->localname;
+    unsigned const    tag_id    = event->tag_id;
 
     for (
-        struct srcsax_attribute const* attribute = attributes + num_attributes - 1;
-        attribute >= attributes;
+        struct srcsax_attribute const* attribute = event->attributes + event->num_attributes - 1;
+        attribute >= event->attributes;
         attribute--)
     {
         if (
@@ -142,39 +167,43 @@ void event_startElement_cc(struct srcsax_context* context, ...) {
             STR_EQ_CONST(attribute->value, "elseif")
         ) {
             VERBOSE_MSG_LITERAL("CC_START_ELEMENT => elseif");
-            start_cparse(cparse, attribute->value);
+            start_cparse(cc->cparse, C_ELSEIF);
             return;
         }
     }
 
     VERBOSE_MSG_VARIADIC("CC_START_ELEMENT => %s", localname);
-    start_cparse(cparse, localname);
+    start_cparse(cc->cparse, tag_id);
 }
 
-void event_endElement_cc(struct srcsax_context* context, ...) {
-    va_list args;
+void event_endElement_cc(Analysis* const analysis, EndElementEvent const* const event) {
+    CCState* const cc = analysis->cc;
 
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
-    va_end(args);
+    char const* const localname = event->localname;
+    uint32_t const    fn_id     = event->fn_id;
+    unsigned const    tag_id    = event->tag_id;
 
     VERBOSE_MSG_VARIADIC("CC_END_ELEMENT => %s", localname);
-    end_cparse(cparse, localname);
+    end_cparse(cc->cparse, tag_id);
+
+    /* The function that just ended is the last one of the CParse */
+    if (tag_id == C_FUNCTION && fn_id != 0xFFFFFFFF) {
+        uint32_t const complexity = complexityFn_cparse(cc->cparse, getFnCount_cparse(cc->cparse) - 1, 0);
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(cc->statistics, fn_id, METRIC_CC, SUBMETRIC_ONLY, VAL_UNSIGNED(complexity)))
+    }
 }
 
-void event_charactersUnit_cc(struct srcsax_context* context, ...) {
-    va_list args;
+void event_charactersUnit_cc(Analysis* const analysis, CharactersEvent const* const event) {
+    CCState* const cc = analysis->cc;
 
-    va_start(args, context);
-    char const* const ch = va_arg(args, char const*);
-    uint64_t const len   = va_arg(args, uint64_t);
-    va_end(args);
+    char const* const ch  = event->ch;
+    uint64_t const    len = event->len;
 
-    appendIfPossible_cparse(cparse, ch, len);
+    appendIfPossible_cparse(cc->cparse, ch, len);
 }
 
-Map const* report_cc(void) {
+ResultTable const* report_cc(Analysis const* const analysis) {
     VERBOSE_MSG_LITERAL("CC_REPORT");
-    return isValid_map(cc_statistics) ? cc_statistics : NULL;
+    return isValid_rtable(analysis->cc->statistics) ? analysis->cc->statistics : NULL;
 }
 
@@ -4,456 +4,336 @@
  * @author Yavuz Koroglu
  */
 #include <math.h>
-#include <stdarg.h>
+#include "languages/c.h"
 #include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/cache.h"
 #include "srcmetrics/metrics/hsm.h"
+#include "srcmetrics/sizing.h"
 #include "padkit/chunkset.h"
 #include "padkit/debug.h"
 #include "padkit/reallocate.h"
-#include "padkit/repeat.h"
-#include "padkit/streq.h"
-
-#define ENTRY_COUNT_GUESS (UNIT_COUNT_GUESS + FN_COUNT_GUESS)
 
 #define HSM_READ_STATE_WAITING          0U
 #define HSM_READ_STATE_READING_OPERATOR 1U
-static unsigned hsm_read_state          = HSM_READ_STATE_WAITING;
-
-static Map hsm_statistics[1]            = { NOT_A_MAP };
-
-#define HSM_OPERATORS_OVERALL           0
-#define HSM_OPERATORS_UNIT              1
-#define HSM_OPERATORS_FN                2
-#define HSM_OPERANDS_OVERALL            3
-#define HSM_OPERANDS_UNIT               4
-#define HSM_OPERANDS_FN                 5
-#define HSM_SET_LAST                    HSM_OPERANDS_FN
-static ChunkSet set[HSM_SET_LAST + 1] = {
-    NOT_A_CHUNK_SET, NOT_A_CHUNK_SET, NOT_A_CHUNK_SET,
-    NOT_A_CHUNK_SET, NOT_A_CHUNK_SET, NOT_A_CHUNK_SET
-};
-
-/* # Distinct Operators */
-static unsigned nu1_overall             = 0U;
-static unsigned nu1_unit                = 0U;
-static unsigned nu1_fn                  = 0U;
-
-/* # Distinct Operands */
-static unsigned nu2_overall             = 0U;
-static unsigned nu2_unit                = 0U;
-static unsigned nu2_fn                  = 0U;
-
-/* # Operators */
-static unsigned n1_overall              = 0U;
-static unsigned n1_unit                 = 0U;
-static unsigned n1_fn                   = 0U;
-
-/* # Operands */
-static unsigned n2_overall              = 0U;
-static unsigned n2_unit                 = 0U;
-static unsigned n2_fn                   = 0U;
-
-/* Halstead Vocabulary */
-static unsigned nu_overall              = 0U;
-static unsigned nu_unit                 = 0U;
-static unsigned nu_fn                   = 0U;
-
-/* Halstead Length */
-static unsigned n_overall               = 0U;
-static unsigned n_unit                  = 0U;
-static unsigned n_fn                    = 0U;
-
-/* Halstead Bugs */
-static float b_overall                  = 0.0f;
-static float b_unit                     = 0.0f;
-static float b_fn                       = 0.0f;
-
-/* Halstead Time */
-static float t_overall                  = 0.0f;
-static float t_unit                     = 0.0f;
-static float t_fn                       = 0.0f;
-
-/* Halstead Volume */
-static float v_overall                  = 0.0f;
-static float v_unit                     = 0.0f;
-static float v_fn                       = 0.0f;
-
-/* Halstead Difficulty */
-static float d_overall                  = 0.0f;
-static float d_unit                     = 0.0f;
-static float d_fn                       = 0.0f;
-
-/* Halstead Effort */
-static float e_overall                  = 0.0f;
-static float e_unit                     = 0.0f;
-static float e_fn                       = 0.0f;
-
-static Chunk* chunk_stack               = NULL;
-static unsigned chunk_stack_size        = 0;
-static unsigned chunk_stack_cap         = BUFSIZ;
-
-static void free_hsm_stuff(void) {
-    VERBOSE_MSG_LITERAL("HSM_FREE");
 
-    DEBUG_ABORT_IF(!free_map(hsm_statistics))
-    NDEBUG_EXECUTE(free_map(hsm_statistics))
-    for (ChunkSet* hsm_set = set + HSM_SET_LAST; hsm_set >= set; hsm_set--)
-        DEBUG_ABORT_IF(!free_cset(hsm_set))
-        NDEBUG_EXECUTE(free_cset(hsm_set))
+#define HSM_OPERANDS_INITIAL_CAP        16
+
+void free_hsm(HSMState* const hsm) {
+    if (!isValid_rtable(hsm->statistics)) return;
 
-    while (chunk_stack_cap--)
-        free_chunk(chunk_stack + chunk_stack_cap);
+    VERBOSE_MSG_LITERAL("HSM_FREE");
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_rtable(hsm->statistics))
+    for (ChunkSet* hsm_set = hsm->set + HSM_SET_LAST; hsm_set >= hsm->set; hsm_set--)
+        DEBUG_ASSERT_NDEBUG_EXECUTE(free_cset(hsm_set))
 
-    free(chunk_stack);
+    free(hsm->operand_ats);
+    hsm->operand_ats = NULL;
 }
 
-void event_startDocument_hsm(struct srcsax_context* context, ...) {
-    static bool first_time_execution = 1;
+static void unite(ChunkSet* const set, ChunkSet const* const other) {
+    for (uint32_t key_id = getKeyCount_cset(other) - 1; key_id != 0xFFFFFFFF; key_id--) {
+        char const* const key  = getKey_cset(other, key_id);
+        uint64_t const key_len = strlen_cset(other, key_id);
+        DEBUG_ERROR_IF(addKey_cset(set, key, key_len) == 0xFFFFFFFF)
+        NDEBUG_EXECUTE(addKey_cset(set, key, key_len))
+    }
+}
 
-    VERBOSE_MSG_LITERAL("HSM_START => document");
+void merge_hsm(Analysis* const analysis, Analysis const* const partial) {
+    HSMState* const       hsm         = analysis->hsm;
+    HSMState const* const partial_hsm = partial->hsm;
 
-    if (first_time_execution) {
-        first_time_execution = 0;
+    VERBOSE_MSG_LITERAL("HSM_MERGE");
 
-        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_map(hsm_statistics, ENTRY_COUNT_GUESS))
+    mergeStatistics_analysis(analysis, hsm->statistics, partial, partial_hsm->statistics);
 
-        for (ChunkSet* hsm_set = set + HSM_SET_LAST; hsm_set >= set; hsm_set--)
-            DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_cset(hsm_set, CHUNK_SET_RECOMMENDED_PARAMETERS))
+    hsm->n1_overall += partial_hsm->n1_overall;
+    hsm->n2_overall += partial_hsm->n2_overall;
 
-        chunk_stack = calloc(chunk_stack_cap, sizeof(Chunk));
-        DEBUG_ERROR_IF(chunk_stack == NULL)
+    /* The distinct operators and operands of the whole input are the union of the partial sets */
+    unite(hsm->set + HSM_OPERATORS_OVERALL, partial_hsm->set + HSM_OPERATORS_OVERALL);
+    unite(hsm->set + HSM_OPERANDS_OVERALL, partial_hsm->set + HSM_OPERANDS_OVERALL);
+}
 
-        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_chunk(chunk_stack + chunk_stack_size++, BUFSIZ, 1))
+static bool saveSet(FILE* const stream, ChunkSet const* const set) {
+    uint32_t const key_count = getKeyCount_cset(set);
+    if (!writeUnsigned_cache(stream, key_count)) return 0;
+    for (uint32_t key_id = 0; key_id < key_count; key_id++)
+        if (!writeString_cache(stream, getKey_cset(set, key_id), strlen_cset(set, key_id))) return 0;
+    return 1;
+}
 
-        DEBUG_ERROR_IF(atexit(free_hsm_stuff) != 0)
-        NDEBUG_EXECUTE(atexit(free_hsm_stuff))
-    } else {
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_map(hsm_statistics))
+bool save_hsm(FILE* const stream, Analysis const* const partial) {
+    HSMState const* const hsm = partial->hsm;
 
-        for (ChunkSet* hsm_set = set + HSM_SET_LAST; hsm_set >= set; hsm_set--)
-            DEBUG_ASSERT_NDEBUG_EXECUTE(flush_cset(hsm_set))
+    VERBOSE_MSG_LITERAL("HSM_SAVE");
 
-        while (chunk_stack_size)
-            DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(chunk_stack + --chunk_stack_size))
+    return writeStatistics_cache(stream, partial, hsm->statistics)
+        && writeUnsigned_cache(stream, hsm->n1_overall)
+        && writeUnsigned_cache(stream, hsm->n2_overall)
+        && saveSet(stream, hsm->set + HSM_OPERATORS_OVERALL)
+        && saveSet(stream, hsm->set + HSM_OPERANDS_OVERALL);
+}
 
-        chunk_stack_size = 1;
+/* The keys go through the strings of the partial Analysis, which the next unit flushes anyway */
+static bool loadSet(ChunkSet* const set, FILE* const stream, Chunk* const strings) {
+    uint64_t key_count;
+    if (!readUnsigned_cache(stream, &key_count)) return 0;
+    while (key_count--) {
+        uint32_t const str_id = readString_cache(stream, strings);
+        if (str_id == 0xFFFFFFFF) return 0;
+        DEBUG_ERROR_IF(addKey_cset(set, get_chunk(strings, str_id), strlen_chunk(strings, str_id)) == 0xFFFFFFFF)
+        NDEBUG_EXECUTE(addKey_cset(set, get_chunk(strings, str_id), strlen_chunk(strings, str_id)))
     }
-
-    hsm_read_state    = HSM_READ_STATE_WAITING;
-    nu1_overall       = 0U;
-    nu2_overall       = 0U;
-    n1_overall        = 0U;
-    n2_overall        = 0U;
-    nu_overall        = 0U;
-    n_overall         = 0U;
-    v_overall         = 0.0f;
-    d_overall         = 0.0f;
-    e_overall         = 0.0f;
+    return 1;
 }
 
-void event_endDocument_hsm(struct srcsax_context* context, ...) {
-    VERBOSE_MSG_LITERAL("HSM_END => document");
+bool load_hsm(Analysis* const partial, FILE* const stream) {
+    HSMState* const hsm = partial->hsm;
+    uint64_t        n1_overall, n2_overall;
 
-    nu1_overall = getKeyCount_cset(set + HSM_OPERATORS_OVERALL);
-    nu2_overall = getKeyCount_cset(set + HSM_OPERANDS_OVERALL);
-    nu_overall  = nu1_overall + nu2_overall;
-    n_overall   = n1_overall + n2_overall;
-    v_overall   = (float)n_overall * log2f((float)nu_overall);
-    d_overall   = (.5f * (float)nu1_overall * (float)n2_overall) / (float)(nu2_overall);
-    e_overall   = v_overall * d_overall;
-    b_overall   = v_overall / 3000.0f;
-    t_overall   = e_overall / (18.0f * 3600.0f * 8.0f);
-
-    uint32_t key_id = add_chunk(strings, "HSM-V", 5);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(v_overall)))
-
-    key_id = add_chunk(strings, "HSM-D", 5);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(d_overall)))
-
-    key_id = add_chunk(strings, "HSM-E", 5);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(e_overall)))
-
-    key_id = add_chunk(strings, "HSM-B", 5);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(b_overall)))
-
-    key_id = add_chunk(strings, "HSM-T", 5);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(t_overall)))
-}
+    VERBOSE_MSG_LITERAL("HSM_LOAD");
 
-void event_startUnit_hsm(struct srcsax_context* context, ...) {
-    VERBOSE_MSG_LITERAL("HSM_START => unit");
+    if (!readStatistics_cache(stream, partial, hsm->statistics)) return 0;
+    if (!readUnsigned_cache(stream, &n1_overall))                return 0;
+    if (!readUnsigned_cache(stream, &n2_overall))                return 0;
+
+    hsm->n1_overall = (unsigned)n1_overall;
+    hsm->n2_overall = (unsigned)n2_overall;
 
-    flush_cset(set + HSM_OPERATORS_UNIT);
-    flush_cset(set + HSM_OPERANDS_UNIT);
-    nu1_unit = 0U;
-    nu2_unit = 0U;
-    n1_unit  = 0U;
-    n2_unit  = 0U;
-    nu_unit  = 0U;
-    n_unit   = 0U;
-    v_unit   = 0.0f;
-    d_unit   = 0.0f;
-    e_unit   = 0.0f;
+    return loadSet(hsm->set + HSM_OPERATORS_OVERALL, stream, partial->strings)
+        && loadSet(hsm->set + HSM_OPERANDS_OVERALL, stream, partial->strings);
 }
 
-void event_endUnit_hsm(struct srcsax_context* context, ...) {
-    va_list args;
+void event_startDocument_hsm(Analysis* const analysis) {
+    HSMState* const hsm = analysis->hsm;
 
-    va_start(args, context);
+    VERBOSE_MSG_LITERAL("HSM_START => document");
 
-    /* localname, prefix, uri */
-    REPEAT(3) va_arg(args, char const*);
+    if (!isValid_rtable(hsm->statistics)) {
+        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_rtable(hsm->statistics, get_sizing(analysis->isPartial)->entry_count))
 
-    uint32_t const unit_id = va_arg(args, uint32_t);
+        for (ChunkSet* hsm_set = hsm->set + HSM_SET_LAST; hsm_set >= hsm->set; hsm_set--)
+            DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_cset(hsm_set, CHUNK_SET_RECOMMENDED_PARAMETERS))
 
-    VERBOSE_MSG_VARIADIC("HSM_END => unit (%s)", get_chunk(strings, unit_id));
+        hsm->operand_cap = HSM_OPERANDS_INITIAL_CAP;
+        hsm->operand_ats = malloc(hsm->operand_cap * sizeof(uint64_t));
+        DEBUG_ERROR_IF(hsm->operand_ats == NULL)
+    } else {
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_rtable(hsm->statistics))
+
+        for (ChunkSet* hsm_set = hsm->set + HSM_SET_LAST; hsm_set >= hsm->set; hsm_set--)
+            DEBUG_ASSERT_NDEBUG_EXECUTE(flush_cset(hsm_set))
+    }
 
-    va_end(args);
-
-    nu1_unit = getKeyCount_cset(set + HSM_OPERATORS_UNIT);
-    nu2_unit = getKeyCount_cset(set + HSM_OPERANDS_UNIT);
-    nu_unit  = nu1_unit + nu2_unit;
-    n_unit   = n1_unit + nu2_unit;
-    v_unit   = (float)n_unit * log2f((float)nu_unit);
-    d_unit   = (.5f * (float)nu1_unit * (float)n2_unit) / (float)(nu2_unit);
-    e_unit   = v_unit * d_unit;
-    b_unit   = v_unit / 3000.0f;
-    t_unit   = e_unit / (18.0f * 3600.0f * 8.0f);
-
-    uint32_t key_id = add_chunk(strings, "HSM-V_", 6);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(v_unit)))
-
-    key_id = add_chunk(strings, "HSM-D_", 6);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(d_unit)))
-
-    key_id = add_chunk(strings, "HSM-E_", 6);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(e_unit)))
-
-    key_id = add_chunk(strings, "HSM-B_", 6);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(b_unit)))
-
-    key_id = add_chunk(strings, "HSM-T_", 6);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(t_unit)))
+    hsm->operand_count     = 0;
+    hsm->hsm_read_state    = HSM_READ_STATE_WAITING;
+    hsm->nu1_overall       = 0U;
+    hsm->nu2_overall       = 0U;
+    hsm->n1_overall        = 0U;
+    hsm->n2_overall        = 0U;
+    hsm->nu_overall        = 0U;
+    hsm->n_overall         = 0U;
+    hsm->v_overall         = 0.0f;
+    hsm->d_overall         = 0.0f;
+    hsm->e_overall         = 0.0f;
 }
 
-void event_startElement_hsm(struct srcsax_context* context, ...) {
-    va_list args;
+void event_endDocument_hsm(Analysis* const analysis) {
+    HSMState* const hsm = analysis->hsm;
 
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
+    VERBOSE_MSG_LITERAL("HSM_END => document");
 
-    /* prefix, uri */
-    REPEAT(2) va_arg(args, char const*);
+    hsm->nu1_overall = getKeyCount_cset(hsm->set + HSM_OPERATORS_OVERALL);
+    hsm->nu2_overall = getKeyCount_cset(hsm->set + HSM_OPERANDS_OVERALL);
+    hsm->nu_overall  = hsm->nu1_overall + hsm->nu2_overall;
+    hsm->n_overall   = hsm->n1_overall + hsm->n2_overall;
+    hsm->v_overall   = (float)hsm->n_overall * log2f((float)hsm->nu_overall);
+    hsm->d_overall   = (.5f * (float)hsm->nu1_overall * (float)hsm->n2_overall) / (float)(hsm->nu2_overall);
+    hsm->e_overall   = hsm->v_overall * hsm->d_overall;
+    hsm->b_overall   = hsm->v_overall / 3000.0f;
+    hsm->t_overall   = hsm->e_overall / (18.0f * 3600.0f * 8.0f);
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, RESULT_OVERALL, METRIC_HSM, HSM_SUB_V, VAL_FLOAT(hsm->v_overall)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, RESULT_OVERALL, METRIC_HSM, HSM_SUB_D, VAL_FLOAT(hsm->d_overall)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, RESULT_OVERALL, METRIC_HSM, HSM_SUB_E, VAL_FLOAT(hsm->e_overall)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, RESULT_OVERALL, METRIC_HSM, HSM_SUB_B, VAL_FLOAT(hsm->b_overall)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, RESULT_OVERALL, METRIC_HSM, HSM_SUB_T, VAL_FLOAT(hsm->t_overall)))
+}
 
-    /* num_namespaces */
-    va_arg(args, int);
+void event_startUnit_hsm(Analysis* const analysis, UnitEvent const* const event) {
+    HSMState* const hsm = analysis->hsm;
 
-    /* namespaces */
-    va_arg(args, void const*);
+    VERBOSE_MSG_LITERAL("HSM_START => unit");
+
+    flush_cset(hsm->set + HSM_OPERATORS_UNIT);
+    flush_cset(hsm->set + HSM_OPERANDS_UNIT);
+    hsm->nu1_unit = 0U;
+    hsm->nu2_unit = 0U;
+    hsm->n1_unit  = 0U;
+    hsm->n2_unit  = 0U;
+    hsm->nu_unit  = 0U;
+    hsm->n_unit   = 0U;
+    hsm->v_unit   = 0.0f;
+    hsm->d_unit   = 0.0f;
+    hsm->e_unit   = 0.0f;
+}
 
-    /* num_attributes */
-    va_arg(args, int);
+void event_endUnit_hsm(Analysis* const analysis, UnitEvent const* const event) {
+    HSMState* const hsm     = analysis->hsm;
+    Chunk* const    strings = analysis->strings;
+    uint32_t const  unit_id = event->unit_id;
+
+    VERBOSE_MSG_VARIADIC("HSM_END => unit (%s)", get_chunk(strings, unit_id));
 
-    /* attributes */
-    va_arg(args, void const*);
+    hsm->nu1_unit = getKeyCount_cset(hsm->set + HSM_OPERATORS_UNIT);
+    hsm->nu2_unit = getKeyCount_cset(hsm->set + HSM_OPERANDS_UNIT);
+    hsm->nu_unit  = hsm->nu1_unit + hsm->nu2_unit;
+    hsm->n_unit   = hsm->n1_unit + hsm->nu2_unit;
+    hsm->v_unit   = (float)hsm->n_unit * log2f((float)hsm->nu_unit);
+    hsm->d_unit   = (.5f * (float)hsm->nu1_unit * (float)hsm->n2_unit) / (float)(hsm->nu2_unit);
+    hsm->e_unit   = hsm->v_unit * hsm->d_unit;
+    hsm->b_unit   = hsm->v_unit / 3000.0f;
+    hsm->t_unit   = hsm->e_unit / (18.0f * 3600.0f * 8.0f);
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, unit_id, METRIC_HSM, HSM_SUB_V, VAL_FLOAT(hsm->v_unit)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, unit_id, METRIC_HSM, HSM_SUB_D, VAL_FLOAT(hsm->d_unit)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, unit_id, METRIC_HSM, HSM_SUB_E, VAL_FLOAT(hsm->e_unit)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, unit_id, METRIC_HSM, HSM_SUB_B, VAL_FLOAT(hsm->b_unit)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, unit_id, METRIC_HSM, HSM_SUB_T, VAL_FLOAT(hsm->t_unit)))
+}
 
-    uint32_t const unit_id = va_arg(args, uint32_t);
-    uint32_t const fn_id   = va_arg(args, uint32_t);
+void event_startElement_hsm(Analysis* const analysis, StartElementEvent const* const event) {
+    HSMState* const hsm = analysis->hsm;
 
-    va_end(args);
+    uint32_t const unit_id = event->unit_id;
+    uint32_t const fn_id   = event->fn_id;
+    unsigned const tag_id  = event->tag_id;
 
-    if (STR_EQ_CONST(localname, "function")) {
+    if (tag_id == C_FUNCTION) {
         VERBOSE_MSG_LITERAL("HSM_START => function");
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_cset(set + HSM_OPERATORS_FN))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_cset(set + HSM_OPERANDS_FN))
-        nu1_fn = 0U;
-        nu2_fn = 0U;
-        n1_fn  = 0U;
-        n2_fn  = 0U;
-        nu_fn  = 0U;
-        n_fn   = 0U;
-        v_fn   = 0.0f;
-        d_fn   = 0.0f;
-        e_fn   = 0.0f;
-    } else if (STR_EQ_CONST(localname, "expr")) {
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_cset(hsm->set + HSM_OPERATORS_FN))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_cset(hsm->set + HSM_OPERANDS_FN))
+        hsm->nu1_fn = 0U;
+        hsm->nu2_fn = 0U;
+        hsm->n1_fn  = 0U;
+        hsm->n2_fn  = 0U;
+        hsm->nu_fn  = 0U;
+        hsm->n_fn   = 0U;
+        hsm->v_fn   = 0.0f;
+        hsm->d_fn   = 0.0f;
+        hsm->e_fn   = 0.0f;
+    } else if (tag_id == C_EXPR) {
         VERBOSE_MSG_LITERAL("HSM_N2++ (operand)");
-        n2_overall++;
-        n2_unit += (unit_id != 0xFFFFFFFF);
-        n2_fn   += (fn_id   != 0xFFFFFFFF);
-
-        RECALLOC_IF_NECESSARY(
-            Chunk*, chunk_stack,
-            unsigned, chunk_stack_cap, chunk_stack_size,
-            {RECALLOC_ERROR;}
+        hsm->n2_overall++;
+        hsm->n2_unit += (unit_id != 0xFFFFFFFF);
+        hsm->n2_fn   += (fn_id   != 0xFFFFFFFF);
+
+        REALLOC_IF_NECESSARY(
+            uint64_t, hsm->operand_ats,
+            unsigned, hsm->operand_cap, hsm->operand_count,
+            {REALLOC_ERROR;}
         )
-
-        if (!isValid_chunk(chunk_stack + chunk_stack_size))
-            DEBUG_ASSERT_NDEBUG_EXECUTE(
-                constructEmpty_chunk(chunk_stack + chunk_stack_size, BUFSIZ, 1)
-            )
-
-        chunk_stack_size++;
-    } else if (STR_EQ_CONST(localname, "operator")) {
+        hsm->operand_ats[hsm->operand_count++] = mark_arena(analysis->arenas + METRIC_HSM);
+    } else if (tag_id == C_OPERATOR) {
         VERBOSE_MSG_LITERAL("HSM_N1++ (operator)");
-        n1_overall++;
-        n1_unit += (unit_id != 0xFFFFFFFF);
-        n1_fn   += (fn_id   != 0xFFFFFFFF);
-        hsm_read_state = HSM_READ_STATE_READING_OPERATOR;
+        hsm->n1_overall++;
+        hsm->n1_unit += (unit_id != 0xFFFFFFFF);
+        hsm->n1_fn   += (fn_id   != 0xFFFFFFFF);
+        hsm->hsm_read_state = HSM_READ_STATE_READING_OPERATOR;
+        hsm->operator_at    = mark_arena(analysis->arenas + METRIC_HSM);
     }
 }
 
-void event_endElement_hsm(struct srcsax_context* context, ...) {
-    va_list args;
-
-    va_start(args, context);
-
-    char const* const localname = va_arg(args, char const*);
-
-    /* prefix and uri */
-    REPEAT(2) va_arg (args, char const*);
+void event_endElement_hsm(Analysis* const analysis, EndElementEvent const* const event) {
+    HSMState* const hsm     = analysis->hsm;
+    Arena* const    arena   = analysis->arenas + METRIC_HSM;
+    Chunk* const    strings = analysis->strings;
 
-    uint32_t const unit_id = va_arg(args, uint32_t);
-    uint32_t const fn_id   = va_arg(args, uint32_t);
+    uint32_t const unit_id = event->unit_id;
+    uint32_t const fn_id   = event->fn_id;
+    unsigned const tag_id  = event->tag_id;
 
-    va_end(args);
-
-    if (STR_EQ_CONST(localname, "function")) {
+    if (tag_id == C_FUNCTION) {
         VERBOSE_MSG_VARIADIC("HSM_END => function (%s)", get_chunk(strings, fn_id));
-        nu1_fn  = getKeyCount_cset(set + HSM_OPERATORS_FN);
-        nu2_fn  = getKeyCount_cset(set + HSM_OPERANDS_FN);
-        nu_fn   = nu1_fn + nu2_fn;
-        n_fn    = n1_fn + nu2_fn;
-        v_fn    = (float)n_fn * log2f((float)nu_fn);
-        d_fn    = (.5f * (float)nu1_fn * (float)n2_fn) / (float)(nu2_fn);
-        e_fn    = v_fn * d_fn;
-        b_fn    = v_fn / 3000.0f;
-        t_fn    = e_fn / (18.0f * 3600.0f * 8.0f);
-
-        uint32_t key_id = add_chunk(strings, "HSM-V_", 6);
-        DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-        DEBUG_ERROR_IF(appendIndex_chunk(strings, fn_id) == NULL)
-        NDEBUG_EXECUTE(appendIndex_chunk(strings, fn_id))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(v_fn)))
-
-        key_id = add_chunk(strings, "HSM-D_", 6);
-        DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-        DEBUG_ERROR_IF(appendIndex_chunk(strings, fn_id) == NULL)
-        NDEBUG_EXECUTE(appendIndex_chunk(strings, fn_id))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(d_fn)))
-
-        key_id = add_chunk(strings, "HSM-E_", 6);
-        DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-        DEBUG_ERROR_IF(appendIndex_chunk(strings, fn_id) == NULL)
-        NDEBUG_EXECUTE(appendIndex_chunk(strings, fn_id))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(e_fn)))
-
-        key_id = add_chunk(strings, "HSM-B_", 6);
-        DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-        DEBUG_ERROR_IF(appendIndex_chunk(strings, fn_id) == NULL)
-        NDEBUG_EXECUTE(appendIndex_chunk(strings, fn_id))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(b_fn)))
-
-        key_id = add_chunk(strings, "HSM-T_", 6);
-        DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-        DEBUG_ERROR_IF(appendIndex_chunk(strings, fn_id) == NULL)
-        NDEBUG_EXECUTE(appendIndex_chunk(strings, fn_id))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(hsm_statistics, key_id, VAL_FLOAT(t_fn)))
-    } else if (STR_EQ_CONST(localname, "expr")) {
-        if (chunk_stack_size <= 1) {TERMINATE_ERROR;}
-
-        Chunk* last_chunk = chunk_stack + --chunk_stack_size;
-        char const* const op = getLast_chunk(last_chunk);
-        DEBUG_ERROR_IF(op == NULL)
-
-        uint64_t const op_len = strlenLast_chunk(last_chunk);
+        hsm->nu1_fn  = getKeyCount_cset(hsm->set + HSM_OPERATORS_FN);
+        hsm->nu2_fn  = getKeyCount_cset(hsm->set + HSM_OPERANDS_FN);
+        hsm->nu_fn   = hsm->nu1_fn + hsm->nu2_fn;
+        hsm->n_fn    = hsm->n1_fn + hsm->nu2_fn;
+        hsm->v_fn    = (float)hsm->n_fn * log2f((float)hsm->nu_fn);
+        hsm->d_fn    = (.5f * (float)hsm->nu1_fn * (float)hsm->n2_fn) / (float)(hsm->nu2_fn);
+        hsm->e_fn    = hsm->v_fn * hsm->d_fn;
+        hsm->b_fn    = hsm->v_fn / 3000.0f;
+        hsm->t_fn    = hsm->e_fn / (18.0f * 3600.0f * 8.0f);
+
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, fn_id, METRIC_HSM, HSM_SUB_V, VAL_FLOAT(hsm->v_fn)))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, fn_id, METRIC_HSM, HSM_SUB_D, VAL_FLOAT(hsm->d_fn)))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, fn_id, METRIC_HSM, HSM_SUB_E, VAL_FLOAT(hsm->e_fn)))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, fn_id, METRIC_HSM, HSM_SUB_B, VAL_FLOAT(hsm->b_fn)))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(hsm->statistics, fn_id, METRIC_HSM, HSM_SUB_T, VAL_FLOAT(hsm->t_fn)))
+    } else if (tag_id == C_EXPR) {
+        if (hsm->operand_count == 0) {TERMINATE_ERROR;}
+
+        uint64_t const    op_at  = hsm->operand_ats[--hsm->operand_count];
+        char const* const op     = get_arena(arena, op_at);
+        uint64_t const    op_len = mark_arena(arena) - op_at;
         DEBUG_ERROR_IF(op_len == 0)
 
         VERBOSE_MSG_VARIADIC("HSM_OPERAND => %.*s", (int)op_len, op);
 
-        DEBUG_ERROR_IF(addKey_cset(set + HSM_OPERANDS_OVERALL, op, op_len) == 0xFFFFFFFF)
-        NDEBUG_EXECUTE(addKey_cset(set + HSM_OPERANDS_OVERALL, op, op_len))
+        DEBUG_ERROR_IF(addKey_cset(hsm->set + HSM_OPERANDS_OVERALL, op, op_len) == 0xFFFFFFFF)
+        NDEBUG_EXECUTE(addKey_cset(hsm->set + HSM_OPERANDS_OVERALL, op, op_len))
 
         if (unit_id != 0xFFFFFFFF) {
-            DEBUG_ERROR_IF(addKey_cset(set + HSM_OPERANDS_UNIT, op, op_len) == 0xFFFFFFFF)
-            NDEBUG_EXECUTE(addKey_cset(set + HSM_OPERANDS_UNIT, op, op_len))
+            DEBUG_ERROR_IF(addKey_cset(hsm->set + HSM_OPERANDS_UNIT, op, op_len) == 0xFFFFFFFF)
+            NDEBUG_EXECUTE(addKey_cset(hsm->set + HSM_OPERANDS_UNIT, op, op_len))
         }
         if (fn_id != 0xFFFFFFFF) {
-            DEBUG_ERROR_IF(addKey_cset(set + HSM_OPERANDS_FN, op, op_len) == 0xFFFFFFFF)
-            NDEBUG_EXECUTE(addKey_cset(set + HSM_OPERANDS_FN, op, op_len))
+            DEBUG_ERROR_IF(addKey_cset(hsm->set + HSM_OPERANDS_FN, op, op_len) == 0xFFFFFFFF)
+            NDEBUG_EXECUTE(addKey_cset(hsm->set + HSM_OPERANDS_FN, op, op_len))
         }
 
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(last_chunk))
-    } else if (STR_EQ_CONST(localname, "operator")) {
-        char const* const op = getLast_chunk(chunk_stack);
-        DEBUG_ERROR_IF(op == NULL)
-
-        uint64_t const op_len = strlenLast_chunk(chunk_stack);
+        /* The outer expressions still need the text */
+        if (hsm->operand_count == 0) release_arena(arena, op_at);
+    } else if (tag_id == C_OPERATOR) {
+        char const* const op     = get_arena(arena, hsm->operator_at);
+        uint64_t const    op_len = mark_arena(arena) - hsm->operator_at;
         DEBUG_ERROR_IF(op_len == 0)
 
         VERBOSE_MSG_VARIADIC("HSM_OPERATOR => %.*s", (int)op_len, op);
 
-        DEBUG_ERROR_IF(addKey_cset(set + HSM_OPERATORS_OVERALL, op, op_len) == 0xFFFFFFFF)
-        NDEBUG_EXECUTE(addKey_cset(set + HSM_OPERATORS_OVERALL, op, op_len))
+        DEBUG_ERROR_IF(addKey_cset(hsm->set + HSM_OPERATORS_OVERALL, op, op_len) == 0xFFFFFFFF)
+        NDEBUG_EXECUTE(addKey_cset(hsm->set + HSM_OPERATORS_OVERALL, op, op_len))
 
         if (unit_id != 0xFFFFFFFF) {
-            DEBUG_ERROR_IF(addKey_cset(set + HSM_OPERATORS_UNIT, op, op_len) == 0xFFFFFFFF)
-            NDEBUG_EXECUTE(addKey_cset(set + HSM_OPERATORS_UNIT, op, op_len))
+            DEBUG_ERROR_IF(addKey_cset(hsm->set + HSM_OPERATORS_UNIT, op, op_len) == 0xFFFFFFFF)
+            NDEBUG_EXECUTE(addKey_cset(hsm->set + HSM_OPERATORS_UNIT, op, op_len))
         }
         if (fn_id != 0xFFFFFFFF) {
-            DEBUG_ERROR_IF(addKey_cset(set + HSM_OPERATORS_FN, op, op_len) == 0xFFFFFFFF)
-            NDEBUG_EXECUTE(addKey_cset(set + HSM_OPERATORS_FN, op, op_len))
+            DEBUG_ERROR_IF(addKey_cset(hsm->set + HSM_OPERATORS_FN, op, op_len) == 0xFFFFFFFF)
+            NDEBUG_EXECUTE(addKey_cset(hsm->set + HSM_OPERATORS_FN, op, op_len))
         }
 
-        hsm_read_state = HSM_READ_STATE_WAITING;
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(chunk_stack))
+        hsm->hsm_read_state = HSM_READ_STATE_WAITING;
+        if (hsm->operand_count == 0) release_arena(arena, hsm->operator_at);
     }
 }
 
-void event_charactersUnit_hsm(struct srcsax_context* context, ...) {
-    va_list args;
+void event_charactersUnit_hsm(Analysis* const analysis, CharactersEvent const* const event) {
+    HSMState* const hsm = analysis->hsm;
 
-    va_start(args, context);
-    char const* const ch = va_arg(args, char*);
-    uint64_t const len   = va_arg(args, uint64_t);
-    va_end(args);
+    char const* const ch  = event->ch;
+    uint64_t const    len = event->len;
 
-    if (hsm_read_state == HSM_READ_STATE_READING_OPERATOR) {
-        DEBUG_ERROR_IF(append_chunk(chunk_stack, ch, len) == NULL)
-        NDEBUG_EXECUTE(append_chunk(chunk_stack, ch, len))
-    }
-
-    for (
-        Chunk* operand_chunk = chunk_stack + chunk_stack_size - 1;
-        operand_chunk > chunk_stack;
-        operand_chunk--
-    ) {
-        DEBUG_ERROR_IF(append_chunk(operand_chunk, ch, len) == NULL)
-        NDEBUG_EXECUTE(append_chunk(operand_chunk, ch, len))
-    }
+    /* Once for the operator and every open expression, instead of once each */
+    if (hsm->hsm_read_state == HSM_READ_STATE_READING_OPERATOR || hsm->operand_count > 0)
+        append_arena(analysis->arenas + METRIC_HSM, ch, len);
 }
 
-Map const* report_hsm(void) {
+ResultTable const* report_hsm(Analysis const* const analysis) {
     VERBOSE_MSG_LITERAL("HSM_REPORT");
-    return isValid_map(hsm_statistics) ? hsm_statistics : NULL;
+    return isValid_rtable(analysis->hsm->statistics) ? analysis->hsm->statistics : NULL;
 }
 
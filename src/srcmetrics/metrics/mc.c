@@ -3,94 +3,106 @@
  * @brief Method Count
  * @author Yavuz Koroglu
  */
-#include <stdarg.h>
+#include "languages/c.h"
 #include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/cache.h"
 #include "srcmetrics/metrics/mc.h"
+#include "srcmetrics/sizing.h"
 #include "padkit/chunk.h"
 #include "padkit/debug.h"
-#include "padkit/repeat.h"
-#include "padkit/streq.h"
 
-#define ENTRY_COUNT_GUESS UNIT_COUNT_GUESS
+void free_mc(MCState* const mc) {
+    if (!isValid_rtable(mc->statistics)) return;
 
-static Map mc_statistics[1] = { NOT_A_MAP };
+    VERBOSE_MSG_LITERAL("MC_FREE");
 
-static unsigned mc_overall  = 0U;
-static unsigned mc_unit     = 0U;
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_rtable(mc->statistics))
+}
 
-static void free_mc_statistics(void) {
-    VERBOSE_MSG_LITERAL("MC_FREE");
-    DEBUG_ABORT_IF(!free_map(mc_statistics))
-    NDEBUG_EXECUTE(free_map(mc_statistics))
+void merge_mc(Analysis* const analysis, Analysis const* const partial) {
+    MCState* const mc = analysis->mc;
+
+    VERBOSE_MSG_LITERAL("MC_MERGE");
+
+    mergeStatistics_analysis(analysis, mc->statistics, partial, partial->mc->statistics);
+
+    mc->mc_overall += partial->mc->mc_overall;
 }
 
-void event_startDocument_mc(struct srcsax_context* context, ...) {
-    static bool first_time_execution = 1;
+bool save_mc(FILE* const stream, Analysis const* const partial) {
+    MCState const* const mc = partial->mc;
 
-    VERBOSE_MSG_LITERAL("MC_START => document");
+    VERBOSE_MSG_LITERAL("MC_SAVE");
+
+    return writeStatistics_cache(stream, partial, mc->statistics)
+        && writeUnsigned_cache(stream, mc->mc_overall);
+}
 
-    if (first_time_execution) {
-        first_time_execution = 0;
+bool load_mc(Analysis* const partial, FILE* const stream) {
+    MCState* const mc = partial->mc;
+    uint64_t       mc_overall;
 
-        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_map(mc_statistics, ENTRY_COUNT_GUESS))
+    VERBOSE_MSG_LITERAL("MC_LOAD");
 
-        DEBUG_ERROR_IF(atexit(free_mc_statistics) != 0)
-        NDEBUG_EXECUTE(atexit(free_mc_statistics))
+    if (!readStatistics_cache(stream, partial, mc->statistics)) return 0;
+    if (!readUnsigned_cache(stream, &mc_overall))               return 0;
+
+    mc->mc_overall = (unsigned)mc_overall;
+    return 1;
+}
+
+void event_startDocument_mc(Analysis* const analysis) {
+    MCState* const mc = analysis->mc;
+
+    VERBOSE_MSG_LITERAL("MC_START => document");
+
+    if (!isValid_rtable(mc->statistics)) {
+        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_rtable(mc->statistics, get_sizing(analysis->isPartial)->unit_count))
     } else {
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_map(mc_statistics))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_rtable(mc->statistics))
     }
 
-    mc_overall = 0U;
+    mc->mc_overall = 0U;
 }
 
-void event_endDocument_mc(struct srcsax_context* context, ...) {
+void event_endDocument_mc(Analysis* const analysis) {
+    MCState* const mc = analysis->mc;
+
     VERBOSE_MSG_LITERAL("MC_END => document");
-    uint32_t const key_id = add_chunk(strings, "MC", 2);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(mc_statistics, key_id, VAL_UNSIGNED(mc_overall)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(mc->statistics, RESULT_OVERALL, METRIC_MC, SUBMETRIC_ONLY, VAL_UNSIGNED(mc->mc_overall)))
 }
 
-void event_startUnit_mc(struct srcsax_context* context, ...) {
+void event_startUnit_mc(Analysis* const analysis, UnitEvent const* const event) {
+    MCState* const mc = analysis->mc;
+
     VERBOSE_MSG_LITERAL("MC_START => unit");
-    mc_unit = 0U;
+    mc->mc_unit = 0U;
 }
 
-void event_endUnit_mc(struct srcsax_context* context, ...) {
-    va_list args;
-
-    va_start(args, context);
-
-    /* Unused variables: localname, prefix, uri */
-    REPEAT(3) va_arg(args, char const*);
-
-    uint32_t const unit_id = va_arg(args, uint32_t);
+void event_endUnit_mc(Analysis* const analysis, UnitEvent const* const event) {
+    MCState* const mc      = analysis->mc;
+    Chunk* const   strings = analysis->strings;
+    uint32_t const unit_id = event->unit_id;
 
     VERBOSE_MSG_VARIADIC("MC_END => unit (%s)", get_chunk(strings, unit_id));
 
-    va_end(args);
-
-    uint32_t const key_id = add_chunk(strings, "MC_", 3);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(mc_statistics, key_id, VAL_UNSIGNED(mc_unit)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(mc->statistics, unit_id, METRIC_MC, SUBMETRIC_ONLY, VAL_UNSIGNED(mc->mc_unit)))
 }
 
-void event_startElement_mc(struct srcsax_context* context, ...) {
-    va_list args;
+void event_startElement_mc(Analysis* const analysis, StartElementEvent const* const event) {
+    MCState* const mc = analysis->mc;
 
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
-    va_end(args);
+    unsigned const tag_id = event->tag_id;
 
-    if (STR_EQ_CONST(localname, "function")) {
+    if (tag_id == C_FUNCTION) {
         VERBOSE_MSG_LITERAL("MC++ (function)");
-        mc_overall++;
-        mc_unit++;
+        mc->mc_overall++;
+        mc->mc_unit++;
     }
 }
 
-Map const* report_mc(void) {
+ResultTable const* report_mc(Analysis const* const analysis) {
     VERBOSE_MSG_LITERAL("MC_REPORT");
-    return isValid_map(mc_statistics) ? mc_statistics : NULL;
+    return isValid_rtable(analysis->mc->statistics) ? analysis->mc->statistics : NULL;
 }
@@ -3,141 +3,137 @@
  * @brief Maximum Nesting Depth
  * @author Yavuz Koroglu
  */
-#include <stdarg.h>
+#include "languages/c.h"
 #include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/cache.h"
 #include "srcmetrics/metrics/mnd.h"
+#include "srcmetrics/sizing.h"
 #include "padkit/chunk.h"
 #include "padkit/debug.h"
-#include "padkit/repeat.h"
-#include "padkit/streq.h"
-
-#define ENTRY_COUNT_GUESS (UNIT_COUNT_GUESS + FN_COUNT_GUESS)
 
 #define MND_READ_STATE_WAITING_METHOD 0U
 #define MND_READ_STATE_READING_METHOD 1U
-static unsigned mnd_read_state = MND_READ_STATE_WAITING_METHOD;
-
-static Map mnd_statistics[1]   = { NOT_A_MAP };
 
-static unsigned mnd_overall    = 0U;
-static unsigned mnd_unit       = 0U;
-static unsigned mnd_fn         = 0U;
-static unsigned nd             = 0U;
+void free_mnd(MNDState* const mnd) {
+    if (!isValid_rtable(mnd->statistics)) return;
 
-static void free_mnd_statistics(void) {
     VERBOSE_MSG_LITERAL("MND_FREE");
-    DEBUG_ABORT_IF(!free_map(mnd_statistics))
-    NDEBUG_EXECUTE(free_map(mnd_statistics))
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_rtable(mnd->statistics))
 }
 
-void event_startDocument_mnd(struct srcsax_context* context, ...) {
-    static bool first_time_execution = 1;
+void merge_mnd(Analysis* const analysis, Analysis const* const partial) {
+    MNDState* const mnd = analysis->mnd;
 
-    VERBOSE_MSG_LITERAL("MND_START => document");
+    VERBOSE_MSG_LITERAL("MND_MERGE");
+
+    mergeStatistics_analysis(analysis, mnd->statistics, partial, partial->mnd->statistics);
+
+    if (partial->mnd->mnd_overall > mnd->mnd_overall) mnd->mnd_overall = partial->mnd->mnd_overall;
+}
+
+bool save_mnd(FILE* const stream, Analysis const* const partial) {
+    MNDState const* const mnd = partial->mnd;
 
-    if (first_time_execution) {
-        first_time_execution = 0;
+    VERBOSE_MSG_LITERAL("MND_SAVE");
+
+    return writeStatistics_cache(stream, partial, mnd->statistics)
+        && writeUnsigned_cache(stream, mnd->mnd_overall);
+}
+
+bool load_mnd(Analysis* const partial, FILE* const stream) {
+    MNDState* const mnd = partial->mnd;
+    uint64_t        mnd_overall;
+
+    VERBOSE_MSG_LITERAL("MND_LOAD");
+
+    if (!readStatistics_cache(stream, partial, mnd->statistics)) return 0;
+    if (!readUnsigned_cache(stream, &mnd_overall))               return 0;
+
+    mnd->mnd_overall = (unsigned)mnd_overall;
+    return 1;
+}
 
+void event_startDocument_mnd(Analysis* const analysis) {
+    MNDState* const mnd = analysis->mnd;
+
+    VERBOSE_MSG_LITERAL("MND_START => document");
+
+    if (!isValid_rtable(mnd->statistics)) {
         DEBUG_ASSERT_NDEBUG_EXECUTE(
-            constructEmpty_map(mnd_statistics, ENTRY_COUNT_GUESS)
+            constructEmpty_rtable(mnd->statistics, get_sizing(analysis->isPartial)->entry_count)
         )
-
-        DEBUG_ERROR_IF(atexit(free_mnd_statistics) != 0)
-        NDEBUG_EXECUTE(atexit(free_mnd_statistics))
     } else {
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_map(mnd_statistics))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_rtable(mnd->statistics))
     }
 
-    mnd_overall     = 0U;
-    mnd_read_state  = MND_READ_STATE_WAITING_METHOD;
+    mnd->mnd_overall     = 0U;
+    mnd->mnd_read_state  = MND_READ_STATE_WAITING_METHOD;
 }
 
-void event_endDocument_mnd(struct srcsax_context* context, ...) {
+void event_endDocument_mnd(Analysis* const analysis) {
+    MNDState* const mnd = analysis->mnd;
+
     VERBOSE_MSG_LITERAL("MND_END => document");
-    uint32_t const key_id = add_chunk(strings, "MND", 3);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(mnd_statistics, key_id, VAL_UNSIGNED(mnd_overall)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(mnd->statistics, RESULT_OVERALL, METRIC_MND, SUBMETRIC_ONLY, VAL_UNSIGNED(mnd->mnd_overall)))
 }
 
-void event_startUnit_mnd(struct srcsax_context* context, ...) {
+void event_startUnit_mnd(Analysis* const analysis, UnitEvent const* const event) {
+    MNDState* const mnd = analysis->mnd;
+
     VERBOSE_MSG_LITERAL("MND_START => unit");
-    mnd_read_state = MND_READ_STATE_WAITING_METHOD;
-    mnd_unit       = 0U;
-    nd             = 0U;
+    mnd->mnd_read_state = MND_READ_STATE_WAITING_METHOD;
+    mnd->mnd_unit       = 0U;
+    mnd->nd             = 0U;
 }
 
-void event_endUnit_mnd(struct srcsax_context* context, ...) {
-    va_list     args;
-
-    va_start(args, context);
-
-    /* localname, prefix, uri */
-    REPEAT(3) va_arg(args, char const*);
-
-    uint32_t const unit_id = va_arg(args, uint32_t);
+void event_endUnit_mnd(Analysis* const analysis, UnitEvent const* const event) {
+    MNDState* const mnd     = analysis->mnd;
+    Chunk* const    strings = analysis->strings;
+    uint32_t const  unit_id = event->unit_id;
 
     VERBOSE_MSG_VARIADIC("MND_END => unit (%s)", get_chunk(strings, unit_id));
 
-    va_end(args);
-
-    uint32_t const key_id = add_chunk(strings, "MND_", 4);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(mnd_statistics, key_id, VAL_UNSIGNED(mnd_unit)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(mnd->statistics, unit_id, METRIC_MND, SUBMETRIC_ONLY, VAL_UNSIGNED(mnd->mnd_unit)))
 }
 
-void event_startElement_mnd(struct srcsax_context* context, ...) {
-    va_list args;
+void event_startElement_mnd(Analysis* const analysis, StartElementEvent const* const event) {
+    MNDState* const mnd = analysis->mnd;
 
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
-    va_end(args);
+    unsigned const tag_id = event->tag_id;
 
-    if (STR_EQ_CONST(localname, "function")) {
+    if (tag_id == C_FUNCTION) {
         VERBOSE_MSG_LITERAL("MND_START => function");
-        mnd_read_state = MND_READ_STATE_READING_METHOD;
-        mnd_fn         = nd;
-    } else if (STR_EQ_CONST(localname, "block")) {
+        mnd->mnd_read_state = MND_READ_STATE_READING_METHOD;
+        mnd->mnd_fn         = mnd->nd;
+    } else if (tag_id == C_BLOCK) {
         VERBOSE_MSG_LITERAL("MND_ND++ (block)");
-        nd++;
-        if (nd > mnd_overall)                                               mnd_overall = nd;
-        if (nd > mnd_unit)                                                  mnd_unit    = nd;
-        if (mnd_read_state == MND_READ_STATE_READING_METHOD && nd > mnd_fn) mnd_fn      = nd;
+        mnd->nd++;
+        if (mnd->nd > mnd->mnd_overall)                                               mnd->mnd_overall = mnd->nd;
+        if (mnd->nd > mnd->mnd_unit)                                                  mnd->mnd_unit    = mnd->nd;
+        if (mnd->mnd_read_state == MND_READ_STATE_READING_METHOD && mnd->nd > mnd->mnd_fn) mnd->mnd_fn      = mnd->nd;
     }
 }
 
-void event_endElement_mnd(struct srcsax_context* context, ...) {
-    va_list args;
-    va_start(args, context);
-
-    char const* const localname = va_arg(args, char const*);
-
-    /* prefix and uri */
-    REPEAT(2) va_arg(args, char const*);
-
-    /* unit_id */
-    va_arg(args, uint32_t);
-
-    uint32_t const fn_id = va_arg(args, uint32_t);
+void event_endElement_mnd(Analysis* const analysis, EndElementEvent const* const event) {
+    MNDState* const mnd     = analysis->mnd;
+    Chunk* const    strings = analysis->strings;
 
-    va_end(args);
+    uint32_t const fn_id  = event->fn_id;
+    unsigned const tag_id = event->tag_id;
 
-    if (STR_EQ_CONST(localname, "function")) {
+    if (tag_id == C_FUNCTION) {
         VERBOSE_MSG_VARIADIC("MND_END => function (%s)", get_chunk(strings, fn_id));
-        uint32_t const key_id = add_chunk(strings, "MND_", 4);
-        DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-        DEBUG_ERROR_IF(appendIndex_chunk(strings, fn_id) == NULL)
-        NDEBUG_EXECUTE(appendIndex_chunk(strings, fn_id))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(mnd_statistics, key_id, VAL_UNSIGNED(mnd_fn)))
-        mnd_read_state = MND_READ_STATE_WAITING_METHOD;
-    } else if (STR_EQ_CONST(localname, "block")) {
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(mnd->statistics, fn_id, METRIC_MND, SUBMETRIC_ONLY, VAL_UNSIGNED(mnd->mnd_fn)))
+        mnd->mnd_read_state = MND_READ_STATE_WAITING_METHOD;
+    } else if (tag_id == C_BLOCK) {
         VERBOSE_MSG_LITERAL("MND_ND-- (block)");
-        nd--;
+        mnd->nd--;
     }
 }
 
-Map const* report_mnd(void) {
+ResultTable const* report_mnd(Analysis const* const analysis) {
     VERBOSE_MSG_LITERAL("MND_REPORT");
-    return isValid_map(mnd_statistics) ? mnd_statistics : NULL;
+    return isValid_rtable(analysis->mnd->statistics) ? analysis->mnd->statistics : NULL;
 }
@@ -3,169 +3,174 @@
  * @brief Number of Public Methods
  * @author Yavuz Koroglu
  */
-#include <stdarg.h>
+#include "languages/c.h"
 #include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/cache.h"
 #include "srcmetrics/metrics/npm.h"
+#include "srcmetrics/sizing.h"
 #include "padkit/chunk.h"
 #include "padkit/debug.h"
-#include "padkit/repeat.h"
 #include "padkit/streq.h"
 
-#define ENTRY_COUNT_GUESS UNIT_COUNT_GUESS
-
 #define NPM_READ_STATE_WAITING_METHOD    0U
 #define NPM_READ_STATE_READING_METHOD    1U
 #define NPM_READ_STATE_READING_TYPE      2U
 #define NPM_READ_STATE_READING_SPECIFIER 3U
-static unsigned npm_read_state  = NPM_READ_STATE_WAITING_METHOD;
 
-static Map npm_statistics[1]    = { NOT_A_MAP };
+void free_npm(NPMState* const npm) {
+    if (!isValid_rtable(npm->statistics)) return;
 
-static unsigned npm_overall     = 0U;
-static unsigned npm_unit        = 0U;
+    VERBOSE_MSG_LITERAL("NPM_FREE");
 
-static Chunk specifier_chunk[1] = { NOT_A_CHUNK };
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_rtable(npm->statistics))
 
-static void free_npm_stuff(void) {
-    VERBOSE_MSG_LITERAL("NPM_FREE");
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_chunk(npm->specifier_chunk))
+}
+
+void merge_npm(Analysis* const analysis, Analysis const* const partial) {
+    NPMState* const npm = analysis->npm;
 
-    DEBUG_ABORT_IF(!free_map(npm_statistics))
-    NDEBUG_EXECUTE(free_map(npm_statistics))
+    VERBOSE_MSG_LITERAL("NPM_MERGE");
 
-    DEBUG_ABORT_IF(!free_chunk(specifier_chunk))
-    NDEBUG_EXECUTE(free_chunk(specifier_chunk))
+    mergeStatistics_analysis(analysis, npm->statistics, partial, partial->npm->statistics);
+
+    npm->npm_overall += partial->npm->npm_overall;
 }
 
-void event_startDocument_npm(struct srcsax_context* context, ...) {
-    static bool first_time_execution = 1;
+bool save_npm(FILE* const stream, Analysis const* const partial) {
+    NPMState const* const npm = partial->npm;
 
-    VERBOSE_MSG_LITERAL("NPM_START => document");
+    VERBOSE_MSG_LITERAL("NPM_SAVE");
+
+    return writeStatistics_cache(stream, partial, npm->statistics)
+        && writeUnsigned_cache(stream, npm->npm_overall);
+}
+
+bool load_npm(Analysis* const partial, FILE* const stream) {
+    NPMState* const npm = partial->npm;
+    uint64_t        npm_overall;
 
-    if (first_time_execution) {
-        first_time_execution = 0;
+    VERBOSE_MSG_LITERAL("NPM_LOAD");
 
-        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_map(npm_statistics, ENTRY_COUNT_GUESS))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_chunk(specifier_chunk, BUFSIZ, 1))
+    if (!readStatistics_cache(stream, partial, npm->statistics)) return 0;
+    if (!readUnsigned_cache(stream, &npm_overall))               return 0;
 
-        DEBUG_ERROR_IF(atexit(free_npm_stuff) != 0)
-        NDEBUG_EXECUTE(atexit(free_npm_stuff))
+    npm->npm_overall = (unsigned)npm_overall;
+    return 1;
+}
+
+void event_startDocument_npm(Analysis* const analysis) {
+    NPMState* const npm = analysis->npm;
+
+    VERBOSE_MSG_LITERAL("NPM_START => document");
+
+    if (!isValid_rtable(npm->statistics)) {
+        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_rtable(npm->statistics, get_sizing(analysis->isPartial)->unit_count))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_chunk(npm->specifier_chunk, BUFSIZ, 1))
     } else {
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_map(npm_statistics))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(specifier_chunk))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_rtable(npm->statistics))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(npm->specifier_chunk))
     }
 
-    npm_overall     = 0U;
-    npm_read_state  = NPM_READ_STATE_WAITING_METHOD;
+    npm->npm_overall     = 0U;
+    npm->npm_read_state  = NPM_READ_STATE_WAITING_METHOD;
 }
 
-void event_endDocument_npm(struct srcsax_context* context, ...) {
+void event_endDocument_npm(Analysis* const analysis) {
+    NPMState* const npm = analysis->npm;
+
     VERBOSE_MSG_LITERAL("NPM_END => document");
-    uint32_t const key_id = add_chunk(strings, "NPM", 3);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(npm_statistics, key_id, VAL_UNSIGNED(npm_overall)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(npm->statistics, RESULT_OVERALL, METRIC_NPM, SUBMETRIC_ONLY, VAL_UNSIGNED(npm->npm_overall)))
 }
 
-void event_startUnit_npm(struct srcsax_context* context, ...) {
+void event_startUnit_npm(Analysis* const analysis, UnitEvent const* const event) {
+    NPMState* const npm = analysis->npm;
+
     VERBOSE_MSG_LITERAL("NPM_START => unit");
-    npm_read_state  = NPM_READ_STATE_WAITING_METHOD;
-    npm_unit        = 0U;
+    npm->npm_read_state  = NPM_READ_STATE_WAITING_METHOD;
+    npm->npm_unit        = 0U;
 }
 
-void event_endUnit_npm(struct srcsax_context* context, ...) {
-    va_list args;
-    va_start(args, context);
-
-    /* localname, prefix, uri */
-    REPEAT(3) va_arg(args, char const*);
-
-    uint32_t const unit_id = va_arg(args, uint32_t);
+void event_endUnit_npm(Analysis* const analysis, UnitEvent const* const event) {
+    NPMState* const npm     = analysis->npm;
+    Chunk* const    strings = analysis->strings;
+    uint32_t const  unit_id = event->unit_id;
 
     VERBOSE_MSG_VARIADIC("NPM_END => unit (%s)", get_chunk(strings, unit_id));
 
-    va_end(args);
-
-    uint32_t const key_id = add_chunk(strings, "NPM_", 4);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(npm_statistics, key_id, VAL_UNSIGNED(npm_unit)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(npm->statistics, unit_id, METRIC_NPM, SUBMETRIC_ONLY, VAL_UNSIGNED(npm->npm_unit)))
 }
 
-void event_startElement_npm(struct srcsax_context* context, ...) {
-    va_list args;
+void event_startElement_npm(Analysis* const analysis, StartElementEvent const* const event) {
+    NPMState* const npm = analysis->npm;
 
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
-    va_end(args);
+    unsigned const tag_id = event->tag_id;
 
-    switch (npm_read_state) {
+    switch (npm->npm_read_state) {
         case NPM_READ_STATE_WAITING_METHOD:
-            if (STR_EQ_CONST(localname, "function")) {
+            if (tag_id == C_FUNCTION) {
                 VERBOSE_MSG_LITERAL("NPM++ (function)");
-                npm_read_state = NPM_READ_STATE_READING_METHOD;
-                npm_overall++;
-                npm_unit++;
+                npm->npm_read_state = NPM_READ_STATE_READING_METHOD;
+                npm->npm_overall++;
+                npm->npm_unit++;
             }
             break;
         case NPM_READ_STATE_READING_METHOD:
-            if (STR_EQ_CONST(localname, "type")) {
-                npm_read_state = NPM_READ_STATE_READING_TYPE;
+            if (tag_id == C_TYPE) {
+                npm->npm_read_state = NPM_READ_STATE_READING_TYPE;
             }
             break;
         case NPM_READ_STATE_READING_TYPE:
-            if (STR_EQ_CONST(localname, "specifier")) {
-                npm_read_state = NPM_READ_STATE_READING_SPECIFIER;
+            if (tag_id == C_SPECIFIER) {
+                npm->npm_read_state = NPM_READ_STATE_READING_SPECIFIER;
             }
             break;
     }
 }
 
-void event_endElement_npm(struct srcsax_context* context, ...) {
-    va_list args;
+void event_endElement_npm(Analysis* const analysis, EndElementEvent const* const event) {
+    NPMState* const npm = analysis->npm;
 
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
-    va_end(args);
+    unsigned const tag_id = event->tag_id;
 
-    switch (npm_read_state) {
+    switch (npm->npm_read_state) {
         case NPM_READ_STATE_READING_TYPE:
-            if (STR_EQ_CONST(localname, "type"))
-                npm_read_state = NPM_READ_STATE_WAITING_METHOD;
+            if (tag_id == C_TYPE)
+                npm->npm_read_state = NPM_READ_STATE_WAITING_METHOD;
             break;
         case NPM_READ_STATE_READING_SPECIFIER:
-            if (STR_EQ_CONST(localname, "specifier")) {
-                char const* const specifier = getLast_chunk(specifier_chunk);
+            if (tag_id == C_SPECIFIER) {
+                char const* const specifier = getLast_chunk(npm->specifier_chunk);
                 DEBUG_ERROR_IF(specifier == NULL)
 
                 if (STR_EQ_CONST(specifier, "static")) {
                     VERBOSE_MSG_LITERAL("NPM-- (static function)");
-                    npm_read_state = NPM_READ_STATE_WAITING_METHOD;
-                    npm_overall--;
-                    npm_unit--;
+                    npm->npm_read_state = NPM_READ_STATE_WAITING_METHOD;
+                    npm->npm_overall--;
+                    npm->npm_unit--;
                 }
-                DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(specifier_chunk))
+                DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(npm->specifier_chunk))
             }
             break;
         default:
-            if (STR_EQ_CONST(localname, "function"))
-                npm_read_state = NPM_READ_STATE_WAITING_METHOD;
+            if (tag_id == C_FUNCTION)
+                npm->npm_read_state = NPM_READ_STATE_WAITING_METHOD;
     }
 }
 
-void event_charactersUnit_npm(struct srcsax_context* context, ...) {
-    va_list args;
+void event_charactersUnit_npm(Analysis* const analysis, CharactersEvent const* const event) {
+    NPMState* const npm = analysis->npm;
 
-    va_start(args, context);
-    char const* const ch = va_arg(args, char const*);
-    uint64_t const len   = va_arg(args, uint64_t);
-    va_end(args);
+    char const* const ch  = event->ch;
+    uint64_t const    len = event->len;
 
-    if (npm_read_state == NPM_READ_STATE_READING_SPECIFIER)
-        DEBUG_ERROR_IF(append_chunk(specifier_chunk, ch, len) == NULL)
-        NDEBUG_EXECUTE(append_chunk(specifier_chunk, ch, len))
+    if (npm->npm_read_state == NPM_READ_STATE_READING_SPECIFIER)
+        DEBUG_ERROR_IF(append_chunk(npm->specifier_chunk, ch, len) == NULL)
+        NDEBUG_EXECUTE(append_chunk(npm->specifier_chunk, ch, len))
 }
 
-Map const* report_npm(void) {
+ResultTable const* report_npm(Analysis const* const analysis) {
     VERBOSE_MSG_LITERAL("NPM_REPORT");
-    return isValid_map(npm_statistics) ? npm_statistics : NULL;
+    return isValid_rtable(analysis->npm->statistics) ? analysis->npm->statistics : NULL;
 }
@@ -3,35 +3,19 @@
  * @brief Response for Unit
  * @author Yavuz Koroglu
  */
-#include <stdarg.h>
+#include <string.h>
+#include "languages/c.h"
 #include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/cache.h"
+#include "srcmetrics/interner.h"
 #include "srcmetrics/metrics/rfu.h"
+#include "srcmetrics/profile.h"
+#include "srcmetrics/sizing.h"
+#include "srcmetrics/sparsegraph.h"
 #include "padkit/chunkset.h"
 #include "padkit/debug.h"
-#include "padkit/graphmatrix.h"
-#include "padkit/repeat.h"
-#include "padkit/streq.h"
-
-#define ENTRY_COUNT_GUESS (UNIT_COUNT_GUESS + FN_COUNT_GUESS)
-
-static Map rfu_statistics[1]     = { NOT_A_MAP };
-
-static GraphMatrix callGraph[1]  = { NOT_A_GRAPH_MATRIX };
-static ChunkSet units[1]         = { NOT_A_CHUNK_SET };
-static ChunkSet fns[1]           = { NOT_A_CHUNK_SET };
-static GraphMatrix ownerGraph[1] = { NOT_A_GRAPH_MATRIX };
-
-static uint32_t unit_count       = 0;
-static uint32_t fn_count         = 0;
-
-static uint32_t unit_id          = 0xFFFFFFFF;
-static uint32_t fn_id            = 0xFFFFFFFF;
-
-static unsigned rfu_fn           = 0U;
-static unsigned rfu_unit         = 0U;
-static unsigned rfu_overall      = 0U;
-
-static Chunk name_chunk[1]       = { NOT_A_CHUNK };
+#include "padkit/reallocate.h"
 
 #define RFU_READ_STATE_WAITING_METHOD       0U
 #define RFU_READ_STATE_READING_METHOD       1U
@@ -40,31 +24,498 @@ static Chunk name_chunk[1]       = { NOT_A_CHUNK };
 #define RFU_READ_STATE_READING_METHOD_NAME  4U
 #define RFU_READ_STATE_READING_CALL_NAME    5U
 #define RFU_READ_STATE_READING_METHOD_TYPE  6U
-static unsigned rfu_read_state = 0U;
 
-static void free_rfu_stuff(void) {
+#define RFU_REPLAY_START_UNIT               0U
+#define RFU_REPLAY_END_UNIT                 1U
+#define RFU_REPLAY_DEFINE_FN                2U
+#define RFU_REPLAY_CALL_FN                  3U
+#define RFU_REPLAY_END_FN                   4U
+
+#define RFU_REPLAY_INITIAL_CAP              BUFSIZ
+
+void free_rfu(RFUState* const rfu) {
+    if (!isValid_rtable(rfu->statistics)) return;
+
     VERBOSE_MSG_LITERAL("RFU_FREE");
 
-    DEBUG_ABORT_IF(!free_map(rfu_statistics))
-    NDEBUG_EXECUTE(free_map(rfu_statistics))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_rtable(rfu->statistics))
+
+    /* A partial Analysis has no call graph */
+    if (isValid_cset(rfu->fns)) {
+        DEBUG_ASSERT_NDEBUG_EXECUTE(free_sgraph(rfu->callGraph))
+
+        DEBUG_ASSERT_NDEBUG_EXECUTE(free_cset(rfu->units))
+
+        DEBUG_ASSERT_NDEBUG_EXECUTE(free_cset(rfu->fns))
+
+        DEBUG_ASSERT_NDEBUG_EXECUTE(free_sgraph(rfu->ownerGraph))
+
+        DEBUG_ASSERT_NDEBUG_EXECUTE(free_sgraph(rfu->unitGraph))
+
+        free(rfu->transitive_rows);
+        rfu->transitive_rows = NULL;
+
+        free(rfu->symbol_fns);
+        rfu->symbol_fns = NULL;
+
+        free(rfu->visited);
+        rfu->visited = NULL;
+    }
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_chunk(rfu->name_chunk))
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_cset(rfu->replay_symbols))
+
+    free(rfu->replay_ops);
+    rfu->replay_ops = NULL;
+}
+
+static void pushReplay(RFUState* const rfu, unsigned const word) {
+    REALLOC_IF_NECESSARY(
+        unsigned, rfu->replay_ops,
+        uint32_t, rfu->replay_cap, rfu->replay_count,
+        {REALLOC_ERROR;}
+    )
+    rfu->replay_ops[rfu->replay_count++] = word;
+}
+
+/**
+ * @brief Records an op in the replay log, followed by the symbol id of its name if it has one.
+ */
+static void record(RFUState* const rfu, unsigned const op, char const* const name, uint64_t const name_len) {
+    pushReplay(rfu, op);
+
+    if (name == NULL) return;
+
+    uint32_t const symbol_id = addKey_cset(rfu->replay_symbols, name, name_len);
+    DEBUG_ERROR_IF(symbol_id == 0xFFFFFFFF)
+    pushReplay(rfu, symbol_id);
+}
+
+static bool hasSymbol(unsigned const op) {
+    return op == RFU_REPLAY_START_UNIT || op == RFU_REPLAY_DEFINE_FN || op == RFU_REPLAY_CALL_FN;
+}
+
+/**
+ * @brief Interns a function name, so the graphs and the rows only deal with its dense id.
+ */
+static uint32_t internFn(RFUState* const rfu, char const* const fn_name, uint64_t const fn_len) {
+    uint32_t const fn_id = addKey_cset(rfu->fns, fn_name, fn_len);
+    DEBUG_ERROR_IF(fn_id == 0xFFFFFFFF)
+
+    rfu->fn_count = getKeyCount_cset(rfu->fns);
+    return fn_id;
+}
+
+/**
+ * @brief Starts a new set of visited functions in O(1), and makes room for every function so far.
+ * @return The stamp of the functions in the new set.
+ */
+static uint32_t nextVisitEpoch(RFUState* const rfu) {
+    if (rfu->visited_cap < rfu->fn_count) {
+        uint32_t new_cap = rfu->visited_cap;
+        while (new_cap < rfu->fn_count) new_cap <<= 1;
+
+        uint32_t* const new_visited = realloc(rfu->visited, (size_t)new_cap * sizeof(uint32_t));
+        DEBUG_ERROR_IF(new_visited == NULL)
 
-    DEBUG_ABORT_IF(!free_gmtx(callGraph))
-    NDEBUG_EXECUTE(free_gmtx(callGraph))
+        memset(new_visited + rfu->visited_cap, 0, (size_t)(new_cap - rfu->visited_cap) * sizeof(uint32_t));
+        rfu->visited     = new_visited;
+        rfu->visited_cap = new_cap;
+    }
+
+    /* Zero is never an epoch, so a wrap around clears the stamps */
+    if (++rfu->visit_epoch == 0) {
+        memset(rfu->visited, 0, (size_t)rfu->visited_cap * sizeof(uint32_t));
+        rfu->visit_epoch = 1;
+    }
+    return rfu->visit_epoch;
+}
+
+static unsigned visit(RFUState* const rfu, uint32_t const fn_id) {
+    DEBUG_ERROR_IF(fn_id >= rfu->visited_cap)
+    if (rfu->visited[fn_id] == rfu->visit_epoch) return 0;
+
+    rfu->visited[fn_id] = rfu->visit_epoch;
+    return 1;
+}
+
+static void enterUnit(RFUState* const rfu, char const* const unit_name, uint64_t const unit_name_len) {
+    rfu->rfu_unit = 0U;
+    rfu->unit_id  = addKey_cset(rfu->units, unit_name, unit_name_len);
+    DEBUG_ERROR_IF(rfu->unit_id == 0xFFFFFFFF)
+    VERBOSE_MSG_VARIADIC("RFU_START => unit (%.*s)", (int)unit_name_len, unit_name);
+
+    rfu->unit_count = getKeyCount_cset(rfu->units);
+}
+
+static void deferRow(RFUState* const rfu, uint32_t const entity_id, uint32_t const vertex_id, bool const isUnit) {
+    REALLOC_IF_NECESSARY(
+        RFURow, rfu->transitive_rows,
+        uint32_t, rfu->transitive_cap, rfu->transitive_count,
+        {REALLOC_ERROR;}
+    )
+    rfu->transitive_rows[rfu->transitive_count++] = (RFURow){ entity_id, vertex_id, isUnit };
+}
+
+static void exitUnit(RFUState* const rfu, Analysis* const analysis) {
+    VERBOSE_MSG_VARIADIC("RFU_END => unit (%s)", getKey_cset(rfu->units, rfu->unit_id));
+    if (isRFUQuiet()) return;
+
+    char const* const unit_name = getKey_cset(rfu->units, rfu->unit_id);
+    uint64_t const unit_len     = strlen_cset(rfu->units, rfu->unit_id);
+
+    /* A replayed unit has no event, so its entity name is interned here, usually finding the merged one */
+    uint32_t const entity_id = intern_interner(analysis->interner, analysis->strings, unit_name, unit_len);
+    DEBUG_ERROR_IF(entity_id == 0xFFFFFFFF)
+
+    if (!isRFUSimple()) {
+        deferRow(rfu, entity_id, rfu->unit_id, 1);
+        return;
+    }
+
+    rfu->rfu_unit = 0U;
+    nextVisitEpoch(rfu);
+
+    uint32_t const* const fns = sinks_sgraph(rfu->unitGraph, rfu->unit_id);
+    for (uint32_t fn_pos = outDegree_sgraph(rfu->unitGraph, rfu->unit_id); fn_pos-- > 0;) {
+        rfu->fn_id = fns[fn_pos];
+
+        /* Always, all the unit's functions count. */
+        rfu->rfu_unit += visit(rfu, rfu->fn_id);
+
+        /* Always, all the direct calls count. */
+        uint32_t const* const sinks = sinks_sgraph(rfu->callGraph, rfu->fn_id);
+        for (uint32_t sink_pos = outDegree_sgraph(rfu->callGraph, rfu->fn_id); sink_pos-- > 0;)
+            rfu->rfu_unit += visit(rfu, sinks[sink_pos]);
+    }
+    rfu->fn_id = 0xFFFFFFFF;
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(rfu->statistics, entity_id, METRIC_RFU, SUBMETRIC_ONLY, VAL_UNSIGNED(rfu->rfu_unit)))
+}
 
-    DEBUG_ABORT_IF(!free_cset(units))
-    NDEBUG_EXECUTE(free_cset(units))
+static void defineFn(RFUState* const rfu, uint32_t const fn_id) {
+    rfu->fn_id = fn_id;
+    DEBUG_ASSERT_NDEBUG_EXECUTE(connect_sgraph(rfu->ownerGraph, rfu->fn_id, rfu->unit_id))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(connect_sgraph(rfu->unitGraph, rfu->unit_id, rfu->fn_id))
+}
 
-    DEBUG_ABORT_IF(!free_cset(fns))
-    NDEBUG_EXECUTE(free_cset(fns))
+static void callFn(RFUState* const rfu, uint32_t const sink_fn_id) {
+    DEBUG_ASSERT_NDEBUG_EXECUTE(connect_sgraph(rfu->callGraph, rfu->fn_id, sink_fn_id))
+}
 
-    DEBUG_ABORT_IF(!free_gmtx(ownerGraph))
-    NDEBUG_EXECUTE(free_gmtx(ownerGraph))
+static void exitFn(RFUState* const rfu, Analysis* const analysis) {
+    if (!isRFUQuiet()) {
+        Arena* const      arena     = analysis->arenas + METRIC_RFU;
+        char const* const unit_name = getKey_cset(rfu->units, rfu->unit_id);
+        char const* const fn_name   = getKey_cset(rfu->fns, rfu->fn_id);
+        uint64_t const unit_len     = strlen_cset(rfu->units, rfu->unit_id);
+        uint64_t const fn_len       = strlen_cset(rfu->fns, rfu->fn_id);
+
+        /* The name is put together in the Arena, so the strings get it only if no event or merge added it */
+        uint64_t const name_at = append_arena(arena, unit_name, unit_len);
+        append_arena(arena, "::", 2);
+        append_arena(arena, fn_name, fn_len);
+        append_arena(arena, "()", 2);
+
+        uint32_t const entity_id = intern_interner(
+            analysis->interner, analysis->strings, get_arena(arena, name_at), unit_len + fn_len + 4
+        );
+        DEBUG_ERROR_IF(entity_id == 0xFFFFFFFF)
+        release_arena(arena, name_at);
 
-    DEBUG_ABORT_IF(!free_chunk(name_chunk))
-    NDEBUG_EXECUTE(free_chunk(name_chunk))
+        if (!isRFUSimple()) {
+            deferRow(rfu, entity_id, rfu->fn_id, 0);
+        } else {
+            /* The sinks are unique, so only a recursive call can repeat the function itself */
+            rfu->rfu_fn = 1U + outDegree_sgraph(rfu->callGraph, rfu->fn_id)
+                        - (unsigned)isConnected_sgraph(rfu->callGraph, rfu->fn_id, rfu->fn_id);
+
+            /* Record RFU for this function */
+            DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(rfu->statistics, entity_id, METRIC_RFU, SUBMETRIC_ONLY, VAL_UNSIGNED(rfu->rfu_fn)))
+        }
+    }
+    rfu->fn_id = 0xFFFFFFFF;
 }
 
-static void generateDot(void) {
+/**
+ * @brief Translates a replay symbol of a partial Analysis to a function id, interning it on its first use.
+ */
+static uint32_t resolveSymbol(RFUState* const rfu, RFUState const* const partial_rfu, uint32_t const symbol_id) {
+    if (rfu->symbol_fns[symbol_id] == 0xFFFFFFFF) {
+        rfu->symbol_fns[symbol_id] = internFn(
+            rfu,
+            getKey_cset(partial_rfu->replay_symbols, symbol_id),
+            strlen_cset(partial_rfu->replay_symbols, symbol_id)
+        );
+    }
+    return rfu->symbol_fns[symbol_id];
+}
+
+void merge_rfu(Analysis* const analysis, Analysis const* const partial) {
+    RFUState* const       rfu          = analysis->rfu;
+    RFUState const* const partial_rfu  = partial->rfu;
+    uint32_t const        symbol_count = getKeyCount_cset(partial_rfu->replay_symbols);
+
+    VERBOSE_MSG_LITERAL("RFU_MERGE");
+
+    if (rfu->symbol_fn_cap < symbol_count) {
+        uint32_t new_cap = rfu->symbol_fn_cap;
+        while (new_cap < symbol_count) new_cap <<= 1;
+
+        uint32_t* const new_symbol_fns = realloc(rfu->symbol_fns, (size_t)new_cap * sizeof(uint32_t));
+        DEBUG_ERROR_IF(new_symbol_fns == NULL)
+
+        rfu->symbol_fns    = new_symbol_fns;
+        rfu->symbol_fn_cap = new_cap;
+    }
+    memset(rfu->symbol_fns, 0xFF, (size_t)symbol_count * sizeof(uint32_t));
+
+    for (unsigned const* op = partial_rfu->replay_ops; op < partial_rfu->replay_ops + partial_rfu->replay_count; op++) {
+        switch (*op) {
+            case RFU_REPLAY_START_UNIT:
+                op++;
+                enterUnit(rfu, getKey_cset(partial_rfu->replay_symbols, *op), strlen_cset(partial_rfu->replay_symbols, *op));
+                break;
+            case RFU_REPLAY_END_UNIT:
+                exitUnit(rfu, analysis);
+                break;
+            case RFU_REPLAY_DEFINE_FN:
+                op++;
+                defineFn(rfu, resolveSymbol(rfu, partial_rfu, *op));
+                break;
+            case RFU_REPLAY_CALL_FN:
+                op++;
+                callFn(rfu, resolveSymbol(rfu, partial_rfu, *op));
+                break;
+            case RFU_REPLAY_END_FN:
+                exitFn(rfu, analysis);
+                break;
+            default:
+                TERMINATE_ERROR;
+        }
+    }
+}
+
+bool save_rfu(FILE* const stream, Analysis const* const partial) {
+    RFUState const* const rfu = partial->rfu;
+
+    VERBOSE_MSG_LITERAL("RFU_SAVE");
+
+    /* A partial Analysis only has the replay log, see merge_rfu() */
+    if (!writeUnsigned_cache(stream, rfu->replay_count)) return 0;
+    for (unsigned const* op = rfu->replay_ops; op < rfu->replay_ops + rfu->replay_count; op++)
+        if (!writeUnsigned_cache(stream, *op)) return 0;
+
+    /* The symbols go in id order, so loading them interns the same ids */
+    uint32_t const symbol_count = getKeyCount_cset(rfu->replay_symbols);
+    if (!writeUnsigned_cache(stream, symbol_count)) return 0;
+    for (uint32_t symbol_id = 0; symbol_id < symbol_count; symbol_id++) {
+        char const* const name     = getKey_cset(rfu->replay_symbols, symbol_id);
+        uint64_t const    name_len = strlen_cset(rfu->replay_symbols, symbol_id);
+        if (!writeString_cache(stream, name, name_len)) return 0;
+    }
+
+    return 1;
+}
+
+bool load_rfu(Analysis* const partial, FILE* const stream) {
+    RFUState* const rfu = partial->rfu;
+    uint64_t        replay_count, word, symbol_count;
+
+    VERBOSE_MSG_LITERAL("RFU_LOAD");
+
+    if (!readUnsigned_cache(stream, &replay_count)) return 0;
+    while (replay_count--) {
+        if (!readUnsigned_cache(stream, &word) || word >= 0xFFFFFFFF) return 0;
+        pushReplay(rfu, (unsigned)word);
+    }
+
+    if (!readUnsigned_cache(stream, &symbol_count)) return 0;
+    for (uint64_t symbol_id = 0; symbol_id < symbol_count; symbol_id++) {
+        uint32_t const name_id = readString_cache(stream, rfu->name_chunk);
+        if (name_id == 0xFFFFFFFF) return 0;
+
+        /* A duplicate symbol would shift the ids of the log */
+        uint32_t const loaded_id = addKey_cset(
+            rfu->replay_symbols, get_chunk(rfu->name_chunk, name_id), strlen_chunk(rfu->name_chunk, name_id)
+        );
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(rfu->name_chunk))
+        if (loaded_id != symbol_id) return 0;
+    }
+
+    /* Every op must be known, and every symbol id must be loaded */
+    for (unsigned const* op = rfu->replay_ops; op < rfu->replay_ops + rfu->replay_count; op++) {
+        if (*op > RFU_REPLAY_END_FN) return 0;
+        if (!hasSymbol(*op)) continue;
+        if (++op >= rfu->replay_ops + rfu->replay_count || *op >= symbol_count) return 0;
+    }
+
+    return 1;
+}
+
+static unsigned popcount(uint64_t word) {
+    #if defined(__GNUC__) || defined(__clang__)
+        return (unsigned)__builtin_popcountll(word);
+    #else
+        word = word - ((word >> 1) & 0x5555555555555555ULL);
+        word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return (unsigned)((word * 0x0101010101010101ULL) >> 56);
+    #endif
+}
+
+/**
+ * @brief ORs the nonzero words of a compressed bitset into a dense one, and remembers the new nonzero words.
+ */
+static void orWords(
+    uint64_t* const         dense,
+    uint32_t* const         touched,
+    uint32_t* const         touched_count,
+    uint32_t const* const   word_ids,
+    uint64_t const* const   words,
+    uint32_t const          len
+) {
+    for (uint32_t i = 0; i < len; i++) {
+        if (dense[word_ids[i]] == 0) touched[(*touched_count)++] = word_ids[i];
+        dense[word_ids[i]] |= words[i];
+    }
+}
+
+/**
+ * @brief Counts the bits of the touched words of a dense bitset, and clears them.
+ */
+static unsigned countAndClear(uint64_t* const dense, uint32_t const* const touched, uint32_t* const touched_count) {
+    unsigned count = 0;
+    for (uint32_t i = 0; i < *touched_count; i++) {
+        count              += popcount(dense[touched[i]]);
+        dense[touched[i]]   = 0;
+    }
+    *touched_count = 0;
+    return count;
+}
+
+/**
+ * @brief Computes the transitive RFU of every deferred row, and inserts the rows in order.
+ *
+ * Collapses the strongly connected components of the call graph, so the reachable set of a component is
+ * itself plus the union of its successors' sets. The component numbers are in reverse topological order, so
+ * every successor is ready before its predecessors. The bits of a component are consecutive, and a set only
+ * stores its nonzero words, i.e., a compressed bitset. Then, the RFU of a function is the bit count of its
+ * component's set, and the RFU of a unit is the bit count of the union of its functions' sets.
+ */
+static void insertTransitiveRows(RFUState* const rfu) {
+    uint32_t const fn_count   = rfu->fn_count;
+    uint32_t const word_count = (fn_count + 63) / 64;
+
+    if (rfu->transitive_count == 0) return;
+
+    VERBOSE_MSG_VARIADIC("RFU_TRANSITIVE => %u functions", (unsigned)fn_count);
+
+    uint32_t* const component       = malloc(((size_t)fn_count + 1) * sizeof(uint32_t));
+    DEBUG_ERROR_IF(component == NULL)
+    uint32_t const  component_count = condense_sgraph(rfu->callGraph, fn_count, component);
+
+    uint32_t* const first_bit   = calloc((size_t)component_count + 1, sizeof(uint32_t));
+    uint32_t* const next_member = malloc(((size_t)component_count + 1) * sizeof(uint32_t));
+    uint32_t* const members     = malloc(((size_t)fn_count + 1) * sizeof(uint32_t));
+    uint32_t* const stamp       = malloc(((size_t)component_count + 1) * sizeof(uint32_t));
+    uint32_t* const reach_len   = malloc(((size_t)component_count + 1) * sizeof(uint32_t));
+    unsigned* const reach_count = malloc(((size_t)component_count + 1) * sizeof(unsigned));
+    size_t* const   reach_first = malloc(((size_t)component_count + 1) * sizeof(size_t));
+    uint64_t* const dense       = calloc((size_t)word_count + 1, sizeof(uint64_t));
+    uint32_t* const touched     = malloc(((size_t)word_count + 1) * sizeof(uint32_t));
+    DEBUG_ERROR_IF(first_bit == NULL || next_member == NULL || members == NULL || stamp == NULL)
+    DEBUG_ERROR_IF(reach_len == NULL || reach_count == NULL || reach_first == NULL || dense == NULL || touched == NULL)
+
+    /* Number the functions component by component */
+    for (uint32_t fn_id = 0; fn_id < fn_count; fn_id++)
+        first_bit[component[fn_id] + 1]++;
+    for (uint32_t c = 0; c < component_count; c++)
+        first_bit[c + 1] += first_bit[c];
+    memcpy(next_member, first_bit, (size_t)component_count * sizeof(uint32_t));
+    for (uint32_t fn_id = 0; fn_id < fn_count; fn_id++)
+        members[next_member[component[fn_id]]++] = fn_id;
+
+    size_t    words_total = 0;
+    size_t    words_cap   = (size_t)component_count + 1;
+    uint32_t* word_ids    = malloc(words_cap * sizeof(uint32_t));
+    uint64_t* words       = malloc(words_cap * sizeof(uint64_t));
+    DEBUG_ERROR_IF(word_ids == NULL || words == NULL)
+
+    uint32_t touched_count = 0;
+    for (uint32_t c = 0; c < component_count; c++) stamp[c] = 0xFFFFFFFF;
+    for (uint32_t c = 0; c < component_count; c++) {
+        /* A component reaches itself */
+        for (uint32_t bit = first_bit[c]; bit < first_bit[c + 1]; bit++) {
+            if (dense[bit / 64] == 0) touched[touched_count++] = bit / 64;
+            dense[bit / 64] |= (uint64_t)1 << (bit % 64);
+        }
+
+        /* and everything its successors reach */
+        for (uint32_t const* member = members + first_bit[c]; member < members + first_bit[c + 1]; member++) {
+            uint32_t const* const sinks = sinks_sgraph(rfu->callGraph, *member);
+            for (uint32_t sink_pos = outDegree_sgraph(rfu->callGraph, *member); sink_pos-- > 0;) {
+                uint32_t const d = component[sinks[sink_pos]];
+                if (d == c || stamp[d] == c) continue;
+                stamp[d] = c;
+                orWords(dense, touched, &touched_count, word_ids + reach_first[d], words + reach_first[d], reach_len[d]);
+            }
+        }
+
+        while (words_total + touched_count > words_cap) {
+            words_cap <<= 1;
+            word_ids    = realloc(word_ids, words_cap * sizeof(uint32_t));
+            words       = realloc(words, words_cap * sizeof(uint64_t));
+            DEBUG_ERROR_IF(word_ids == NULL || words == NULL)
+        }
+
+        reach_first[c] = words_total;
+        reach_len[c]   = touched_count;
+        for (uint32_t i = 0; i < touched_count; i++) {
+            word_ids[words_total] = touched[i];
+            words[words_total++]  = dense[touched[i]];
+        }
+        reach_count[c] = countAndClear(dense, touched, &touched_count);
+    }
+
+    for (uint32_t c = 0; c < component_count; c++) stamp[c] = 0xFFFFFFFF;
+    for (uint32_t row_id = 0; row_id < rfu->transitive_count; row_id++) {
+        RFURow const* const row = rfu->transitive_rows + row_id;
+
+        unsigned rfu_value;
+        if (row->isUnit) {
+            uint32_t const* const fns = sinks_sgraph(rfu->unitGraph, row->vertex_id);
+            for (uint32_t fn_pos = outDegree_sgraph(rfu->unitGraph, row->vertex_id); fn_pos-- > 0;) {
+                uint32_t const c = component[fns[fn_pos]];
+                if (stamp[c] == row_id) continue;
+                stamp[c] = row_id;
+                orWords(dense, touched, &touched_count, word_ids + reach_first[c], words + reach_first[c], reach_len[c]);
+            }
+            rfu_value = countAndClear(dense, touched, &touched_count);
+        } else {
+            rfu_value = reach_count[component[row->vertex_id]];
+        }
+
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(rfu->statistics, row->entity_id, METRIC_RFU, SUBMETRIC_ONLY, VAL_UNSIGNED(rfu_value)))
+    }
+    rfu->transitive_count = 0;
+
+    free(words);
+    free(word_ids);
+    free(touched);
+    free(dense);
+    free(reach_first);
+    free(reach_count);
+    free(reach_len);
+    free(stamp);
+    free(members);
+    free(next_member);
+    free(first_bit);
+    free(component);
+}
+
+static void generateDot(RFUState* const rfu, Chunk* const strings) {
     DEBUG_ERROR_IF(options.cg_name == NULL)
 
     uint64_t const cg_name_len = strlen(options.cg_name);
@@ -88,59 +539,54 @@ static void generateDot(void) {
     if (!isCGNoExternal()) {
         fprintf(cg, "    subgraph cluster_%d {\n"
                             "        graph [label=\"External\"];\n", cluster_id++);
-        for (fn_id = fn_count - 1; fn_id != 0xFFFFFFFF; fn_id--) {
-            unit_id = findSink_gmtx(ownerGraph, fn_id, unit_count - 1);
-            if (unit_id != 0xFFFFFFFF) continue;
-            char const* const node_name = getKey_cset(fns, fn_id);
+        for (rfu->fn_id = rfu->fn_count - 1; rfu->fn_id != 0xFFFFFFFF; rfu->fn_id--) {
+            if (outDegree_sgraph(rfu->ownerGraph, rfu->fn_id) > 0) continue;
+            char const* const node_name = getKey_cset(rfu->fns, rfu->fn_id);
             fprintf(cg, "        \"%s()\";\n", node_name);
         }
         fputs("    }\n", cg);
     }
-    for (unit_id = unit_count - 1; unit_id != 0xFFFFFFFF; unit_id--) {
-        char const* const unit_name = getKey_cset(units, unit_id);
+    for (rfu->unit_id = rfu->unit_count - 1; rfu->unit_id != 0xFFFFFFFF; rfu->unit_id--) {
+        char const* const unit_name = getKey_cset(rfu->units, rfu->unit_id);
         fprintf(cg, "    subgraph cluster_%d {\n"
                             "        graph [label=\"%s\"];\n", cluster_id++, unit_name);
-        for (
-            fn_id = findSource_gmtx(ownerGraph, unit_id, fn_count - 1);
-            fn_id != 0xFFFFFFFF;
-            fn_id = findSource_gmtx(ownerGraph, unit_id, fn_id - 1)
-        ) {
-            char const* const fn_name = getKey_cset(fns, fn_id);
+        uint32_t const* const fns = sinks_sgraph(rfu->unitGraph, rfu->unit_id);
+        for (uint32_t fn_pos = outDegree_sgraph(rfu->unitGraph, rfu->unit_id); fn_pos-- > 0;) {
+            rfu->fn_id = fns[fn_pos];
+            char const* const fn_name = getKey_cset(rfu->fns, rfu->fn_id);
             fprintf(cg, "        \"%s::%s()\" [label=\"%s()\"];\n", unit_name, fn_name, fn_name);
         }
         fputs("    }\n", cg);
     }
-    for (uint32_t source_unit_id = unit_count - 1; source_unit_id != 0xFFFFFFFF; source_unit_id--) {
-        char const* const source_unit_name = getKey_cset(units, source_unit_id);
-        for (
-            uint32_t source_fn_id = findSource_gmtx(ownerGraph, source_unit_id, fn_count - 1);
-            source_fn_id != 0xFFFFFFFF;
-            source_fn_id = findSource_gmtx(ownerGraph, source_unit_id, source_fn_id - 1)
-        ) {
-            char const* const source_fn_name = getKey_cset(fns, source_fn_id);
-            if (isConnected_gmtx(callGraph, source_fn_id, source_fn_id)) {
+    for (uint32_t source_unit_id = rfu->unit_count - 1; source_unit_id != 0xFFFFFFFF; source_unit_id--) {
+        char const* const source_unit_name = getKey_cset(rfu->units, source_unit_id);
+        uint32_t const* const source_fns = sinks_sgraph(rfu->unitGraph, source_unit_id);
+        for (uint32_t source_fn_pos = outDegree_sgraph(rfu->unitGraph, source_unit_id); source_fn_pos-- > 0;) {
+            uint32_t const source_fn_id      = source_fns[source_fn_pos];
+            char const* const source_fn_name = getKey_cset(rfu->fns, source_fn_id);
+            if (isConnected_sgraph(rfu->callGraph, source_fn_id, source_fn_id)) {
                 fprintf(cg,
                     "    \"%s::%s()\"--\"%s::%s()\";\n",
                     source_unit_name, source_fn_name,
                     source_unit_name, source_fn_name
                 );
             } else {
-                for (
-                    uint32_t sink_fn_id = findSink_gmtx(callGraph, source_fn_id, fn_count - 1);
-                    sink_fn_id != 0xFFFFFFFF;
-                    sink_fn_id = findSink_gmtx(callGraph, source_fn_id, sink_fn_id - 1)
-                ) {
-                    char const* const sink_fn_name = getKey_cset(fns, sink_fn_id);
-                    uint32_t sink_unit_id = findSink_gmtx(ownerGraph, sink_fn_id, unit_count - 1);
-                    if (sink_unit_id == 0xFFFFFFFF && !isCGNoExternal()) {
+                uint32_t const* const sink_fns = sinks_sgraph(rfu->callGraph, source_fn_id);
+                for (uint32_t sink_fn_pos = outDegree_sgraph(rfu->callGraph, source_fn_id); sink_fn_pos-- > 0;) {
+                    uint32_t const sink_fn_id          = sink_fns[sink_fn_pos];
+                    char const* const sink_fn_name     = getKey_cset(rfu->fns, sink_fn_id);
+                    uint32_t const* const sink_units   = sinks_sgraph(rfu->ownerGraph, sink_fn_id);
+                    uint32_t sink_unit_pos             = outDegree_sgraph(rfu->ownerGraph, sink_fn_id);
+                    if (sink_unit_pos == 0 && !isCGNoExternal()) {
                         fprintf(cg,
                             "    \"%s::%s()\"--\"%s()\" [style=\"dashed\"];\n",
                             source_unit_name, source_fn_name,
                             sink_fn_name
                         );
                     } else {
-                        while (sink_unit_id != 0xFFFFFFFF) {
-                            char const* const sink_unit_name = getKey_cset(units, sink_unit_id);
+                        while (sink_unit_pos-- > 0) {
+                            uint32_t const sink_unit_id      = sink_units[sink_unit_pos];
+                            char const* const sink_unit_name = getKey_cset(rfu->units, sink_unit_id);
                             if (source_unit_id == sink_unit_id) {
                                 fprintf(cg,
                                     "    \"%s::%s()\"--\"%s::%s()\";\n",
@@ -154,7 +600,6 @@ static void generateDot(void) {
                                     sink_unit_name, sink_fn_name
                                 );
                             }
-                            sink_unit_id = findSink_gmtx(ownerGraph, sink_fn_id, sink_unit_id - 1);
                         }
                     }
                 }
@@ -167,7 +612,7 @@ static void generateDot(void) {
     NDEBUG_EXECUTE(fclose(cg))
 }
 
-static void generateXml(void) {
+static void generateXml(RFUState* const rfu, Chunk* const strings) {
     DEBUG_ERROR_IF(options.cg_name == NULL)
 
     uint64_t const cg_name_len    = strlen(options.cg_name);
@@ -189,33 +634,28 @@ static void generateXml(void) {
           "    <graph id=\"CG\" edgedefault=\"directed\">\n", cg);
 
     if (!isCGNoExternal()) {
-        for (fn_id = fn_count - 1; fn_id != 0xFFFFFFFF; fn_id--) {
-            unit_id = findSink_gmtx(ownerGraph, fn_id, unit_count - 1);
-            if (unit_id != 0xFFFFFFFF) continue;
-            char const* const node_id = getKey_cset(fns, fn_id);
+        for (rfu->fn_id = rfu->fn_count - 1; rfu->fn_id != 0xFFFFFFFF; rfu->fn_id--) {
+            if (outDegree_sgraph(rfu->ownerGraph, rfu->fn_id) > 0) continue;
+            char const* const node_id = getKey_cset(rfu->fns, rfu->fn_id);
             fprintf(cg, "        <node id=\"%s()\"/>\n", node_id);
         }
     }
-    for (unit_id = unit_count - 1; unit_id != 0xFFFFFFFF; unit_id--) {
-        char const* const unit_name = getKey_cset(units, unit_id);
-        for (
-            fn_id = findSource_gmtx(ownerGraph, unit_id, fn_count - 1);
-            fn_id != 0xFFFFFFFF;
-            fn_id = findSource_gmtx(ownerGraph, unit_id, fn_id - 1)
-        ) {
-            char const* const fn_name = getKey_cset(fns, fn_id);
+    for (rfu->unit_id = rfu->unit_count - 1; rfu->unit_id != 0xFFFFFFFF; rfu->unit_id--) {
+        char const* const unit_name = getKey_cset(rfu->units, rfu->unit_id);
+        uint32_t const* const fns = sinks_sgraph(rfu->unitGraph, rfu->unit_id);
+        for (uint32_t fn_pos = outDegree_sgraph(rfu->unitGraph, rfu->unit_id); fn_pos-- > 0;) {
+            rfu->fn_id = fns[fn_pos];
+            char const* const fn_name = getKey_cset(rfu->fns, rfu->fn_id);
             fprintf(cg, "        <node id=\"%s::%s()\">\n", unit_name, fn_name);
         }
     }
-    for (uint32_t source_unit_id = unit_count - 1; source_unit_id != 0xFFFFFFFF; source_unit_id--) {
-        char const* const source_unit_name = getKey_cset(units, source_unit_id);
-        for (
-            uint32_t source_fn_id = findSource_gmtx(ownerGraph, source_unit_id, fn_count - 1);
-            source_fn_id != 0xFFFFFFFF;
-            source_fn_id = findSource_gmtx(ownerGraph, source_unit_id, source_fn_id - 1)
-        ) {
-            char const* const source_fn_name = getKey_cset(fns, source_fn_id);
-            if (isConnected_gmtx(callGraph, source_fn_id, source_fn_id)) {
+    for (uint32_t source_unit_id = rfu->unit_count - 1; source_unit_id != 0xFFFFFFFF; source_unit_id--) {
+        char const* const source_unit_name = getKey_cset(rfu->units, source_unit_id);
+        uint32_t const* const source_fns = sinks_sgraph(rfu->unitGraph, source_unit_id);
+        for (uint32_t source_fn_pos = outDegree_sgraph(rfu->unitGraph, source_unit_id); source_fn_pos-- > 0;) {
+            uint32_t const source_fn_id      = source_fns[source_fn_pos];
+            char const* const source_fn_name = getKey_cset(rfu->fns, source_fn_id);
+            if (isConnected_sgraph(rfu->callGraph, source_fn_id, source_fn_id)) {
                 fprintf(cg,
                     "        <edge id=\"%s::%s()--%s::%s()\" source=\"%s::%s()\" sink=\"%s::%s()\"/>\n",
                     source_unit_name, source_fn_name,
@@ -224,14 +664,13 @@ static void generateXml(void) {
                     source_unit_name, source_fn_name
                 );
             } else {
-                for (
-                    uint32_t sink_fn_id = findSink_gmtx(callGraph, source_fn_id, fn_count - 1);
-                    sink_fn_id != 0xFFFFFFFF;
-                    sink_fn_id = findSink_gmtx(callGraph, source_fn_id, sink_fn_id - 1)
-                ) {
-                    char const* const sink_fn_name = getKey_cset(fns, sink_fn_id);
-                    uint32_t sink_unit_id = findSink_gmtx(ownerGraph, sink_fn_id, unit_count - 1);
-                    if (sink_unit_id == 0xFFFFFFFF && !isCGNoExternal()) {
+                uint32_t const* const sink_fns = sinks_sgraph(rfu->callGraph, source_fn_id);
+                for (uint32_t sink_fn_pos = outDegree_sgraph(rfu->callGraph, source_fn_id); sink_fn_pos-- > 0;) {
+                    uint32_t const sink_fn_id          = sink_fns[sink_fn_pos];
+                    char const* const sink_fn_name     = getKey_cset(rfu->fns, sink_fn_id);
+                    uint32_t const* const sink_units   = sinks_sgraph(rfu->ownerGraph, sink_fn_id);
+                    uint32_t sink_unit_pos             = outDegree_sgraph(rfu->ownerGraph, sink_fn_id);
+                    if (sink_unit_pos == 0 && !isCGNoExternal()) {
                         fprintf(cg,
                             "        <edge id=\"%s::%s()--%s()\" source=\"%s::%s()\" sink=\"%s()\"/>\n",
                             source_unit_name, source_fn_name,
@@ -240,8 +679,9 @@ static void generateXml(void) {
                             sink_fn_name
                         );
                     } else {
-                        while (sink_unit_id != 0xFFFFFFFF) {
-                            char const* const sink_unit_name = getKey_cset(units, sink_unit_id);
+                        while (sink_unit_pos-- > 0) {
+                            uint32_t const sink_unit_id      = sink_units[sink_unit_pos];
+                            char const* const sink_unit_name = getKey_cset(rfu->units, sink_unit_id);
                             if (source_unit_id == sink_unit_id) {
                                 fprintf(cg,
                                     "        <edge id=\"%s::%s()--%s::%s()\" source=\"%s::%s()\" sink=\"%s::%s()\"/>\n",
@@ -259,7 +699,6 @@ static void generateXml(void) {
                                     sink_unit_name, sink_fn_name
                                 );
                             }
-                            sink_unit_id = findSink_gmtx(ownerGraph, sink_fn_id, sink_unit_id - 1);
                         }
                     }
                 }
@@ -272,314 +711,209 @@ static void generateXml(void) {
     DEBUG_ERROR_IF(fclose(cg) == EOF)
 }
 
-void event_startDocument_rfu(struct srcsax_context* context, ...) {
-    static bool first_time_execution = 1;
+void event_startDocument_rfu(Analysis* const analysis) {
+    RFUState* const rfu = analysis->rfu;
 
     VERBOSE_MSG_LITERAL("RFU_START => document");
 
-    if (first_time_execution) {
-        first_time_execution = 0;
+    /* The call graph needs these even if RFU is quiet */
+    if (!isValid_rtable(rfu->statistics)) {
+        Sizing const* const sizing = get_sizing(analysis->isPartial);
 
-        if (!isRFUQuiet()) {
-            DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_map(rfu_statistics, ENTRY_COUNT_GUESS))
-            DEBUG_ASSERT_NDEBUG_EXECUTE(construct_gmtx(callGraph, FN_COUNT_GUESS, FN_COUNT_GUESS))
-            DEBUG_ASSERT_NDEBUG_EXECUTE(construct_gmtx(ownerGraph, FN_COUNT_GUESS, UNIT_COUNT_GUESS))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_rtable(rfu->statistics, sizing->entry_count))
+        if (!analysis->isPartial) {
+            DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_sgraph(rfu->callGraph, sizing->fn_count))
+            DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_sgraph(rfu->ownerGraph, sizing->fn_count))
+            DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_sgraph(rfu->unitGraph, sizing->unit_count))
             DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_cset(
-                units,
+                rfu->units,
                 CHUNK_RECOMMENDED_INITIAL_CAP,
-                UNIT_COUNT_GUESS,
+                sizing->unit_count,
                 CHUNK_SET_RECOMMENDED_LOAD_PERCENT
             ))
             DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_cset(
-                fns,
+                rfu->fns,
                 CHUNK_RECOMMENDED_INITIAL_CAP,
-                FN_COUNT_GUESS,
+                sizing->fn_count,
                 CHUNK_SET_RECOMMENDED_LOAD_PERCENT
             ))
-            DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_chunk(name_chunk, BUFSIZ, 1))
 
-            DEBUG_ERROR_IF(atexit(free_rfu_stuff) != 0)
-            NDEBUG_EXECUTE(atexit(free_rfu_stuff))
+            rfu->transitive_cap  = sizing->entry_count;
+            rfu->transitive_rows = malloc(rfu->transitive_cap * sizeof(RFURow));
+            DEBUG_ERROR_IF(rfu->transitive_rows == NULL)
+
+            rfu->symbol_fn_cap = sizing->fn_count;
+            rfu->symbol_fns    = malloc(rfu->symbol_fn_cap * sizeof(uint32_t));
+            DEBUG_ERROR_IF(rfu->symbol_fns == NULL)
+
+            rfu->visited_cap = sizing->fn_count;
+            rfu->visited     = calloc(rfu->visited_cap, sizeof(uint32_t));
+            DEBUG_ERROR_IF(rfu->visited == NULL)
+            rfu->visit_epoch = 0;
         }
+        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_chunk(rfu->name_chunk, BUFSIZ, 1))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_cset(rfu->replay_symbols, CHUNK_SET_RECOMMENDED_PARAMETERS))
+
+        rfu->replay_cap = RFU_REPLAY_INITIAL_CAP;
+        rfu->replay_ops = malloc(rfu->replay_cap * sizeof(unsigned));
+        DEBUG_ERROR_IF(rfu->replay_ops == NULL)
     } else {
-        if (!isRFUQuiet()) {
-            DEBUG_ASSERT_NDEBUG_EXECUTE(flush_map(rfu_statistics))
-            DEBUG_ASSERT_NDEBUG_EXECUTE(disconnectAll_gmtx(callGraph))
-            DEBUG_ASSERT_NDEBUG_EXECUTE(disconnectAll_gmtx(ownerGraph))
-            DEBUG_ASSERT_NDEBUG_EXECUTE(flush_cset(units))
-            DEBUG_ASSERT_NDEBUG_EXECUTE(flush_cset(fns))
-            DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(name_chunk))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_rtable(rfu->statistics))
+        if (!analysis->isPartial) {
+            DEBUG_ASSERT_NDEBUG_EXECUTE(disconnectAll_sgraph(rfu->callGraph))
+            DEBUG_ASSERT_NDEBUG_EXECUTE(disconnectAll_sgraph(rfu->ownerGraph))
+            DEBUG_ASSERT_NDEBUG_EXECUTE(disconnectAll_sgraph(rfu->unitGraph))
+            DEBUG_ASSERT_NDEBUG_EXECUTE(flush_cset(rfu->units))
+            DEBUG_ASSERT_NDEBUG_EXECUTE(flush_cset(rfu->fns))
         }
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(rfu->name_chunk))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_cset(rfu->replay_symbols))
     }
 
-    unit_count     = 0;
-    unit_id        = 0xFFFFFFFF;
-    fn_count       = 0;
-    rfu_overall    = 0U;
+    rfu->unit_count     = 0;
+    rfu->unit_id        = 0xFFFFFFFF;
+    rfu->fn_count       = 0;
+    rfu->fn_id          = 0xFFFFFFFF;
+    rfu->rfu_overall    = 0U;
+    rfu->rfu_read_state = RFU_READ_STATE_WAITING_METHOD;
+    rfu->replay_count   = 0;
+
+    rfu->transitive_count = 0;
 }
 
-void event_endDocument_rfu(struct srcsax_context* context, ...) {
+void event_endDocument_rfu(Analysis* const analysis) {
+    RFUState* const rfu     = analysis->rfu;
+    Chunk* const    strings = analysis->strings;
+
     VERBOSE_MSG_LITERAL("RFU_END => document");
 
     if (isCGEnabled()) {
-        if (isDotEnabled()) generateDot();
-        if (isXmlEnabled()) generateXml();
+        uint64_t const start = start_profile(analysis->profile);
+        if (isDotEnabled()) generateDot(rfu, strings);
+        if (isXmlEnabled()) generateXml(rfu, strings);
+        stop_profile(analysis->profile, PROFILE_GRAPHS, start);
     }
 
     if (!isRFUQuiet()) {
-        rfu_overall = fn_count;
-        uint32_t const key_id = add_chunk(strings, "RFU", 3);
-        DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(rfu_statistics, key_id, VAL_UNSIGNED(rfu_overall)))
+        if (!isRFUSimple()) insertTransitiveRows(rfu);
+
+        rfu->rfu_overall = rfu->fn_count;
+        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(rfu->statistics, RESULT_OVERALL, METRIC_RFU, SUBMETRIC_ONLY, VAL_UNSIGNED(rfu->rfu_overall)))
     }
 }
 
-void event_startUnit_rfu(struct srcsax_context* context, ...) {
-    va_list args;
-
-    va_start(args, context);
-
-    /* localname, prefix, uri */
-    REPEAT(3) va_arg(args, char const*);
-
-    /* num_namespaces */
-    va_arg(args, int);
-
-    /* namespaces */
-    va_arg(args, void const*);
-
-    /* num_attributes */
-    va_arg(args, int);
-
-    /* attributes */
-    va_arg(args, void const*);
+void event_startUnit_rfu(Analysis* const analysis, UnitEvent const* const event) {
+    RFUState* const rfu     = analysis->rfu;
+    Chunk* const    strings = analysis->strings;
 
-    unit_id = va_arg(args, uint32_t);
+    uint32_t const unit_id = event->unit_id;
 
-    va_end(args);
-
-    rfu_unit                     = 0U;
     char const* const unit_name  = get_chunk(strings, unit_id);
     uint64_t const unit_name_len = strlen_chunk(strings, unit_id);
-    unit_id = addKey_cset(units, unit_name, unit_name_len);
-    DEBUG_ERROR_IF(unit_id == 0xFFFFFFFF)
-    VERBOSE_MSG_VARIADIC("RFU_START => unit (%s)", unit_name);
-
-    unit_count = getKeyCount_cset(units);
+    if (analysis->isPartial) {
+        record(rfu, RFU_REPLAY_START_UNIT, unit_name, unit_name_len);
+    } else {
+        enterUnit(rfu, unit_name, unit_name_len);
+    }
 }
 
-void event_endUnit_rfu(struct srcsax_context* context, ...) {
-    VERBOSE_MSG_VARIADIC("RFU_END => unit (%s)", getKey_cset(units, unit_id));
-    if (!isRFUQuiet()) {
-        ChunkSet unique_calls[1];
-        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_cset(unique_calls, CHUNK_SET_RECOMMENDED_PARAMETERS))
-
-        char const* const unit_name = getKey_cset(units, unit_id);
-        uint64_t const unit_len     = strlen_cset(units, unit_id);
-        for (
-            fn_id = findSource_gmtx(ownerGraph, unit_id, fn_count - 1);
-            fn_id != 0xFFFFFFFF;
-            fn_id = findSource_gmtx(ownerGraph, unit_id, fn_id - 1)
-        ) {
-            /* Always, all the unit's functions count. */
-            char const* const fn_name     = getKey_cset(fns, fn_id);
-            uint64_t const fn_name_len    = strlen_cset(fns, fn_id);
-            DEBUG_ERROR_IF(addKey_cset(unique_calls, fn_name, fn_name_len) == 0xFFFFFFFF)
-            NDEBUG_EXECUTE(addKey_cset(unique_calls, fn_name, fn_name_len))
-
-            /* Always, all the direct calls count. */
-            for (
-                uint32_t sink_fn_id = findSink_gmtx(callGraph, fn_id, fn_count - 1);
-                sink_fn_id != 0xFFFFFFFF;
-                sink_fn_id = findSink_gmtx(callGraph, fn_id, sink_fn_id - 1)
-            ) {
-                char const* const sink_fn  = getKey_cset(fns, sink_fn_id);
-                uint64_t const sink_fn_len = strlen_cset(fns, sink_fn_id);
-                DEBUG_ERROR_IF(addKey_cset(unique_calls, sink_fn, sink_fn_len) == 0xFFFFFFFF)
-                NDEBUG_EXECUTE(addKey_cset(unique_calls, sink_fn, sink_fn_len))
-            }
-        }
-        if (!isRFUSimple()) {
-            /* RFU_Transitive */
-            for (
-                uint32_t unique_call_id = 0;
-                unique_call_id < getKeyCount_cset(unique_calls);
-                unique_call_id++
-            ) {
-                char const* const unique_call_name = getKey_cset(unique_calls, unique_call_id);
-                uint64_t const unique_call_len     = strlen_cset(unique_calls, unique_call_id);
-                uint32_t const source_fn_id        = getKeyId_cset(fns, unique_call_name, unique_call_len);
-                for (
-                    uint32_t sink_fn_id = findSink_gmtx(callGraph, source_fn_id, fn_count - 1);
-                    sink_fn_id != 0xFFFFFFFF;
-                    sink_fn_id = findSink_gmtx(callGraph, source_fn_id, sink_fn_id - 1)
-                ) {
-                    char const* const sink_key  = getKey_cset(fns, sink_fn_id);
-                    uint64_t const sink_key_len = strlen_cset(fns, sink_fn_id);
-                    DEBUG_ERROR_IF(addKey_cset(unique_calls, sink_key, sink_key_len) == 0xFFFFFFFF)
-                    NDEBUG_EXECUTE(addKey_cset(unique_calls, sink_key, sink_key_len))
-                }
-            }
-        }
-        rfu_unit = getKeyCount_cset(unique_calls);
-        DEBUG_ASSERT_NDEBUG_EXECUTE(free_cset(unique_calls))
+void event_endUnit_rfu(Analysis* const analysis, UnitEvent const* const event) {
+    RFUState* const rfu = analysis->rfu;
 
-        uint32_t key_id = add_chunk(strings, "RFU_", 4);
-        DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-        DEBUG_ERROR_IF(append_chunk(strings, unit_name, unit_len) == NULL)
-        NDEBUG_EXECUTE(append_chunk(strings, unit_name, unit_len))
-        DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(rfu_statistics, key_id, VAL_UNSIGNED(rfu_unit)))
+    if (analysis->isPartial) {
+        record(rfu, RFU_REPLAY_END_UNIT, NULL, 0);
+    } else {
+        exitUnit(rfu, analysis);
     }
 }
 
-void event_startElement_rfu(struct srcsax_context* context, ...) {
-    va_list args;
+void event_startElement_rfu(Analysis* const analysis, StartElementEvent const* const event) {
+    RFUState* const rfu = analysis->rfu;
 
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
-    va_end(args);
+    unsigned const tag_id = event->tag_id;
 
-    switch (rfu_read_state) {
+    switch (rfu->rfu_read_state) {
         case RFU_READ_STATE_WAITING_METHOD:
-            if (STR_EQ_CONST(localname, "function"))  { rfu_fn = 0U; rfu_read_state = RFU_READ_STATE_READING_METHOD; }
-            else if (STR_EQ_CONST(localname, "call")) { rfu_read_state = RFU_READ_STATE_WAITING_CALL_NAME; }
+            if (tag_id == C_FUNCTION)  { rfu->rfu_fn = 0U; rfu->rfu_read_state = RFU_READ_STATE_READING_METHOD; }
+            else if (tag_id == C_CALL) { rfu->rfu_read_state = RFU_READ_STATE_WAITING_CALL_NAME; }
             break;
         case RFU_READ_STATE_READING_METHOD:
-            if (STR_EQ_CONST(localname, "type")) { rfu_read_state = RFU_READ_STATE_READING_METHOD_TYPE; }
+            if (tag_id == C_TYPE) { rfu->rfu_read_state = RFU_READ_STATE_READING_METHOD_TYPE; }
             break;
         case RFU_READ_STATE_WAITING_METHOD_NAME:
-            if (STR_EQ_CONST(localname, "name")) { rfu_read_state = RFU_READ_STATE_READING_METHOD_NAME; }
+            if (tag_id == C_NAME) { rfu->rfu_read_state = RFU_READ_STATE_READING_METHOD_NAME; }
             break;
         case RFU_READ_STATE_WAITING_CALL_NAME:
-            if (STR_EQ_CONST(localname, "name")) { rfu_read_state = RFU_READ_STATE_READING_CALL_NAME; }
+            if (tag_id == C_NAME) { rfu->rfu_read_state = RFU_READ_STATE_READING_CALL_NAME; }
     }
 }
 
-void event_endElement_rfu(struct srcsax_context* context, ...) {
-    va_list args;
-
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
-    va_end(args);
-
-    if (STR_EQ_CONST(localname, "function")) {
-        if (!isRFUQuiet()) {
-            char const* const unit_name = getKey_cset(units, unit_id);
-            char const* const fn_name   = getKey_cset(fns, fn_id);
-            uint64_t const unit_len     = strlen_cset(units, unit_id);
-            uint64_t const fn_len       = strlen_cset(fns, fn_id);
-            ChunkSet unique_calls[1];
-            DEBUG_ASSERT_NDEBUG_EXECUTE(
-                constructEmpty_cset(unique_calls, CHUNK_SET_RECOMMENDED_PARAMETERS)
-            )
-
-            DEBUG_ERROR_IF(addKey_cset(unique_calls, fn_name, fn_len) == 0xFFFFFFFF)
-            NDEBUG_EXECUTE(addKey_cset(unique_calls, fn_name, fn_len))
-
-            for (
-                uint32_t sink_fn_id = findSink_gmtx(callGraph, fn_id, fn_count - 1);
-                sink_fn_id != 0xFFFFFFFF;
-                sink_fn_id = findSink_gmtx(callGraph, fn_id, sink_fn_id - 1)
-            ) {
-                char const* const sink_fn_name  = getKey_cset(fns, sink_fn_id);
-                uint64_t const sink_fn_name_len = strlen_cset(fns, sink_fn_id);
-                DEBUG_ERROR_IF(addKey_cset(unique_calls, sink_fn_name, sink_fn_name_len) == 0xFFFFFFFF)
-                NDEBUG_EXECUTE(addKey_cset(unique_calls, sink_fn_name, sink_fn_name_len))
-            }
-            if (!isRFUSimple()) {
-                /* RFU_Transitive */
-                for (
-                    uint32_t unique_call_id = 0;
-                    unique_call_id < getKeyCount_cset(unique_calls);
-                    unique_call_id++
-                ) {
-                    char const* const unique_call_name = getKey_cset(unique_calls, unique_call_id);
-                    uint64_t const unique_call_len     = strlen_cset(unique_calls, unique_call_id);
-                    uint32_t const source_fn_id        = getKeyId_cset(fns, unique_call_name, unique_call_len);
-                    for (
-                        uint32_t sink_fn_id = findSink_gmtx(callGraph, source_fn_id, fn_count - 1);
-                        sink_fn_id != 0xFFFFFFFF;
-                        sink_fn_id = findSink_gmtx(callGraph, source_fn_id, sink_fn_id - 1)
-                    ) {
-                        char const* const sink_fn_name  = getKey_cset(fns, sink_fn_id);
-                        uint64_t const sink_fn_name_len = strlen_cset(fns, sink_fn_id);
-                        DEBUG_ERROR_IF(addKey_cset(unique_calls, sink_fn_name, sink_fn_name_len) == 0xFFFFFFFF)
-                        NDEBUG_EXECUTE(addKey_cset(unique_calls, sink_fn_name, sink_fn_name_len))
-                    }
-                }
-            }
-            rfu_fn = getKeyCount_cset(unique_calls);
-            DEBUG_ASSERT_NDEBUG_EXECUTE(free_cset(unique_calls))
+void event_endElement_rfu(Analysis* const analysis, EndElementEvent const* const event) {
+    RFUState* const rfu = analysis->rfu;
 
-            /* Record RFU for this function */
-            uint32_t const key_id = add_chunk(strings, "RFU_", 4);
-            DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-            DEBUG_ERROR_IF(append_chunk(strings, unit_name, unit_len) == NULL)
-            NDEBUG_EXECUTE(append_chunk(strings, unit_name, unit_len))
-            DEBUG_ERROR_IF(append_chunk(strings, "::", 2) == NULL)
-            NDEBUG_EXECUTE(append_chunk(strings, "::", 2))
-            DEBUG_ERROR_IF(append_chunk(strings, fn_name, fn_len) == NULL)
-            NDEBUG_EXECUTE(append_chunk(strings, fn_name, fn_len))
-            DEBUG_ERROR_IF(append_chunk(strings, "()", 2) == NULL)
-            NDEBUG_EXECUTE(append_chunk(strings, "()", 2))
-            DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(rfu_statistics, key_id, VAL_UNSIGNED(rfu_fn)))
+    unsigned const tag_id = event->tag_id;
+
+    if (tag_id == C_FUNCTION) {
+        if (analysis->isPartial) {
+            record(rfu, RFU_REPLAY_END_FN, NULL, 0);
+        } else {
+            exitFn(rfu, analysis);
         }
-        fn_id = 0xFFFFFFFF;
-    } else if (rfu_read_state == RFU_READ_STATE_READING_METHOD_TYPE && STR_EQ_CONST(localname, "type")) {
-        rfu_read_state = RFU_READ_STATE_WAITING_METHOD_NAME;
-    } else if (rfu_read_state == RFU_READ_STATE_READING_METHOD_NAME && STR_EQ_CONST(localname, "name")) {
-        char const* const fn_name = getLast_chunk(name_chunk);
+    } else if (rfu->rfu_read_state == RFU_READ_STATE_READING_METHOD_TYPE && tag_id == C_TYPE) {
+        rfu->rfu_read_state = RFU_READ_STATE_WAITING_METHOD_NAME;
+    } else if (rfu->rfu_read_state == RFU_READ_STATE_READING_METHOD_NAME && tag_id == C_NAME) {
+        char const* const fn_name = getLast_chunk(rfu->name_chunk);
         DEBUG_ERROR_IF(fn_name == NULL)
 
-        uint64_t const fn_len = strlenLast_chunk(name_chunk);
+        uint64_t const fn_len = strlenLast_chunk(rfu->name_chunk);
         DEBUG_ERROR_IF(fn_len == 0)
 
-        fn_id = addKey_cset(fns, fn_name, fn_len);
-        DEBUG_ERROR_IF(fn_id == 0xFFFFFFFF)
-        DEBUG_ASSERT_NDEBUG_EXECUTE(connect_gmtx(ownerGraph, fn_id, unit_id))
+        if (analysis->isPartial) {
+            record(rfu, RFU_REPLAY_DEFINE_FN, fn_name, fn_len);
+        } else {
+            defineFn(rfu, internFn(rfu, fn_name, fn_len));
+        }
 
-        fn_count       = getKeyCount_cset(fns);
-        rfu_read_state = RFU_READ_STATE_WAITING_METHOD;
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(name_chunk))
-    } else if (rfu_read_state == RFU_READ_STATE_READING_CALL_NAME && STR_EQ_CONST(localname, "name")) {
-        char const* const sink_fn_name = getLast_chunk(name_chunk);
+        rfu->rfu_read_state = RFU_READ_STATE_WAITING_METHOD;
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(rfu->name_chunk))
+    } else if (rfu->rfu_read_state == RFU_READ_STATE_READING_CALL_NAME && tag_id == C_NAME) {
+        char const* const sink_fn_name = getLast_chunk(rfu->name_chunk);
         DEBUG_ERROR_IF(sink_fn_name == NULL)
 
-        uint64_t const sink_fn_len = strlenLast_chunk(name_chunk);
+        uint64_t const sink_fn_len = strlenLast_chunk(rfu->name_chunk);
         DEBUG_ERROR_IF(sink_fn_len == 0)
 
-        uint32_t const sink_fn_id = addKey_cset(fns, sink_fn_name, sink_fn_len);
-        DEBUG_ERROR_IF(sink_fn_id == 0xFFFFFFFF)
-        DEBUG_ASSERT_NDEBUG_EXECUTE(connect_gmtx(callGraph, fn_id, sink_fn_id))
+        if (analysis->isPartial) {
+            record(rfu, RFU_REPLAY_CALL_FN, sink_fn_name, sink_fn_len);
+        } else {
+            callFn(rfu, internFn(rfu, sink_fn_name, sink_fn_len));
+        }
 
-        fn_count       = getKeyCount_cset(fns);
-        rfu_read_state = RFU_READ_STATE_WAITING_METHOD;
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(name_chunk))
+        rfu->rfu_read_state = RFU_READ_STATE_WAITING_METHOD;
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(rfu->name_chunk))
     }
 }
 
-void event_charactersUnit_rfu(struct srcsax_context* context, ...) {
-    va_list args;
+void event_charactersUnit_rfu(Analysis* const analysis, CharactersEvent const* const event) {
+    RFUState* const rfu = analysis->rfu;
 
-    va_start(args, context);
-    char const* const ch = va_arg(args, char*);
-    uint64_t const len   = va_arg(args, uint64_t);
-    va_end(args);
+    char const* const ch  = event->ch;
+    uint64_t const    len = event->len;
 
-    switch (rfu_read_state) {
+    switch (rfu->rfu_read_state) {
         case RFU_READ_STATE_READING_METHOD_NAME:
         case RFU_READ_STATE_READING_CALL_NAME:
-            DEBUG_ERROR_IF(append_chunk(name_chunk, ch, len) == NULL)
-            NDEBUG_EXECUTE(append_chunk(name_chunk, ch, len))
+            DEBUG_ERROR_IF(append_chunk(rfu->name_chunk, ch, len) == NULL)
+            NDEBUG_EXECUTE(append_chunk(rfu->name_chunk, ch, len))
     }
 }
 
-Map const* report_rfu(void) {
+ResultTable const* report_rfu(Analysis const* const analysis) {
     if (isRFUQuiet()) {
         return NULL;
     } else {
         VERBOSE_MSG_LITERAL("RFU_REPORT");
-        return isValid_map(rfu_statistics) ? rfu_statistics : NULL;
+        return isValid_rtable(analysis->rfu->statistics) ? analysis->rfu->statistics : NULL;
     }
 }
 
@@ -3,209 +3,195 @@
  * @brief Source Lines of Code
  * @author Yavuz Koroglu
  */
-#include <stdarg.h>
+#include "languages/c.h"
 #include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/cache.h"
 #include "srcmetrics/metrics/sloc.h"
+#include "srcmetrics/sizing.h"
 #include "padkit/chunk.h"
 #include "padkit/debug.h"
-#include "padkit/repeat.h"
-#include "padkit/streq.h"
-
-#define ENTRY_COUNT_GUESS (UNIT_COUNT_GUESS + FN_COUNT_GUESS)
-
-static Map sloc_statistics[1] = { NOT_A_MAP };
 
 #define SLOC_STATE_WAITING_UNIT             0U
 #define SLOC_STATE_READING_UNIT             1U
 #define SLOC_STATE_READING_METHOD           2U
 #define SLOC_STATE_READING_UNIT_STATEMENT   3U
 #define SLOC_STATE_READING_METHOD_STATEMENT 4U
-static unsigned sloc_state   = 0U;
 
-static unsigned sloc_overall = 0U;
-static unsigned sloc_unit    = 0U;
-static unsigned sloc_fn      = 0U;
+void free_sloc(SLOCState* const sloc) {
+    if (!isValid_rtable(sloc->statistics)) return;
 
-static void free_sloc_statistics(void) {
     VERBOSE_MSG_LITERAL("SLOC_FREE");
 
-    DEBUG_ABORT_IF(!free_map(sloc_statistics))
-    NDEBUG_EXECUTE(free_map(sloc_statistics))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_rtable(sloc->statistics))
 }
 
-void event_startDocument_sloc(struct srcsax_context* context, ...) {
-    static bool first_time_execution = 1;
+void merge_sloc(Analysis* const analysis, Analysis const* const partial) {
+    SLOCState* const sloc = analysis->sloc;
 
-    VERBOSE_MSG_LITERAL("SLOC_START => document");
+    VERBOSE_MSG_LITERAL("SLOC_MERGE");
+
+    mergeStatistics_analysis(analysis, sloc->statistics, partial, partial->sloc->statistics);
+
+    sloc->sloc_overall += partial->sloc->sloc_overall;
+}
+
+bool save_sloc(FILE* const stream, Analysis const* const partial) {
+    SLOCState const* const sloc = partial->sloc;
 
-    if (first_time_execution) {
-        first_time_execution = 0;
+    VERBOSE_MSG_LITERAL("SLOC_SAVE");
+
+    return writeStatistics_cache(stream, partial, sloc->statistics)
+        && writeUnsigned_cache(stream, sloc->sloc_overall);
+}
+
+bool load_sloc(Analysis* const partial, FILE* const stream) {
+    SLOCState* const sloc = partial->sloc;
+    uint64_t         sloc_overall;
+
+    VERBOSE_MSG_LITERAL("SLOC_LOAD");
+
+    if (!readStatistics_cache(stream, partial, sloc->statistics)) return 0;
+    if (!readUnsigned_cache(stream, &sloc_overall))               return 0;
+
+    sloc->sloc_overall = (unsigned)sloc_overall;
+    return 1;
+}
 
-        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_map(sloc_statistics, ENTRY_COUNT_GUESS))
+void event_startDocument_sloc(Analysis* const analysis) {
+    SLOCState* const sloc = analysis->sloc;
 
-        DEBUG_ERROR_IF(atexit(free_sloc_statistics) != 0)
-        NDEBUG_EXECUTE(atexit(free_sloc_statistics))
+    VERBOSE_MSG_LITERAL("SLOC_START => document");
+
+    if (!isValid_rtable(sloc->statistics)) {
+        DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_rtable(sloc->statistics, get_sizing(analysis->isPartial)->entry_count))
     } else {
-        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_map(sloc_statistics))
+        DEBUG_ASSERT_NDEBUG_EXECUTE(flush_rtable(sloc->statistics))
     }
 
-    sloc_overall = 0U;
-    sloc_state   = SLOC_STATE_WAITING_UNIT;
+    sloc->sloc_overall = 0U;
+    sloc->sloc_state   = SLOC_STATE_WAITING_UNIT;
 }
 
-void event_endDocument_sloc(struct srcsax_context* context, ...) {
+void event_endDocument_sloc(Analysis* const analysis) {
+    SLOCState* const sloc = analysis->sloc;
+
     VERBOSE_MSG_LITERAL("SLOC_END => document");
-    uint32_t const key_id = add_chunk(strings, "SLOC", 4);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(sloc_statistics, key_id, VAL_UNSIGNED(sloc_overall)))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(sloc->statistics, RESULT_OVERALL, METRIC_SLOC, SUBMETRIC_ONLY, VAL_UNSIGNED(sloc->sloc_overall)))
 }
 
-void event_startUnit_sloc(struct srcsax_context* context, ...) {
+void event_startUnit_sloc(Analysis* const analysis, UnitEvent const* const event) {
+    SLOCState* const sloc = analysis->sloc;
+
     VERBOSE_MSG_LITERAL("SLOC_START => unit");
-    sloc_unit  = 0U;
-    sloc_state = SLOC_STATE_READING_UNIT;
+    sloc->sloc_unit  = 0U;
+    sloc->sloc_state = SLOC_STATE_READING_UNIT;
 }
 
-void event_endUnit_sloc(struct srcsax_context* context, ...) {
-    va_list args;
-
-    va_start(args, context);
-
-    /* localname, prefix, uri */
-    REPEAT(3) va_arg(args, char const*);
-
-    uint32_t const unit_id = va_arg(args, uint32_t);
+void event_endUnit_sloc(Analysis* const analysis, UnitEvent const* const event) {
+    SLOCState* const sloc    = analysis->sloc;
+    Chunk* const     strings = analysis->strings;
+    uint32_t const   unit_id = event->unit_id;
 
     VERBOSE_MSG_VARIADIC("SLOC_END => unit (%s)", get_chunk(strings, unit_id));
 
-    va_end(args);
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(sloc->statistics, unit_id, METRIC_SLOC, SUBMETRIC_ONLY, VAL_UNSIGNED(sloc->sloc_unit)))
 
-    uint32_t const key_id = add_chunk(strings, "SLOC_", 5);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, unit_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, unit_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(sloc_statistics, key_id, VAL_UNSIGNED(sloc_unit)))
-
-    sloc_state = SLOC_STATE_WAITING_UNIT;
+    sloc->sloc_state = SLOC_STATE_WAITING_UNIT;
 }
 
-void event_startElement_sloc(struct srcsax_context* context, ...) {
-    va_list args;
-
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
-    va_end(args);
-
-    if (STR_EQ_CONST(localname, "function")) {
-        VERBOSE_MSG_VARIADIC("SLOC++ (%s)", localname);
-        sloc_overall++;
-        sloc_unit++;
-        sloc_fn    = 0U;
-        sloc_state = SLOC_STATE_READING_METHOD;
-    } else if (
-        STR_EQ_CONST(localname, "expr_stmt") ||
-        STR_EQ_CONST(localname, "decl_stmt") ||
-        STR_EQ_CONST(localname, "return")    ||
-        STR_EQ_CONST(localname, "break")     ||
-        STR_EQ_CONST(localname, "continue")  ||
-        STR_EQ_CONST(localname, "label")     ||
-        STR_EQ_CONST(localname, "goto")      ||
-        STR_EQ_CONST(localname, "default")   ||
-        STR_EQ_CONST(localname, "case")      ||
-        STR_EQ_CONST(localname, "directive") ||
-        STR_EQ_CONST(localname, "macro")
-    ) {
-        switch (sloc_state) {
-            case SLOC_STATE_READING_UNIT:
-                VERBOSE_MSG_VARIADIC("SLOC++ (%s)", localname);
-                sloc_unit++;
-                sloc_overall++;
-                sloc_state = SLOC_STATE_READING_UNIT_STATEMENT;
-                break;
-            case SLOC_STATE_READING_METHOD:
-                VERBOSE_MSG_VARIADIC("SLOC++ (%s)", localname);
-                sloc_unit++;
-                sloc_overall++;
-                sloc_fn++;
-                sloc_state = SLOC_STATE_READING_METHOD_STATEMENT;
-        }
-    } else if (
-        STR_EQ_CONST(localname, "for")     ||
-        STR_EQ_CONST(localname, "while")   ||
-        STR_EQ_CONST(localname, "switch")  ||
-        STR_EQ_CONST(localname, "if_stmt") ||
-        STR_EQ_CONST(localname, "typedef") ||
-        STR_EQ_CONST(localname, "struct")  ||
-        STR_EQ_CONST(localname, "union")
-    ) {
-        switch (sloc_state) {
-            case SLOC_STATE_READING_METHOD:
-                VERBOSE_MSG_VARIADIC("SLOC++ (%s)", localname);
-                sloc_overall++;
-                sloc_unit++;
-                sloc_fn++;
-        }
+void event_startElement_sloc(Analysis* const analysis, StartElementEvent const* const event) {
+    SLOCState* const sloc = analysis->sloc;
+
+    char const* const localname = event->localname;
+    unsigned const    tag_id    = event->tag_id;
+
+    switch (tag_id) {
+        case C_FUNCTION:
+            VERBOSE_MSG_VARIADIC("SLOC++ (%s)", localname);
+            sloc->sloc_overall++;
+            sloc->sloc_unit++;
+            sloc->sloc_fn    = 0U;
+            sloc->sloc_state = SLOC_STATE_READING_METHOD;
+            break;
+        case C_EXPR_STMT:
+        case C_DECL_STMT:
+        case C_RETURN:
+        case C_BREAK:
+        case C_CONTINUE:
+        case C_LABEL:
+        case C_GOTO:
+        case C_DEFAULT:
+        case C_CASE:
+        case C_DIRECTIVE:
+        case C_MACRO:
+            switch (sloc->sloc_state) {
+                case SLOC_STATE_READING_UNIT:
+                    VERBOSE_MSG_VARIADIC("SLOC++ (%s)", localname);
+                    sloc->sloc_unit++;
+                    sloc->sloc_overall++;
+                    sloc->sloc_state = SLOC_STATE_READING_UNIT_STATEMENT;
+                    break;
+                case SLOC_STATE_READING_METHOD:
+                    VERBOSE_MSG_VARIADIC("SLOC++ (%s)", localname);
+                    sloc->sloc_unit++;
+                    sloc->sloc_overall++;
+                    sloc->sloc_fn++;
+                    sloc->sloc_state = SLOC_STATE_READING_METHOD_STATEMENT;
+            }
+            break;
+        case C_FOR:
+        case C_WHILE:
+        case C_SWITCH:
+        case C_IF_STMT:
+        case C_TYPEDEF:
+        case C_STRUCT:
+        case C_UNION:
+            if (sloc->sloc_state != SLOC_STATE_READING_METHOD) break;
+            VERBOSE_MSG_VARIADIC("SLOC++ (%s)", localname);
+            sloc->sloc_overall++;
+            sloc->sloc_unit++;
+            sloc->sloc_fn++;
     }
 }
 
-void event_endElement_sloc(struct srcsax_context* context, ...) {
-    va_list args;
-
-    va_start(args, context);
-    char const* const localname = va_arg(args, char const*);
-
-    /* prefix, uri */
-    REPEAT(2) va_arg(args, char const*);
-
-    /* unit_id */
-    va_arg(args, uint32_t);
-
-    uint32_t const fn_id = va_arg(args, uint32_t);
-    va_end(args);
-
-    switch (sloc_state) {
-        case SLOC_STATE_READING_METHOD_STATEMENT:
-            if (
-                STR_EQ_CONST(localname, "expr_stmt") ||
-                STR_EQ_CONST(localname, "decl_stmt") ||
-                STR_EQ_CONST(localname, "return")    ||
-                STR_EQ_CONST(localname, "break")     ||
-                STR_EQ_CONST(localname, "continue")  ||
-                STR_EQ_CONST(localname, "label")     ||
-                STR_EQ_CONST(localname, "goto")      ||
-                STR_EQ_CONST(localname, "default")   ||
-                STR_EQ_CONST(localname, "case")      ||
-                STR_EQ_CONST(localname, "directive") ||
-                STR_EQ_CONST(localname, "macro")
-            ) sloc_state = SLOC_STATE_READING_METHOD;
+void event_endElement_sloc(Analysis* const analysis, EndElementEvent const* const event) {
+    SLOCState* const sloc = analysis->sloc;
+
+    uint32_t const fn_id  = event->fn_id;
+    unsigned const tag_id = event->tag_id;
+
+    switch (tag_id) {
+        case C_EXPR_STMT:
+        case C_DECL_STMT:
+        case C_RETURN:
+        case C_BREAK:
+        case C_CONTINUE:
+        case C_LABEL:
+        case C_GOTO:
+        case C_DEFAULT:
+        case C_CASE:
+        case C_DIRECTIVE:
+        case C_MACRO:
+            switch (sloc->sloc_state) {
+                case SLOC_STATE_READING_METHOD_STATEMENT:
+                    sloc->sloc_state = SLOC_STATE_READING_METHOD;
+                    break;
+                case SLOC_STATE_READING_UNIT_STATEMENT:
+                    sloc->sloc_state = SLOC_STATE_READING_UNIT;
+            }
+            return;
+        case C_FUNCTION:
             break;
-        case SLOC_STATE_READING_UNIT_STATEMENT:
-            if (
-                STR_EQ_CONST(localname, "expr_stmt") ||
-                STR_EQ_CONST(localname, "decl_stmt") ||
-                STR_EQ_CONST(localname, "return")    ||
-                STR_EQ_CONST(localname, "break")     ||
-                STR_EQ_CONST(localname, "continue")  ||
-                STR_EQ_CONST(localname, "label")     ||
-                STR_EQ_CONST(localname, "goto")      ||
-                STR_EQ_CONST(localname, "default")   ||
-                STR_EQ_CONST(localname, "case")      ||
-                STR_EQ_CONST(localname, "directive") ||
-                STR_EQ_CONST(localname, "macro")
-            ) sloc_state = SLOC_STATE_READING_UNIT;
+        default:
+            return;
     }
 
-    if (!STR_EQ_CONST(localname, "function")) return;
-
-    sloc_state = SLOC_STATE_READING_UNIT;
-    uint32_t const key_id = add_chunk(strings, "SLOC_", 5);
-    DEBUG_ERROR_IF(key_id == 0xFFFFFFFF)
-    DEBUG_ERROR_IF(appendIndex_chunk(strings, fn_id) == NULL)
-    NDEBUG_EXECUTE(appendIndex_chunk(strings, fn_id))
-    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_map(sloc_statistics, key_id, VAL_UNSIGNED(sloc_fn)))
+    sloc->sloc_state = SLOC_STATE_READING_UNIT;
+    DEBUG_ASSERT_NDEBUG_EXECUTE(insert_rtable(sloc->statistics, fn_id, METRIC_SLOC, SUBMETRIC_ONLY, VAL_UNSIGNED(sloc->sloc_fn)))
 }
 
-Map const* report_sloc(void) {
+ResultTable const* report_sloc(Analysis const* const analysis) {
     VERBOSE_MSG_LITERAL("SLOC_REPORT");
-    return isValid_map(sloc_statistics) ? sloc_statistics : NULL;
+    return isValid_rtable(analysis->sloc->statistics) ? analysis->sloc->statistics : NULL;
 }
@@ -0,0 +1,380 @@
+/**
+ * @file parse.c
+ * @brief Implements functions defined in parse.h.
+ * @author Yavuz Koroglu
+ * @see parse.h
+ */
+#include <string.h>
+
+#include "srcmetrics.h"
+#include "srcmetrics/cache.h"
+#include "srcmetrics/parse.h"
+#include "srcmetrics/profile.h"
+#include "srcmetrics/sizing.h"
+#include "srcmetrics/source.h"
+#include "padkit/debug.h"
+
+/**
+ * @brief Given a job number, returns the index of the infile to parse.
+ *
+ * The serial loop parses from the last infile to the first, so does the pool.
+ */
+#define INFILE_ID_OF_JOB(pool, job) ((pool)->n_infiles - 1 - (job))
+
+/**
+ * @brief Maps or reads a source file into a released Source.
+ * @return 0 if the file cannot be opened, 1 otherwise.
+ */
+static bool readInfile(char const* const infile, Source* const source, Profile* const profile) {
+    uint64_t const start = start_profile(profile);
+
+    if (!read_source(source, infile)) return 0;
+
+    stop_profile(profile, PROFILE_FILE_READ, start);
+    return 1;
+}
+
+/**
+ * @brief Parses the source code in a Source into a new srcML unit.
+ */
+static struct srcml_unit* parseInfile(
+    struct srcml_archive* const archive,
+    char const* const           infile,
+    Source const* const         source,
+    Profile* const              profile
+) {
+    VERBOSE_MSG_VARIADIC("SRCML_UNIT = %s", infile);
+
+    /* NOTE: I assume every file contains exactly one unit.
+     * This is true for C but maybe not for Java */
+    struct srcml_unit* const unit = srcml_unit_create(archive);
+
+    VERBOSE_MSG_LITERAL("SRCML_LANGUAGE = C");
+
+    /* Set language to C */
+    DEBUG_ERROR_IF(srcml_unit_set_language(unit, SRCML_LANGUAGE_C) != SRCML_STATUS_OK)
+    NDEBUG_EXECUTE(srcml_unit_set_language(unit, SRCML_LANGUAGE_C))
+
+    VERBOSE_MSG_VARIADIC("SRCML_SET_FILENAME = %s", infile);
+
+    /* Set filename */
+    DEBUG_ERROR_IF(srcml_unit_set_filename(unit, infile) != SRCML_STATUS_OK)
+    NDEBUG_EXECUTE(srcml_unit_set_filename(unit, infile))
+
+    VERBOSE_MSG_VARIADIC("SRCML_UNIT_PARSE => %llu bytes", source->len);
+
+    /* Create the unit */
+    uint64_t const start = start_profile(profile);
+    DEBUG_ERROR_IF(srcml_unit_parse_memory(unit, source->start, source->len) != SRCML_STATUS_OK)
+    NDEBUG_EXECUTE(srcml_unit_parse_memory(unit, source->start, source->len))
+    stop_profile(profile, PROFILE_SRCML_PARSE, start);
+
+    return unit;
+}
+
+static void* work_ppool(void* const arg) {
+    ParseWorker* const worker = (ParseWorker*)arg;
+    ParsePool* const   pool   = worker->pool;
+
+    Source source[1];
+    constructEmpty_source(source);
+
+    Profile* const profile = new_profile();
+
+    while (1) {
+        pthread_mutex_lock(&pool->mutex);
+        while (pool->nextToParse < pool->n_infiles && pool->nextToParse - pool->nextToTake >= pool->queue_cap)
+            pthread_cond_wait(&pool->slotFreed, &pool->mutex);
+        if (pool->nextToParse >= pool->n_infiles) {
+            pthread_mutex_unlock(&pool->mutex);
+            break;
+        }
+        size_t const job = pool->nextToParse++;
+        pthread_mutex_unlock(&pool->mutex);
+
+        char const* const  infile = pool->infiles[INFILE_ID_OF_JOB(pool, job)];
+        struct srcml_unit* unit   = NULL;
+        bool               isDone;
+
+        if (pool->analyses != NULL) {
+            /* Nobody else touches the Analysis of this slot until the slot is ready */
+            isDone = evaluateUnit_ppool(worker->archive, infile, source, profile, pool->analyses + job % pool->queue_cap);
+        } else {
+            unit   = parseUnit_ppool(worker->archive, infile, source, profile);
+            isDone = unit != NULL;
+        }
+        release_source(source);
+
+        /* A failure is reported by the consumer when it takes this slot, so in input order */
+        pthread_mutex_lock(&pool->mutex);
+        ParseSlot* const slot = pool->queue + job % pool->queue_cap;
+        DEBUG_ASSERT(!slot->isReady)
+        slot->unit      = unit;
+        slot->hasFailed = !isDone;
+        slot->isReady   = 1;
+        pthread_cond_broadcast(&pool->unitParsed);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+
+    free_source(source);
+    free_profile(profile);
+    return NULL;
+}
+
+void constructEmpty_ppool(
+    ParsePool* const            pool,
+    struct srcml_archive* const archive,
+    char const* const* const    infiles,
+    size_t const                n_infiles,
+    uint32_t const              n_jobs,
+    uint_fast64_t const         evaluatedMetrics
+) {
+    DEBUG_ERROR_IF(pool == NULL)
+    DEBUG_ERROR_IF(archive == NULL)
+    DEBUG_ERROR_IF(infiles == NULL && n_infiles > 0)
+    DEBUG_ERROR_IF(n_jobs == 0)
+
+    pool->n_infiles   = n_infiles;
+    pool->infiles     = infiles;
+    pool->n_jobs      = n_jobs;
+    pool->queue_cap   = n_jobs * PPOOL_RECOMMENDED_QUEUE_CAP_PER_JOB;
+    pool->nextToParse = 0;
+    pool->nextToTake  = 0;
+    pool->queue       = NULL;
+    pool->workers     = NULL;
+    pool->analyses    = NULL;
+    pool->archive     = archive;
+    pool->profile     = NULL;
+
+    pool->failedInfile = NULL;
+
+    pool->isHoldingAnalysis = 0;
+
+    if (n_jobs == 1) {
+        constructEmpty_source(pool->source);
+        pool->profile = new_profile();
+
+        /* One partial Analysis is enough, nextAnalysis_ppool() evaluates the next unit in it */
+        if (evaluatedMetrics != 0) {
+            pool->analyses = malloc(sizeof(Analysis));
+            DEBUG_ERROR_IF(pool->analyses == NULL)
+            constructEmptyPartial_analysis(pool->analyses, evaluatedMetrics);
+        }
+        return;
+    }
+
+    pool->queue = calloc(pool->queue_cap, sizeof(ParseSlot));
+    DEBUG_ERROR_IF(pool->queue == NULL)
+
+    pool->workers = malloc(n_jobs * sizeof(ParseWorker));
+    DEBUG_ERROR_IF(pool->workers == NULL)
+
+    if (evaluatedMetrics != 0) {
+        pool->analyses = malloc(pool->queue_cap * sizeof(Analysis));
+        DEBUG_ERROR_IF(pool->analyses == NULL)
+
+        for (Analysis* partial = pool->analyses; partial < pool->analyses + pool->queue_cap; partial++)
+            constructEmptyPartial_analysis(partial, evaluatedMetrics);
+    }
+
+    DEBUG_ERROR_IF(pthread_mutex_init(&pool->mutex, NULL) != 0)
+    NDEBUG_EXECUTE(pthread_mutex_init(&pool->mutex, NULL))
+    DEBUG_ERROR_IF(pthread_cond_init(&pool->unitParsed, NULL) != 0)
+    NDEBUG_EXECUTE(pthread_cond_init(&pool->unitParsed, NULL))
+    DEBUG_ERROR_IF(pthread_cond_init(&pool->slotFreed, NULL) != 0)
+    NDEBUG_EXECUTE(pthread_cond_init(&pool->slotFreed, NULL))
+
+    for (ParseWorker* worker = pool->workers; worker < pool->workers + n_jobs; worker++) {
+        worker->archive = srcml_archive_clone(archive);
+        DEBUG_ERROR_IF(worker->archive == NULL)
+        worker->pool    = pool;
+        DEBUG_ERROR_IF(pthread_create(&worker->thread, NULL, work_ppool, worker) != 0)
+        NDEBUG_EXECUTE(pthread_create(&worker->thread, NULL, work_ppool, worker))
+    }
+
+    VERBOSE_MSG_VARIADIC("PARSE_POOL_STARTED => %u jobs", (unsigned)n_jobs);
+}
+
+void free_ppool(ParsePool* const pool) {
+    DEBUG_ASSERT(isValid_ppool(pool))
+
+    if (pool->n_jobs == 1) {
+        free_source(pool->source);
+        free_profile(pool->profile);
+        if (pool->analyses != NULL) {
+            free_analysis(pool->analyses);
+            free(pool->analyses);
+        }
+        pool->profile  = NULL;
+        pool->analyses = NULL;
+        pool->n_jobs   = 0;
+        return;
+    }
+
+    /* The consumer may stop early, e.g., after a failure, so no worker starts another job */
+    pthread_mutex_lock(&pool->mutex);
+    pool->nextToParse = pool->n_infiles;
+    pthread_cond_broadcast(&pool->slotFreed);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (ParseWorker* worker = pool->workers; worker < pool->workers + pool->n_jobs; worker++) {
+        DEBUG_ERROR_IF(pthread_join(worker->thread, NULL) != 0)
+        NDEBUG_EXECUTE(pthread_join(worker->thread, NULL))
+        srcml_archive_free(worker->archive);
+    }
+
+    pthread_cond_destroy(&pool->slotFreed);
+    pthread_cond_destroy(&pool->unitParsed);
+    pthread_mutex_destroy(&pool->mutex);
+
+    /* The units nobody took */
+    for (ParseSlot* slot = pool->queue; slot < pool->queue + pool->queue_cap; slot++)
+        if (slot->unit != NULL) srcml_unit_free(slot->unit);
+
+    if (pool->analyses != NULL) {
+        for (Analysis* partial = pool->analyses; partial < pool->analyses + pool->queue_cap; partial++)
+            free_analysis(partial);
+        free(pool->analyses);
+    }
+
+    free(pool->workers);
+    free(pool->queue);
+
+    pool->workers  = NULL;
+    pool->queue    = NULL;
+    pool->analyses = NULL;
+    pool->n_jobs   = 0;
+}
+
+bool isValid_ppool(ParsePool const* const pool) {
+    return pool != NULL && pool->n_jobs > 0 && pool->archive != NULL && pool->nextToTake <= pool->n_infiles;
+}
+
+struct srcml_unit* nextUnit_ppool(ParsePool* const pool) {
+    DEBUG_ASSERT(isValid_ppool(pool))
+
+    if (pool->failedInfile != NULL || pool->nextToTake >= pool->n_infiles) return NULL;
+
+    char const* const infile = pool->infiles[INFILE_ID_OF_JOB(pool, pool->nextToTake)];
+
+    if (pool->n_jobs == 1) {
+        struct srcml_unit* const unit = parseUnit_ppool(pool->archive, infile, pool->source, pool->profile);
+        release_source(pool->source);
+        if (unit == NULL) {
+            pool->failedInfile = infile;
+            return NULL;
+        }
+        pool->nextToTake++;
+        return unit;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    ParseSlot* const slot = pool->queue + pool->nextToTake % pool->queue_cap;
+    while (!slot->isReady)
+        pthread_cond_wait(&pool->unitParsed, &pool->mutex);
+
+    if (slot->hasFailed) {
+        pool->failedInfile = infile;
+        pthread_mutex_unlock(&pool->mutex);
+        return NULL;
+    }
+
+    struct srcml_unit* const unit = slot->unit;
+    slot->unit    = NULL;
+    slot->isReady = 0;
+    pool->nextToTake++;
+    pthread_cond_broadcast(&pool->slotFreed);
+    pthread_mutex_unlock(&pool->mutex);
+
+    return unit;
+}
+
+Analysis const* nextAnalysis_ppool(ParsePool* const pool) {
+    DEBUG_ASSERT(isValid_ppool(pool))
+    DEBUG_ERROR_IF(pool->analyses == NULL)
+
+    if (pool->failedInfile != NULL) return NULL;
+
+    if (pool->n_jobs == 1) {
+        if (pool->nextToTake >= pool->n_infiles) return NULL;
+
+        char const* const infile = pool->infiles[INFILE_ID_OF_JOB(pool, pool->nextToTake)];
+        bool const        isDone = evaluateUnit_ppool(pool->archive, infile, pool->source, pool->profile, pool->analyses);
+        release_source(pool->source);
+        if (!isDone) {
+            pool->failedInfile = infile;
+            return NULL;
+        }
+        pool->nextToTake++;
+        return pool->analyses;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+
+    /* The caller is done with the previous Analysis, so its slot is free */
+    if (pool->isHoldingAnalysis) {
+        pool->isHoldingAnalysis = 0;
+        pool->nextToTake++;
+        pthread_cond_broadcast(&pool->slotFreed);
+    }
+
+    if (pool->nextToTake >= pool->n_infiles) {
+        pthread_mutex_unlock(&pool->mutex);
+        return NULL;
+    }
+
+    ParseSlot* const slot = pool->queue + pool->nextToTake % pool->queue_cap;
+    while (!slot->isReady)
+        pthread_cond_wait(&pool->unitParsed, &pool->mutex);
+
+    if (slot->hasFailed) {
+        pool->failedInfile = pool->infiles[INFILE_ID_OF_JOB(pool, pool->nextToTake)];
+        pthread_mutex_unlock(&pool->mutex);
+        return NULL;
+    }
+
+    Analysis const* const partial = pool->analyses + pool->nextToTake % pool->queue_cap;
+    slot->isReady                 = 0;
+    pool->isHoldingAnalysis       = 1;
+    pthread_mutex_unlock(&pool->mutex);
+
+    return partial;
+}
+
+struct srcml_unit* parseUnit_ppool(
+    struct srcml_archive* const archive,
+    char const* const           infile,
+    Source* const               source,
+    Profile* const              profile
+) {
+    if (!readInfile(infile, source, profile)) return NULL;
+    return parseInfile(archive, infile, source, profile);
+}
+
+bool evaluateUnit_ppool(
+    struct srcml_archive* const archive,
+    char const* const           infile,
+    Source* const               source,
+    Profile* const              profile,
+    Analysis* const             partial
+) {
+    if (!readInfile(infile, source, profile)) return 0;
+
+    /* The server evaluates one file at a time, so its tables fit the file at hand */
+    if (isServing()) prepareUnit_sizing(source->len);
+
+    if (isCaching() && load_cache(partial, infile, source)) return 1;
+
+    struct srcml_unit* const unit = parseInfile(archive, infile, source, profile);
+
+    char const* const unit_srcml = srcml_unit_get_srcml(unit);
+    DEBUG_ERROR_IF(unit_srcml == NULL)
+
+    runUnit_analysis(partial, unit_srcml, strlen(unit_srcml));
+
+    srcml_unit_free(unit);
+
+    if (isCaching()) save_cache(partial, infile, source);
+
+    return 1;
+}
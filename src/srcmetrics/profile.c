@@ -0,0 +1,160 @@
+/**
+ * @file profile.c
+ * @brief Implements functions defined in profile.h.
+ * @author Yavuz Koroglu
+ * @see profile.h
+ */
+#ifndef _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 199309L
+#endif
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "srcmetrics.h"
+#include "srcmetrics/metrics.h"
+#include "srcmetrics/profile.h"
+#include "padkit/debug.h"
+
+static Profile         total[1];
+static pthread_mutex_t totalMutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t        wallStart  = 0;
+
+static uint64_t now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+static bool endsWithCsv(char const* const filename) {
+    size_t const len = strlen(filename);
+    return len >= 4 && strcmp(filename + len - 4, ".csv") == 0;
+}
+
+static void writeCsv(FILE* const output, uint64_t const wallNanoseconds) {
+    static char const* phases[]  = PROFILE_PHASES;
+    static char const* metrics[] = METRICS;
+
+    fputs("kind,name,calls,seconds\n", output);
+    fprintf(output, "wall,total,1,%.6f\n", wallNanoseconds / 1e9);
+    for (unsigned phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+        fprintf(
+            output, "phase,%s,%llu,%.6f\n", phases[phase],
+            (unsigned long long)total->phaseCalls[phase], total->phaseNanoseconds[phase] / 1e9
+        );
+    }
+    for (size_t metricId = 0; metrics[metricId] && metricId < METRICS_COUNT_MAX; metricId++) {
+        if (!(options.enabledMetrics & ((uint_fast64_t)1 << metricId))) continue;
+        fprintf(
+            output, "metric,%s,%llu,%.6f\n", metrics[metricId],
+            (unsigned long long)total->metricCalls[metricId], total->metricNanoseconds[metricId] / 1e9
+        );
+    }
+}
+
+static void writeJson(FILE* const output, uint64_t const wallNanoseconds) {
+    static char const* phases[]  = PROFILE_PHASES;
+    static char const* metrics[] = METRICS;
+
+    fprintf(output, "{\n  \"wall_seconds\": %.6f,\n  \"phases\": [", wallNanoseconds / 1e9);
+    for (unsigned phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+        fprintf(
+            output, "%s\n    { \"phase\": \"%s\", \"calls\": %llu, \"seconds\": %.6f }",
+            phase ? "," : "", phases[phase],
+            (unsigned long long)total->phaseCalls[phase], total->phaseNanoseconds[phase] / 1e9
+        );
+    }
+    fputs("\n  ],\n  \"metrics\": [", output);
+    bool isFirst = 1;
+    for (size_t metricId = 0; metrics[metricId] && metricId < METRICS_COUNT_MAX; metricId++) {
+        if (!(options.enabledMetrics & ((uint_fast64_t)1 << metricId))) continue;
+        fprintf(
+            output, "%s\n    { \"metric\": \"%s\", \"calls\": %llu, \"seconds\": %.6f }",
+            isFirst ? "" : ",", metrics[metricId],
+            (unsigned long long)total->metricCalls[metricId], total->metricNanoseconds[metricId] / 1e9
+        );
+        isFirst = 0;
+    }
+    fputs("\n  ]\n}\n", output);
+}
+
+/**
+ * @brief Writes the process total, called @ exit.
+ */
+static void report_profile(void) {
+    uint64_t const wallNanoseconds = now() - wallStart;
+
+    FILE* const output = options.profile_file ? fopen(options.profile_file, "w") : stderr;
+    if (output == NULL) {
+        fprintf(stderr, "\n"
+                        "Could NOT write the profile to '%s'\n"
+                        "\n", options.profile_file);
+        return;
+    }
+
+    pthread_mutex_lock(&totalMutex);
+    if (options.profile_file && endsWithCsv(options.profile_file))
+        writeCsv(output, wallNanoseconds);
+    else
+        writeJson(output, wallNanoseconds);
+    pthread_mutex_unlock(&totalMutex);
+
+    if (options.profile_file) fclose(output);
+}
+
+Profile* new_profile(void) {
+    if (!isProfiling()) return NULL;
+
+    Profile* const profile = calloc(1, sizeof(Profile));
+    DEBUG_ERROR_IF(profile == NULL)
+
+    return profile;
+}
+
+void free_profile(Profile* const profile) {
+    if (profile == NULL) return;
+    submit_profile(profile);
+    free(profile);
+}
+
+uint64_t start_profile(Profile const* const profile) {
+    return profile ? now() : 0;
+}
+
+void stop_profile(Profile* const profile, unsigned const phase, uint64_t const start) {
+    if (profile == NULL) return;
+    DEBUG_ERROR_IF(phase >= PROFILE_PHASE_COUNT)
+    profile->phaseNanoseconds[phase] += now() - start;
+    profile->phaseCalls[phase]++;
+}
+
+void stopMetric_profile(Profile* const profile, size_t const metricId, uint64_t const start) {
+    if (profile == NULL) return;
+    DEBUG_ERROR_IF(metricId >= METRICS_COUNT_MAX)
+    profile->metricNanoseconds[metricId] += now() - start;
+    profile->metricCalls[metricId]++;
+}
+
+void submit_profile(Profile* const profile) {
+    if (profile == NULL) return;
+
+    pthread_mutex_lock(&totalMutex);
+    for (unsigned phase = 0; phase < PROFILE_PHASE_COUNT; phase++) {
+        total->phaseNanoseconds[phase] += profile->phaseNanoseconds[phase];
+        total->phaseCalls[phase]       += profile->phaseCalls[phase];
+    }
+    for (size_t metricId = 0; metricId < METRICS_COUNT_MAX; metricId++) {
+        total->metricNanoseconds[metricId] += profile->metricNanoseconds[metricId];
+        total->metricCalls[metricId]       += profile->metricCalls[metricId];
+    }
+    pthread_mutex_unlock(&totalMutex);
+
+    memset(profile, 0, sizeof(Profile));
+}
+
+void enable_profile(void) {
+    wallStart = now();
+    DEBUG_ERROR_IF(atexit(report_profile) != 0)
+    NDEBUG_EXECUTE(atexit(report_profile))
+}
@@ -4,82 +4,121 @@
  * @author Yavuz Koroglu
  * @see report.h
  */
+#include <string.h>
+
 #include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/columnar.h"
 #include "srcmetrics/metrics.h"
+#include "srcmetrics/profile.h"
 #include "srcmetrics/report.h"
+#include "srcmetrics/result.h"
+#include "srcmetrics/writer.h"
 #include "padkit/chunk.h"
 #include "padkit/csv.h"
-#include "padkit/map.h"
+
+/**
+ * @brief Writes the rows added since the last call, opening the output first if necessary.
+ * @return 0 if the output cannot be opened, 1 otherwise.
+ */
+static bool reportRowsCsv(Analysis* const analysis) {
+    static Report      reports[]      = REPORTS;
+    Report*            report         = NULL;
+    ResultTable const* statistics     = NULL;
+    uint32_t*          reportedCount  = analysis->reportedRowCounts;
+    uint_fast64_t      enabledMetrics = analysis->enabledMetrics;
+    Writer* const      writer         = analysis->writer;
+
+    if (analysis->output == NULL) analysis->output = options.outfile ? fopen(options.outfile, isGzipping() ? "wb" : "w") : stdout;
+    if (analysis->output == NULL) return 0;
+    if (!isOpen_writer(writer) && !open_writer(writer, analysis->output, isGzipping())) return 0;
+
+    size_t const delimeter_len = strlen(csv_delimeter);
+    size_t const row_end_len   = strlen(csv_row_end);
+
+    for (report = reports; enabledMetrics; report++, reportedCount++, enabledMetrics >>= 1) {
+        if (report == NULL || *report == NULL || !(enabledMetrics & 1)) continue;
+        statistics = (*report)(analysis);
+        if (statistics == NULL || !isValid_rtable(statistics)) continue;
+        for (Result const* result = statistics->results + *reportedCount; result < statistics->results + statistics->size; result++) {
+            /* The name is formatted here, e.g., "ABC-A" + "_" + "unit.c::fn()" */
+            writeString_writer(writer, nameOf_result(result));
+            if (result->entity_id != RESULT_OVERALL) {
+                write_writer(writer, "_", 1);
+                write_writer(
+                    writer,
+                    get_chunk(analysis->strings, result->entity_id),
+                    (size_t)strlen_chunk(analysis->strings, result->entity_id)
+                );
+            }
+            write_writer(writer, csv_delimeter, delimeter_len);
+            writeValue_writer(writer, result->value);
+            write_writer(writer, csv_row_end, row_end_len);
+        }
+        *reportedCount = statistics->size;
+    }
+
+    return 1;
+}
 
 #ifndef NDEBUG
 bool
 #else
 void
 #endif
-reportCsv(void) {
-    static Report reports[]      = REPORTS;
-    Report*       report         = NULL;
-    Map const*    statistics     = NULL;
-    uint_fast64_t enabledMetrics = options.enabledMetrics;
-    FILE* const   output         = options.outfile ? fopen(options.outfile, "w") : stdout;
+reportCsv(Analysis* const analysis) {
+    uint64_t const start = start_profile(analysis->profile);
+    #ifndef NDEBUG
+        if (isColumnar()) {
+            if (!reportColumnar(analysis)) return 0;
+            stop_profile(analysis->profile, PROFILE_REPORT_CSV, start);
+            return 1;
+        }
+        if (!reportRowsCsv(analysis)) return 0;
+        if (!close_writer(analysis->writer)) return 0;
+        if (options.outfile && fclose(analysis->output) == EOF) return 0;
+        analysis->output = NULL;
+        stop_profile(analysis->profile, PROFILE_REPORT_CSV, start);
+        return 1;
+    #else
+        if (isColumnar()) {
+            reportColumnar(analysis);
+            stop_profile(analysis->profile, PROFILE_REPORT_CSV, start);
+            return;
+        }
+        if (reportRowsCsv(analysis)) close_writer(analysis->writer);
+        if (options.outfile && analysis->output != NULL) fclose(analysis->output);
+        analysis->output = NULL;
+        stop_profile(analysis->profile, PROFILE_REPORT_CSV, start);
+    #endif
+}
 
+#ifndef NDEBUG
+bool
+#else
+void
+#endif
+reportNewRowsCsv(Analysis* const analysis) {
+    /* A columnar report is written at once, see reportCsv() */
     #ifndef NDEBUG
-        if (output == NULL) return 0;
+        if (isColumnar()) return 1;
+    #else
+        if (isColumnar()) return;
     #endif
-    for (report = reports; enabledMetrics; report++, enabledMetrics >>= 1) {
-        if (report == NULL || *report == NULL || !(enabledMetrics & 1)) continue;
-        statistics = (*report)();
-        if (statistics == NULL && !isValid_map(statistics)) continue;
-        for (Mapping* mapping = statistics->mappings; mapping < statistics->mappings + statistics->size; mapping++) {
-            char const* key = get_chunk(strings, mapping->key_id);
-            #ifndef NDEBUG
-                if (key == NULL)                         return 0;
-                if (fputs(key, output) == EOF)           return 0;
-                if (fputs(csv_delimeter, output) == EOF) return 0;
-            #else
-                fputs(key, output);
-                fputs(csv_delimeter, output);
-            #endif
-            switch (mapping->value.type_code) {
-                case VAL_TC_FLOAT:
-                    #ifndef NDEBUG
-                        if (fprintf(output, VAL_F_FLOAT, (double)mapping->value.raw.as_float) < 0) return 0;
-                    #else
-                        fprintf(output, VAL_F_FLOAT, (double)mapping->value.raw.as_float);
-                    #endif
-                    break;
-                case VAL_TC_INT:
-                    #ifndef NDEBUG
-                        if (fprintf(output, VAL_F_INT, mapping->value.raw.as_int) < 0) return 0;
-                    #else
-                        fprintf(output, VAL_F_INT, mapping->value.raw.as_int);
-                    #endif
-                    break;
-                case VAL_TC_UNSIGNED:
-                    #ifndef NDEBUG
-                        if (fprintf(output, VAL_F_UNSIGNED, mapping->value.raw.as_unsigned) < 0) return 0;
-                    #else
-                        fprintf(output, VAL_F_UNSIGNED, mapping->value.raw.as_unsigned);
-                    #endif
-                    break;
-                default:
-                    #ifndef NDEBUG
-                        if (fputs("NOT_A_VALUE", output) == EOF) return 0;
-                    #else
-                        fputs("NOT_A_VALUE", output);
-                    #endif
-            }
-            #ifndef NDEBUG
-                if (fputs(csv_row_end, output) == EOF) return 0;
-            #else
-                fputs(csv_row_end, output);
-            #endif
-        }
-    }
+
+    uint64_t const start = start_profile(analysis->profile);
     #ifndef NDEBUG
-        if (options.outfile && fclose(output) == EOF) return 0;
-        return 1;
+        if (!reportRowsCsv(analysis)) return 0;
+        if (!flush_writer(analysis->writer)) return 0;
     #else
-        if (options.outfile) fclose(output);
+        if (reportRowsCsv(analysis)) flush_writer(analysis->writer);
+    #endif
+
+    /* The rows are written, so the next unit reuses their memory */
+    flushRows_analysis(analysis);
+
+    stop_profile(analysis->profile, PROFILE_REPORT_CSV, start);
+    #ifndef NDEBUG
+        return 1;
     #endif
 }
@@ -0,0 +1,86 @@
+/**
+ * @file result.c
+ * @brief Implements functions defined in result.h.
+ * @author Yavuz Koroglu
+ * @see result.h
+ */
+#include <stdlib.h>
+
+#include "srcmetrics/metrics.h"
+#include "srcmetrics/result.h"
+#include "srcmetrics/sizing.h"
+#include "padkit/debug.h"
+#include "padkit/reallocate.h"
+
+static char const* const submetrics[][SUBMETRICS_COUNT_MAX] = SUBMETRICS;
+
+bool constructEmpty_rtable(ResultTable* const table, uint32_t const initial_cap) {
+    DEBUG_ERROR_IF(table == NULL)
+    DEBUG_ERROR_IF(initial_cap == 0)
+
+    charge_sizing(0, (uint64_t)initial_cap * sizeof(Result));
+
+    table->cap     = initial_cap;
+    table->size    = 0;
+    table->results = malloc((size_t)initial_cap * sizeof(Result));
+
+    return table->results != NULL;
+}
+
+bool flush_rtable(ResultTable* const table) {
+    if (!isValid_rtable(table)) return 0;
+
+    table->size = 0;
+
+    return 1;
+}
+
+bool free_rtable(ResultTable* const table) {
+    if (!isValid_rtable(table)) return 0;
+
+    free(table->results);
+    charge_sizing((uint64_t)table->cap * sizeof(Result), 0);
+
+    *table = NOT_A_RESULT_TABLE;
+
+    return 1;
+}
+
+bool insert_rtable(
+    ResultTable* const  table,
+    uint32_t const      entity_id,
+    uint16_t const      metric_id,
+    uint16_t const      sub_id,
+    Value const         value
+) {
+    DEBUG_ASSERT(isValid_rtable(table))
+    DEBUG_ERROR_IF(metric_id >= sizeof(submetrics) / sizeof(submetrics[0]))
+    DEBUG_ERROR_IF(sub_id >= SUBMETRICS_COUNT_MAX)
+    DEBUG_ERROR_IF(submetrics[metric_id][sub_id] == NULL)
+
+    uint32_t const old_cap = table->cap;
+    REALLOC_IF_NECESSARY(
+        Result, table->results,
+        uint32_t, table->cap, table->size,
+        {return 0;}
+    )
+    if (table->cap != old_cap) charge_sizing((uint64_t)old_cap * sizeof(Result), (uint64_t)table->cap * sizeof(Result));
+
+    table->results[table->size++] = (Result){ entity_id, metric_id, sub_id, value };
+
+    return 1;
+}
+
+bool isValid_rtable(ResultTable const* const table) {
+    return table != NULL && table->results != NULL && table->size <= table->cap;
+}
+
+char const* nameOf_result(Result const* const result) {
+    DEBUG_ERROR_IF(result == NULL)
+    return submetrics[result->metric_id][result->sub_id];
+}
+
+char const* entityOf_result(Result const* const result, Chunk const* const strings) {
+    DEBUG_ERROR_IF(result == NULL)
+    return result->entity_id == RESULT_OVERALL ? NULL : get_chunk(strings, result->entity_id);
+}
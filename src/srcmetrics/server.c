@@ -0,0 +1,469 @@
+/**
+ * @file server.c
+ * @brief Implements functions defined in server.h.
+ * @author Yavuz Koroglu
+ * @see server.h
+ */
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "srcmetrics.h"
+#include "srcmetrics/analysis.h"
+#include "srcmetrics/parse.h"
+#include "srcmetrics/profile.h"
+#include "srcmetrics/report.h"
+#include "srcmetrics/server.h"
+#include "srcmetrics/sizing.h"
+#include "srcmetrics/writer.h"
+#include "padkit/chunk.h"
+#include "padkit/chunkset.h"
+#include "padkit/debug.h"
+#include "padkit/reallocate.h"
+#include "padkit/streq.h"
+
+/**
+ * @brief Finds the value of a key among the members of a JSON object, NOT the members of its values.
+ * @param json The object, or NULL.
+ * @return A pointer to the first character of the value, or NULL if the key is NOT found.
+ */
+static char const* findValue(char const* const json, char const* const key) {
+    if (json == NULL) return NULL;
+
+    char const* c = json;
+    while (isspace((unsigned char)*c)) c++;
+    if (*c != '{') return NULL;
+
+    size_t const key_len = strlen(key);
+    unsigned     depth   = 0;
+    for (; *c; c++) {
+        if (*c == '{' || *c == '[') {
+            depth++;
+            continue;
+        }
+        if (*c == '}' || *c == ']') {
+            if (--depth == 0) return NULL;
+            continue;
+        }
+        if (*c != '"') continue;
+
+        /* A string is skipped as a whole, so a brace or a quote in it does NOT count */
+        char const* const start = ++c;
+        while (*c && *c != '"') c += (*c == '\\' && c[1]) ? 2 : 1;
+        if (*c == '\0') return NULL;
+        if (depth != 1) continue;
+
+        /* Only a string followed by a colon is a key */
+        char const* value = c + 1;
+        while (isspace((unsigned char)*value)) value++;
+        if (*value != ':') continue;
+
+        if ((size_t)(c - start) != key_len || memcmp(start, key, key_len) != 0) continue;
+
+        for (value++; isspace((unsigned char)*value); value++);
+        return value;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Finds the end of a JSON string, a number, true, false, or null.
+ * @return A pointer past the last character of the value, or NULL if the value is NOT one of them.
+ */
+static char const* endOfScalar(char const* c) {
+    if (*c == '"') {
+        for (c++; *c && *c != '"'; c += (*c == '\\' && c[1]) ? 2 : 1);
+        return *c ? c + 1 : NULL;
+    }
+
+    char const* const start = c;
+    while (isalnum((unsigned char)*c) || *c == '-' || *c == '+' || *c == '.') c++;
+    return c > start ? c : NULL;
+}
+
+/**
+ * @brief Unescapes a JSON string value.
+ * @return A malloc'ed string the caller must free, or NULL if the value is NOT a string.
+ */
+static char* newUnescaped(char const* value) {
+    if (value == NULL || *value != '"') return NULL;
+
+    char const* const end = endOfScalar(value);
+    if (end == NULL) return NULL;
+
+    /* An escape sequence is never shorter than what it stands for */
+    char* const str = malloc((size_t)(end - value));
+    DEBUG_ERROR_IF(str == NULL)
+
+    char* out = str;
+    for (value++; value < end - 1; value++) {
+        if (*value != '\\') {
+            *out++ = *value;
+            continue;
+        }
+        switch (*++value) {
+            case 'b':  *out++ = '\b'; break;
+            case 'f':  *out++ = '\f'; break;
+            case 'n':  *out++ = '\n'; break;
+            case 'r':  *out++ = '\r'; break;
+            case 't':  *out++ = '\t'; break;
+            case 'u': {
+                char hex[5] = { 0 };
+                for (int i = 0; i < 4; i++) {
+                    if (!isxdigit((unsigned char)value[i + 1])) { free(str); return NULL; }
+                    hex[i] = value[i + 1];
+                }
+                value += 4;
+
+                unsigned long const code = strtoul(hex, NULL, 16);
+
+                /* UTF-8, a surrogate pair is NOT a valid path character anyway */
+                if (code < 0x80) {
+                    *out++ = (char)code;
+                } else if (code < 0x800) {
+                    *out++ = (char)(0xC0 | (code >> 6));
+                    *out++ = (char)(0x80 | (code & 0x3F));
+                } else {
+                    *out++ = (char)(0xE0 | (code >> 12));
+                    *out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+                    *out++ = (char)(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+            default:
+                *out++ = *value;
+        }
+    }
+    *out = '\0';
+
+    return str;
+}
+
+/**
+ * @brief Writes a string as a JSON string value.
+ */
+static void writeEscaped(FILE* const output, char const* const str, size_t const len) {
+    fputc('"', output);
+    for (char const* c = str; c < str + len; c++) {
+        switch (*c) {
+            case '"':  fputs("\\\"", output); break;
+            case '\\': fputs("\\\\", output); break;
+            case '\n': fputs("\\n", output);  break;
+            case '\r': fputs("\\r", output);  break;
+            case '\t': fputs("\\t", output);  break;
+            default:
+                if ((unsigned char)*c < 0x20)
+                    fprintf(output, "\\u%04x", (unsigned)(unsigned char)*c);
+                else
+                    fputc(*c, output);
+        }
+    }
+    fputc('"', output);
+}
+
+/**
+ * @brief Writes the beginning of a response, up to the result or the error.
+ */
+static void startResponse(FILE* const output, char const* const id, size_t const id_len) {
+    fputs("{\"jsonrpc\":\"2.0\",\"id\":", output);
+    if (id == NULL)
+        fputs("null", output);
+    else
+        fwrite(id, 1, id_len, output);
+}
+
+/**
+ * @brief Writes an error response.
+ */
+static void respondError(
+    FILE* const         output,
+    char const* const   id,
+    size_t const        id_len,
+    int const           code,
+    char const* const   message
+) {
+    startResponse(output, id, id_len);
+    fprintf(output, ",\"error\":{\"code\":%d,\"message\":", code);
+    writeEscaped(output, message, strlen(message));
+    fputs("}}\n", output);
+    fflush(output);
+}
+
+/**
+ * @brief Writes a response whose result is a JSON literal, e.g., true.
+ */
+static void respondLiteral(FILE* const output, char const* const id, size_t const id_len, char const* const result) {
+    startResponse(output, id, id_len);
+    fprintf(output, ",\"result\":%s}\n", result);
+    fflush(output);
+}
+
+/**
+ * @brief Reads the next line of the input, growing the line buffer if necessary.
+ * @return 0 at the end of the input, 1 otherwise.
+ */
+static bool readLine(FILE* const input, char** const line, size_t* const cap) {
+    size_t len = 0;
+    while (fgets(*line + len, (int)(*cap - len), input) != NULL) {
+        len += strlen(*line + len);
+        if (len > 0 && (*line)[len - 1] == '\n') return 1;
+
+        *cap <<= 1;
+        *line  = realloc(*line, *cap);
+        DEBUG_ERROR_IF(*line == NULL)
+    }
+    return len > 0;
+}
+
+/**
+ * @brief Finds the tracked unit of a source file.
+ * @return A pointer to the ServerUnit, or NULL if the file is NOT tracked.
+ */
+static ServerUnit* findUnit(Server* const server, char const* const infile) {
+    uint32_t const infile_id = getKeyId_cset(server->infiles, infile, strlen(infile));
+    if (infile_id == 0xFFFFFFFF) return NULL;
+
+    for (ServerUnit* unit = server->units; unit < server->units + server->n_units; unit++)
+        if (unit->infile_id == infile_id) return unit;
+
+    return NULL;
+}
+
+void constructEmpty_server(Server* const server) {
+    DEBUG_ERROR_IF(server == NULL)
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_cset(server->infiles, CHUNK_SET_RECOMMENDED_PARAMETERS))
+    constructEmpty_source(server->source);
+
+    server->n_units   = 0;
+    server->cap_units = SERVER_RECOMMENDED_INITIAL_CAP;
+    server->units     = malloc(server->cap_units * sizeof(ServerUnit));
+    DEBUG_ERROR_IF(server->units == NULL)
+
+    /* The archive is never written, it only provides the unit defaults */
+    server->archive = srcml_archive_create();
+    DEBUG_ERROR_IF(server->archive == NULL)
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_chunk(server->report, CHUNK_RECOMMENDED_INITIAL_CAP, 1))
+
+    server->profile       = new_profile();
+    server->isReportStale = 1;
+    server->isShutdown    = 0;
+}
+
+void free_server(Server* const server) {
+    DEBUG_ASSERT(isValid_server(server))
+
+    for (ServerUnit* unit = server->units; unit < server->units + server->n_units; unit++) {
+        free_analysis(unit->partial);
+        free(unit->partial);
+    }
+    free(server->units);
+
+    srcml_archive_free(server->archive);
+    free_profile(server->profile);
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_chunk(server->report))
+
+    free_source(server->source);
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_cset(server->infiles))
+
+    server->units   = NULL;
+    server->archive = NULL;
+    server->profile = NULL;
+    server->n_units = 0;
+}
+
+bool isValid_server(Server const* const server) {
+    return server != NULL && server->units != NULL && server->archive != NULL && isValid_source(server->source);
+}
+
+bool update_server(Server* const server, char const* const infile) {
+    DEBUG_ASSERT(isValid_server(server))
+    DEBUG_ERROR_IF(infile == NULL)
+
+    ServerUnit* unit  = findUnit(server, infile);
+    bool const  isNew = unit == NULL;
+    if (isNew) {
+        REALLOC_IF_NECESSARY(
+            ServerUnit, server->units,
+            size_t, server->cap_units, server->n_units,
+            {REALLOC_ERROR;}
+        )
+        unit = server->units + server->n_units++;
+
+        unit->infile_id = addKey_cset(server->infiles, infile, strlen(infile));
+        DEBUG_ERROR_IF(unit->infile_id == 0xFFFFFFFF)
+
+        unit->partial = malloc(sizeof(Analysis));
+        DEBUG_ERROR_IF(unit->partial == NULL)
+        constructEmptyPartial_analysis(unit->partial, options.enabledMetrics);
+
+        VERBOSE_MSG_VARIADIC("SERVER_TRACK => %s", infile);
+    }
+
+    /* Forgets the previous version of the unit, unless the file is gone, which keeps it */
+    bool const isDone = evaluateUnit_ppool(server->archive, infile, server->source, server->profile, unit->partial);
+    if (isDone) unit->len = server->source->len;
+    release_source(server->source);
+
+    if (!isDone) {
+        /* A file that was never evaluated is NOT tracked */
+        if (isNew) {
+            free_analysis(unit->partial);
+            free(unit->partial);
+            server->n_units--;
+        }
+        VERBOSE_MSG_VARIADIC("SERVER_FILE_NOT_FOUND => %s", infile);
+        return 0;
+    }
+
+    /* Only the rows wait for the report */
+    trim_analysis(unit->partial);
+    server->isReportStale = 1;
+
+    VERBOSE_MSG_VARIADIC("SERVER_UPDATED => %s", infile);
+    return 1;
+}
+
+bool remove_server(Server* const server, char const* const infile) {
+    DEBUG_ASSERT(isValid_server(server))
+    DEBUG_ERROR_IF(infile == NULL)
+
+    ServerUnit* const unit = findUnit(server, infile);
+    if (unit == NULL) return 0;
+
+    free_analysis(unit->partial);
+    free(unit->partial);
+
+    /* Keep the order of the rest */
+    memmove(unit, unit + 1, (size_t)(server->units + --server->n_units - unit) * sizeof(ServerUnit));
+    server->isReportStale = 1;
+
+    VERBOSE_MSG_VARIADIC("SERVER_REMOVED => %s", infile);
+    return 1;
+}
+
+bool report_server(Server* const server, FILE* const output) {
+    DEBUG_ASSERT(isValid_server(server))
+    DEBUG_ERROR_IF(output == NULL)
+
+    /* The tables fit the tracked files, and the next update sizes its own unit again */
+    uint64_t bytes = 0;
+    for (ServerUnit const* unit = server->units; unit < server->units + server->n_units; unit++)
+        bytes += unit->len;
+    prepare_sizing(bytes, server->n_units);
+
+    Analysis analysis[1];
+    constructEmpty_analysis(analysis, options.enabledMetrics);
+
+    startStream_analysis(analysis);
+
+    /* Merging from the last tracked file gives the rows of the serial loop */
+    for (ServerUnit* unit = server->units + server->n_units - 1; unit >= server->units; unit--)
+        merge_analysis(analysis, unit->partial);
+
+    endStream_analysis(analysis);
+
+    analysis->output = output;
+    DEBUG_ASSERT_NDEBUG_EXECUTE(reportNewRowsCsv(analysis))
+    analysis->output = NULL;
+
+    /* The rows bypass the buffer of the output, see writer.h */
+    bool const isWritten = isOpen_writer(analysis->writer) && close_writer(analysis->writer);
+
+    free_analysis(analysis);
+
+    return isWritten && !ferror(output);
+}
+
+/**
+ * @brief Merges the report again if a file changed since the last one.
+ * @return 0 if the report cannot be written, 1 otherwise.
+ */
+static bool refreshReport(Server* const server) {
+    if (!server->isReportStale) return 1;
+
+    VERBOSE_MSG_LITERAL("SERVER_REPORT_MERGED");
+
+    /* The report goes to a temporary file first, so it becomes one JSON string */
+    FILE* const tmp = tmpfile();
+    if (tmp == NULL) return 0;
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(server->report))
+    server->isReportStale = !report_server(server, tmp)
+        || fseek(tmp, 0, SEEK_SET) != 0
+        || fromStreamAsWhole_chunk(server->report, tmp) == 0xFFFFFFFF;
+
+    fclose(tmp);
+    return !server->isReportStale;
+}
+
+void serve_server(Server* const server, FILE* const input, FILE* const output) {
+    DEBUG_ASSERT(isValid_server(server))
+    DEBUG_ERROR_IF(input == NULL)
+    DEBUG_ERROR_IF(output == NULL)
+
+    size_t cap  = BUFSIZ;
+    char*  line = malloc(cap);
+    DEBUG_ERROR_IF(line == NULL)
+
+    VERBOSE_MSG_LITERAL("SERVER_STARTED");
+
+    while (!server->isShutdown && readLine(input, &line, &cap)) {
+        char const* c = line;
+        while (isspace((unsigned char)*c)) c++;
+        if (*c == '\0') continue;
+
+        /* The id is echoed back as it is, and a notification has none */
+        char const* const id     = findValue(line, "id");
+        char const* const id_end = id ? endOfScalar(id) : NULL;
+        size_t const      id_len = id_end ? (size_t)(id_end - id) : 0;
+        bool const        isNote = id_end == NULL;
+
+        if (*c != '{') {
+            respondError(output, NULL, 0, SERVER_ERROR_PARSE, "Parse error");
+            continue;
+        }
+
+        char* const method = newUnescaped(findValue(line, "method"));
+        if (method == NULL) {
+            if (!isNote) respondError(output, id, id_len, SERVER_ERROR_INVALID_REQUEST, "Invalid Request");
+            continue;
+        }
+
+        VERBOSE_MSG_VARIADIC("SERVER_REQUEST => %s", method);
+
+        if (STR_EQ_CONST(method, "didChange") || STR_EQ_CONST(method, "didDelete")) {
+            char* const infile = newUnescaped(findValue(findValue(line, "params"), "file"));
+            if (infile == NULL) {
+                if (!isNote) respondError(output, id, id_len, SERVER_ERROR_INVALID_PARAMS, "Invalid params, expected {\"file\": FILE}");
+            } else if (STR_EQ_CONST(method, "didChange") ? update_server(server, infile) : remove_server(server, infile)) {
+                if (!isNote) respondLiteral(output, id, id_len, "true");
+            } else {
+                if (!isNote) respondError(output, id, id_len, SERVER_ERROR_FILE_NOT_FOUND, "File NOT found");
+            }
+            free(infile);
+        } else if (STR_EQ_CONST(method, "report")) {
+            if (!refreshReport(server)) {
+                if (!isNote) respondError(output, id, id_len, SERVER_ERROR_INTERNAL, "Could NOT write the report");
+            } else if (!isNote) {
+                startResponse(output, id, id_len);
+                fputs(",\"result\":", output);
+                writeEscaped(output, server->report->start, server->report->len);
+                fputs("}\n", output);
+                fflush(output);
+            }
+        } else if (STR_EQ_CONST(method, "shutdown")) {
+            server->isShutdown = 1;
+            if (!isNote) respondLiteral(output, id, id_len, "null");
+        } else {
+            if (!isNote) respondError(output, id, id_len, SERVER_ERROR_METHOD_NOT_FOUND, "Method not found");
+        }
+
+        free(method);
+    }
+
+    VERBOSE_MSG_LITERAL("SERVER_STOPPED");
+
+    free(line);
+}
@@ -0,0 +1,98 @@
+/**
+ * @file sizing.c
+ * @brief Implements functions defined in sizing.h.
+ * @author Yavuz Koroglu
+ * @see sizing.h
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "languages/c.h"
+#include "srcmetrics.h"
+#include "srcmetrics/sizing.h"
+
+/* The Sizing before prepare_sizing() */
+#define SIZING_GUESSES                          \
+    {                                           \
+        UNIT_COUNT_GUESS,                       \
+        FN_COUNT_GUESS,                         \
+        UNIT_COUNT_GUESS + FN_COUNT_GUESS,      \
+        CPARSE_RECOMMENDED_CHUNK_ITEM_COUNT,    \
+        CPARSE_RECOMMENDED_CHUNK_SIZE           \
+    }
+
+static Sizing overall[1] = { SIZING_GUESSES };
+static Sizing unit[1]    = { SIZING_GUESSES };
+
+/* The bytes of the tables that charge_sizing() knows, across the threads */
+static uint64_t        charged      = 0;
+static pthread_mutex_t chargedMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Clamps a count between a minimum and a maximum.
+ */
+static uint32_t clamp(uint64_t const count, uint32_t const min, uint32_t const max) {
+    if (count < min) return min;
+    if (count > max) return max;
+    return (uint32_t)count;
+}
+
+/**
+ * @brief Guesses the capacities for some bytes of source code in some units.
+ */
+static void guess(Sizing* const sizing, uint64_t const bytes, uint64_t const n_units) {
+    sizing->unit_count  = clamp(n_units, SIZING_COUNT_MIN, UNIT_COUNT_GUESS);
+    sizing->fn_count    = clamp(bytes / SIZING_BYTES_PER_FN, SIZING_COUNT_MIN, FN_COUNT_GUESS);
+    sizing->entry_count = sizing->unit_count + sizing->fn_count;
+    sizing->stmt_count  = clamp(bytes / SIZING_BYTES_PER_STMT, SIZING_COUNT_MIN, CPARSE_RECOMMENDED_CHUNK_ITEM_COUNT);
+
+    /* The statements keep about half of the text, the comments and the blanks go away */
+    sizing->text_len    = clamp(bytes / 2, BUFSIZ, CPARSE_RECOMMENDED_CHUNK_SIZE);
+}
+
+void charge_sizing(uint64_t const old_bytes, uint64_t const new_bytes) {
+    if (options.memory_budget == 0) return;
+
+    pthread_mutex_lock(&chargedMutex);
+    uint64_t const total = charged - old_bytes + new_bytes;
+    if (new_bytes > old_bytes && total > options.memory_budget) {
+        pthread_mutex_unlock(&chargedMutex);
+        fprintf(stderr, "\n"
+                        "The metrics need more than the memory budget of %llu bytes, see '--memory-budget'\n"
+                        "\n", (unsigned long long)options.memory_budget);
+        exit(EXIT_FAILURE);
+    }
+    charged = total;
+    pthread_mutex_unlock(&chargedMutex);
+}
+
+Sizing const* get_sizing(bool const isPartial) {
+    return isPartial ? unit : overall;
+}
+
+void prepareUnit_sizing(uint64_t const unit_bytes) {
+    uint64_t const bytes = options.memory_budget > 0 && unit_bytes > options.memory_budget
+        ? options.memory_budget
+        : unit_bytes;
+
+    guess(unit, bytes, 1);
+}
+
+void prepare_sizing(uint64_t const input_bytes, size_t const n_infiles) {
+    if (n_infiles == 0) return;
+
+    uint64_t const bytes = options.memory_budget > 0 && input_bytes > options.memory_budget
+        ? options.memory_budget
+        : input_bytes;
+
+    guess(overall, bytes, n_infiles);
+
+    /* A partial Analysis evaluates one unit at a time, an average one to begin with */
+    guess(unit, bytes / n_infiles, 1);
+
+    VERBOSE_MSG_VARIADIC(
+        "SIZING => %llu bytes, %u units, %u functions, %u statements",
+        (unsigned long long)bytes, overall->unit_count, overall->fn_count, overall->stmt_count
+    );
+}
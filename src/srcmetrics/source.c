@@ -0,0 +1,181 @@
+/**
+ * @file source.c
+ * @brief Implements functions defined in source.h.
+ * @author Yavuz Koroglu
+ * @see source.h
+ */
+#include <stdio.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+#include "srcmetrics.h"
+#include "srcmetrics/source.h"
+#include "srcmetrics/walk.h"
+#include "padkit/debug.h"
+
+/**
+ * @brief Maps a byte range of a file read-only, e.g., a whole file or a tar member.
+ * @return 0 if the range cannot be mapped, 1 otherwise.
+ */
+static bool mapFile(Source* const source, FILE* const stream, uint64_t const offset, size_t const len) {
+    #ifdef _WIN32
+        (void)source;
+        (void)stream;
+        (void)offset;
+        (void)len;
+        return 0;
+    #else
+        /* A mapping starts at a page boundary */
+        uint64_t const page_size = (uint64_t)sysconf(_SC_PAGESIZE);
+        size_t const   skip      = (size_t)(offset % page_size);
+
+        void* const map = mmap(NULL, skip + len, PROT_READ, MAP_PRIVATE, fileno(stream), (off_t)(offset - skip));
+        if (map == MAP_FAILED) return 0;
+
+        /* The parser reads the file once from the start to the end */
+        #ifdef MADV_SEQUENTIAL
+            madvise(map, skip + len, MADV_SEQUENTIAL);
+        #endif
+
+        source->map     = map;
+        source->map_len = skip + len;
+        source->start   = (char const*)map + skip;
+        source->len     = len;
+        return 1;
+    #endif
+}
+
+/**
+ * @brief Reads a tar member into the buffer.
+ * @return 0 if the archive ends before the member does, 1 otherwise.
+ */
+static bool readMember(Source* const source, FILE* const stream, TarMember const* const member) {
+    char     piece[BUFSIZ];
+    uint64_t len       = member->len;
+    uint64_t piece_len = len < BUFSIZ ? len : BUFSIZ;
+
+    if (fseeko(stream, (off_t)member->offset, SEEK_SET) != 0)   return 0;
+    if (fread(piece, 1, piece_len, stream) != piece_len)        return 0;
+
+    uint32_t const str_id = add_chunk(source->buffer, piece, piece_len);
+    DEBUG_ERROR_IF(str_id == 0xFFFFFFFF)
+
+    for (len -= piece_len; len > 0; len -= piece_len) {
+        piece_len = len < BUFSIZ ? len : BUFSIZ;
+        if (fread(piece, 1, piece_len, stream) != piece_len) return 0;
+        DEBUG_ERROR_IF(append_chunk(source->buffer, piece, piece_len) == NULL)
+        NDEBUG_EXECUTE(append_chunk(source->buffer, piece, piece_len))
+    }
+
+    source->start = get_chunk(source->buffer, str_id);
+    source->len   = member->len;
+    return 1;
+}
+
+void constructEmpty_source(Source* const source) {
+    DEBUG_ERROR_IF(source == NULL)
+
+    source->start   = NULL;
+    source->len     = 0;
+    source->map     = NULL;
+    source->map_len = 0;
+    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_chunk(source->buffer, CHUNK_RECOMMENDED_INITIAL_CAP, 1))
+}
+
+void free_source(Source* const source) {
+    DEBUG_ASSERT(isValid_source(source))
+
+    release_source(source);
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_chunk(source->buffer))
+}
+
+bool exists_source(char const* const infile) {
+    DEBUG_ERROR_IF(infile == NULL)
+
+    char const* archive;
+    TarMember   member;
+    if (findMember_walk(infile, &archive, &member)) return 1;
+
+    FILE* const stream = fopen(infile, "r");
+    if (stream == NULL) return 0;
+
+    DEBUG_ERROR_IF(fclose(stream) == EOF)
+    NDEBUG_EXECUTE(fclose(stream))
+
+    return 1;
+}
+
+bool isValid_source(Source const* const source) {
+    return source != NULL && isValid_chunk(source->buffer) && (source->map == NULL || source->start >= (char const*)source->map);
+}
+
+bool read_source(Source* const source, char const* const infile) {
+    DEBUG_ASSERT(isValid_source(source))
+    DEBUG_ERROR_IF(source->start != NULL)
+    DEBUG_ERROR_IF(infile == NULL)
+
+    /* A server reads the files while they are edited, and a truncated mapping raises SIGBUS */
+    bool const canMap = !isServing();
+
+    /* A tar member is a byte range of its archive, see walk.h */
+    char const* archive;
+    TarMember   member;
+    if (findMember_walk(infile, &archive, &member)) {
+        FILE* const stream = fopen(archive, "rb");
+        if (stream == NULL) return 0;
+
+        bool const isRead = (canMap && member.len >= SOURCE_MMAP_THRESHOLD && mapFile(source, stream, member.offset, (size_t)member.len))
+            || readMember(source, stream, &member);
+
+        DEBUG_ERROR_IF(fclose(stream) == EOF)
+        NDEBUG_EXECUTE(fclose(stream))
+
+        return isRead;
+    }
+
+    FILE* const stream = fopen(infile, "r");
+    if (stream == NULL) return 0;
+
+    /* The mapping outlives the stream */
+    struct stat status;
+    bool const isMapped = canMap
+        && fstat(fileno(stream), &status) == 0
+        && S_ISREG(status.st_mode)
+        && status.st_size >= SOURCE_MMAP_THRESHOLD
+        && mapFile(source, stream, 0, (size_t)status.st_size);
+
+    if (isMapped) {
+        VERBOSE_MSG_VARIADIC("SOURCE_MAPPED => %s", infile);
+    } else {
+        DEBUG_ERROR_IF(fromStreamAsWhole_chunk(source->buffer, stream) == 0xFFFFFFFF)
+        NDEBUG_EXECUTE(fromStreamAsWhole_chunk(source->buffer, stream))
+
+        source->start = source->buffer->start;
+        source->len   = source->buffer->len;
+    }
+
+    DEBUG_ERROR_IF(fclose(stream) == EOF)
+    NDEBUG_EXECUTE(fclose(stream))
+
+    return 1;
+}
+
+void release_source(Source* const source) {
+    DEBUG_ASSERT(isValid_source(source))
+
+    #ifndef _WIN32
+        if (source->map != NULL) {
+            DEBUG_ERROR_IF(munmap(source->map, source->map_len) != 0)
+            NDEBUG_EXECUTE(munmap(source->map, source->map_len))
+        }
+    #endif
+
+    source->start   = NULL;
+    source->len     = 0;
+    source->map     = NULL;
+    source->map_len = 0;
+    DEBUG_ASSERT_NDEBUG_EXECUTE(flush_chunk(source->buffer))
+}
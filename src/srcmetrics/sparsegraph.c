@@ -0,0 +1,199 @@
+/**
+ * @file sparsegraph.c
+ * @brief Implements functions defined in sparsegraph.h.
+ * @author Yavuz Koroglu
+ * @see sparsegraph.h
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "srcmetrics/sparsegraph.h"
+#include "padkit/debug.h"
+#include "padkit/reallocate.h"
+
+/**
+ * @brief Finds the position of a sink in a sorted sink list.
+ * @return The index of the sink, or of the first greater sink if it is NOT in the list.
+ */
+static uint32_t lowerBound(SparseVertex const* const vertex, uint32_t const sink) {
+    uint32_t low  = 0;
+    uint32_t high = vertex->degree;
+    while (low < high) {
+        uint32_t const mid = low + (high - low) / 2;
+        if (vertex->sinks[mid] < sink)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+bool connect_sgraph(SparseGraph* const graph, uint32_t const source, uint32_t const sink) {
+    DEBUG_ASSERT(isValid_sgraph(graph))
+    DEBUG_ERROR_IF(source == 0xFFFFFFFF)
+    DEBUG_ERROR_IF(sink == 0xFFFFFFFF)
+
+    if (source >= graph->vertex_cap) {
+        uint32_t new_cap = graph->vertex_cap;
+        while (new_cap <= source) new_cap <<= 1;
+
+        SparseVertex* const new_vertices = realloc(graph->vertices, (size_t)new_cap * sizeof(SparseVertex));
+        if (new_vertices == NULL) return 0;
+
+        memset(new_vertices + graph->vertex_cap, 0, (size_t)(new_cap - graph->vertex_cap) * sizeof(SparseVertex));
+        graph->vertices   = new_vertices;
+        graph->vertex_cap = new_cap;
+    }
+    if (source >= graph->vertex_count) graph->vertex_count = source + 1;
+
+    SparseVertex* const vertex = graph->vertices + source;
+    uint32_t const      pos    = lowerBound(vertex, sink);
+    if (pos < vertex->degree && vertex->sinks[pos] == sink) return 1;
+
+    if (vertex->sinks == NULL) {
+        vertex->cap   = SPARSE_GRAPH_RECOMMENDED_INITIAL_DEGREE_CAP;
+        vertex->sinks = malloc((size_t)vertex->cap * sizeof(uint32_t));
+        if (vertex->sinks == NULL) return 0;
+    }
+    REALLOC_IF_NECESSARY(
+        uint32_t, vertex->sinks,
+        uint32_t, vertex->cap, vertex->degree,
+        {return 0;}
+    )
+
+    memmove(vertex->sinks + pos + 1, vertex->sinks + pos, (size_t)(vertex->degree - pos) * sizeof(uint32_t));
+    vertex->sinks[pos] = sink;
+    vertex->degree++;
+
+    return 1;
+}
+
+uint32_t condense_sgraph(SparseGraph const* const graph, uint32_t const vertex_count, uint32_t* const component) {
+    DEBUG_ASSERT(isValid_sgraph(graph))
+    DEBUG_ERROR_IF(component == NULL && vertex_count > 0)
+
+    if (vertex_count == 0) return 0;
+
+    uint32_t* const index     = malloc((size_t)vertex_count * sizeof(uint32_t));
+    uint32_t* const low       = malloc((size_t)vertex_count * sizeof(uint32_t));
+    uint32_t* const stack     = malloc((size_t)vertex_count * sizeof(uint32_t));
+    uint32_t* const frame_v   = malloc((size_t)vertex_count * sizeof(uint32_t));
+    uint32_t* const frame_pos = malloc((size_t)vertex_count * sizeof(uint32_t));
+    DEBUG_ERROR_IF(index == NULL || low == NULL || stack == NULL || frame_v == NULL || frame_pos == NULL)
+
+    /* A vertex is on the stack iff it has an index but no component yet */
+    for (uint32_t v = 0; v < vertex_count; v++) {
+        index[v]     = 0xFFFFFFFF;
+        component[v] = 0xFFFFFFFF;
+    }
+
+    uint32_t next_index      = 0;
+    uint32_t component_count = 0;
+    uint32_t stack_size      = 0;
+    for (uint32_t root = 0; root < vertex_count; root++) {
+        if (index[root] != 0xFFFFFFFF) continue;
+
+        uint32_t depth = 0;
+        index[root]         = low[root] = next_index++;
+        stack[stack_size++] = root;
+        frame_v[depth]      = root;
+        frame_pos[depth++]  = 0;
+
+        while (depth > 0) {
+            uint32_t const v = frame_v[depth - 1];
+            if (frame_pos[depth - 1] < outDegree_sgraph(graph, v)) {
+                uint32_t const w = sinks_sgraph(graph, v)[frame_pos[depth - 1]++];
+                DEBUG_ERROR_IF(w >= vertex_count)
+
+                if (index[w] == 0xFFFFFFFF) {
+                    index[w]            = low[w] = next_index++;
+                    stack[stack_size++] = w;
+                    frame_v[depth]      = w;
+                    frame_pos[depth++]  = 0;
+                } else if (component[w] == 0xFFFFFFFF && index[w] < low[v]) {
+                    low[v] = index[w];
+                }
+                continue;
+            }
+
+            /* v is the root of a component, pop it */
+            if (low[v] == index[v]) {
+                uint32_t w;
+                do {
+                    w            = stack[--stack_size];
+                    component[w] = component_count;
+                } while (w != v);
+                component_count++;
+            }
+
+            depth--;
+            if (depth > 0 && low[v] < low[frame_v[depth - 1]]) low[frame_v[depth - 1]] = low[v];
+        }
+    }
+
+    free(frame_pos);
+    free(frame_v);
+    free(stack);
+    free(low);
+    free(index);
+
+    return component_count;
+}
+
+bool constructEmpty_sgraph(SparseGraph* const graph, uint32_t const vertex_cap) {
+    DEBUG_ERROR_IF(graph == NULL)
+    DEBUG_ERROR_IF(vertex_cap == 0)
+
+    graph->vertex_count = 0;
+    graph->vertex_cap   = vertex_cap;
+    graph->vertices     = calloc(vertex_cap, sizeof(SparseVertex));
+
+    return graph->vertices != NULL;
+}
+
+bool disconnectAll_sgraph(SparseGraph* const graph) {
+    if (!isValid_sgraph(graph)) return 0;
+
+    for (SparseVertex* vertex = graph->vertices; vertex < graph->vertices + graph->vertex_count; vertex++)
+        vertex->degree = 0;
+    graph->vertex_count = 0;
+
+    return 1;
+}
+
+bool free_sgraph(SparseGraph* const graph) {
+    if (!isValid_sgraph(graph)) return 0;
+
+    /* Flushed vertices keep their sink lists, so free up to the capacity */
+    for (SparseVertex* vertex = graph->vertices; vertex < graph->vertices + graph->vertex_cap; vertex++)
+        free(vertex->sinks);
+    free(graph->vertices);
+
+    *graph = NOT_A_SPARSE_GRAPH;
+
+    return 1;
+}
+
+bool isConnected_sgraph(SparseGraph const* const graph, uint32_t const source, uint32_t const sink) {
+    DEBUG_ASSERT(isValid_sgraph(graph))
+
+    if (source >= graph->vertex_count) return 0;
+
+    SparseVertex const* const vertex = graph->vertices + source;
+    uint32_t const            pos    = lowerBound(vertex, sink);
+    return pos < vertex->degree && vertex->sinks[pos] == sink;
+}
+
+bool isValid_sgraph(SparseGraph const* const graph) {
+    return graph != NULL && graph->vertices != NULL && graph->vertex_count <= graph->vertex_cap;
+}
+
+uint32_t outDegree_sgraph(SparseGraph const* const graph, uint32_t const source) {
+    DEBUG_ASSERT(isValid_sgraph(graph))
+    return source < graph->vertex_count ? graph->vertices[source].degree : 0;
+}
+
+uint32_t const* sinks_sgraph(SparseGraph const* const graph, uint32_t const source) {
+    DEBUG_ASSERT(isValid_sgraph(graph))
+    return source < graph->vertex_count && graph->vertices[source].degree > 0 ? graph->vertices[source].sinks : NULL;
+}
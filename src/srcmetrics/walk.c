@@ -0,0 +1,516 @@
+/**
+ * @file walk.c
+ * @brief Implements functions defined in walk.h.
+ * @author Yavuz Koroglu
+ * @see walk.h
+ */
+#include <dirent.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "srcmetrics.h"
+#include "srcmetrics/walk.h"
+#include "padkit/chunk.h"
+#include "padkit/chunkset.h"
+#include "padkit/debug.h"
+#include "padkit/reallocate.h"
+#include "padkit/streq.h"
+
+#define WALK_KIND_FILE          0
+#define WALK_KIND_DIRECTORY     1
+#define WALK_KIND_TAR           2
+
+#define WALK_PATTERNS_INITIAL_CAP   8
+
+/**
+ * @struct ClassifyJob
+ * @brief Every n_jobs'th infile, starting from the first one, for one classifier thread.
+ */
+typedef struct ClassifyJobBody {
+    char const* const*  infiles;
+    size_t              n_infiles;
+    unsigned char*      kinds;
+    uint64_t*           lens;
+    size_t              first;
+    size_t              stride;
+    pthread_t           thread;
+} ClassifyJob;
+
+static char const** patterns[2]     = { NULL, NULL };
+static size_t       n_patterns[2]   = { 0, 0 };
+static size_t       cap_patterns[2] = { 0, 0 };
+
+static Chunk        names[1]        = { NOT_A_CHUNK };
+static Chunk        archives[1]     = { NOT_A_CHUNK };
+static ChunkSet     members[1]      = { NOT_A_CHUNK_SET };
+static TarMember*   tar_members     = NULL;
+static uint32_t     cap_tar_members = 0;
+static uint64_t     input_bytes     = 0;
+
+static bool endsWith(char const* const str, char const* const suffix) {
+    size_t const len        = strlen(str);
+    size_t const suffix_len = strlen(suffix);
+    return len >= suffix_len && strcmp(str + len - suffix_len, suffix) == 0;
+}
+
+static bool matchesAny(char const* const* const globs, size_t const n_globs, char const* const path) {
+    char const* const slash    = strrchr(path, '/');
+    char const* const basename = slash == NULL ? path : slash + 1;
+
+    for (char const* const* glob = globs; glob < globs + n_globs; glob++)
+        if (fnmatch(*glob, strchr(*glob, '/') == NULL ? basename : path, 0) == 0) return 1;
+
+    return 0;
+}
+
+static bool isExcludedPath(char const* const path) {
+    return matchesAny(patterns[1], n_patterns[1], path);
+}
+
+static bool isIncludedPath(char const* const path) {
+    static char const* const defaults[] = WALK_DEFAULT_INCLUDES;
+
+    if (n_patterns[0] == 0) return matchesAny(defaults, sizeof(defaults) / sizeof(defaults[0]), path);
+    return matchesAny(patterns[0], n_patterns[0], path);
+}
+
+static void* classify(void* const arg) {
+    ClassifyJob* const job = (ClassifyJob*)arg;
+
+    for (size_t infile_id = job->first; infile_id < job->n_infiles; infile_id += job->stride) {
+        char const* const infile = job->infiles[infile_id];
+        struct stat       status;
+
+        /* A missing infile stays a file, reading it reports the error */
+        job->kinds[infile_id] = WALK_KIND_FILE;
+        job->lens[infile_id]  = 0;
+        if (stat(infile, &status) != 0) continue;
+
+        if (S_ISDIR(status.st_mode))
+            job->kinds[infile_id] = WALK_KIND_DIRECTORY;
+        else if (S_ISREG(status.st_mode) && endsWith(infile, WALK_TAR_EXTENSION))
+            job->kinds[infile_id] = WALK_KIND_TAR;
+        else if (S_ISREG(status.st_mode))
+            job->lens[infile_id] = (uint64_t)status.st_size;
+    }
+
+    return NULL;
+}
+
+static void addName(char const* const name, uint64_t const len) {
+    DEBUG_ERROR_IF(add_chunk(names, name, len) == 0xFFFFFFFF)
+    NDEBUG_EXECUTE(add_chunk(names, name, len))
+}
+
+/**
+ * @brief Joins a directory and an entry into a malloc'ed path the caller must free.
+ */
+static char* newPath(char const* const dir_path, char const* const entry) {
+    size_t const dir_len = strlen(dir_path);
+    bool const   isSlash = dir_len > 0 && dir_path[dir_len - 1] == '/';
+    size_t const len     = dir_len + !isSlash + strlen(entry) + 1;
+
+    char* const path = malloc(len);
+    DEBUG_ERROR_IF(path == NULL)
+
+    snprintf(path, len, isSlash ? "%s%s" : "%s/%s", dir_path, entry);
+    return path;
+}
+
+static int compareEntries(void const* const a, void const* const b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/**
+ * @brief Adds the files under a directory in sorted order.
+ *
+ * A directory named on the command line must open. A directory found under it that does NOT open is skipped
+ * with a warning, like find does, so one unreadable directory does NOT stop the walk.
+ */
+static void walkDirectory(char const* const dir_path, bool const isNamed) {
+    DIR* const dir = opendir(dir_path);
+    if (dir == NULL) {
+        if (isNamed) {
+            fprintf(stderr, "\n"
+                            "Directory '%s' could NOT be opened\n"
+                            "\n", dir_path);
+            exit(EXIT_FAILURE);
+        }
+        fprintf(stderr, "Skipping directory '%s', it could NOT be opened\n", dir_path);
+        return;
+    }
+
+    /* Read the whole directory first, so only one directory is open at a time */
+    size_t          n_entries   = 0;
+    size_t          cap_entries = BUFSIZ;
+    char**          entries     = malloc(cap_entries * sizeof(char*));
+    struct dirent*  entry;
+    DEBUG_ERROR_IF(entries == NULL)
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (STR_EQ_CONST(entry->d_name, ".") || STR_EQ_CONST(entry->d_name, "..")) continue;
+
+        REALLOC_IF_NECESSARY(
+            char*, entries,
+            size_t, cap_entries, n_entries,
+            {REALLOC_ERROR;}
+        )
+
+        /* Keep the entry type before the name, DT_UNKNOWN if the file system does NOT know it */
+        size_t const name_len = strlen(entry->d_name);
+        char* const  copy     = malloc(name_len + 2);
+        DEBUG_ERROR_IF(copy == NULL)
+        #ifdef _DIRENT_HAVE_D_TYPE
+            copy[0] = (char)entry->d_type;
+        #else
+            copy[0] = (char)DT_UNKNOWN;
+        #endif
+        memcpy(copy + 1, entry->d_name, name_len + 1);
+        entries[n_entries++] = copy + 1;
+    }
+
+    DEBUG_ERROR_IF(closedir(dir) != 0)
+    NDEBUG_EXECUTE(closedir(dir))
+
+    qsort(entries, n_entries, sizeof(char*), compareEntries);
+
+    for (char** name = entries; name < entries + n_entries; name++) {
+        unsigned char type = (unsigned char)(*name)[-1];
+        char* const   path = newPath(dir_path, *name);
+
+        /* A link to a directory is NOT followed, it may be a cycle */
+        if (type == DT_UNKNOWN || type == DT_LNK) {
+            struct stat status;
+            if (lstat(path, &status) != 0) {
+                type = DT_UNKNOWN;
+            } else if (S_ISDIR(status.st_mode)) {
+                type = DT_DIR;
+            } else if (S_ISREG(status.st_mode)) {
+                type = DT_REG;
+            } else if (S_ISLNK(status.st_mode) && stat(path, &status) == 0 && S_ISREG(status.st_mode)) {
+                type = DT_REG;
+            } else {
+                type = DT_UNKNOWN;
+            }
+        }
+
+        if (!isExcludedPath(path)) {
+            if (type == DT_DIR) {
+                walkDirectory(path, 0);
+            } else if (type == DT_REG && isIncludedPath(path)) {
+                VERBOSE_MSG_VARIADIC("WALK_FILE => %s", path);
+                addName(path, strlen(path));
+                input_bytes += WALK_FILE_LEN_GUESS;
+            }
+        }
+
+        free(path);
+        free(*name - 1);
+    }
+
+    free(entries);
+}
+
+/**
+ * @brief Parses a numeric field of a tar header, octal or GNU base-256.
+ */
+static uint64_t parseTarNumber(unsigned char const* const field, size_t const len) {
+    uint64_t value = 0;
+
+    if (field[0] & 0x80) {
+        for (size_t i = 1; i < len; i++) value = (value << 8) | field[i];
+        return value;
+    }
+
+    size_t i = 0;
+    while (i < len && field[i] == ' ') i++;
+
+    for (; i < len && field[i] != '\0' && field[i] != ' '; i++) {
+        if (field[i] < '0' || field[i] > '7') break;
+        value = (value << 3) | (uint64_t)(field[i] - '0');
+    }
+    return value;
+}
+
+static bool isTarHeaderValid(unsigned char const* const header) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < WALK_TAR_BLOCK_SIZE; i++)
+        sum += (i >= 148 && i < 156) ? (uint64_t)' ' : header[i];
+    return sum == parseTarNumber(header + 148, 8);
+}
+
+static void showCorruptTarError(char const* const tar_path) {
+    fprintf(stderr, "\n"
+                    "Archive '%s' is NOT a valid tar archive\n"
+                    "\n", tar_path);
+    exit(EXIT_FAILURE);
+}
+
+static void showTarNOTOpenedError(char const* const tar_path) {
+    fprintf(stderr, "\n"
+                    "Archive '%s' could NOT be opened\n"
+                    "\n", tar_path);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Reads the data of a tar member that names the next member, i.e., GNU 'L' or pax 'x'.
+ * @return A malloc'ed name the caller must free, or NULL if a pax header has no path.
+ */
+static char* readLongName(FILE* const stream, char const* const tar_path, uint64_t const len, bool const isPax) {
+    char* const data = malloc(len + 1);
+    DEBUG_ERROR_IF(data == NULL)
+    if (fread(data, 1, len, stream) != len) showCorruptTarError(tar_path);
+    data[len] = '\0';
+
+    if (!isPax) return data;
+
+    /* Every pax record is "LENGTH KEY=VALUE\n" */
+    for (char* record = data; record < data + len;) {
+        char*               key;
+        unsigned long const record_len = strtoul(record, &key, 10);
+        if (record_len == 0 || *key != ' ' || record + record_len > data + len) break;
+
+        key++;
+        if (STR_CONTAINS_CONST(key, "path=")) {
+            char* const value = key + 5;
+            size_t const value_len = (size_t)(record + record_len - 1 - value);
+            memmove(data, value, value_len);
+            data[value_len] = '\0';
+            return data;
+        }
+        record += record_len;
+    }
+
+    free(data);
+    return NULL;
+}
+
+static void addMember(uint32_t const archive_id, char const* const tar_path, char const* name, uint64_t const offset, uint64_t const len) {
+    while (STR_CONTAINS_CONST(name, "./")) name += 2;
+
+    char* const    path     = newPath(tar_path, name);
+    uint64_t const path_len = strlen(path);
+
+    if (!isExcludedPath(path) && isIncludedPath(path)) {
+        uint32_t const n_members = getKeyCount_cset(members);
+        uint32_t const member_id = addKey_cset(members, path, path_len);
+        DEBUG_ERROR_IF(member_id == 0xFFFFFFFF)
+
+        REALLOC_IF_NECESSARY(
+            TarMember, tar_members,
+            uint32_t, cap_tar_members, member_id,
+            {REALLOC_ERROR;}
+        )
+        tar_members[member_id] = (TarMember){ archive_id, offset, len };
+
+        /* A later member with the same name replaces the earlier one */
+        if (member_id == n_members) {
+            VERBOSE_MSG_VARIADIC("WALK_TAR_MEMBER => %s", path);
+            addName(path, path_len);
+            input_bytes += len;
+        }
+    }
+
+    free(path);
+}
+
+static void walkTar(char const* const tar_path) {
+    FILE* const stream = fopen(tar_path, "rb");
+    if (stream == NULL) showTarNOTOpenedError(tar_path);
+
+    uint32_t const archive_id = add_chunk(archives, tar_path, strlen(tar_path));
+    DEBUG_ERROR_IF(archive_id == 0xFFFFFFFF)
+
+    unsigned char header[WALK_TAR_BLOCK_SIZE];
+    uint64_t      offset    = 0;
+    char*         next_name = NULL;
+
+    while (fread(header, 1, WALK_TAR_BLOCK_SIZE, stream) == WALK_TAR_BLOCK_SIZE) {
+        offset += WALK_TAR_BLOCK_SIZE;
+
+        /* The archive ends with zero blocks */
+        bool isZero = 1;
+        for (size_t i = 0; i < WALK_TAR_BLOCK_SIZE && isZero; i++) isZero = header[i] == 0;
+        if (isZero) break;
+
+        if (!isTarHeaderValid(header)) showCorruptTarError(tar_path);
+
+        uint64_t const len     = parseTarNumber(header + 124, 12);
+        uint64_t const padding = (WALK_TAR_BLOCK_SIZE - len % WALK_TAR_BLOCK_SIZE) % WALK_TAR_BLOCK_SIZE;
+        uint64_t       skipped = len + padding;
+        char const     type    = (char)header[156];
+
+        if (type == 'L' || type == 'x') {
+            free(next_name);
+            next_name = readLongName(stream, tar_path, len, type == 'x');
+            skipped   = padding;
+        } else if (type == '0' || type == '\0' || type == '7') {
+            if (next_name != NULL) {
+                addMember(archive_id, tar_path, next_name, offset, len);
+            } else {
+                /* A ustar name may be split into a prefix and a name */
+                char name[155 + 1 + 100 + 1];
+                int  name_len = 0;
+                if (memcmp(header + 257, "ustar", 5) == 0 && header[345] != '\0')
+                    name_len = snprintf(name, sizeof(name), "%.155s/", (char const*)header + 345);
+                snprintf(name + name_len, sizeof(name) - (size_t)name_len, "%.100s", (char const*)header);
+                addMember(archive_id, tar_path, name, offset, len);
+            }
+            free(next_name);
+            next_name = NULL;
+        } else {
+            free(next_name);
+            next_name = NULL;
+        }
+
+        if (skipped > 0 && fseeko(stream, (off_t)skipped, SEEK_CUR) != 0) showCorruptTarError(tar_path);
+        offset += len + padding;
+    }
+
+    free(next_name);
+
+    DEBUG_ERROR_IF(fclose(stream) == EOF)
+    NDEBUG_EXECUTE(fclose(stream))
+}
+
+void addPattern_walk(char const* const pattern, bool const isExcluded) {
+    DEBUG_ERROR_IF(pattern == NULL)
+
+    if (patterns[isExcluded] == NULL) {
+        cap_patterns[isExcluded] = WALK_PATTERNS_INITIAL_CAP;
+        patterns[isExcluded]     = malloc(cap_patterns[isExcluded] * sizeof(char const*));
+        DEBUG_ERROR_IF(patterns[isExcluded] == NULL)
+    }
+    REALLOC_IF_NECESSARY(
+        char const*, patterns[isExcluded],
+        size_t, cap_patterns[isExcluded], n_patterns[isExcluded],
+        {REALLOC_ERROR;}
+    )
+    patterns[isExcluded][n_patterns[isExcluded]++] = pattern;
+}
+
+void expand_walk(char const*** const infiles, size_t* const n_infiles, size_t* const cap_infiles, uint32_t const n_jobs) {
+    DEBUG_ERROR_IF(infiles == NULL)
+    DEBUG_ERROR_IF(n_infiles == NULL)
+    DEBUG_ERROR_IF(cap_infiles == NULL)
+    DEBUG_ERROR_IF(n_jobs == 0)
+
+    if (*n_infiles == 0) return;
+
+    unsigned char* const kinds = malloc(*n_infiles);
+    uint64_t* const      lens  = malloc(*n_infiles * sizeof(uint64_t));
+    DEBUG_ERROR_IF(kinds == NULL)
+    DEBUG_ERROR_IF(lens == NULL)
+
+    /* One stat per infile, a long '--files-from' list stats in parallel */
+    size_t const n_threads = n_jobs < *n_infiles ? n_jobs : *n_infiles;
+    ClassifyJob* const jobs = malloc(n_threads * sizeof(ClassifyJob));
+    DEBUG_ERROR_IF(jobs == NULL)
+
+    for (size_t job_id = 0; job_id < n_threads; job_id++)
+        jobs[job_id] = (ClassifyJob){ *infiles, *n_infiles, kinds, lens, job_id, n_threads };
+
+    for (ClassifyJob* job = jobs + 1; job < jobs + n_threads; job++) {
+        DEBUG_ERROR_IF(pthread_create(&job->thread, NULL, classify, job) != 0)
+        NDEBUG_EXECUTE(pthread_create(&job->thread, NULL, classify, job))
+    }
+    classify(jobs);
+    for (ClassifyJob* job = jobs + 1; job < jobs + n_threads; job++) {
+        DEBUG_ERROR_IF(pthread_join(job->thread, NULL) != 0)
+        NDEBUG_EXECUTE(pthread_join(job->thread, NULL))
+    }
+    free(jobs);
+
+    bool isExpanding = 0;
+    input_bytes      = 0;
+    for (size_t infile_id = 0; infile_id < *n_infiles; infile_id++) {
+        isExpanding |= kinds[infile_id] != WALK_KIND_FILE;
+        input_bytes += lens[infile_id];
+    }
+    free(lens);
+
+    if (!isExpanding) {
+        free(kinds);
+        return;
+    }
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_chunk(names, CHUNK_RECOMMENDED_PARAMETERS))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_chunk(archives, CHUNK_RECOMMENDED_PARAMETERS))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(constructEmpty_cset(members, CHUNK_SET_RECOMMENDED_PARAMETERS))
+
+    cap_tar_members = UNIT_COUNT_GUESS;
+    tar_members     = malloc(cap_tar_members * sizeof(TarMember));
+    DEBUG_ERROR_IF(tar_members == NULL)
+
+    for (size_t infile_id = 0; infile_id < *n_infiles; infile_id++) {
+        char const* const infile = (*infiles)[infile_id];
+        switch (kinds[infile_id]) {
+            case WALK_KIND_DIRECTORY:
+                VERBOSE_MSG_VARIADIC("WALK_DIRECTORY => %s", infile);
+                walkDirectory(infile, 1);
+                break;
+            case WALK_KIND_TAR:
+                VERBOSE_MSG_VARIADIC("WALK_TAR => %s", infile);
+                walkTar(infile);
+                break;
+            default:
+                addName(infile, strlen(infile));
+        }
+    }
+    free(kinds);
+
+    /* The names do NOT move anymore, so point the infiles to them */
+    *n_infiles = 0;
+    for (uint32_t name_id = 0; name_id < names->nStrings; name_id++) {
+        REALLOC_IF_NECESSARY(
+            char const*, *infiles,
+            size_t, *cap_infiles, *n_infiles,
+            {REALLOC_ERROR;}
+        )
+        (*infiles)[(*n_infiles)++] = get_chunk(names, name_id);
+    }
+
+    VERBOSE_MSG_VARIADIC("WALK_COMPLETED => %zu files", *n_infiles);
+}
+
+bool findMember_walk(char const* const infile, char const** const archive, TarMember* const member) {
+    DEBUG_ERROR_IF(infile == NULL)
+    DEBUG_ERROR_IF(archive == NULL)
+    DEBUG_ERROR_IF(member == NULL)
+
+    if (!isValid_cset(members) || getKeyCount_cset(members) == 0) return 0;
+
+    uint32_t const member_id = getKeyId_cset(members, infile, strlen(infile));
+    if (member_id == 0xFFFFFFFF) return 0;
+
+    *member  = tar_members[member_id];
+    *archive = get_chunk(archives, member->archive_id);
+    return 1;
+}
+
+void free_walk(void) {
+    for (size_t isExcluded = 0; isExcluded < 2; isExcluded++) {
+        free(patterns[isExcluded]);
+        patterns[isExcluded]     = NULL;
+        n_patterns[isExcluded]   = 0;
+        cap_patterns[isExcluded] = 0;
+    }
+
+    if (!isValid_chunk(names)) return;
+
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_chunk(names))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_chunk(archives))
+    DEBUG_ASSERT_NDEBUG_EXECUTE(free_cset(members))
+
+    free(tar_members);
+    tar_members     = NULL;
+    cap_tar_members = 0;
+}
+
+uint64_t getInputBytes_walk(void) {
+    return input_bytes;
+}
@@ -0,0 +1,293 @@
+/**
+ * @file writer.c
+ * @brief Implements functions defined in writer.h.
+ * @author Yavuz Koroglu
+ * @see writer.h
+ */
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+    #include <unistd.h>
+#endif
+#include <zlib.h>
+
+#include "srcmetrics/writer.h"
+#include "padkit/debug.h"
+
+/* gzip instead of the zlib format, see deflateInit2() */
+#define GZIP_WINDOW_BITS    (15 + 16)
+#define GZIP_MEMORY_LEVEL   8
+
+#define FLOAT_DIGITS_MAX    9
+
+static double const powersOf10[FLOAT_DIGITS_MAX + 1] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+/**
+ * @brief Writes bytes to the file descriptor of a stream, bypassing its buffer.
+ * @return 0 if the bytes cannot be written, 1 otherwise.
+ */
+static bool drain(FILE* const stream, char const* bytes, size_t len) {
+    #ifdef _WIN32
+        return fwrite(bytes, 1, len, stream) == len;
+    #else
+        int const fd = fileno(stream);
+        while (len > 0) {
+            ssize_t const n = write(fd, bytes, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return 0;
+            }
+            bytes += n;
+            len   -= (size_t)n;
+        }
+        return 1;
+    #endif
+}
+
+/**
+ * @brief Passes bytes through zlib and drains whatever comes out.
+ * @return 0 if zlib or the stream fails, 1 otherwise.
+ */
+static bool deflateBytes(Writer* const writer, char const* const bytes, size_t const len, int const flush) {
+    z_stream* const gzip = writer->gzip;
+
+    gzip->next_in  = (Bytef*)(uintptr_t)bytes;
+    gzip->avail_in = (uInt)len;
+    do {
+        gzip->next_out  = (Bytef*)writer->compressed;
+        gzip->avail_out = WRITER_BUFFER_SIZE;
+        if (deflate(gzip, flush) == Z_STREAM_ERROR) return 0;
+        if (!drain(writer->stream, writer->compressed, WRITER_BUFFER_SIZE - gzip->avail_out)) return 0;
+    } while (gzip->avail_out == 0);
+
+    return gzip->avail_in == 0;
+}
+
+/**
+ * @brief Writes the buffer, and the bytes that do NOT fit in it, to the stream.
+ */
+static void spill(Writer* const writer, char const* const bytes, size_t const len, int const flush) {
+    if (!writer->hasFailed && writer->gzip != NULL) {
+        writer->hasFailed = !deflateBytes(writer, writer->buffer, writer->len, len > 0 ? Z_NO_FLUSH : flush)
+            || (len > 0 && !deflateBytes(writer, bytes, len, flush));
+    } else if (!writer->hasFailed) {
+        writer->hasFailed = !drain(writer->stream, writer->buffer, writer->len)
+            || !drain(writer->stream, bytes, len);
+    }
+
+    /* Nothing is written after an error, but the buffer is still emptied */
+    writer->len = 0;
+}
+
+/**
+ * @brief Parses "%f" or "%.Nf" for 0 <= N <= FLOAT_DIGITS_MAX.
+ * @return The number of fraction digits, or -1 for any other format.
+ */
+static int parseFloatDigits(char const* const format) {
+    if (strcmp(format, "%f") == 0) return 6;
+    if (format[0] != '%' || format[1] != '.' || format[2] < '0' || format[2] > '0' + FLOAT_DIGITS_MAX) return -1;
+    if (format[3] != 'f' || format[4] != '\0') return -1;
+    return format[2] - '0';
+}
+
+/**
+ * @brief Writes the digits of an unsigned number backwards, ending at the end pointer.
+ * @return The first digit.
+ */
+static char* formatDigits(char* end, uint64_t n) {
+    do {
+        *--end = (char)('0' + n % 10);
+        n /= 10;
+    } while (n > 0);
+    return end;
+}
+
+/**
+ * @brief Formats a float as printf() does with "%.Nf", rounding the exact binary value half to even.
+ * @return The length, or 0 if the value is NOT finite or too large for the fast path.
+ */
+static size_t formatFloat(char* const out, double const x, int const digits) {
+    if (!isfinite(x)) return 0;
+
+    double const scale = powersOf10[digits];
+    double const a     = fabs(x);
+    double const p     = a * scale;
+    if (p >= 9007199254740992.0) return 0;
+
+    /* a * scale == p + e exactly, so the rounding is decided on the exact product */
+    double const e = fma(a, scale, -p);
+    double const r = floor(p);
+    double const d = (p - r) - 0.5;
+
+    uint64_t q = (uint64_t)r;
+    if (d > -e || (d == -e && (q & 1))) q++;
+
+    char  digitsOf[WRITER_VALUE_LEN_MAX];
+    char* const end   = digitsOf + sizeof(digitsOf);
+    char*       first = end;
+
+    uint64_t const unit = (uint64_t)scale;
+    if (digits > 0) {
+        uint64_t fraction = q % unit;
+        for (int i = 0; i < digits; i++, fraction /= 10) *--first = (char)('0' + fraction % 10);
+        *--first = '.';
+    }
+    first = formatDigits(first, q / unit);
+    if (signbit(x)) *--first = '-';
+
+    size_t const len = (size_t)(end - first);
+    memcpy(out, first, len);
+    return len;
+}
+
+/**
+ * @brief Formats a value with snprintf() for a format the Writer does NOT know.
+ */
+static void writeFormatted(Writer* const writer, char const* const format, ...) {
+    va_list args;
+    va_list retry;
+    va_start(args, format);
+    va_copy(retry, args);
+
+    int n = vsnprintf(writer->buffer + writer->len, WRITER_BUFFER_SIZE - writer->len, format, args);
+    if (n >= 0 && (size_t)n >= WRITER_BUFFER_SIZE - writer->len) {
+        /* Too long for the rest of the buffer, so it starts an empty buffer */
+        spill(writer, NULL, 0, Z_NO_FLUSH);
+        n = vsnprintf(writer->buffer, WRITER_BUFFER_SIZE, format, retry);
+    }
+
+    va_end(retry);
+    va_end(args);
+
+    if (n < 0 || (size_t)n >= WRITER_BUFFER_SIZE - writer->len)
+        writer->hasFailed = 1;
+    else
+        writer->len += (size_t)n;
+}
+
+bool close_writer(Writer* const writer) {
+    DEBUG_ASSERT(isOpen_writer(writer))
+
+    spill(writer, NULL, 0, Z_FINISH);
+    if (writer->gzip != NULL) {
+        deflateEnd(writer->gzip);
+        free(writer->gzip);
+        free(writer->compressed);
+    }
+    free(writer->buffer);
+
+    bool const isWritten = !writer->hasFailed;
+    memset(writer, 0, sizeof(Writer));
+    return isWritten;
+}
+
+bool flush_writer(Writer* const writer) {
+    DEBUG_ASSERT(isOpen_writer(writer))
+
+    spill(writer, NULL, 0, Z_SYNC_FLUSH);
+    return !writer->hasFailed;
+}
+
+bool isOpen_writer(Writer const* const writer) {
+    return writer != NULL && writer->stream != NULL && writer->buffer != NULL && writer->len <= WRITER_BUFFER_SIZE;
+}
+
+bool open_writer(Writer* const writer, FILE* const stream, bool const isCompressing) {
+    DEBUG_ERROR_IF(writer == NULL)
+    DEBUG_ERROR_IF(stream == NULL)
+
+    memset(writer, 0, sizeof(Writer));
+
+    /* The bytes the stream buffered so far come first */
+    if (fflush(stream) == EOF) return 0;
+
+    writer->buffer = malloc(WRITER_BUFFER_SIZE);
+    if (writer->buffer == NULL) return 0;
+
+    if (isCompressing) {
+        writer->gzip       = calloc(1, sizeof(z_stream));
+        writer->compressed = malloc(WRITER_BUFFER_SIZE);
+        if (
+            writer->gzip == NULL || writer->compressed == NULL ||
+            deflateInit2(
+                writer->gzip, Z_DEFAULT_COMPRESSION, Z_DEFLATED, GZIP_WINDOW_BITS, GZIP_MEMORY_LEVEL, Z_DEFAULT_STRATEGY
+            ) != Z_OK
+        ) {
+            free(writer->compressed);
+            free(writer->gzip);
+            free(writer->buffer);
+            memset(writer, 0, sizeof(Writer));
+            return 0;
+        }
+    }
+
+    writer->stream          = stream;
+    writer->float_digits    = parseFloatDigits(VAL_F_FLOAT);
+    writer->isPlainInt      = strcmp(VAL_F_INT, "%d") == 0;
+    writer->isPlainUnsigned = strcmp(VAL_F_UNSIGNED, "%u") == 0;
+
+    return 1;
+}
+
+void write_writer(Writer* const writer, char const* const bytes, size_t const len) {
+    DEBUG_ASSERT(isOpen_writer(writer))
+    DEBUG_ERROR_IF(bytes == NULL && len > 0)
+
+    if (len <= WRITER_BUFFER_SIZE - writer->len) {
+        memcpy(writer->buffer + writer->len, bytes, len);
+        writer->len += len;
+    } else {
+        spill(writer, bytes, len, Z_NO_FLUSH);
+    }
+}
+
+void writeString_writer(Writer* const writer, char const* const str) {
+    DEBUG_ERROR_IF(str == NULL)
+    write_writer(writer, str, strlen(str));
+}
+
+void writeValue_writer(Writer* const writer, Value const value) {
+    DEBUG_ASSERT(isOpen_writer(writer))
+
+    if (WRITER_BUFFER_SIZE - writer->len < WRITER_VALUE_LEN_MAX) spill(writer, NULL, 0, Z_NO_FLUSH);
+
+    char  digits[WRITER_VALUE_LEN_MAX];
+    char* const end   = digits + sizeof(digits);
+    char*       first = end;
+    switch (value.type_code) {
+        case VAL_TC_FLOAT:
+            if (writer->float_digits >= 0) {
+                size_t const len = formatFloat(writer->buffer + writer->len, (double)value.raw.as_float, writer->float_digits);
+                writer->len += len;
+                if (len > 0) return;
+            }
+            writeFormatted(writer, VAL_F_FLOAT, (double)value.raw.as_float);
+            return;
+        case VAL_TC_INT:
+            if (!writer->isPlainInt) {
+                writeFormatted(writer, VAL_F_INT, value.raw.as_int);
+                return;
+            }
+            /* The magnitude of INT_MIN does NOT fit in an int */
+            first = formatDigits(end, value.raw.as_int < 0 ? (uint64_t)-(int64_t)value.raw.as_int : (uint64_t)value.raw.as_int);
+            if (value.raw.as_int < 0) *--first = '-';
+            break;
+        case VAL_TC_UNSIGNED:
+            if (!writer->isPlainUnsigned) {
+                writeFormatted(writer, VAL_F_UNSIGNED, value.raw.as_unsigned);
+                return;
+            }
+            first = formatDigits(end, (uint64_t)value.raw.as_unsigned);
+            break;
+        default:
+            write_writer(writer, "NOT_A_VALUE", sizeof("NOT_A_VALUE") - 1);
+            return;
+    }
+
+    memcpy(writer->buffer + writer->len, first, (size_t)(end - first));
+    writer->len += (size_t)(end - first);
+}
@@ -0,0 +1,158 @@
+/**
+ * @file writer.c
+ * @brief Checks that the Writer formats floats with the same bytes as snprintf().
+ * @author Yavuz Koroglu
+ * @see writer.h
+ *
+ * Usage: make check
+ *
+ * formatFloat() is checked for every "%.Nf" the Writer knows, over ties, zeros, negatives that round to zero,
+ * values around 2^53 / 10^N where the fast path stops, and random doubles. writeValue_writer() is checked
+ * with VAL_F_FLOAT over random floats, so the fallback to snprintf() is checked too. Prints the first few
+ * mismatches, and exits with failure if there is any.
+ */
+#include "../src/srcmetrics/writer.c"
+
+#define CHECK_RANDOM_COUNT      1000000
+#define CHECK_MISMATCHES_SHOWN  16
+
+static uint64_t state       = 20231;
+static uint64_t n_checked   = 0;
+static uint64_t n_mismatch  = 0;
+
+/**
+ * @brief A 64-bit LCG, so the sweep does NOT depend on the rand() of the platform.
+ */
+static uint64_t nextRandom(void) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return state;
+}
+
+static void report(char const* const format, double const x, char const* const expected, char const* const actual) {
+    if (++n_mismatch > CHECK_MISMATCHES_SHOWN) return;
+    fprintf(stderr, "%s of %a: snprintf() gives '%s', the Writer gives '%s'\n", format, x, expected, actual);
+}
+
+/**
+ * @brief Compares formatFloat() with snprintf() for one value, unless the value is off the fast path.
+ */
+static void checkDouble(double const x, int const digits) {
+    char format[8];
+    char expected[WRITER_VALUE_LEN_MAX * 8];
+    char actual[WRITER_VALUE_LEN_MAX];
+
+    snprintf(format, sizeof(format), "%%.%df", digits);
+    snprintf(expected, sizeof(expected), format, x);
+
+    size_t const len = formatFloat(actual, x, digits);
+    if (len == 0) {
+        /* Off the fast path, so writeValue_writer() calls snprintf() */
+        if (isfinite(x) && fabs(x) * powersOf10[digits] < 9007199254740992.0) report(format, x, expected, "");
+        return;
+    }
+    actual[len] = '\0';
+
+    n_checked++;
+    if (strcmp(expected, actual) != 0) report(format, x, expected, actual);
+}
+
+static void checkAllDigits(double const x) {
+    for (int digits = 0; digits <= FLOAT_DIGITS_MAX; digits++) {
+        checkDouble(x, digits);
+        checkDouble(-x, digits);
+    }
+}
+
+/**
+ * @brief Compares writeValue_writer() with snprintf(VAL_F_FLOAT) for floats, through a temporary file.
+ */
+static void checkWriter(void) {
+    FILE* const stream = tmpfile();
+    DEBUG_ERROR_IF(stream == NULL)
+
+    float* const values = malloc(CHECK_RANDOM_COUNT * sizeof(float));
+    DEBUG_ERROR_IF(values == NULL)
+
+    Writer writer[1];
+    DEBUG_ASSERT_NDEBUG_EXECUTE(open_writer(writer, stream, 0))
+    for (size_t i = 0; i < CHECK_RANDOM_COUNT; i++) {
+        /* Every finite float is a bit pattern with an exponent below 255 */
+        uint32_t bits;
+        do bits = (uint32_t)(nextRandom() >> 32); while (((bits >> 23) & 0xFF) == 0xFF);
+        memcpy(values + i, &bits, sizeof(float));
+
+        writeValue_writer(writer, VAL_FLOAT(values[i]));
+        write_writer(writer, "\n", 1);
+    }
+    DEBUG_ASSERT_NDEBUG_EXECUTE(close_writer(writer))
+
+    rewind(stream);
+    static char line[BUFSIZ];
+    static char expected[BUFSIZ];
+    for (size_t i = 0; i < CHECK_RANDOM_COUNT; i++) {
+        if (fgets(line, sizeof(line), stream) == NULL) {
+            report(VAL_F_FLOAT, (double)values[i], "", "<EOF>");
+            break;
+        }
+        line[strcspn(line, "\n")] = '\0';
+
+        snprintf(expected, sizeof(expected), VAL_F_FLOAT, (double)values[i]);
+
+        n_checked++;
+        if (strcmp(expected, line) != 0) report(VAL_F_FLOAT, (double)values[i], expected, line);
+    }
+
+    free(values);
+    fclose(stream);
+}
+
+int main(void) {
+    /* Zeros, and the halves that are exact in binary, i.e., true ties */
+    checkAllDigits(0.0);
+    for (int64_t i = 0; i < 100000; i++) {
+        checkAllDigits((double)i + 0.5);
+        checkAllDigits((double)i / 1024.0);
+        checkAllDigits((double)(2 * i + 1) / 2048.0);
+    }
+
+    /* The decimal halves, which are NOT exact in binary, and the neighbors of both kinds */
+    for (int digits = 0; digits <= FLOAT_DIGITS_MAX; digits++) {
+        for (int64_t i = 0; i < 10000; i++) {
+            double const half = ((double)i + 0.5) / powersOf10[digits];
+            checkAllDigits(half);
+            checkAllDigits(nextafter(half, 0.0));
+            checkAllDigits(nextafter(half, INFINITY));
+        }
+    }
+
+    /* Negatives that round to zero, e.g., "-0.00" */
+    for (int digits = 0; digits <= FLOAT_DIGITS_MAX; digits++) {
+        for (double x = 0.49 / powersOf10[digits]; x > 1e-300; x /= 3.0) checkDouble(-x, digits);
+        checkDouble(-5e-324, digits);
+    }
+
+    /* Around 2^53 / 10^N, where the fast path ends */
+    for (int digits = 0; digits <= FLOAT_DIGITS_MAX; digits++) {
+        double below = 9007199254740992.0 / powersOf10[digits];
+        double above = below;
+        for (int i = 0; i < 1000; i++) {
+            checkAllDigits(below);
+            checkAllDigits(above);
+            below = nextafter(below, 0.0);
+            above = nextafter(above, INFINITY);
+        }
+    }
+
+    /* Random doubles of every magnitude the fast path takes */
+    for (size_t i = 0; i < CHECK_RANDOM_COUNT; i++) {
+        uint64_t const bits  = nextRandom();
+        double const   unit  = (double)(bits >> 11) / 9007199254740992.0;
+        int const      scale = (int)(nextRandom() >> 58) - 24;
+        checkAllDigits(ldexp(unit, scale));
+    }
+
+    checkWriter();
+
+    printf("%llu values, %llu mismatches\n", (unsigned long long)n_checked, (unsigned long long)n_mismatch);
+    return n_mismatch == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file gentaghash.c
+ * @brief Searches the seed of the perfect tag hash of getTagId_cparse() and prints its table.
+ * @author Yavuz Koroglu
+ * @see c.h
+ *
+ * Usage: gentaghash [first_seed]
+ *
+ * Tries the seeds from first_seed (default 0) up, and prints the C_TAG_HASH_SEED and C_TAG_HASH_TABLE of the
+ * first seed that puts every tag of C_ELEMENT_TAGS in a different slot. Paste the output over the two macros
+ * in c.h after changing the tags, C_TAG_HASH_PRIME, or C_TAG_HASH_SIZE.
+ */
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "languages/c.h"
+
+#define GENTAGHASH_COLUMNS  8
+
+static char const* const element_tags[C_TAG_COUNT] = C_ELEMENT_TAGS;
+
+/**
+ * @brief The same hash as getTagId_cparse().
+ */
+static uint32_t hashTag(uint32_t const seed, char const* const tag) {
+    uint32_t hash = seed;
+    for (unsigned char const* c = (unsigned char const*)tag; *c; c++)
+        hash = (hash ^ *c) * C_TAG_HASH_PRIME;
+    return (hash >> 16) % C_TAG_HASH_SIZE;
+}
+
+/**
+ * @brief Fills a table for a seed.
+ * @return 1 if every tag has its own slot, 0 otherwise.
+ */
+static int fillTable(uint32_t const seed, unsigned* const table) {
+    for (size_t slot = 0; slot < C_TAG_HASH_SIZE; slot++) table[slot] = C_NOT_A_TAG;
+
+    for (unsigned tag_id = 0; tag_id < C_TAG_COUNT; tag_id++) {
+        uint32_t const slot = hashTag(seed, element_tags[tag_id]);
+        if (table[slot] != C_NOT_A_TAG) return 0;
+        table[slot] = tag_id;
+    }
+
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    static unsigned table[C_TAG_HASH_SIZE];
+
+    if (argc > 2) {
+        fputs("\n"
+              "Usage: gentaghash [first_seed]\n"
+              "\n", stderr);
+        return EXIT_FAILURE;
+    }
+
+    unsigned long seed = 0;
+    if (argc == 2) {
+        char* end;
+        errno = 0;
+        seed  = strtoul(argv[1], &end, 10);
+        if (errno != 0 || *end != '\0' || seed > UINT32_MAX) {
+            fprintf(stderr, "\n"
+                            "Invalid first_seed '%s'\n"
+                            "\n", argv[1]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    while (!fillTable((uint32_t)seed, table)) {
+        if (seed == UINT32_MAX) {
+            fputs("\n"
+                  "No seed puts every tag in a different slot, try a larger C_TAG_HASH_SIZE\n"
+                  "\n", stderr);
+            return EXIT_FAILURE;
+        }
+        seed++;
+    }
+
+    printf("    #define C_TAG_HASH_SEED     %luU\n", seed);
+    printf("\n");
+    printf("    #define C_TAG_HASH_TABLE {                  \\\n");
+    for (size_t slot = 0; slot < C_TAG_HASH_SIZE; slot++) {
+        if (slot % GENTAGHASH_COLUMNS == 0) printf("       ");
+        printf(" %3u%c", table[slot], slot + 1 < C_TAG_HASH_SIZE ? ',' : ' ');
+        if (slot % GENTAGHASH_COLUMNS == GENTAGHASH_COLUMNS - 1 || slot + 1 == C_TAG_HASH_SIZE) printf(" \\\n");
+    }
+    printf("    }\n");
+
+    return EXIT_SUCCESS;
+}